@@ -0,0 +1,329 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+/**
+ * @file led_strip_fixed.h
+ * @brief Header-only RMT LED strip whose length, pixel format and model are compile-time constants
+ *
+ * There is no function table, no runtime format check and no bounds check outside assert(), so the
+ * compiler can inline and unroll the frame loops. One strip configuration per translation unit:
+ *
+ * @code
+ * #define LED_STRIP_FIXED_LEN   8
+ * #define LED_STRIP_FIXED_BPP   3                          // 3 = GRB, 4 = GRBW
+ * #define LED_STRIP_FIXED_MODEL LED_STRIP_FIXED_MODEL_WS2812
+ * #include "led_strip_fixed.h"
+ *
+ * static led_strip_fixed_t strip;
+ * led_strip_fixed_init(&strip, GPIO_NUM_39);
+ * @endcode
+ */
+
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/cdefs.h>
+#include "esp_err.h"
+#include "driver/rmt_tx.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LED_STRIP_FIXED_MODEL_WS2812 1
+#define LED_STRIP_FIXED_MODEL_SK6812 2
+
+#ifndef LED_STRIP_FIXED_LEN
+#error "define LED_STRIP_FIXED_LEN before including led_strip_fixed.h"
+#endif
+#ifndef LED_STRIP_FIXED_BPP
+#define LED_STRIP_FIXED_BPP 3
+#endif
+#ifndef LED_STRIP_FIXED_MODEL
+#define LED_STRIP_FIXED_MODEL LED_STRIP_FIXED_MODEL_WS2812
+#endif
+
+#if LED_STRIP_FIXED_BPP != 3 && LED_STRIP_FIXED_BPP != 4
+#error "LED_STRIP_FIXED_BPP must be 3 (GRB) or 4 (GRBW)"
+#endif
+
+/**
+ * @brief RMT resolution; all bit timings below are in ticks of 0.1 us
+ */
+#define LED_STRIP_FIXED_RESOLUTION_HZ 10000000
+
+#if LED_STRIP_FIXED_MODEL == LED_STRIP_FIXED_MODEL_WS2812
+#define LED_STRIP_FIXED_T0H 3 // 0.3 us
+#define LED_STRIP_FIXED_T0L 9 // 0.9 us
+#define LED_STRIP_FIXED_T1H 9 // 0.9 us
+#define LED_STRIP_FIXED_T1L 3 // 0.3 us
+#elif LED_STRIP_FIXED_MODEL == LED_STRIP_FIXED_MODEL_SK6812
+#define LED_STRIP_FIXED_T0H 3 // 0.3 us
+#define LED_STRIP_FIXED_T0L 9 // 0.9 us
+#define LED_STRIP_FIXED_T1H 6 // 0.6 us
+#define LED_STRIP_FIXED_T1L 6 // 0.6 us
+#else
+#error "unknown LED_STRIP_FIXED_MODEL"
+#endif
+
+#define LED_STRIP_FIXED_RESET_TICKS 1400 // 2 x 140 us = 280 us, enough for WS2812B-V5
+
+/**
+ * @brief LED strip encoder; the object itself lives inside led_strip_fixed_t, only the RMT
+ *        bytes/copy encoders it chains are allocated by the RMT driver
+ */
+typedef struct {
+    rmt_encoder_t base;
+    rmt_encoder_handle_t bytes_encoder;
+    rmt_encoder_handle_t copy_encoder;
+    int state;
+} led_strip_fixed_encoder_t;
+
+/**
+ * @brief Fixed-size LED strip: RMT channel, encoder and pixel buffer in one static object
+ *
+ * The pixel buffer keeps full-scale colours; gamma and brightness go through a 256-entry level table
+ * when the frame is sent, as the RMT strip encoder does for led_strip_rmt_set_brightness().
+ */
+typedef struct {
+    rmt_channel_handle_t chan;
+    led_strip_fixed_encoder_t encoder;
+    uint8_t pixels[LED_STRIP_FIXED_LEN * LED_STRIP_FIXED_BPP];
+    uint8_t wire[LED_STRIP_FIXED_LEN * LED_STRIP_FIXED_BPP];    // pixels through the level table, what is sent
+    uint8_t brightness;
+    uint8_t gamma[256];     // logical value -> gamma corrected value
+    uint8_t lut[256];       // gamma followed by brightness
+} led_strip_fixed_t;
+
+static const rmt_symbol_word_t led_strip_fixed_reset_code = {
+    .level0 = 0,
+    .duration0 = LED_STRIP_FIXED_RESET_TICKS,
+    .level1 = 0,
+    .duration1 = LED_STRIP_FIXED_RESET_TICKS,
+};
+
+static inline size_t led_strip_fixed_encode(rmt_encoder_t *encoder, rmt_channel_handle_t channel, const void *primary_data,
+                                            size_t data_size, rmt_encode_state_t *ret_state)
+{
+    led_strip_fixed_encoder_t *enc = __containerof(encoder, led_strip_fixed_encoder_t, base);
+    rmt_encode_state_t session_state = RMT_ENCODING_RESET;
+    int state = RMT_ENCODING_RESET;
+    size_t encoded_symbols = 0;
+    switch (enc->state) {
+    case 0: // pixel data
+        encoded_symbols += enc->bytes_encoder->encode(enc->bytes_encoder, channel, primary_data, data_size, &session_state);
+        if (session_state & RMT_ENCODING_COMPLETE) {
+            enc->state = 1;
+        }
+        if (session_state & RMT_ENCODING_MEM_FULL) {
+            state |= RMT_ENCODING_MEM_FULL;
+            goto out;
+        }
+    // fall-through
+    case 1: // reset code
+        encoded_symbols += enc->copy_encoder->encode(enc->copy_encoder, channel, &led_strip_fixed_reset_code,
+                                                     sizeof(led_strip_fixed_reset_code), &session_state);
+        if (session_state & RMT_ENCODING_COMPLETE) {
+            enc->state = 0;
+            state |= RMT_ENCODING_COMPLETE;
+        }
+        if (session_state & RMT_ENCODING_MEM_FULL) {
+            state |= RMT_ENCODING_MEM_FULL;
+            goto out;
+        }
+    }
+out:
+    *ret_state = (rmt_encode_state_t)state;
+    return encoded_symbols;
+}
+
+static inline esp_err_t led_strip_fixed_encoder_reset(rmt_encoder_t *encoder)
+{
+    led_strip_fixed_encoder_t *enc = __containerof(encoder, led_strip_fixed_encoder_t, base);
+    rmt_encoder_reset(enc->bytes_encoder);
+    rmt_encoder_reset(enc->copy_encoder);
+    enc->state = 0;
+    return ESP_OK;
+}
+
+static inline esp_err_t led_strip_fixed_encoder_del(rmt_encoder_t *encoder)
+{
+    // The object is embedded in led_strip_fixed_t: only the chained encoders are released
+    led_strip_fixed_encoder_t *enc = __containerof(encoder, led_strip_fixed_encoder_t, base);
+    rmt_del_encoder(enc->bytes_encoder);
+    rmt_del_encoder(enc->copy_encoder);
+    return ESP_OK;
+}
+
+static inline void led_strip_fixed_update_lut(led_strip_fixed_t *strip)
+{
+    for (int i = 0; i < 256; i++) {
+        strip->lut[i] = (strip->gamma[i] * strip->brightness + 127) / 255;
+    }
+}
+
+/**
+ * @brief Create the RMT channel and encoders of a fixed strip
+ *
+ * @param strip Strip object, usually a static variable
+ * @param gpio_num GPIO connected to the strip data line
+ * @return
+ *      - ESP_OK: strip ready, all pixels off
+ *      - ESP_ERR_NO_MEM / ESP_ERR_INVALID_ARG / ESP_FAIL: error from the RMT driver
+ */
+static inline esp_err_t led_strip_fixed_init(led_strip_fixed_t *strip, int gpio_num)
+{
+    memset(strip, 0, sizeof(*strip));
+    strip->brightness = 255;
+    for (int i = 0; i < 256; i++) {
+        strip->gamma[i] = i;
+    }
+    led_strip_fixed_update_lut(strip);
+    const rmt_tx_channel_config_t chan_config = {
+        .clk_src = RMT_CLK_SRC_DEFAULT,
+        .gpio_num = gpio_num,
+        .mem_block_symbols = 48,
+        .resolution_hz = LED_STRIP_FIXED_RESOLUTION_HZ,
+        .trans_queue_depth = 4,
+    };
+    esp_err_t ret = rmt_new_tx_channel(&chan_config, &strip->chan);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    const rmt_bytes_encoder_config_t bytes_config = {
+        .bit0 = { .level0 = 1, .duration0 = LED_STRIP_FIXED_T0H, .level1 = 0, .duration1 = LED_STRIP_FIXED_T0L },
+        .bit1 = { .level0 = 1, .duration0 = LED_STRIP_FIXED_T1H, .level1 = 0, .duration1 = LED_STRIP_FIXED_T1L },
+        .flags.msb_first = 1,
+    };
+    const rmt_copy_encoder_config_t copy_config = {};
+    strip->encoder.base.encode = led_strip_fixed_encode;
+    strip->encoder.base.reset = led_strip_fixed_encoder_reset;
+    strip->encoder.base.del = led_strip_fixed_encoder_del;
+    ret = rmt_new_bytes_encoder(&bytes_config, &strip->encoder.bytes_encoder);
+    if (ret == ESP_OK) {
+        ret = rmt_new_copy_encoder(&copy_config, &strip->encoder.copy_encoder);
+    }
+    if (ret != ESP_OK) {
+        if (strip->encoder.bytes_encoder) {
+            rmt_del_encoder(strip->encoder.bytes_encoder);
+        }
+        rmt_del_channel(strip->chan);
+        strip->chan = NULL;
+    }
+    return ret;
+}
+
+/**
+ * @brief Set one pixel (GRB order on the wire); index must be below LED_STRIP_FIXED_LEN
+ */
+static inline void led_strip_fixed_set(led_strip_fixed_t *strip, uint32_t index, uint8_t red, uint8_t green, uint8_t blue)
+{
+    assert(index < LED_STRIP_FIXED_LEN);
+    uint8_t *p = &strip->pixels[index * LED_STRIP_FIXED_BPP];
+    p[0] = green;
+    p[1] = red;
+    p[2] = blue;
+#if LED_STRIP_FIXED_BPP == 4
+    p[3] = 0;
+#endif
+}
+
+#if LED_STRIP_FIXED_BPP == 4
+/**
+ * @brief Set one pixel including the white channel (GRBW order on the wire)
+ */
+static inline void led_strip_fixed_set_rgbw(led_strip_fixed_t *strip, uint32_t index, uint8_t red, uint8_t green,
+                                            uint8_t blue, uint8_t white)
+{
+    assert(index < LED_STRIP_FIXED_LEN);
+    uint8_t *p = &strip->pixels[index * LED_STRIP_FIXED_BPP];
+    p[0] = green;
+    p[1] = red;
+    p[2] = blue;
+    p[3] = white;
+}
+#endif
+
+/**
+ * @brief Set every pixel to the same colour; the loop has a constant trip count
+ */
+static inline void led_strip_fixed_fill(led_strip_fixed_t *strip, uint8_t red, uint8_t green, uint8_t blue)
+{
+    for (uint32_t i = 0; i < LED_STRIP_FIXED_LEN; i++) {
+        led_strip_fixed_set(strip, i, red, green, blue);
+    }
+}
+
+/**
+ * @brief Turn every pixel off in the buffer; unlike led_strip_clear() nothing is sent until refresh
+ */
+static inline void led_strip_fixed_clear(led_strip_fixed_t *strip)
+{
+    memset(strip->pixels, 0, sizeof(strip->pixels));
+}
+
+/**
+ * @brief Scale every channel when the frame is sent (255 = full scale); the pixel buffer is not touched
+ *
+ * Takes effect on the next refresh; costs one table lookup per byte of the frame.
+ */
+static inline void led_strip_fixed_set_brightness(led_strip_fixed_t *strip, uint8_t brightness)
+{
+    if (strip->brightness != brightness) {
+        strip->brightness = brightness;
+        led_strip_fixed_update_lut(strip);
+    }
+}
+
+/**
+ * @brief Gamma curve applied before the brightness (1.0 = linear, the default)
+ *
+ * @return
+ *      - ESP_OK: gamma set
+ *      - ESP_ERR_INVALID_ARG: gamma <= 0
+ */
+static inline esp_err_t led_strip_fixed_set_gamma(led_strip_fixed_t *strip, float gamma)
+{
+    if (!(gamma > 0.0f)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (int i = 0; i < 256; i++) {
+        strip->gamma[i] = (uint8_t)(powf(i / 255.0f, gamma) * 255.0f + 0.5f);
+    }
+    led_strip_fixed_update_lut(strip);
+    return ESP_OK;
+}
+
+/**
+ * @brief Send the buffer through the level table and wait for the end of the frame
+ *
+ * @note The channel is enabled only for the transfer, as led_strip_refresh() does, so it does not hold
+ *       a power management lock between frames.
+ */
+static inline esp_err_t led_strip_fixed_refresh(led_strip_fixed_t *strip)
+{
+    const rmt_transmit_config_t tx_conf = {
+        .loop_count = 0,
+    };
+    for (uint32_t i = 0; i < sizeof(strip->pixels); i++) {
+        strip->wire[i] = strip->lut[strip->pixels[i]];
+    }
+    esp_err_t ret = rmt_enable(strip->chan);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    ret = rmt_transmit(strip->chan, &strip->encoder.base, strip->wire, sizeof(strip->wire), &tx_conf);
+    if (ret == ESP_OK) {
+        ret = rmt_tx_wait_all_done(strip->chan, -1);
+    }
+    rmt_disable(strip->chan);
+    return ret;
+}
+
+#ifdef __cplusplus
+}
+#endif
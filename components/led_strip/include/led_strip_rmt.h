@@ -0,0 +1,204 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "led_strip_types.h"
+#include "esp_idf_version.h"
+
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+#include "driver/rmt_types.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief LED Strip RMT specific configuration
+ */
+typedef struct {
+#if ESP_IDF_VERSION < ESP_IDF_VERSION_VAL(5, 0, 0)
+    uint8_t rmt_channel;        /*!< Specify the channel number, the legacy RMT driver doesn't support channel allocator */
+#else // new driver supports specify the clock source and clock resolution
+    rmt_clock_source_t clk_src; /*!< RMT clock source */
+    uint32_t resolution_hz;     /*!< RMT tick resolution, if set to zero, a default resolution (10MHz) will be applied */
+#endif
+    size_t mem_block_symbols;   /*!< How many RMT symbols can one RMT channel hold at one time. Set to 0 will fallback to use the default size. */
+    struct {
+        uint32_t with_dma: 1;   /*!< Use DMA to transmit data */
+    } flags;                    /*!< Extra driver flags */
+} led_strip_rmt_config_t;
+
+/**
+ * @brief Create LED strip based on RMT TX channel
+ *
+ * @param led_config LED strip configuration
+ * @param rmt_config RMT specific configuration
+ * @param ret_strip Returned LED strip handle
+ * @return
+ *      - ESP_OK: create LED strip handle successfully
+ *      - ESP_ERR_INVALID_ARG: create LED strip handle failed because of invalid argument
+ *      - ESP_ERR_NO_MEM: create LED strip handle failed because of out of memory
+ *      - ESP_FAIL: create LED strip handle failed because some other error
+ */
+esp_err_t led_strip_new_rmt_device(const led_strip_config_t *led_config, const led_strip_rmt_config_t *rmt_config, led_strip_handle_t *ret_strip);
+
+/**
+ * @brief Upper bound of the RMT strip object size, excluding the pixel buffer
+ */
+#define LED_STRIP_RMT_OBJ_MAX_SIZE 64
+
+/**
+ * @brief Number of 32-bit words needed to hold an RMT strip object with its pixel buffer
+ *
+ * @param max_leds Maximum number of LEDs, as passed in led_strip_config_t
+ * @param bytes_per_pixel 3 for GRB, 4 for GRBW
+ */
+#define LED_STRIP_RMT_STATIC_MEM_WORDS(max_leds, bytes_per_pixel) \
+    ((LED_STRIP_RMT_OBJ_MAX_SIZE + (max_leds) * (bytes_per_pixel) + 3) / 4)
+
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+/**
+ * @brief Refill interrupts the RMT driver takes to send one frame of a strip with this configuration
+ *
+ * The driver encodes the whole channel memory (or DMA buffer) when the transaction starts and half of it
+ * on each threshold interrupt, until the pixels, the reset code and its end marker are in. One more
+ * interrupt signals the end of the transmission.
+ *
+ * @param max_leds Number of LEDs
+ * @param led_pixel_format Pixel format
+ * @param rmt_config Configuration; mem_block_symbols 0 means the default block
+ */
+uint32_t led_strip_rmt_refills_for_length(uint32_t max_leds, led_pixel_format_t led_pixel_format, const led_strip_rmt_config_t *rmt_config);
+
+/**
+ * @brief Fill an RMT configuration for a strip of the given length
+ *
+ * Uses one channel block while a frame needs at most LED_STRIP_RMT_AUTO_MAX_REFILLS refill interrupts,
+ * then two; a second block is borrowed from the next channel, so short strips leave channels free for
+ * other strips. Past that, DMA is used if the target supports it, with a buffer large enough to hold the
+ * whole frame when possible.
+ *
+ * @param max_leds Number of LEDs
+ * @param led_pixel_format Pixel format
+ * @param rmt_config Configuration to fill; clk_src and resolution_hz are left untouched
+ */
+void led_strip_rmt_config_for_length(uint32_t max_leds, led_pixel_format_t led_pixel_format, led_strip_rmt_config_t *rmt_config);
+
+/**
+ * @brief Refill interrupts per frame above which led_strip_rmt_config_for_length() switches to DMA
+ */
+#define LED_STRIP_RMT_AUTO_MAX_REFILLS 16
+
+/**
+ * @brief Create LED strip based on RMT TX channel, placing the strip object and pixel buffer in caller-provided memory
+ *
+ * @note The RMT channel and encoder are still allocated by the RMT driver. The memory must outlive the strip
+ *       and is not freed by led_strip_del().
+ *
+ * @param led_config LED strip configuration
+ * @param rmt_config RMT specific configuration
+ * @param mem Word-aligned storage, see LED_STRIP_RMT_STATIC_MEM_WORDS
+ * @param mem_size Size of mem in bytes
+ * @param ret_strip Returned LED strip handle
+ * @return
+ *      - ESP_OK: create LED strip handle successfully
+ *      - ESP_ERR_INVALID_ARG: create LED strip handle failed because of invalid argument
+ *      - ESP_ERR_INVALID_SIZE: mem is too small for the requested number of LEDs
+ *      - ESP_ERR_NO_MEM: create LED strip handle failed because the RMT driver is out of memory
+ *      - ESP_FAIL: create LED strip handle failed because some other error
+ */
+esp_err_t led_strip_new_rmt_device_with_mem(const led_strip_config_t *led_config, const led_strip_rmt_config_t *rmt_config,
+                                            uint32_t *mem, size_t mem_size, led_strip_handle_t *ret_strip);
+
+/**
+ * @brief Maximum number of strips in a group (one per RMT TX channel)
+ */
+#define LED_STRIP_RMT_GROUP_MAX_STRIPS 4
+
+/**
+ * @brief Group of RMT strips refreshed together
+ */
+typedef struct led_strip_rmt_group_t led_strip_rmt_group_t;
+typedef led_strip_rmt_group_t *led_strip_rmt_group_handle_t;
+
+/**
+ * @brief Group RMT strips so that one call refreshes all of them in parallel
+ *
+ * On targets with synchronized TX the channels are bound to an RMT sync manager and start on the same
+ * clock edge. The refresh time of the group is that of its longest strip instead of the sum.
+ *
+ * @note The channels stay enabled while the group exists, so the RMT driver keeps its power management
+ *       lock. With a sync manager (more than one strip on a target with synchronized TX) a channel only
+ *       starts together with the others, so led_strip_refresh() and led_strip_clear() on one of the strips
+ *       return ESP_ERR_INVALID_STATE instead of waiting forever: refresh the group, or delete it first.
+ *
+ * @param strips Strips created with led_strip_new_rmt_device() or led_strip_new_rmt_device_with_mem()
+ * @param num_strips Number of strips, 1 to LED_STRIP_RMT_GROUP_MAX_STRIPS
+ * @param ret_group Returned group handle
+ * @return
+ *      - ESP_OK: group created
+ *      - ESP_ERR_INVALID_ARG: a strip is not an RMT strip, or wrong number of strips
+ *      - ESP_ERR_INVALID_STATE: a strip already belongs to a group
+ *      - ESP_ERR_NO_MEM / ESP_FAIL: error from the RMT driver
+ */
+esp_err_t led_strip_rmt_new_group(const led_strip_handle_t *strips, size_t num_strips, led_strip_rmt_group_handle_t *ret_group);
+
+/**
+ * @brief Send the pixel buffers of every strip in the group and wait until all of them are done
+ */
+esp_err_t led_strip_rmt_group_refresh(led_strip_rmt_group_handle_t group);
+
+/**
+ * @brief Delete the group and release its channels; the strips themselves are kept
+ */
+esp_err_t led_strip_rmt_del_group(led_strip_rmt_group_handle_t group);
+
+/**
+ * @brief Scale every channel of an RMT strip while it is encoded (255 = full scale)
+ *
+ * The pixel buffer keeps the values passed to led_strip_set_pixel(); the scale is applied through a
+ * 256-entry table when the bytes are turned into RMT symbols, so changing it costs nothing per pixel.
+ * Takes effect on the next refresh; do not call it while a refresh is in progress.
+ *
+ * @param strip Strip created with led_strip_new_rmt_device() or led_strip_new_rmt_device_with_mem()
+ * @param brightness 0..255
+ * @return
+ *      - ESP_OK: brightness set
+ *      - ESP_ERR_INVALID_ARG: not an RMT strip
+ *      - ESP_ERR_NOT_SUPPORTED: IDF older than 5.3 (no RMT simple encoder)
+ */
+esp_err_t led_strip_rmt_set_brightness(led_strip_handle_t strip, uint8_t brightness);
+
+/**
+ * @brief Gamma curve applied before the brightness while encoding (1.0 = linear, the default)
+ *
+ * @return
+ *      - ESP_OK: gamma set
+ *      - ESP_ERR_INVALID_ARG: not an RMT strip or gamma <= 0
+ *      - ESP_ERR_NOT_SUPPORTED: IDF older than 5.3 (no RMT simple encoder)
+ */
+esp_err_t led_strip_rmt_set_gamma(led_strip_handle_t strip, float gamma);
+
+/**
+ * @brief Get the RMT TX channel behind a strip, e.g. to register an on_trans_done callback
+ *
+ * @note The channel is disabled between refreshes, so rmt_tx_register_event_callbacks() can be called
+ *       on it as long as the strip is not in a group and no refresh is in progress. The callback fires
+ *       after the reset code, i.e. when the LEDs latch the new frame.
+ *
+ * @return
+ *      - ESP_OK: channel returned
+ *      - ESP_ERR_INVALID_ARG: not an RMT strip
+ */
+esp_err_t led_strip_rmt_get_channel(led_strip_handle_t strip, rmt_channel_handle_t *ret_chan);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,364 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <string.h>
+#include <sys/cdefs.h>
+#include "esp_log.h"
+#include "esp_check.h"
+#include "driver/rmt_tx.h"
+#include "led_strip.h"
+#include "led_strip_interface.h"
+#include "led_strip_rmt_encoder.h"
+#include "soc/soc_caps.h"
+
+#define LED_STRIP_RMT_DEFAULT_RESOLUTION 10000000 // 10MHz resolution
+#define LED_STRIP_RMT_DEFAULT_TRANS_QUEUE_SIZE 4
+// the memory size of each RMT channel, in words (4 bytes)
+#if CONFIG_IDF_TARGET_ESP32 || CONFIG_IDF_TARGET_ESP32S2
+#define LED_STRIP_RMT_DEFAULT_MEM_BLOCK_SYMBOLS 64
+#else
+#define LED_STRIP_RMT_DEFAULT_MEM_BLOCK_SYMBOLS 48
+#endif
+
+// DMA buffer bounds, in symbols
+#define LED_STRIP_RMT_DMA_MIN_SYMBOLS 1024
+#define LED_STRIP_RMT_DMA_MAX_SYMBOLS 4096
+
+static const char *TAG = "led_strip_rmt";
+
+typedef struct {
+    led_strip_t base;
+    rmt_channel_handle_t rmt_chan;
+    rmt_encoder_handle_t strip_encoder;
+    uint32_t strip_len;
+    uint8_t bytes_per_pixel;
+    bool static_mem;
+    bool grouped;   // channel kept enabled by a strip group
+    bool synced;    // the group has a sync manager: the channel only starts together with the others
+    uint8_t pixel_buf[];
+} led_strip_rmt_obj;
+
+_Static_assert(sizeof(led_strip_rmt_obj) <= LED_STRIP_RMT_OBJ_MAX_SIZE, "LED_STRIP_RMT_OBJ_MAX_SIZE too small");
+
+static esp_err_t led_strip_rmt_set_pixel(led_strip_t *strip, uint32_t index, uint32_t red, uint32_t green, uint32_t blue)
+{
+    led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
+    ESP_RETURN_ON_FALSE(index < rmt_strip->strip_len, ESP_ERR_INVALID_ARG, TAG, "index out of maximum number of LEDs");
+    uint32_t start = index * rmt_strip->bytes_per_pixel;
+    // In thr order of GRB, as LED strip like WS2812 sends out pixels in this order
+    rmt_strip->pixel_buf[start + 0] = green & 0xFF;
+    rmt_strip->pixel_buf[start + 1] = red & 0xFF;
+    rmt_strip->pixel_buf[start + 2] = blue & 0xFF;
+    if (rmt_strip->bytes_per_pixel > 3) {
+        rmt_strip->pixel_buf[start + 3] = 0;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t led_strip_rmt_set_pixel_rgbw(led_strip_t *strip, uint32_t index, uint32_t red, uint32_t green, uint32_t blue, uint32_t white)
+{
+    led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
+    ESP_RETURN_ON_FALSE(index < rmt_strip->strip_len, ESP_ERR_INVALID_ARG, TAG, "index out of maximum number of LEDs");
+    ESP_RETURN_ON_FALSE(rmt_strip->bytes_per_pixel == 4, ESP_ERR_INVALID_ARG, TAG, "wrong LED pixel format, expected 4 bytes per pixel");
+    uint8_t *buf_start = rmt_strip->pixel_buf + index * 4;
+    // SK6812 component order is GRBW
+    *buf_start = green & 0xFF;
+    *++buf_start = red & 0xFF;
+    *++buf_start = blue & 0xFF;
+    *++buf_start = white & 0xFF;
+    return ESP_OK;
+}
+
+static esp_err_t led_strip_rmt_refresh(led_strip_t *strip)
+{
+    led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
+    rmt_transmit_config_t tx_conf = {
+        .loop_count = 0,
+    };
+
+    // alone, a synchronized channel would wait for the rest of the group forever
+    ESP_RETURN_ON_FALSE(!rmt_strip->synced, ESP_ERR_INVALID_STATE, TAG, "strip is in a synchronized group, use led_strip_rmt_group_refresh()");
+    if (!rmt_strip->grouped) {
+        ESP_RETURN_ON_ERROR(rmt_enable(rmt_strip->rmt_chan), TAG, "enable RMT channel failed");
+    }
+    ESP_RETURN_ON_ERROR(rmt_transmit(rmt_strip->rmt_chan, rmt_strip->strip_encoder, rmt_strip->pixel_buf,
+                                     rmt_strip->strip_len * rmt_strip->bytes_per_pixel, &tx_conf), TAG, "transmit pixels by RMT failed");
+    ESP_RETURN_ON_ERROR(rmt_tx_wait_all_done(rmt_strip->rmt_chan, -1), TAG, "flush RMT channel failed");
+    if (!rmt_strip->grouped) {
+        ESP_RETURN_ON_ERROR(rmt_disable(rmt_strip->rmt_chan), TAG, "disable RMT channel failed");
+    }
+    return ESP_OK;
+}
+
+static esp_err_t led_strip_rmt_clear(led_strip_t *strip)
+{
+    led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
+    // Write zero to turn off all leds
+    memset(rmt_strip->pixel_buf, 0, rmt_strip->strip_len * rmt_strip->bytes_per_pixel);
+    return led_strip_rmt_refresh(strip);
+}
+
+static esp_err_t led_strip_rmt_del(led_strip_t *strip)
+{
+    led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
+    ESP_RETURN_ON_ERROR(rmt_del_channel(rmt_strip->rmt_chan), TAG, "delete RMT channel failed");
+    ESP_RETURN_ON_ERROR(rmt_del_encoder(rmt_strip->strip_encoder), TAG, "delete strip encoder failed");
+    if (!rmt_strip->static_mem) {
+        free(rmt_strip);
+    }
+    return ESP_OK;
+}
+
+static uint8_t led_strip_rmt_bytes_per_pixel(const led_strip_config_t *led_config)
+{
+    if (led_config->led_pixel_format == LED_PIXEL_FORMAT_GRBW) {
+        return 4;
+    } else if (led_config->led_pixel_format == LED_PIXEL_FORMAT_GRB) {
+        return 3;
+    }
+    assert(false);
+    return 3;
+}
+
+static esp_err_t led_strip_rmt_init(led_strip_rmt_obj *rmt_strip, const led_strip_config_t *led_config, const led_strip_rmt_config_t *rmt_config, uint8_t bytes_per_pixel)
+{
+    esp_err_t ret = ESP_OK;
+    uint32_t resolution = rmt_config->resolution_hz ? rmt_config->resolution_hz : LED_STRIP_RMT_DEFAULT_RESOLUTION;
+
+    // for backward compatibility, if the user does not set the clk_src, use the default value
+    rmt_clock_source_t clk_src = RMT_CLK_SRC_DEFAULT;
+    if (rmt_config->clk_src) {
+        clk_src = rmt_config->clk_src;
+    }
+    size_t mem_block_symbols = LED_STRIP_RMT_DEFAULT_MEM_BLOCK_SYMBOLS;
+    // override the default value if the user sets it
+    if (rmt_config->mem_block_symbols) {
+        mem_block_symbols = rmt_config->mem_block_symbols;
+    }
+    rmt_tx_channel_config_t rmt_chan_config = {
+        .clk_src = clk_src,
+        .gpio_num = led_config->strip_gpio_num,
+        .mem_block_symbols = mem_block_symbols,
+        .resolution_hz = resolution,
+        .trans_queue_depth = LED_STRIP_RMT_DEFAULT_TRANS_QUEUE_SIZE,
+        .flags.with_dma = rmt_config->flags.with_dma,
+        .flags.invert_out = led_config->flags.invert_out,
+    };
+    ESP_GOTO_ON_ERROR(rmt_new_tx_channel(&rmt_chan_config, &rmt_strip->rmt_chan), err, TAG, "create RMT TX channel failed");
+
+    led_strip_encoder_config_t strip_encoder_conf = {
+        .resolution = resolution,
+        .led_model = led_config->led_model
+    };
+    ESP_GOTO_ON_ERROR(rmt_new_led_strip_encoder(&strip_encoder_conf, &rmt_strip->strip_encoder), err, TAG, "create LED strip encoder failed");
+
+
+    rmt_strip->bytes_per_pixel = bytes_per_pixel;
+    rmt_strip->strip_len = led_config->max_leds;
+    rmt_strip->base.set_pixel = led_strip_rmt_set_pixel;
+    rmt_strip->base.set_pixel_rgbw = led_strip_rmt_set_pixel_rgbw;
+    rmt_strip->base.refresh = led_strip_rmt_refresh;
+    rmt_strip->base.clear = led_strip_rmt_clear;
+    rmt_strip->base.del = led_strip_rmt_del;
+    return ESP_OK;
+err:
+    if (rmt_strip->rmt_chan) {
+        rmt_del_channel(rmt_strip->rmt_chan);
+    }
+    if (rmt_strip->strip_encoder) {
+        rmt_del_encoder(rmt_strip->strip_encoder);
+    }
+    return ret;
+}
+
+uint32_t led_strip_rmt_refills_for_length(uint32_t max_leds, led_pixel_format_t led_pixel_format, const led_strip_rmt_config_t *rmt_config)
+{
+    uint32_t bytes_per_pixel = led_pixel_format == LED_PIXEL_FORMAT_GRBW ? 4 : 3;
+    // one symbol per bit, the reset code and the end marker the driver appends
+    uint32_t symbols = max_leds * bytes_per_pixel * 8 + 2;
+    uint32_t mem_block_symbols = rmt_config->mem_block_symbols ? rmt_config->mem_block_symbols : LED_STRIP_RMT_DEFAULT_MEM_BLOCK_SYMBOLS;
+    // the transaction starts with the whole memory (or DMA buffer) encoded, then each interrupt refills half of it
+    if (symbols <= mem_block_symbols) {
+        return 0;
+    }
+    uint32_t half = mem_block_symbols / 2;
+    return (symbols - mem_block_symbols + half - 1) / half;
+}
+
+void led_strip_rmt_config_for_length(uint32_t max_leds, led_pixel_format_t led_pixel_format, led_strip_rmt_config_t *rmt_config)
+{
+    // fewest channel blocks that stay within the refill limit: a second block is borrowed from the
+    // next channel, which then cannot drive another strip (e.g. in a group)
+    rmt_config->flags.with_dma = 0;
+    rmt_config->mem_block_symbols = LED_STRIP_RMT_DEFAULT_MEM_BLOCK_SYMBOLS;
+    if (led_strip_rmt_refills_for_length(max_leds, led_pixel_format, rmt_config) <= LED_STRIP_RMT_AUTO_MAX_REFILLS) {
+        return;
+    }
+    rmt_config->mem_block_symbols = 2 * LED_STRIP_RMT_DEFAULT_MEM_BLOCK_SYMBOLS;
+#if SOC_RMT_SUPPORT_DMA
+    if (led_strip_rmt_refills_for_length(max_leds, led_pixel_format, rmt_config) > LED_STRIP_RMT_AUTO_MAX_REFILLS) {
+        uint32_t bytes_per_pixel = led_pixel_format == LED_PIXEL_FORMAT_GRBW ? 4 : 3;
+        uint32_t dma_symbols = (max_leds * bytes_per_pixel * 8 + 2 + 63) / 64 * 64;
+        if (dma_symbols < LED_STRIP_RMT_DMA_MIN_SYMBOLS) {
+            dma_symbols = LED_STRIP_RMT_DMA_MIN_SYMBOLS;
+        } else if (dma_symbols > LED_STRIP_RMT_DMA_MAX_SYMBOLS) {
+            dma_symbols = LED_STRIP_RMT_DMA_MAX_SYMBOLS;
+        }
+        rmt_config->flags.with_dma = 1;
+        rmt_config->mem_block_symbols = dma_symbols;
+    }
+#endif
+}
+
+esp_err_t led_strip_new_rmt_device(const led_strip_config_t *led_config, const led_strip_rmt_config_t *rmt_config, led_strip_handle_t *ret_strip)
+{
+    ESP_RETURN_ON_FALSE(led_config && rmt_config && ret_strip, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(led_config->led_pixel_format < LED_PIXEL_FORMAT_INVALID, ESP_ERR_INVALID_ARG, TAG, "invalid led_pixel_format");
+    uint8_t bytes_per_pixel = led_strip_rmt_bytes_per_pixel(led_config);
+    led_strip_rmt_obj *rmt_strip = calloc(1, sizeof(led_strip_rmt_obj) + led_config->max_leds * bytes_per_pixel);
+    ESP_RETURN_ON_FALSE(rmt_strip, ESP_ERR_NO_MEM, TAG, "no mem for rmt strip");
+
+    esp_err_t ret = led_strip_rmt_init(rmt_strip, led_config, rmt_config, bytes_per_pixel);
+    if (ret != ESP_OK) {
+        free(rmt_strip);
+        return ret;
+    }
+    *ret_strip = &rmt_strip->base;
+    return ESP_OK;
+}
+
+esp_err_t led_strip_new_rmt_device_with_mem(const led_strip_config_t *led_config, const led_strip_rmt_config_t *rmt_config,
+                                            uint32_t *mem, size_t mem_size, led_strip_handle_t *ret_strip)
+{
+    ESP_RETURN_ON_FALSE(led_config && rmt_config && mem && ret_strip, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(led_config->led_pixel_format < LED_PIXEL_FORMAT_INVALID, ESP_ERR_INVALID_ARG, TAG, "invalid led_pixel_format");
+    uint8_t bytes_per_pixel = led_strip_rmt_bytes_per_pixel(led_config);
+    ESP_RETURN_ON_FALSE(mem_size >= sizeof(led_strip_rmt_obj) + led_config->max_leds * bytes_per_pixel,
+                        ESP_ERR_INVALID_SIZE, TAG, "static memory too small for %"PRIu32" LEDs", led_config->max_leds);
+    memset(mem, 0, mem_size);
+    led_strip_rmt_obj *rmt_strip = (led_strip_rmt_obj *)mem;
+    rmt_strip->static_mem = true;
+
+    ESP_RETURN_ON_ERROR(led_strip_rmt_init(rmt_strip, led_config, rmt_config, bytes_per_pixel), TAG, "init RMT strip failed");
+    *ret_strip = &rmt_strip->base;
+    return ESP_OK;
+}
+
+struct led_strip_rmt_group_t {
+    size_t num_strips;
+    led_strip_rmt_obj *strips[LED_STRIP_RMT_GROUP_MAX_STRIPS];
+    rmt_sync_manager_handle_t sync;
+};
+
+static void led_strip_rmt_group_release(led_strip_rmt_group_t *group)
+{
+    if (group->sync) {
+        rmt_del_sync_manager(group->sync);
+    }
+    for (size_t i = 0; i < group->num_strips; i++) {
+        group->strips[i]->synced = false;
+        if (group->strips[i]->grouped) {
+            rmt_disable(group->strips[i]->rmt_chan);
+            group->strips[i]->grouped = false;
+        }
+    }
+    free(group);
+}
+
+esp_err_t led_strip_rmt_new_group(const led_strip_handle_t *strips, size_t num_strips, led_strip_rmt_group_handle_t *ret_group)
+{
+    ESP_RETURN_ON_FALSE(strips && ret_group && num_strips > 0 && num_strips <= LED_STRIP_RMT_GROUP_MAX_STRIPS,
+                        ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    for (size_t i = 0; i < num_strips; i++) {
+        ESP_RETURN_ON_FALSE(strips[i] && strips[i]->refresh == led_strip_rmt_refresh, ESP_ERR_INVALID_ARG, TAG,
+                            "strip %u is not an RMT strip", (unsigned)i);
+        led_strip_rmt_obj *rmt_strip = __containerof(strips[i], led_strip_rmt_obj, base);
+        ESP_RETURN_ON_FALSE(!rmt_strip->grouped, ESP_ERR_INVALID_STATE, TAG, "strip %u already in a group", (unsigned)i);
+    }
+
+    led_strip_rmt_group_t *group = calloc(1, sizeof(led_strip_rmt_group_t));
+    ESP_RETURN_ON_FALSE(group, ESP_ERR_NO_MEM, TAG, "no mem for strip group");
+    esp_err_t ret = ESP_OK;
+    rmt_channel_handle_t channels[LED_STRIP_RMT_GROUP_MAX_STRIPS];
+    // the sync manager only accepts enabled channels, so they stay enabled for the life of the group
+    for (size_t i = 0; i < num_strips; i++) {
+        group->strips[i] = __containerof(strips[i], led_strip_rmt_obj, base);
+        group->num_strips = i + 1;
+        channels[i] = group->strips[i]->rmt_chan;
+        ESP_GOTO_ON_ERROR(rmt_enable(channels[i]), err, TAG, "enable RMT channel failed");
+        group->strips[i]->grouped = true;
+    }
+#if SOC_RMT_SUPPORT_TX_SYNCHRO
+    if (num_strips > 1) {
+        rmt_sync_manager_config_t sync_config = {
+            .tx_channel_array = channels,
+            .array_size = num_strips,
+        };
+        ESP_GOTO_ON_ERROR(rmt_new_sync_manager(&sync_config, &group->sync), err, TAG, "create sync manager failed");
+        for (size_t i = 0; i < num_strips; i++) {
+            group->strips[i]->synced = true;
+        }
+    }
+#endif
+    *ret_group = group;
+    return ESP_OK;
+err:
+    led_strip_rmt_group_release(group);
+    return ret;
+}
+
+esp_err_t led_strip_rmt_group_refresh(led_strip_rmt_group_handle_t group)
+{
+    ESP_RETURN_ON_FALSE(group, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    rmt_transmit_config_t tx_conf = {
+        .loop_count = 0,
+    };
+    if (group->sync) {
+        ESP_RETURN_ON_ERROR(rmt_sync_reset(group->sync), TAG, "reset sync manager failed");
+    }
+    // queue every strip first: with the sync manager they start together once the last one is queued,
+    // without it they start a few microseconds apart; either way the waits below overlap
+    for (size_t i = 0; i < group->num_strips; i++) {
+        led_strip_rmt_obj *rmt_strip = group->strips[i];
+        ESP_RETURN_ON_ERROR(rmt_transmit(rmt_strip->rmt_chan, rmt_strip->strip_encoder, rmt_strip->pixel_buf,
+                                         rmt_strip->strip_len * rmt_strip->bytes_per_pixel, &tx_conf), TAG, "transmit pixels by RMT failed");
+    }
+    for (size_t i = 0; i < group->num_strips; i++) {
+        ESP_RETURN_ON_ERROR(rmt_tx_wait_all_done(group->strips[i]->rmt_chan, -1), TAG, "flush RMT channel failed");
+    }
+    return ESP_OK;
+}
+
+esp_err_t led_strip_rmt_del_group(led_strip_rmt_group_handle_t group)
+{
+    ESP_RETURN_ON_FALSE(group, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    led_strip_rmt_group_release(group);
+    return ESP_OK;
+}
+
+esp_err_t led_strip_rmt_set_brightness(led_strip_handle_t strip, uint8_t brightness)
+{
+    ESP_RETURN_ON_FALSE(strip && strip->refresh == led_strip_rmt_refresh, ESP_ERR_INVALID_ARG, TAG, "not an RMT strip");
+    led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
+    return rmt_led_strip_encoder_set_brightness(rmt_strip->strip_encoder, brightness);
+}
+
+esp_err_t led_strip_rmt_set_gamma(led_strip_handle_t strip, float gamma)
+{
+    ESP_RETURN_ON_FALSE(strip && strip->refresh == led_strip_rmt_refresh, ESP_ERR_INVALID_ARG, TAG, "not an RMT strip");
+    led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
+    return rmt_led_strip_encoder_set_gamma(rmt_strip->strip_encoder, gamma);
+}
+
+esp_err_t led_strip_rmt_get_channel(led_strip_handle_t strip, rmt_channel_handle_t *ret_chan)
+{
+    ESP_RETURN_ON_FALSE(strip && ret_chan && strip->refresh == led_strip_rmt_refresh, ESP_ERR_INVALID_ARG, TAG, "not an RMT strip");
+    led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
+    *ret_chan = rmt_strip->rmt_chan;
+    return ESP_OK;
+}
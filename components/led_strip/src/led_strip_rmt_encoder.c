@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <math.h>
 #include "esp_check.h"
 #include "led_strip_rmt_encoder.h"
 
@@ -15,11 +16,60 @@ typedef struct {
     rmt_encoder_t *copy_encoder;
     int state;
     rmt_symbol_word_t reset_code;
+#if LED_STRIP_RMT_ENCODER_LEVELS
+    rmt_encoder_t *simple_encoder;
+    rmt_symbol_word_t bit0;
+    rmt_symbol_word_t bit1;
+    uint8_t brightness;
+    uint8_t gamma[256];     // logical value -> gamma corrected value
+    uint8_t lut[256];       // gamma followed by brightness, what is actually sent
+#endif
 } rmt_led_strip_encoder_t;
 
+#if LED_STRIP_RMT_ENCODER_LEVELS
+// Called by the simple encoder whenever there is room in the channel memory (or DMA buffer).
+// Each pixel byte goes through the level table and becomes 8 symbols, MSB first; the reset code
+// closes the frame. The framebuffer itself is never modified.
+static size_t rmt_encode_led_strip_levels(const void *data, size_t data_size, size_t symbols_written, size_t symbols_free,
+                                          rmt_symbol_word_t *symbols, bool *done, void *arg)
+{
+    rmt_led_strip_encoder_t *led_encoder = arg;
+    const uint8_t *bytes = data;
+    size_t byte = symbols_written / 8;
+    size_t n = 0;
+
+    if (byte >= data_size) {
+        if (symbols_free < 1) {
+            return 0;
+        }
+        symbols[0] = led_encoder->reset_code;
+        *done = true;
+        return 1;
+    }
+    while (byte < data_size && symbols_free - n >= 8) {
+        uint8_t value = led_encoder->lut[bytes[byte++]];
+        for (int bit = 7; bit >= 0; bit--) {
+            symbols[n++] = (value >> bit) & 0x01 ? led_encoder->bit1 : led_encoder->bit0;
+        }
+    }
+    return n;
+}
+
+static void rmt_led_strip_encoder_update_lut(rmt_led_strip_encoder_t *led_encoder)
+{
+    for (int i = 0; i < 256; i++) {
+        led_encoder->lut[i] = (led_encoder->gamma[i] * led_encoder->brightness + 127) / 255;
+    }
+}
+#endif
+
 static size_t rmt_encode_led_strip(rmt_encoder_t *encoder, rmt_channel_handle_t channel, const void *primary_data, size_t data_size, rmt_encode_state_t *ret_state)
 {
     rmt_led_strip_encoder_t *led_encoder = __containerof(encoder, rmt_led_strip_encoder_t, base);
+#if LED_STRIP_RMT_ENCODER_LEVELS
+    rmt_encoder_handle_t simple_encoder = led_encoder->simple_encoder;
+    return simple_encoder->encode(simple_encoder, channel, primary_data, data_size, ret_state);
+#else
     rmt_encoder_handle_t bytes_encoder = led_encoder->bytes_encoder;
     rmt_encoder_handle_t copy_encoder = led_encoder->copy_encoder;
     rmt_encode_state_t session_state = 0;
@@ -51,13 +101,18 @@ static size_t rmt_encode_led_strip(rmt_encoder_t *encoder, rmt_channel_handle_t
 out:
     *ret_state = state;
     return encoded_symbols;
+#endif
 }
 
 static esp_err_t rmt_del_led_strip_encoder(rmt_encoder_t *encoder)
 {
     rmt_led_strip_encoder_t *led_encoder = __containerof(encoder, rmt_led_strip_encoder_t, base);
+#if LED_STRIP_RMT_ENCODER_LEVELS
+    rmt_del_encoder(led_encoder->simple_encoder);
+#else
     rmt_del_encoder(led_encoder->bytes_encoder);
     rmt_del_encoder(led_encoder->copy_encoder);
+#endif
     free(led_encoder);
     return ESP_OK;
 }
@@ -65,8 +120,12 @@ static esp_err_t rmt_del_led_strip_encoder(rmt_encoder_t *encoder)
 static esp_err_t rmt_led_strip_encoder_reset(rmt_encoder_t *encoder)
 {
     rmt_led_strip_encoder_t *led_encoder = __containerof(encoder, rmt_led_strip_encoder_t, base);
+#if LED_STRIP_RMT_ENCODER_LEVELS
+    rmt_encoder_reset(led_encoder->simple_encoder);
+#else
     rmt_encoder_reset(led_encoder->bytes_encoder);
     rmt_encoder_reset(led_encoder->copy_encoder);
+#endif
     led_encoder->state = 0;
     return ESP_OK;
 }
@@ -119,10 +178,6 @@ esp_err_t rmt_new_led_strip_encoder(const led_strip_encoder_config_t *config, rm
     } else {
         assert(false);
     }
-    ESP_GOTO_ON_ERROR(rmt_new_bytes_encoder(&bytes_encoder_config, &led_encoder->bytes_encoder), err, TAG, "create bytes encoder failed");
-    rmt_copy_encoder_config_t copy_encoder_config = {};
-    ESP_GOTO_ON_ERROR(rmt_new_copy_encoder(&copy_encoder_config, &led_encoder->copy_encoder), err, TAG, "create copy encoder failed");
-
     uint32_t reset_ticks = config->resolution / 1000000 * 280 / 2; // reset code duration defaults to 280us to accomodate WS2812B-V5
     led_encoder->reset_code = (rmt_symbol_word_t) {
         .level0 = 0,
@@ -130,6 +185,25 @@ esp_err_t rmt_new_led_strip_encoder(const led_strip_encoder_config_t *config, rm
         .level1 = 0,
         .duration1 = reset_ticks,
     };
+#if LED_STRIP_RMT_ENCODER_LEVELS
+    led_encoder->bit0 = bytes_encoder_config.bit0;
+    led_encoder->bit1 = bytes_encoder_config.bit1;
+    led_encoder->brightness = 255;
+    for (int i = 0; i < 256; i++) {
+        led_encoder->gamma[i] = i;
+    }
+    rmt_led_strip_encoder_update_lut(led_encoder);
+    rmt_simple_encoder_config_t simple_encoder_config = {
+        .callback = rmt_encode_led_strip_levels,
+        .arg = led_encoder,
+        .min_chunk_size = 8, // one pixel byte
+    };
+    ESP_GOTO_ON_ERROR(rmt_new_simple_encoder(&simple_encoder_config, &led_encoder->simple_encoder), err, TAG, "create simple encoder failed");
+#else
+    ESP_GOTO_ON_ERROR(rmt_new_bytes_encoder(&bytes_encoder_config, &led_encoder->bytes_encoder), err, TAG, "create bytes encoder failed");
+    rmt_copy_encoder_config_t copy_encoder_config = {};
+    ESP_GOTO_ON_ERROR(rmt_new_copy_encoder(&copy_encoder_config, &led_encoder->copy_encoder), err, TAG, "create copy encoder failed");
+#endif
     *ret_encoder = &led_encoder->base;
     return ESP_OK;
 err:
@@ -144,3 +218,37 @@ err:
     }
     return ret;
 }
+
+#if LED_STRIP_RMT_ENCODER_LEVELS
+esp_err_t rmt_led_strip_encoder_set_brightness(rmt_encoder_handle_t encoder, uint8_t brightness)
+{
+    ESP_RETURN_ON_FALSE(encoder && encoder->encode == rmt_encode_led_strip, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    rmt_led_strip_encoder_t *led_encoder = __containerof(encoder, rmt_led_strip_encoder_t, base);
+    if (led_encoder->brightness != brightness) {
+        led_encoder->brightness = brightness;
+        rmt_led_strip_encoder_update_lut(led_encoder);
+    }
+    return ESP_OK;
+}
+
+esp_err_t rmt_led_strip_encoder_set_gamma(rmt_encoder_handle_t encoder, float gamma)
+{
+    ESP_RETURN_ON_FALSE(encoder && encoder->encode == rmt_encode_led_strip && gamma > 0.0f, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    rmt_led_strip_encoder_t *led_encoder = __containerof(encoder, rmt_led_strip_encoder_t, base);
+    for (int i = 0; i < 256; i++) {
+        led_encoder->gamma[i] = (uint8_t)(powf(i / 255.0f, gamma) * 255.0f + 0.5f);
+    }
+    rmt_led_strip_encoder_update_lut(led_encoder);
+    return ESP_OK;
+}
+#else
+esp_err_t rmt_led_strip_encoder_set_brightness(rmt_encoder_handle_t encoder, uint8_t brightness)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t rmt_led_strip_encoder_set_gamma(rmt_encoder_handle_t encoder, float gamma)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+#endif
@@ -0,0 +1,67 @@
+/*
+ * SPDX-FileCopyrightText: 2022 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <stdint.h>
+#include "esp_idf_version.h"
+#include "driver/rmt_encoder.h"
+#include "led_strip_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Brightness and gamma are applied while encoding (needs the RMT simple encoder, IDF >= 5.3)
+ */
+#define LED_STRIP_RMT_ENCODER_LEVELS (ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 3, 0))
+
+/**
+ * @brief Type of led strip encoder configuration
+ */
+typedef struct {
+    uint32_t resolution;   /*!< Encoder resolution, in Hz */
+    led_model_t led_model; /*!< LED model */
+} led_strip_encoder_config_t;
+
+/**
+ * @brief Create RMT encoder for encoding LED strip pixels into RMT symbols
+ *
+ * @param[in] config Encoder configuration
+ * @param[out] ret_encoder Returned encoder handle
+ * @return
+ *      - ESP_ERR_INVALID_ARG for any invalid arguments
+ *      - ESP_ERR_NO_MEM out of memory when creating led strip encoder
+ *      - ESP_OK if creating encoder successfully
+ */
+esp_err_t rmt_new_led_strip_encoder(const led_strip_encoder_config_t *config, rmt_encoder_handle_t *ret_encoder);
+
+/**
+ * @brief Set the brightness applied to every byte while encoding (255 = unchanged)
+ *
+ * @note Only the 256-entry level table is rebuilt; the pixel buffer is not touched.
+ *       Call it between refreshes, never while a frame is being transmitted.
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if the encoder was not created by rmt_new_led_strip_encoder()
+ *      - ESP_ERR_NOT_SUPPORTED on IDF versions without the RMT simple encoder
+ */
+esp_err_t rmt_led_strip_encoder_set_brightness(rmt_encoder_handle_t encoder, uint8_t brightness);
+
+/**
+ * @brief Set the gamma curve applied before the brightness (1.0 = linear)
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG for a wrong encoder or a gamma <= 0
+ *      - ESP_ERR_NOT_SUPPORTED on IDF versions without the RMT simple encoder
+ */
+esp_err_t rmt_led_strip_encoder_set_gamma(rmt_encoder_handle_t encoder, float gamma);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,202 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_rom_crc.h"
+#include "nvs.h"
+#include "sdkconfig.h"
+#include "app_config.h"
+
+static const char *TAG = "APP_CONFIG";
+
+#define NVS_NAMESPACE "zoomctl"
+#define NVS_KEY       "cfg"
+#define HEADER_LEN    offsetof(app_config_t, led_gpio)
+
+static const app_config_t defaults = {
+    .version = APP_CONFIG_VERSION,
+    .size = sizeof(app_config_t),
+    .led_gpio = CONFIG_APP_LED_GPIO,
+    .num_leds = CONFIG_APP_NUM_LEDS,
+    .brightness = 255,
+    .standby_dim = 10,
+    .standby_s = CONFIG_APP_STANDBY_MINUTES * 60,
+    .color_active = { 0, 200, 0 },
+    .color_page = { 0, 0, 200 },
+    .color_welcome = { 0, 0, 100 },
+    .color_ready = { 150, 0, 200 },
+    .setlist_len = 0,
+    .setlist_scene_cc = CONFIG_APP_SETLIST_SCENE_CC,
+    .color_pending = { 120, 100, 0 },
+    .color_failed = { 200, 0, 0 },
+};
+
+static app_config_t active;
+static app_config_t saved;      // Lo último escrito en flash, para no repetir escrituras
+static portMUX_TYPE cfg_lock = portMUX_INITIALIZER_UNLOCKED;
+static volatile uint32_t generation = 1;   // Sube con cada app_config_set(); nunca vale 0
+static TaskHandle_t cfg_task_hdl = NULL;
+static bool migrated = false;
+
+static uint32_t payload_crc(const app_config_t *cfg) {
+    return esp_rom_crc32_le(0, (const uint8_t *)cfg + HEADER_LEN, sizeof(*cfg) - HEADER_LEN);
+}
+
+// Corrige valores que el firmware no puede usar; devuelve true si tocó algo
+static bool sanitize(app_config_t *cfg) {
+    bool changed = false;
+    // La tira se dimensiona en compilación: más LEDs de los que caben no se pueden usar
+    if (cfg->num_leds == 0 || cfg->num_leds > CONFIG_APP_NUM_LEDS) {
+        cfg->num_leds = CONFIG_APP_NUM_LEDS;
+        changed = true;
+    }
+    if (cfg->setlist_len > SETLIST_MAX_SONGS) {
+        cfg->setlist_len = SETLIST_MAX_SONGS;
+        changed = true;
+    }
+    return changed;
+}
+
+// Lleva un blob de una versión anterior a la actual. Los campos que no existían se
+// toman de los valores por defecto; cada versión añade aquí sus conversiones.
+static void migrate(app_config_t *cfg, size_t stored_size) {
+    memcpy((uint8_t *)cfg + stored_size, (const uint8_t *)&defaults + stored_size, sizeof(*cfg) - stored_size);
+
+    switch (cfg->version) {
+    case 1:
+        // v1 -> v2: set list vacío; los valores por defecto ya bastan
+    case 2:
+        // v2 -> v3: colores de pulsación pendiente y fallida por defecto
+    default:
+        break;
+    }
+    ESP_LOGI(TAG, "Configuracion migrada de la version %d a la %d", cfg->version, APP_CONFIG_VERSION);
+    cfg->version = APP_CONFIG_VERSION;
+    cfg->size = sizeof(*cfg);
+    cfg->crc32 = payload_crc(cfg);
+}
+
+static bool load(app_config_t *cfg) {
+    nvs_handle_t h;
+    if (nvs_open(NVS_NAMESPACE, NVS_READONLY, &h) != ESP_OK) return false;
+
+    size_t len = sizeof(*cfg);
+    esp_err_t err = nvs_get_blob(h, NVS_KEY, cfg, &len);
+    nvs_close(h);
+    if (err != ESP_OK) {
+        if (err != ESP_ERR_NVS_NOT_FOUND) ESP_LOGW(TAG, "No se pudo leer la configuracion: %s", esp_err_to_name(err));
+        return false;
+    }
+
+    if (len < HEADER_LEN || cfg->size != len || cfg->version == 0 || cfg->version > APP_CONFIG_VERSION) {
+        ESP_LOGW(TAG, "Configuracion de otra version (%d, %u bytes): se descarta", cfg->version, (unsigned)len);
+        return false;
+    }
+    uint32_t crc = esp_rom_crc32_le(0, (const uint8_t *)cfg + HEADER_LEN, len - HEADER_LEN);
+    if (crc != cfg->crc32) {
+        ESP_LOGW(TAG, "CRC de la configuracion incorrecto: se descarta");
+        return false;
+    }
+
+    if (cfg->version < APP_CONFIG_VERSION) {
+        migrate(cfg, len);
+        migrated = true;
+    }
+    return true;
+}
+
+esp_err_t app_config_init(void) {
+    if (load(&active)) {
+        if (sanitize(&active)) active.crc32 = payload_crc(&active);
+        saved = active;
+        // Un blob migrado se reescribe en el formato nuevo en cuanto arranque la tarea
+        if (migrated) memset(&saved, 0, sizeof(saved));
+        ESP_LOGI(TAG, "Configuracion cargada (version %d)", active.version);
+    } else {
+        active = defaults;
+        active.crc32 = payload_crc(&active);
+        saved = active; // Los valores por defecto no se escriben hasta que alguien cambie algo
+    }
+    generation++;
+    return ESP_OK;
+}
+
+void app_config_copy(app_config_t *out) {
+    portENTER_CRITICAL(&cfg_lock);
+    *out = active;
+    portEXIT_CRITICAL(&cfg_lock);
+}
+
+bool app_config_sync(app_config_t *copy, uint32_t *gen) {
+    if (*gen == generation) return false;
+    portENTER_CRITICAL(&cfg_lock);
+    *copy = active;
+    *gen = generation;
+    portEXIT_CRITICAL(&cfg_lock);
+    return true;
+}
+
+void app_config_set(const app_config_t *cfg) {
+    portENTER_CRITICAL(&cfg_lock);
+    uint16_t version = active.version, size = active.size;
+    active = *cfg;
+    active.version = version;
+    active.size = size;
+    sanitize(&active);
+    active.crc32 = payload_crc(&active);
+    if (++generation == 0) generation = 1;
+    portEXIT_CRITICAL(&cfg_lock);
+
+    if (cfg_task_hdl) xTaskNotifyGive(cfg_task_hdl);
+}
+
+void app_config_reset(void) {
+    app_config_set(&defaults);
+}
+
+static void commit(void) {
+    app_config_t snapshot;
+    portENTER_CRITICAL(&cfg_lock);
+    snapshot = active;
+    portEXIT_CRITICAL(&cfg_lock);
+
+    // Cambiar un valor y volver a dejarlo como estaba no gasta un ciclo de borrado
+    if (memcmp(&snapshot, &saved, sizeof(snapshot)) == 0) return;
+
+    nvs_handle_t h;
+    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &h);
+    if (err == ESP_OK) {
+        err = nvs_set_blob(h, NVS_KEY, &snapshot, sizeof(snapshot));
+        if (err == ESP_OK) err = nvs_commit(h);
+        nvs_close(h);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "No se pudo guardar la configuracion: %s", esp_err_to_name(err));
+        return;
+    }
+    saved = snapshot;
+    ESP_LOGI(TAG, "Configuracion guardada");
+}
+
+void app_config_setup(void) {
+    cfg_task_hdl = xTaskGetCurrentTaskHandle();
+    app_config_t snapshot;
+    app_config_copy(&snapshot);
+    if (memcmp(&snapshot, &saved, sizeof(snapshot)) != 0) xTaskNotifyGive(cfg_task_hdl);
+}
+
+void app_config_loop(void) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    // Mientras sigan llegando cambios se pospone la escritura: una ráfaga de
+    // ajustes en directo acaba en una sola escritura en flash
+    while (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(APP_CONFIG_COMMIT_DELAY_MS)) != 0) {
+    }
+    commit();
+}
+
+void app_config_task(void *arg) {
+    app_config_setup();
+    while (1) app_config_loop();
+}
@@ -0,0 +1,67 @@
+#ifndef APP_CONFIG_H
+#define APP_CONFIG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "setlist.h"
+
+// Blob binario en NVS, leído tal cual sobre la estructura (sin parseo de texto).
+// Los campos nuevos se añaden SIEMPRE al final y suben APP_CONFIG_VERSION: un blob
+// antiguo se completa con los valores por defecto y se migra al arrancar.
+#define APP_CONFIG_VERSION 3
+#define APP_CONFIG_COMMIT_DELAY_MS 5000 // Silencio tras el último cambio antes de escribir en flash
+
+typedef struct __attribute__((packed)) {
+    uint8_t r, g, b;
+} app_rgb_t;
+
+typedef struct __attribute__((packed)) {
+    // Cabecera
+    uint16_t version;
+    uint16_t size;          // sizeof de la versión que escribió el blob
+    uint32_t crc32;         // CRC-32 de todo lo que sigue a la cabecera
+
+    // Versión 1
+    uint8_t led_gpio;       // Se aplica al reiniciar
+    uint8_t num_leds;       // Hasta CONFIG_APP_NUM_LEDS
+    uint8_t brightness;     // 0-255, escala todos los colores
+    uint8_t standby_dim;    // Divisor de brillo del efecto de standby
+    uint32_t standby_s;     // Inactividad antes del standby
+    app_rgb_t color_active; // Último parche, confirmado
+    app_rgb_t color_page;   // Indicador de página
+    app_rgb_t color_welcome;
+    app_rgb_t color_ready;
+
+    // Versión 2
+    uint8_t setlist_len;
+    uint8_t setlist_scene_cc;   // CC que selecciona la escena dentro del parche
+    setlist_song_t setlist[SETLIST_MAX_SONGS];
+
+    // Versión 3
+    app_rgb_t color_pending;    // Pulsación enviada, aún sin confirmar
+    app_rgb_t color_failed;     // El cambio no llegó o no se confirmó a tiempo
+} app_config_t;
+
+esp_err_t app_config_init(void);
+// La tarea es app_config_setup() y luego app_config_loop() sin fin; las pruebas en el PC
+// (test/host/test_app_config.c) las llaman por separado con el reloj simulado
+void app_config_task(void *arg);
+void app_config_setup(void);
+// Espera un cambio, deja pasar APP_CONFIG_COMMIT_DELAY_MS sin ninguno más y lo escribe en flash
+void app_config_loop(void);
+
+// La configuración en uso siempre es válida (valores por defecto si NVS está vacío o corrupto),
+// pero nadie guarda un puntero a ella: app_config_set() la reescribe desde otra tarea y un
+// lector podría ver media estructura. Cada lector trabaja sobre su propia copia.
+void app_config_copy(app_config_t *out);
+// Refresca la copia del lector si la configuración cambió desde su última llamada (*gen a 0 la
+// primera vez) y devuelve true si la copió. Sin cambios no toma el cerrojo: vale en bucles rápidos
+bool app_config_sync(app_config_t *copy, uint32_t *gen);
+
+// Sustituye la configuración en uso al momento. La escritura en flash se agrupa y se
+// hace desde la tarea de configuración, nunca desde quien llama.
+void app_config_set(const app_config_t *cfg);
+void app_config_reset(void);
+
+#endif
@@ -0,0 +1,93 @@
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_system.h"
+#include "esp_clk_tree.h"
+#include "soc/rtc.h"
+#include "boot_prof.h"
+
+static const char *TAG = "BOOT";
+
+static const char *const names[BOOT_PHASES] = {
+    [BOOT_APP_MAIN] = "app_main",
+    [BOOT_CONFIG] = "configuracion",
+    [BOOT_INPUT] = "interruptores",
+    [BOOT_LEDS] = "leds",
+    [BOOT_READY] = "listo",
+    [BOOT_USB_INSTALL] = "usb_host_install",
+    [BOOT_USB_CLIENT] = "class_driver",
+    [BOOT_FIRST_DEVICE] = "zoom_g6",
+    [BOOT_WELCOME_DONE] = "bienvenida",
+};
+
+// Cada hito lo escribe una sola tarea, una sola vez
+static volatile int64_t marks[BOOT_PHASES];
+// Para ver qué fase reserva memoria y comprobar que después del arranque ya no se toca el heap
+static uint32_t heap_free[BOOT_PHASES];
+static int64_t preapp_us = -1;
+
+// Contador del reloj lento RTC pasado a µs con la frecuencia calibrada en el arranque
+static int64_t rtc_us(void) {
+    uint32_t hz = 0;
+    if (esp_clk_tree_src_get_freq_hz(SOC_MOD_CLK_RTC_SLOW, ESP_CLK_TREE_SRC_FREQ_PRECISION_CACHED, &hz) != ESP_OK || hz == 0) {
+        return -1;
+    }
+    uint64_t ticks = rtc_time_get();
+    return (int64_t)(ticks / hz * 1000000ULL + ticks % hz * 1000000ULL / hz);
+}
+
+void boot_prof_mark(boot_phase_t phase) {
+    if (phase >= BOOT_PHASES || marks[phase] != 0) return;
+    int64_t now = esp_timer_get_time();
+    heap_free[phase] = esp_get_free_heap_size();
+    marks[phase] = now;
+
+    // El reloj RTC cuenta desde el encendido; esp_timer desde que arranca la app.
+    // Tras un reset por software el RTC no se reinicia y la diferencia no significa nada.
+    if (phase == BOOT_APP_MAIN && esp_reset_reason() == ESP_RST_POWERON) {
+        int64_t rtc = rtc_us();
+        if (rtc >= 0) preapp_us = rtc - now;
+    }
+}
+
+int64_t boot_prof_get(boot_phase_t phase) {
+    return phase < BOOT_PHASES ? marks[phase] : 0;
+}
+
+int64_t boot_prof_preapp_us(void) {
+    return preapp_us;
+}
+
+uint32_t boot_prof_heap_free(boot_phase_t phase) {
+    return phase < BOOT_PHASES ? heap_free[phase] : 0;
+}
+
+const char *boot_prof_name(boot_phase_t phase) {
+    return phase < BOOT_PHASES ? names[phase] : "?";
+}
+
+void boot_prof_log(void) {
+    // Orden cronológico: las tareas arrancan en paralelo y los hitos se cruzan
+    int order[BOOT_PHASES];
+    int n = 0;
+    for (int i = 0; i < BOOT_PHASES; i++) {
+        if (marks[i] == 0) continue;
+        int j = n++;
+        while (j > 0 && marks[order[j - 1]] > marks[i]) {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = i;
+    }
+
+    if (preapp_us >= 0) ESP_LOGI(TAG, "%-18s %8lld us antes de la app", "rom+bootloader", (long long)preapp_us);
+    int64_t prev = 0;
+    for (int k = 0; k < n; k++) {
+        int64_t t = marks[order[k]];
+        ESP_LOGI(TAG, "%-18s %8lld us (+%lld)  heap libre %lu", names[order[k]], (long long)t,
+                 (long long)(t - prev), (unsigned long)heap_free[order[k]]);
+        prev = t;
+    }
+    for (int i = 0; i < BOOT_PHASES; i++) {
+        if (marks[i] == 0) ESP_LOGI(TAG, "%-18s pendiente", names[i]);
+    }
+}
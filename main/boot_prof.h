@@ -0,0 +1,33 @@
+#ifndef BOOT_PROF_H
+#define BOOT_PROF_H
+
+#include <stdint.h>
+
+// Hitos del arranque, en el orden en que se listan (no tienen por qué alcanzarse en ese orden)
+typedef enum {
+    BOOT_APP_MAIN,      // Entrada en app_main
+    BOOT_CONFIG,        // NVS y configuración cargadas
+    BOOT_INPUT,         // Interruptores listos para leer
+    BOOT_LEDS,          // Tira de LEDs creada
+    BOOT_READY,         // Primera vuelta del escaneo: se aceptan pulsaciones
+    BOOT_USB_INSTALL,   // usb_host_install() terminado
+    BOOT_USB_CLIENT,    // Class driver registrado
+    BOOT_FIRST_DEVICE,  // Primera Zoom G6 enumerada y abierta
+    BOOT_WELCOME_DONE,  // Fin de la animación de bienvenida
+    BOOT_PHASES
+} boot_phase_t;
+
+// Guarda el instante (µs desde el arranque de la app) la primera vez que se alcanza cada hito
+void boot_prof_mark(boot_phase_t phase);
+// 0 si el hito aún no se ha alcanzado
+int64_t boot_prof_get(boot_phase_t phase);
+// Tiempo de ROM + bootloader antes de la app; -1 si no se conoce (no fue un encendido)
+int64_t boot_prof_preapp_us(void);
+// Heap libre en el momento del hito (0 si no se ha alcanzado)
+uint32_t boot_prof_heap_free(boot_phase_t phase);
+const char *boot_prof_name(boot_phase_t phase);
+
+// Escribe la línea de tiempo por el log
+void boot_prof_log(void);
+
+#endif
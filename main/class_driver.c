@@ -1,108 +1,896 @@
+#include <ctype.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <string.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "usb/usb_host.h"
 #include "class_driver.h"
+#include "sysex.h"
+#include "patch_cache.h"
+#include "macro.h"
+#include "midi_clock.h"
+#include "expression.h"
+#include "patch_map.h"
+#include "app_config.h"
+#include "setlist.h"
+#include "power.h"
+#include "boot_prof.h"
+#include "trace.h"
+#include "led_feedback.h"
+#if CONFIG_APP_CONSOLE_ENABLE
+#include "midi_probe.h"
+#endif
 
 static const char *TAG = "CLASS_DRV";
 QueueHandle_t midi_msg_queue = NULL;
 
+// Interfaz MIDI de la Zoom G6
+#define ZOOM_G6_MIDI_INTF 4
+#define MIDI_XFER_SIZE 64
+#define MIDI_TX_POOL_SIZE 4
+#define MIDI_RX_POOL_SIZE 2
+// La ráfaga más larga que puede provocar una pulsación
+#define PRESS_MAX_BYTES SETLIST_MAX_BURST
+
+typedef struct {
+    uint8_t buf[MIDI_XFER_SIZE];
+    int len;
+    int64_t first_us;   // Momento en que entró el primer paquete del lote
+    int64_t press_us;   // Pulsación más antigua que viaja en el lote
+    latency_hist_t *press_hist;
+    int64_t fb_press_us;    // Pulsación más reciente del lote, la que confirma el indicador (0 = ninguna)
+    // Cambios de parche del lote: se anotan en el log cuando la transferencia sale de verdad
+    struct {
+        uint8_t page;
+        uint8_t button;
+        uint8_t bank_lsb;
+        uint8_t program;
+    } sent[MIDI_XFER_SIZE / ZOOM_G6_PATCH_BYTES];
+    int num_sent;
+    // Valores del pedal de expresión del lote: la latencia se cuenta con el más antiguo
+    int64_t expr_sample_us;
+    uint32_t expr_count;
+} midi_batch_t;
+
 typedef struct {
     usb_host_client_handle_t client_hdl;
     usb_device_handle_t dev_hdl;
+    uint8_t ep_out;
+    uint8_t ep_in;
+    uint16_t mps_out;
+    // Transferencias reservadas una sola vez; cada bit de tx_busy marca una en vuelo
+    usb_transfer_t *tx_pool[MIDI_TX_POOL_SIZE];
+    uint32_t tx_busy;
+    // Transferencia propia para tiempo real (bit MIDI_TX_POOL_SIZE de tx_busy): el reloj nunca espera al pool
+    usb_transfer_t *rt_xfer;
+    // Pulsación que originó cada transferencia en vuelo, para medir al completarse
+    int64_t tx_press_us[MIDI_TX_POOL_SIZE];
+    latency_hist_t *tx_press_hist[MIDI_TX_POOL_SIZE];
+    int64_t tx_fb_press_us[MIDI_TX_POOL_SIZE];
+    int64_t tx_expr_sample_us[MIDI_TX_POOL_SIZE];
+    uint32_t tx_expr_count[MIDI_TX_POOL_SIZE];
+    usb_transfer_t *rx_pool[MIDI_RX_POOL_SIZE];
+    bool closing;
+    uint8_t rx_bank_lsb;
+    // Paquetes pendientes que saldrán juntos en una sola transferencia
+    midi_batch_t batch;
+    macro_runner_t macro;
+    size_t macro_sysex_off;     // Bytes ya enviados del SysEx de la macro que se está troceando
+    esp_timer_handle_t macro_timer;
+    // Pulsación en curso de atender, a la espera de su primer paquete
+    int64_t press_us;
+    latency_hist_t *press_hist;
+    setlist_t setlist;
+    uint32_t setlist_gen;   // Generación de la configuración revisada por setlist_refresh() (app_config_sync)
+    // Pedalera simulada de `rtt sim` (midi_probe.c): las transferencias OUT se completan sin
+    // salir al bus y sus cambios de banco y parche vuelven, pasado el retardo, por el mismo
+    // análisis que MIDI IN. Mientras está activa, también se queda con lo que mande una pulsación
+    struct {
+        bool on;
+        uint32_t reply_us;      // Retardo de la respuesta a lo que se envíe a continuación
+        uint8_t echo[MIDI_XFER_SIZE];
+        int echo_len;
+        int64_t due_us;
+        esp_timer_handle_t timer;
+    } sim;
+    // Estado de antes de la sonda, para dejarlo como estaba al terminar
+    struct {
+        bool active;
+        bool has_patch;
+        uint8_t rx_bank_lsb;
+        uint8_t bank_lsb;
+        uint8_t program;
+        int setlist_pos;
+        bool setlist_synced;
+    } probe;
 } midi_context_t;
 
 static midi_context_t ctx = {0};
+static class_driver_stats_t stats = {0};
+// Los escribe quien encola o quien pide el reinicio, no la tarea MIDI
+static volatile uint32_t queue_drops = 0;
+static volatile bool stats_reset_pending = false;
 
 static void xfer_cb(usb_transfer_t *transfer) {
-    // Liberamos la transferencia una vez completada
-    usb_host_transfer_free(transfer);
+    uintptr_t i = (uintptr_t)transfer->context;
+    int64_t latency_us = 0;
+    if (i < MIDI_TX_POOL_SIZE && ctx.tx_press_hist[i]) {
+        if (transfer->status == USB_TRANSFER_STATUS_COMPLETED) {
+            latency_us = esp_timer_get_time() - ctx.tx_press_us[i];
+            latency_record(ctx.tx_press_hist[i], latency_us);
+        }
+        ctx.tx_press_hist[i] = NULL;
+    }
+    if (i < MIDI_TX_POOL_SIZE && ctx.tx_fb_press_us[i]) {
+        led_feedback_sent(ctx.tx_fb_press_us[i], transfer->status == USB_TRANSFER_STATUS_COMPLETED, esp_timer_get_time());
+        ctx.tx_fb_press_us[i] = 0;
+    }
+#if CONFIG_APP_EXPRESSION_ENABLE
+    if (i < MIDI_TX_POOL_SIZE && ctx.tx_expr_count[i]) {
+        // Hasta aquí el valor no ha salido por el cable: es el final de su latencia
+        if (transfer->status == USB_TRANSFER_STATUS_COMPLETED) {
+            expression_record_tx(esp_timer_get_time(), ctx.tx_expr_sample_us[i], ctx.tx_expr_count[i]);
+        }
+        ctx.tx_expr_count[i] = 0;
+    }
+#endif
+    if (transfer->status != USB_TRANSFER_STATUS_COMPLETED) stats.xfer_failed++;
+    TRACE(TRACE_EV_XFER_DONE, transfer->status, (uint32_t)latency_us, i);
+    // Devolvemos la transferencia al pool una vez completada
+    ctx.tx_busy &= ~(1u << i);
+}
+
+static usb_transfer_t *tx_acquire(void) {
+    for (int i = 0; i < MIDI_TX_POOL_SIZE; i++) {
+        if (!(ctx.tx_busy & (1u << i))) {
+            ctx.tx_busy |= (1u << i);
+            return ctx.tx_pool[i];
+        }
+    }
+    return NULL;
+}
+
+// La pedalera simulada recibe la transferencia: guarda los cambios de banco y parche para
+// devolverlos pasado su retardo y la da por completada, como haría el bus
+static esp_err_t sim_submit(usb_transfer_t *xfer) {
+    for (int i = 0; i + 4 <= xfer->num_bytes; i += 4) {
+        uint8_t cin = xfer->data_buffer[i] & 0x0F;
+        if ((cin == 0x0B || cin == 0x0C) && ctx.sim.echo_len + 4 <= MIDI_XFER_SIZE) {
+            memcpy(&ctx.sim.echo[ctx.sim.echo_len], &xfer->data_buffer[i], 4);
+            ctx.sim.echo_len += 4;
+        }
+    }
+    if (ctx.sim.echo_len) {
+        ctx.sim.due_us = esp_timer_get_time() + ctx.sim.reply_us;
+        esp_timer_stop(ctx.sim.timer);
+        esp_timer_start_once(ctx.sim.timer, ctx.sim.reply_us ? ctx.sim.reply_us : 1);
+    }
+    xfer->actual_num_bytes = xfer->num_bytes;
+    xfer->status = USB_TRANSFER_STATUS_COMPLETED;
+    xfer->callback(xfer);
+    return ESP_OK;
+}
+
+static esp_err_t tx_submit(usb_transfer_t *xfer, int num_bytes) {
+    xfer->num_bytes = num_bytes;
+    xfer->bEndpointAddress = ctx.ep_out;
+    xfer->device_handle = ctx.dev_hdl;
+    esp_err_t err = ctx.sim.on ? sim_submit(xfer) : usb_host_transfer_submit(xfer);
+    if (err != ESP_OK) {
+        xfer_cb(xfer);
+        stats.xfer_errors++;
+        return err;
+    }
+
+    int packets = num_bytes / 4;
+    TRACE(TRACE_EV_XFER_SUBMIT, packets, num_bytes, 0);
+    stats.transfers++;
+    stats.packets += packets;
+    stats.packets_per_xfer[packets <= MIDI_MAX_PACKETS_PER_XFER ? packets : MIDI_MAX_PACKETS_PER_XFER]++;
+    return ESP_OK;
+}
+
+static int batch_capacity(void) {
+    // Nunca más de un wMaxPacketSize por transferencia
+    return (ctx.mps_out && ctx.mps_out < MIDI_XFER_SIZE) ? ctx.mps_out : MIDI_XFER_SIZE;
+}
+
+static void batch_log_sent(void) {
+    for (int i = 0; i < ctx.batch.num_sent; i++) {
+        uint8_t page = ctx.batch.sent[i].page;
+        uint8_t button = ctx.batch.sent[i].button;
+        uint8_t bank_lsb = ctx.batch.sent[i].bank_lsb;
+        uint8_t program = ctx.batch.sent[i].program;
+#if CONFIG_APP_TRACE_ENABLE
+        // Formatear y sacar la línea por la UART cuesta milisegundos: la tarea de trazas la escribe luego
+        TRACE(TRACE_EV_PATCH, button, (uint32_t)bank_lsb << 8 | program, page);
+#else
+        patch_info_t info;
+        char bank_name[3];
+        ESP_LOGI(TAG, "Enviado: Pagina %d Boton %d -> Banco %s Parche %d (%s)",
+                 page + 1, button, zoom_bank_name(bank_lsb, bank_name), program + 1,
+                 patch_cache_lookup(bank_lsb, program, &info) ? info.name : "?");
+#endif
+    }
+}
+
+static bool batch_flush(void) {
+    if (ctx.batch.len == 0) return true;
+    // Un SysEx de la cola a medio enviar (flush_sysex) termina antes: el lote caería entre sus
+    // trozos y la pedalera lo recibiría cortado. Lo que ya está en el lote espera ahí
+    if (sysex_tx_partial()) return false;
+    usb_transfer_t *xfer = tx_acquire();
+    if (!xfer) return false;
+
+    memcpy(xfer->data_buffer, ctx.batch.buf, ctx.batch.len);
+    uintptr_t slot = (uintptr_t)xfer->context;
+    ctx.tx_press_us[slot] = ctx.batch.press_us;
+    ctx.tx_press_hist[slot] = ctx.batch.press_hist;
+    ctx.tx_fb_press_us[slot] = ctx.batch.fb_press_us;
+    ctx.tx_expr_sample_us[slot] = ctx.batch.expr_sample_us;
+    ctx.tx_expr_count[slot] = ctx.batch.expr_count;
+    esp_err_t err = tx_submit(xfer, ctx.batch.len);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Error al enviar: 0x%x", err);
+    } else {
+        batch_log_sent();
+    }
+    ctx.batch.len = 0;
+    ctx.batch.num_sent = 0;
+    ctx.batch.press_hist = NULL;
+    ctx.batch.fb_press_us = 0;
+    ctx.batch.expr_count = 0;
+    return true;
+}
+
+// Garantiza hueco para 'bytes' más en el lote, enviando el actual si hace falta
+static bool batch_reserve(int bytes) {
+    if (ctx.batch.len + bytes <= batch_capacity()) return true;
+    return batch_flush();
+}
+
+static uint8_t *batch_append(int bytes) {
+    if (ctx.batch.len == 0) ctx.batch.first_us = esp_timer_get_time();
+    // El primer paquete que provoca una pulsación se lleva su marca de tiempo;
+    // si el lote ya llevaba otra, cuenta la más antigua
+    if (ctx.press_hist && !ctx.batch.press_hist) {
+        ctx.batch.press_us = ctx.press_us;
+        ctx.batch.press_hist = ctx.press_hist;
+    }
+    if (ctx.press_hist) ctx.batch.fb_press_us = ctx.press_us;
+    ctx.press_hist = NULL;
+    uint8_t *dst = &ctx.batch.buf[ctx.batch.len];
+    ctx.batch.len += bytes;
+    return dst;
+}
+
+static bool batch_due(void) {
+    if (ctx.batch.len == 0) return false;
+    if (CONFIG_APP_MIDI_COALESCE_MS == 0 || ctx.batch.len + ZOOM_G6_PATCH_BYTES > batch_capacity()) return true;
+    return esp_timer_get_time() - ctx.batch.first_us >= CONFIG_APP_MIDI_COALESCE_MS * 1000LL;
+}
+
+static TickType_t batch_wait_ticks(void) {
+    // Sin lote abierto dormimos hasta el siguiente evento; con lote, solo lo que quede de ventana
+    int64_t now = esp_timer_get_time();
+    int64_t left_us = 10000;
+    // Sin pedalera solo hay que esperar a una conexión o a class_driver_wake(): el chip puede dormir
+    if (!ctx.dev_hdl && !ctx.sim.on) return portMAX_DELAY;
+    if (ctx.batch.len != 0) {
+        left_us = CONFIG_APP_MIDI_COALESCE_MS * 1000LL - (now - ctx.batch.first_us);
+        // Ventana ya vencida (la vuelta anterior se retrasó): despertar cuanto antes
+        if (left_us < 0) left_us = 0;
+    }
+    if (ctx.sim.echo_len && ctx.sim.due_us - now < left_us) left_us = ctx.sim.due_us > now ? ctx.sim.due_us - now : 0;
+#if CONFIG_APP_EXPRESSION_ENABLE
+    // Un valor del pedal retenido por el límite de tasa también marca cuándo despertar
+    int64_t expr_us = expression_wait_us(now);
+    if (expr_us >= 0 && expr_us < left_us) left_us = expr_us;
+#endif
+    TickType_t ticks = pdMS_TO_TICKS((left_us + 999) / 1000);
+    return ticks > 0 ? ticks : 1;
+}
+
+// Paquetes recibidos por MIDI IN, o la respuesta de la pedalera simulada
+static void rx_parse(const uint8_t *data, int len) {
+    // Cada paquete USB MIDI ocupa 4 bytes
+    for (int i = 0; i + 4 <= len; i += 4) {
+        const uint8_t *pkt = &data[i];
+        switch (pkt[0] & 0x0F) {
+        case 0x0B:
+            // Seguimos el banco para saber qué parche carga la pedalera por su cuenta
+            if ((pkt[1] & 0xF0) == 0xB0 && pkt[2] == 0x20) ctx.rx_bank_lsb = pkt[3];
+            break;
+        case 0x0C:
+            // Parche cambiado desde la propia pedalera, o confirmación del que le enviamos
+            patch_cache_set_current(ctx.rx_bank_lsb, pkt[2]);
+            led_feedback_confirm(ctx.rx_bank_lsb, pkt[2], esp_timer_get_time());
+#if CONFIG_APP_CONSOLE_ENABLE
+            midi_probe_pc(ctx.rx_bank_lsb, pkt[2], esp_timer_get_time());
+#endif
+            setlist_desync(&ctx.setlist);
+            break;
+        default:
+            sysex_rx_packet(pkt);
+            break;
+        }
+    }
+}
+
+static void rx_cb(usb_transfer_t *transfer) {
+    if (transfer->status != USB_TRANSFER_STATUS_COMPLETED) {
+        // Cancelada o dispositivo desconectado: no se vuelve a encolar
+        if (!ctx.closing) {
+            ESP_LOGW(TAG, "Error en MIDI IN: %d", transfer->status);
+        }
+        return;
+    }
+    rx_parse(transfer->data_buffer, transfer->actual_num_bytes);
+
+    if (!ctx.closing && ctx.dev_hdl) {
+        usb_host_transfer_submit(transfer);
+    }
+}
+
+// Los bancos de la G6 se nombran A..Z, AA..AX
+const char *zoom_bank_name(uint8_t bank, char out[3]) {
+    if (bank < 26) {
+        out[0] = 'A' + bank;
+        out[1] = '\0';
+    } else {
+        out[0] = 'A';
+        out[1] = 'A' + (bank - 26) % 26;
+        out[2] = '\0';
+    }
+    return out;
+}
+
+int zoom_bank_parse(const char *text) {
+    int bank = -1;
+    char a = toupper((unsigned char)text[0]), b = a ? toupper((unsigned char)text[1]) : 0;
+    if (isdigit((unsigned char)a)) {
+        char *end;
+        long n = strtol(text, &end, 10);
+        if (*end == '\0') bank = (int)n;
+    } else if (isalpha((unsigned char)a) && b == '\0') {
+        bank = a - 'A';
+    } else if (a == 'A' && isalpha((unsigned char)b) && text[2] == '\0') {
+        bank = 26 + b - 'A';
+    }
+    return bank >= 0 && bank < ZOOM_G6_NUM_BANKS ? bank : -1;
+}
+
+void zoom_encode_patch(const patch_map_entry_t *entry, uint8_t *pkt) {
+    // Mensaje 1: Bank Select MSB (Control Change 0)
+    pkt[0] = 0x0B; // MIDI USB Cine-byte (Control Change)
+    pkt[1] = 0xB0; // Status: CC Canal 1
+    pkt[2] = 0x00; // CC#0 (Bank Select MSB)
+    pkt[3] = entry->bank_msb;
+
+    // Mensaje 2: Bank Select LSB (Control Change 32, Valor 0x19, 0x1A...)
+    pkt[4] = 0x0B;
+    pkt[5] = 0xB0;
+    pkt[6] = 0x20; // CC#32 (Bank Select LSB)
+    pkt[7] = entry->bank_lsb;
+
+    // Mensaje 3: Program Change (El parche dentro del banco)
+    pkt[8] = 0x0C; // MIDI USB Cine-byte (Program Change)
+    pkt[9] = 0xC0; // Status: PC Canal 1
+    pkt[10] = entry->program;
+    pkt[11] = 0x00;
+}
+
+static void send_midi_zoom_g6(uint8_t button_index, uint8_t page) {
+    if (!ctx.dev_hdl && !ctx.sim.on) {
+        ESP_LOGW(TAG, "Zoom G6 no detectada. No se puede enviar MIDI.");
+        led_feedback_fail(ctx.press_us);
+        return;
+    }
+
+    if (!batch_reserve(ZOOM_G6_PATCH_BYTES)) {
+        ESP_LOGW(TAG, "Sin transferencias libres, se descarta el boton %d", button_index);
+        led_feedback_fail(ctx.press_us);
+        return;
+    }
+    // LÓGICA DE BANCOS ZOOM G6: banco y parche salen del mapa en flash (patch_map.c).
+    // Sin mapa grabado:
+    // Botones 0-3 -> Banco Z (LSB 0x19), Parches 0-3
+    // Botones 4-7 -> Banco AA (LSB 0x1A), Parches 0-3
+    patch_map_entry_t entry = patch_map_get(page, button_index);
+    uint8_t lsb_bank = entry.bank_lsb;
+    uint8_t patch_id = entry.program;
+    zoom_encode_patch(&entry, batch_append(ZOOM_G6_PATCH_BYTES));
+
+    patch_cache_set_current(lsb_bank, patch_id);
+    led_feedback_expect(ctx.press_us, lsb_bank, patch_id);
+    setlist_desync(&ctx.setlist);
+    // El log espera a que el lote salga: un envío fallido no debe aparecer como enviado
+    if (ctx.batch.num_sent < (int)(sizeof(ctx.batch.sent) / sizeof(ctx.batch.sent[0]))) {
+        int n = ctx.batch.num_sent++;
+        ctx.batch.sent[n].page = page;
+        ctx.batch.sent[n].button = button_index;
+        ctx.batch.sent[n].bank_lsb = lsb_bank;
+        ctx.batch.sent[n].program = patch_id;
+    }
+}
+
+static void encode_packet(uint8_t *pkt, const uint8_t *msg, size_t len) {
+    // CIN = nibble alto del status en mensajes de canal; 0xF para tiempo real
+    pkt[0] = (msg[0] >= 0xF8) ? 0x0F : (msg[0] >> 4);
+    pkt[1] = msg[0];
+    pkt[2] = len > 1 ? msg[1] : 0;
+    pkt[3] = len > 2 ? msg[2] : 0;
+}
+
+static bool macro_emit(const uint8_t *msg, size_t len, void *arg) {
+    if (msg[0] == 0xF0) {
+        // Tampoco puede empezar dentro del SysEx de la cola que esté a medias
+        if (ctx.macro_sysex_off == 0 && sysex_tx_partial()) return false;
+        // El SysEx va por el mismo lote que los mensajes de canal, así la pedalera los recibe
+        // en el orden de la macro. Si no cabe entero se trocea en varias transferencias; al
+        // quedarse sin ellas se sigue por donde iba en la siguiente vuelta
+        while (ctx.macro_sysex_off < len) {
+            if (!batch_reserve(4)) return false;
+            ctx.macro_sysex_off += sysex_pack(batch_append(4), msg, len, ctx.macro_sysex_off);
+        }
+        ctx.macro_sysex_off = 0;
+        return true;
+    }
+    if (!batch_reserve(4)) return false;
+    encode_packet(batch_append(4), msg, len);
+    return true;
+}
+
+static void macro_timer_cb(void *arg) {
+    class_driver_wake();
+}
+
+static void run_macro(void) {
+    int64_t now = esp_timer_get_time();
+    macro_status_t st = macro_step(&ctx.macro, now, macro_emit, NULL);
+    if (st == MACRO_WAIT) {
+        // Lo acumulado antes de la espera sale ya; el temporizador nos despierta a tiempo
+        batch_flush();
+        if (!esp_timer_is_active(ctx.macro_timer)) {
+            int64_t left = ctx.macro.resume_us - now;
+            esp_timer_start_once(ctx.macro_timer, left > 0 ? left : 1);
+        }
+    } else if (st == MACRO_DONE) {
+        batch_flush();
+    }
+}
+
+static void send_realtime(void) {
+    const uint32_t rt_bit = 1u << MIDI_TX_POOL_SIZE;
+    if (!ctx.dev_hdl || (ctx.tx_busy & rt_bit)) return;
+
+    uint8_t rt[MIDI_MAX_PACKETS_PER_XFER];
+    size_t n = midi_clock_take_pending(rt, batch_capacity() / 4);
+    if (n == 0) return;
+
+    uint32_t ticks = 0;
+    for (size_t i = 0; i < n; i++) {
+        encode_packet(&ctx.rt_xfer->data_buffer[i * 4], &rt[i], 1);
+        if (rt[i] == 0xF8) ticks++;
+    }
+    ctx.tx_busy |= rt_bit;
+    if (tx_submit(ctx.rt_xfer, (int)n * 4) == ESP_OK) {
+        midi_clock_record_tx(esp_timer_get_time(), ticks);
+    }
+}
+
+#if CONFIG_APP_EXPRESSION_ENABLE
+static void send_expression(void) {
+    if (!ctx.dev_hdl || ctx.macro_sysex_off != 0 || !batch_reserve(4)) return;
+
+    uint8_t value;
+    int64_t sample_us;
+    int64_t now = esp_timer_get_time();
+    if (!expression_take(now, &value, &sample_us)) return;
+
+    const uint8_t msg[3] = { 0xB0, CONFIG_APP_EXPRESSION_CC, value };
+    encode_packet(batch_append(4), msg, sizeof(msg));
+    // La latencia se anota cuando la transferencia termina (xfer_cb), no al entrar en el lote
+    if (ctx.batch.expr_count++ == 0) ctx.batch.expr_sample_us = sample_us;
 }
+#endif
 
-static void send_midi_zoom_g6(uint8_t button_index) {
+static void handle_button(uint8_t button_index, uint8_t page) {
+    const uint8_t *code = macro_for_button(button_index);
+    // Durante una sonda (real o simulada) el botón es un cambio de parche como los de la sonda:
+    // pasa por la misma comprobación de modo y la macro no llega ni a la pedalera ni a la simulada
+    if (!code || ctx.probe.active) {
+        send_midi_zoom_g6(button_index, page);
+        return;
+    }
     if (!ctx.dev_hdl) {
         ESP_LOGW(TAG, "Zoom G6 no detectada. No se puede enviar MIDI.");
+        led_feedback_fail(ctx.press_us);
         return;
     }
+    // Una pulsación nueva sustituye a la macro que estuviera en curso
+    esp_timer_stop(ctx.macro_timer);
+    ctx.macro_sysex_off = 0;
+    macro_start(&ctx.macro, code, esp_timer_get_time());
+    run_macro();
+}
 
-    usb_transfer_t *xfer;
-    // Reservamos espacio para 12 bytes (3 paquetes MIDI USB de 4 bytes cada uno)
-    if (usb_host_transfer_alloc(64, 0, &xfer) == ESP_OK) {
-        xfer->num_bytes = 12; 
-        xfer->bEndpointAddress = 0x03; // Endpoint MIDI Out de la Zoom G6
-        xfer->device_handle = ctx.dev_hdl;
-        xfer->callback = xfer_cb;
-
-        // LÓGICA DE BANCOS ZOOM G6:
-        // Botones 0-3 -> Banco Z (LSB 0x19), Parches 0-3
-        // Botones 4-7 -> Banco AA (LSB 0x1A), Parches 0-3
-        
-        uint8_t lsb_bank = (button_index < 4) ? 0x19 : 0x1A;
-        uint8_t patch_id = (button_index < 4) ? button_index : (button_index - 4);
-
-        // Mensaje 1: Bank Select MSB (Control Change 0, Valor 0)
-        xfer->data_buffer[0] = 0x0B; // MIDI USB Cine-byte (Control Change)
-        xfer->data_buffer[1] = 0xB0; // Status: CC Canal 1
-        xfer->data_buffer[2] = 0x00; // CC#0 (Bank Select MSB)
-        xfer->data_buffer[3] = 0x00; // Valor 0
-
-        // Mensaje 2: Bank Select LSB (Control Change 32, Valor 0x19 o 0x1A)
-        xfer->data_buffer[4] = 0x0B; 
-        xfer->data_buffer[5] = 0xB0; 
-        xfer->data_buffer[6] = 0x20; // CC#32 (Bank Select LSB)
-        xfer->data_buffer[7] = lsb_bank;
-
-        // Mensaje 3: Program Change (El parche dentro del banco)
-        xfer->data_buffer[8] = 0x0C; // MIDI USB Cine-byte (Program Change)
-        xfer->data_buffer[9] = 0xC0; // Status: PC Canal 1
-        xfer->data_buffer[10] = patch_id; 
-        xfer->data_buffer[11] = 0x00;
-
-        esp_err_t err = usb_host_transfer_submit(xfer);
+static void setlist_refresh(void) {
+    // Solo se mira si la configuración cambió desde la última vez
+    static app_config_t cfg;
+    if (!app_config_sync(&cfg, &ctx.setlist_gen)) return;
+    // Y solo se recompila si cambió el set list: ajustar otra cosa no pierde la posición ni la sincronía
+    if (cfg.setlist_len == ctx.setlist.count && cfg.setlist_scene_cc == ctx.setlist.scene_cc &&
+        memcmp(cfg.setlist, ctx.setlist.songs, cfg.setlist_len * sizeof(cfg.setlist[0])) == 0) {
+        return;
+    }
+    setlist_compile(&ctx.setlist, cfg.setlist, cfg.setlist_len, cfg.setlist_scene_cc);
+}
+
+static void handle_setlist(int dir) {
+    if (!ctx.dev_hdl) {
+        ESP_LOGW(TAG, "Zoom G6 no detectada. No se puede enviar MIDI.");
+        led_feedback_fail(ctx.press_us);
+        return;
+    }
+    setlist_refresh();
+
+    // Un paso es copiar la ráfaga precalculada al lote y, solo si cupo, avanzar el índice
+    const setlist_burst_t *b = setlist_peek(&ctx.setlist, dir);
+    if (!b) {
+        ESP_LOGI(TAG, "Set list: %s", dir > 0 ? "ultima cancion" : "primera cancion");
+        led_feedback_fail(ctx.press_us);
+        return;
+    }
+    if (b->len != 0 && !batch_reserve(b->len)) {
+        // Sin hueco la pedalera no cambia: la posición y la sincronía se quedan como estaban
+        ESP_LOGW(TAG, "Sin transferencias libres, se descarta el paso del set list");
+        led_feedback_fail(ctx.press_us);
+        return;
+    }
+    uint8_t len = b->len;
+    if (len == 0) {
+        // La canción siguiente usa el parche que ya está cargado
+        led_feedback_sent(ctx.press_us, true, esp_timer_get_time());
+    } else {
+        memcpy(batch_append(len), b->pkt, len);
+    }
+    setlist_commit(&ctx.setlist, dir);
+
+    const setlist_song_t *song = &ctx.setlist.songs[ctx.setlist.pos];
+    patch_cache_set_current(song->bank_lsb, song->program);
+    led_feedback_expect(ctx.press_us, song->bank_lsb, song->program);
+#if CONFIG_APP_TRACE_ENABLE
+    TRACE(TRACE_EV_SETLIST, ctx.setlist.pos, len, (uint32_t)song->bank_lsb << 8 | song->program);
+#else
+    char bank_name[3];
+    ESP_LOGI(TAG, "Set list %d/%d -> Banco %s Parche %d (%d bytes)", ctx.setlist.pos + 1, ctx.setlist.count,
+             zoom_bank_name(song->bank_lsb, bank_name), song->program + 1, len);
+#endif
+}
+
+static void sim_timer_cb(void *arg) {
+    class_driver_wake();
+}
+
+// La pedalera simulada contesta cuando vence su retardo
+static void sim_poll(void) {
+    if (!ctx.sim.echo_len || esp_timer_get_time() < ctx.sim.due_us) return;
+    int len = ctx.sim.echo_len;
+    ctx.sim.echo_len = 0;
+    rx_parse(ctx.sim.echo, len);
+}
+
+static void probe_begin(bool sim) {
+    // La macro en curso se corta aquí (nunca a mitad de SysEx: este mensaje no se lee hasta
+    // que termina), o seguiría saliendo entre las rondas de la sonda
+    ctx.macro.active = false;
+    esp_timer_stop(ctx.macro_timer);
+    ctx.probe.active = true;
+    ctx.probe.has_patch = patch_cache_get_current(&ctx.probe.bank_lsb, &ctx.probe.program);
+    ctx.probe.setlist_pos = ctx.setlist.pos;
+    ctx.probe.setlist_synced = ctx.setlist.synced;
+    ctx.probe.rx_bank_lsb = ctx.rx_bank_lsb;
+    ctx.sim.on = sim;
+    ctx.sim.echo_len = 0;
+}
+
+static void probe_end(void) {
+    if (!ctx.probe.active) return;
+    // Lo enviado a la pedalera simulada ya ha salido del lote; lo que quede de su respuesta se descarta
+    batch_flush();
+    bool sim = ctx.sim.on;
+    ctx.sim.on = false;
+    ctx.sim.echo_len = 0;
+    esp_timer_stop(ctx.sim.timer);
+    ctx.probe.active = false;
+
+    if (ctx.probe.has_patch) {
+        patch_cache_set_current(ctx.probe.bank_lsb, ctx.probe.program);
+    } else {
+        patch_cache_set_current(0xFF, 0xFF);
+    }
+    ctx.setlist.pos = ctx.probe.setlist_pos;
+    if (sim) {
+        // La pedalera de verdad no se ha enterado de nada
+        ctx.setlist.synced = ctx.probe.setlist_synced;
+        ctx.rx_bank_lsb = ctx.probe.rx_bank_lsb;
+        return;
+    }
+    // La de verdad vuelve al parche de antes; la escena del set list no se sabe: el siguiente
+    // paso manda la ráfaga completa
+    if (ctx.probe.has_patch && ctx.dev_hdl && batch_reserve(ZOOM_G6_PATCH_BYTES)) {
+        const patch_map_entry_t entry = { .bank_lsb = ctx.probe.bank_lsb, .program = ctx.probe.program };
+        zoom_encode_patch(&entry, batch_append(ZOOM_G6_PATCH_BYTES));
+    }
+}
+
+static void handle_msg(const midi_msg_t *m) {
+    uint8_t type = m->status & MIDI_MSG_TYPE_MASK;
+    if (type == MIDI_MSG_PROBE_BEGIN) {
+        probe_begin(m->data1 != 0);
+        return;
+    }
+    if (type == MIDI_MSG_PROBE_END) {
+        probe_end();
+        return;
+    }
+    if (type == MIDI_MSG_PROBE) {
+        // La sonda mide por su cuenta la vuelta por MIDI IN; su marca no coincide con ninguna pulsación
+        ctx.press_us = m->time_us;
+        ctx.press_hist = NULL;
+        ctx.sim.reply_us = m->sim_ms * 1000u;
+        send_midi_zoom_g6(m->data1, m->data2);
+        return;
+    }
+    bool setlist = type == MIDI_MSG_SETLIST_NEXT || type == MIDI_MSG_SETLIST_PREV;
+    ctx.press_us = m->time_us;
+    if (m->status & MIDI_MSG_FLAG_WAKE) ctx.press_hist = &stats.wake_to_midi;
+    else ctx.press_hist = setlist ? &stats.setlist_to_midi : &stats.press_to_midi;
+
+    if (setlist) handle_setlist(type == MIDI_MSG_SETLIST_NEXT ? 1 : -1);
+    else handle_button(m->data1, m->data2);
+    // Sin nada que enviar (sin pedalera, fin de lista...) no hay latencia que medir
+    ctx.press_hist = NULL;
+}
+
+static void flush_sysex(void) {
+    // Reparte los SysEx pendientes en tantas transferencias como haya libres;
+    // lo que no quepa sale en la siguiente vuelta del bucle. Con el SysEx de una macro
+    // a medias se espera a que termine, o este se metería entre sus trozos
+    while (ctx.dev_hdl && ctx.macro_sysex_off == 0 && sysex_tx_pending()) {
+        usb_transfer_t *xfer = tx_acquire();
+        if (!xfer) return;
+
+        uint16_t cap = ctx.mps_out < MIDI_XFER_SIZE ? ctx.mps_out : MIDI_XFER_SIZE;
+        size_t n = sysex_tx_fill(xfer->data_buffer, cap);
+        if (n == 0) {
+            xfer_cb(xfer);
+            return;
+        }
+        esp_err_t err = tx_submit(xfer, (int)n);
         if (err != ESP_OK) {
-            ESP_LOGE(TAG, "Error al enviar: 0x%x", err);
-            usb_host_transfer_free(xfer);
+            ESP_LOGE(TAG, "Error al enviar SysEx: 0x%x", err);
+            return;
+        }
+    }
+}
+
+static bool find_endpoints(void) {
+    const usb_config_desc_t *config;
+    if (usb_host_get_active_config_descriptor(ctx.dev_hdl, &config) != ESP_OK) return false;
+
+    int intf_offset;
+    const usb_intf_desc_t *intf = usb_parse_interface_descriptor(config, ZOOM_G6_MIDI_INTF, 0, &intf_offset);
+    if (!intf) return false;
+
+    ctx.ep_out = 0;
+    ctx.ep_in = 0;
+    for (int i = 0; i < intf->bNumEndpoints; i++) {
+        int ep_offset = intf_offset;
+        const usb_ep_desc_t *ep = usb_parse_endpoint_descriptor_by_index(intf, i, config->wTotalLength, &ep_offset);
+        if (!ep) continue;
+        if (ep->bEndpointAddress & USB_B_ENDPOINT_ADDRESS_EP_DIR_MASK) {
+            ctx.ep_in = ep->bEndpointAddress;
         } else {
-            ESP_LOGI(TAG, "Enviado: Boton %d -> Banco %s Parche %d", 
-                     button_index, (lsb_bank == 0x19 ? "Z" : "AA"), patch_id + 1);
+            ctx.ep_out = ep->bEndpointAddress;
+            ctx.mps_out = USB_EP_DESC_GET_MPS(ep);
         }
     }
+    return ctx.ep_out != 0;
+}
+
+static void open_device(uint8_t address) {
+    if (usb_host_device_open(ctx.client_hdl, address, &ctx.dev_hdl) != ESP_OK) return;
+
+    if (!find_endpoints() || usb_host_interface_claim(ctx.client_hdl, ctx.dev_hdl, ZOOM_G6_MIDI_INTF, 0) != ESP_OK) {
+        ESP_LOGE(TAG, "Interfaz MIDI no encontrada");
+        usb_host_device_close(ctx.client_hdl, ctx.dev_hdl);
+        ctx.dev_hdl = NULL;
+        return;
+    }
+
+    ctx.closing = false;
+    sysex_reset();
+
+    // Dos lecturas en vuelo para no dejar huecos en el endpoint durante un volcado largo
+    if (ctx.ep_in) {
+        for (int i = 0; i < MIDI_RX_POOL_SIZE; i++) {
+            ctx.rx_pool[i]->num_bytes = MIDI_XFER_SIZE;
+            ctx.rx_pool[i]->bEndpointAddress = ctx.ep_in;
+            ctx.rx_pool[i]->device_handle = ctx.dev_hdl;
+            usb_host_transfer_submit(ctx.rx_pool[i]);
+        }
+    }
+    patch_cache_on_connect();
+    power_usb_device(true);
+    TRACE(TRACE_EV_CONNECT, 1, 0, 0);
+#if CONFIG_APP_MIDI_CLOCK_ENABLE
+    // Solo si el usuario no lo apagó: la conexión no cambia lo que pidió
+    midi_clock_on_connect();
+#endif
+    ESP_LOGI(TAG, "--- ZOOM G6 CONECTADA --- (OUT 0x%02x, IN 0x%02x, MPS %d)", ctx.ep_out, ctx.ep_in, ctx.mps_out);
+    if (boot_prof_get(BOOT_FIRST_DEVICE) == 0) {
+        boot_prof_mark(BOOT_FIRST_DEVICE);
+        boot_prof_log();
+    }
+}
+
+static void close_device(void) {
+    if (!ctx.dev_hdl) return;
+    ctx.closing = true;
+
+    // Cancelamos lo que siga en vuelo antes de soltar la interfaz
+    uint8_t eps[2] = { ctx.ep_in, ctx.ep_out };
+    for (int i = 0; i < 2; i++) {
+        if (!eps[i]) continue;
+        usb_host_endpoint_halt(ctx.dev_hdl, eps[i]);
+        usb_host_endpoint_flush(ctx.dev_hdl, eps[i]);
+        usb_host_endpoint_clear(ctx.dev_hdl, eps[i]);
+    }
+    usb_host_interface_release(ctx.client_hdl, ctx.dev_hdl, ZOOM_G6_MIDI_INTF);
+    usb_host_device_close(ctx.client_hdl, ctx.dev_hdl);
+    ctx.dev_hdl = NULL;
+    ctx.batch.len = 0;
+    ctx.batch.num_sent = 0;
+    ctx.batch.press_hist = NULL;
+    ctx.batch.fb_press_us = 0;
+    ctx.batch.expr_count = 0;
+    ctx.macro.active = false;
+    ctx.macro_sysex_off = 0;
+    setlist_desync(&ctx.setlist);
+    esp_timer_stop(ctx.macro_timer);
+#if CONFIG_APP_MIDI_CLOCK_ENABLE
+    midi_clock_on_disconnect();
+#endif
+    sysex_reset();
+    patch_cache_on_disconnect();
+    power_usb_device(false);
+    TRACE(TRACE_EV_CONNECT, 0, 0, 0);
+
+    ESP_LOGI(TAG, "Enviados %lu paquetes en %lu transferencias",
+             (unsigned long)stats.packets, (unsigned long)stats.transfers);
+    ESP_LOGI(TAG, "Pulsacion->MIDI: media %ld us, max %ld us; set list: media %ld us, max %ld us",
+             (long)latency_avg_us(&stats.press_to_midi), (long)stats.press_to_midi.max_us,
+             (long)latency_avg_us(&stats.setlist_to_midi), (long)stats.setlist_to_midi.max_us);
 }
 
 static void handle_client_event(const usb_host_client_event_msg_t *msg, void *arg) {
     if (msg->event == USB_HOST_CLIENT_EVENT_NEW_DEV) {
-        if (usb_host_device_open(ctx.client_hdl, msg->new_dev.address, &ctx.dev_hdl) == ESP_OK) {
-            // Reclamamos la interfaz MIDI (usualmente la 4 en Zoom G6)
-            usb_host_interface_claim(ctx.client_hdl, ctx.dev_hdl, 4, 0);
-            ESP_LOGI(TAG, "--- ZOOM G6 CONECTADA ---");
-        }
+        if (!ctx.dev_hdl) open_device(msg->new_dev.address);
     } else if (msg->event == USB_HOST_CLIENT_EVENT_DEV_GONE) {
-        ctx.dev_hdl = NULL;
+        close_device();
         ESP_LOGW(TAG, "--- ZOOM G6 DESCONECTADA ---");
     }
 }
 
-void class_driver_task(void *arg) {
+void class_driver_wake(void) {
+    if (ctx.client_hdl) usb_host_client_unblock(ctx.client_hdl);
+}
+
+bool class_driver_post(const midi_msg_t *msg) {
+    if (midi_msg_queue == NULL || xQueueSend(midi_msg_queue, msg, 0) != pdTRUE) {
+        queue_drops++;
+        return false;
+    }
+    class_driver_wake();
+    return true;
+}
+
+void class_driver_get_stats(class_driver_stats_t *out) {
+    // Solo la tarea MIDI escribe; una copia sin bloqueo basta para leer contadores
+    memcpy(out, &stats, sizeof(stats));
+    out->queue_drops = queue_drops;
+}
+
+void class_driver_reset_stats(void) {
+    queue_drops = 0;
+    stats_reset_pending = true;
+    class_driver_wake();
+}
+
+void class_driver_setup(void) {
     usb_host_client_config_t cfg = {
         .is_synchronous = false,
         .max_num_event_msg = 5,
         .async = { .client_event_callback = handle_client_event, .callback_arg = NULL }
     };
     usb_host_client_register(&cfg, &ctx.client_hdl);
-    
+    boot_prof_mark(BOOT_USB_CLIENT);
+
+    // usb_host no acepta buffers del llamante (tienen que ser memoria DMA): las transferencias
+    // se reservan una sola vez aquí, durante el arranque, y se reutilizan en cada conexión
+    for (int i = 0; i < MIDI_TX_POOL_SIZE; i++) {
+        usb_host_transfer_alloc(MIDI_XFER_SIZE, 0, &ctx.tx_pool[i]);
+        ctx.tx_pool[i]->callback = xfer_cb;
+        ctx.tx_pool[i]->context = (void *)(uintptr_t)i;
+    }
+    for (int i = 0; i < MIDI_RX_POOL_SIZE; i++) {
+        usb_host_transfer_alloc(MIDI_XFER_SIZE, 0, &ctx.rx_pool[i]);
+        ctx.rx_pool[i]->callback = rx_cb;
+    }
+
+    usb_host_transfer_alloc(MIDI_XFER_SIZE, 0, &ctx.rt_xfer);
+    ctx.rt_xfer->callback = xfer_cb;
+    ctx.rt_xfer->context = (void *)(uintptr_t)MIDI_TX_POOL_SIZE;
+
+    macro_init();
+    setlist_init(&ctx.setlist);
+    setlist_refresh();
+    const esp_timer_create_args_t timer_args = { .callback = macro_timer_cb, .name = "macro" };
+    esp_timer_create(&timer_args, &ctx.macro_timer);
+    const esp_timer_create_args_t sim_args = { .callback = sim_timer_cb, .name = "midi_sim" };
+    esp_timer_create(&sim_args, &ctx.sim.timer);
+}
+
+void class_driver_loop(void) {
+    // Manejamos eventos USB con timeout para no bloquear
+    usb_host_client_handle_events(ctx.client_hdl, batch_wait_ticks());
+    // La respuesta de la pedalera simulada entra donde entraría MIDI IN
+    sim_poll();
+
+    if (stats_reset_pending) {
+        stats_reset_pending = false;
+        memset(&stats, 0, sizeof(stats));
+        macro_reset_stats();
+    }
+
+    // Tiempo real primero: adelanta a cualquier ráfaga pendiente
+    send_realtime();
+
+    // Macro nueva desde la consola: se instala entre dos ráfagas
+    macro_sync(&ctx.macro);
+
+    midi_msg_t m;
+    // Un SysEx de macro a medias termina antes que nada: un mensaje de canal en medio lo cortaría
+    if (ctx.macro_sysex_off != 0) run_macro();
+    // Vaciamos la cola en el lote actual; lo que no quepa espera en la cola. Solo se hace
+    // hueco (y puede salir el lote) si hay algo que meter: si no, el lote sigue abierto hasta
+    // que venza la ventana o se llene
+    while (ctx.macro_sysex_off == 0 && uxQueueMessagesWaiting(midi_msg_queue) > 0 &&
+           batch_reserve(PRESS_MAX_BYTES) && xQueueReceive(midi_msg_queue, &m, 0) == pdTRUE) {
+        handle_msg(&m);
+    }
+    if (ctx.macro.active) run_macro();
+#if CONFIG_APP_EXPRESSION_ENABLE
+    send_expression();
+#endif
+    if (batch_due()) batch_flush();
+
+    flush_sysex();
+
+    // Pequeño respiro para el Watchdog
+    vTaskDelay(pdMS_TO_TICKS(1));
+}
+
+void class_driver_task(void *arg) {
+    // usb_host_lib_task avisa cuando usb_host_install() ha terminado
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    class_driver_setup();
     while (1) {
-        // Manejamos eventos USB con timeout para no bloquear
-        usb_host_client_handle_events(ctx.client_hdl, pdMS_TO_TICKS(10)); 
-        
-        midi_msg_t m;
-        // Si hay un mensaje en la cola, lo enviamos a la pedalera
-        if (xQueueReceive(midi_msg_queue, &m, 0) == pdTRUE) {
-            send_midi_zoom_g6(m.data1);
-        }
-        
-        // Pequeño respiro para el Watchdog
-        vTaskDelay(pdMS_TO_TICKS(1));
+        class_driver_loop();
     }
-}
\ No newline at end of file
+}
@@ -1,18 +1,73 @@
 #ifndef CLASS_DRIVER_H
 #define CLASS_DRIVER_H
 
+#include <stdbool.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/queue.h"
+#include "latency.h"
+#include "patch_map.h"
+
+// Mapa por defecto: los botones se reparten en grupos de 4 a partir del banco Z
+#define ZOOM_G6_FIRST_BANK 0x19
+#define ZOOM_G6_PATCHES_PER_BANK 4
+#define ZOOM_G6_NUM_BANKS 50
+// Bank Select MSB, Bank Select LSB y Program Change en paquetes USB MIDI
+#define ZOOM_G6_PATCH_BYTES 12
+
+// Tipos de mensaje en midi_msg_t.status
+#define MIDI_MSG_BUTTON       0 // data1 = botón, data2 = página del mapa de parches
+#define MIDI_MSG_SETLIST_NEXT 1
+#define MIDI_MSG_SETLIST_PREV 2
+#define MIDI_MSG_PROBE        3 // Como BUTTON pero siempre el parche del mapa, sin macros ni estadísticas
+#define MIDI_MSG_PROBE_BEGIN  4 // Guarda el parche actual y el set list; data1 = 1: responde la pedalera simulada
+#define MIDI_MSG_PROBE_END    5 // Los deja como estaban antes de MIDI_MSG_PROBE_BEGIN
+#define MIDI_MSG_TYPE_MASK    0x7F
+#define MIDI_MSG_FLAG_WAKE    0x80 // La pulsación sacó al controlador del standby
 
 typedef struct {
     uint8_t status;
     uint8_t data1;
     uint8_t data2;
+    int64_t time_us;    // Flanco de la pulsación, para medir la latencia hasta el MIDI
+    uint16_t sim_ms;    // MIDI_MSG_PROBE con la pedalera simulada: lo que tarda en contestar
 } midi_msg_t;
 
+// Paquetes USB MIDI de 4 bytes que caben en una transferencia de 64 bytes
+#define MIDI_MAX_PACKETS_PER_XFER 16
+
+typedef struct {
+    uint32_t transfers;
+    uint32_t packets;
+    uint32_t xfer_errors;       // Rechazadas al enviar
+    uint32_t xfer_failed;       // Completadas con error
+    uint32_t queue_drops;       // Pulsaciones perdidas con la cola llena
+    uint32_t packets_per_xfer[MIDI_MAX_PACKETS_PER_XFER + 1];
+    // Desde la pulsación hasta que la transferencia termina en el bus
+    latency_hist_t press_to_midi;
+    latency_hist_t setlist_to_midi;
+    latency_hist_t wake_to_midi;    // Desde el flanco que despertó del standby
+} class_driver_stats_t;
+
 extern QueueHandle_t midi_msg_queue;
 
 void class_driver_task(void *arg);
+// La tarea es class_driver_setup() y después class_driver_loop() sin fin; las pruebas en el PC
+// (test/host) los llaman por separado y hacen de planificador
+void class_driver_setup(void);
+void class_driver_loop(void);
 void class_driver_client_deregister(void);
+// Despierta a la tarea MIDI cuando hay trabajo nuevo fuera de la cola de botones
+void class_driver_wake(void);
+// Encola una pulsación sin esperar; devuelve false (y lo cuenta) si la cola está llena
+bool class_driver_post(const midi_msg_t *msg);
+void class_driver_get_stats(class_driver_stats_t *out);
+// La tarea MIDI pone los contadores a cero en su siguiente vuelta
+void class_driver_reset_stats(void);
+// Nombre del banco como lo muestra la pedalera (A..Z, AA..AX)
+const char *zoom_bank_name(uint8_t bank, char out[3]);
+// Al revés: nombre de la pedalera o número; -1 si no es un banco
+int zoom_bank_parse(const char *text);
+// Cambio de parche de una entrada del mapa (ZOOM_G6_PATCH_BYTES bytes)
+void zoom_encode_patch(const patch_map_entry_t *entry, uint8_t *pkt);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,165 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "class_driver.h"
+#include "app_config.h"
+#include "setlist.h"
+#include "sdkconfig.h"
+#include "config_cmd.h"
+
+// La copia que se edita: la consola es una sola tarea
+static app_config_t edit;
+
+typedef enum { FIELD_U8, FIELD_U32, FIELD_RGB } field_type_t;
+
+typedef struct {
+    const char *name;
+    field_type_t type;
+    uint16_t offset;
+    uint32_t min, max;
+} field_t;
+
+#define FIELD(f, t, lo, hi) { #f, t, offsetof(app_config_t, f), lo, hi }
+
+// Lo que se puede ajustar en directo; el set list tiene su propio comando
+static const field_t fields[] = {
+    FIELD(led_gpio, FIELD_U8, 0, 48),
+    FIELD(num_leds, FIELD_U8, 1, CONFIG_APP_NUM_LEDS),
+    FIELD(brightness, FIELD_U8, 0, 255),
+    FIELD(standby_dim, FIELD_U8, 0, 255),
+    FIELD(standby_s, FIELD_U32, 1, 24 * 3600),
+    FIELD(color_active, FIELD_RGB, 0, 255),
+    FIELD(color_page, FIELD_RGB, 0, 255),
+    FIELD(color_welcome, FIELD_RGB, 0, 255),
+    FIELD(color_ready, FIELD_RGB, 0, 255),
+    FIELD(color_pending, FIELD_RGB, 0, 255),
+    FIELD(color_failed, FIELD_RGB, 0, 255),
+    FIELD(setlist_scene_cc, FIELD_U8, 0, 119),
+};
+
+#define NUM_FIELDS (sizeof(fields) / sizeof(fields[0]))
+
+static const field_t *find_field(const char *name) {
+    for (size_t i = 0; i < NUM_FIELDS; i++) {
+        if (strcmp(fields[i].name, name) == 0) return &fields[i];
+    }
+    printf("campo desconocido: %s\n", name);
+    return NULL;
+}
+
+static void field_show(const app_config_t *cfg, const field_t *f) {
+    const uint8_t *p = (const uint8_t *)cfg + f->offset;
+    switch (f->type) {
+    case FIELD_U8:
+        printf("%-16s %u\n", f->name, *p);
+        break;
+    case FIELD_U32: {
+        uint32_t v;
+        memcpy(&v, p, sizeof(v));   // La estructura está empaquetada
+        printf("%-16s %lu\n", f->name, (unsigned long)v);
+        break;
+    }
+    case FIELD_RGB:
+        printf("%-16s %u %u %u\n", f->name, p[0], p[1], p[2]);
+        break;
+    }
+}
+
+// Lee los valores de argv sobre la copia; false (y nada cambiado) si falta alguno o se sale del rango
+static bool field_parse(app_config_t *cfg, const field_t *f, int argc, char **argv) {
+    int n = f->type == FIELD_RGB ? 3 : 1;
+    uint32_t v[3];
+    if (argc != n) {
+        printf("set %s: %d valor%s\n", f->name, n, n > 1 ? "es" : "");
+        return false;
+    }
+    for (int i = 0; i < n; i++) {
+        char *end;
+        unsigned long x = strtoul(argv[i], &end, 0);
+        if (*end || end == argv[i] || x < f->min || x > f->max) {
+            printf("set %s: %s fuera de %lu..%lu\n", f->name, argv[i], (unsigned long)f->min, (unsigned long)f->max);
+            return false;
+        }
+        v[i] = (uint32_t)x;
+    }
+    uint8_t *p = (uint8_t *)cfg + f->offset;
+    if (f->type == FIELD_U32) {
+        memcpy(p, &v[0], sizeof(v[0]));
+    } else {
+        for (int i = 0; i < n; i++) p[i] = (uint8_t)v[i];
+    }
+    return true;
+}
+
+int config_cmd_cfg(int argc, char **argv) {
+    const char *sub = argc > 1 ? argv[1] : "show";
+    app_config_copy(&edit);
+    if (strcmp(sub, "show") == 0) {
+        for (size_t i = 0; i < NUM_FIELDS; i++) field_show(&edit, &fields[i]);
+        return 0;
+    }
+    if (strcmp(sub, "reset") == 0) {
+        app_config_reset();
+        printf("valores por defecto; se guardan en %d s sin mas cambios\n", APP_CONFIG_COMMIT_DELAY_MS / 1000);
+        return 0;
+    }
+    const field_t *f = argc > 2 && (strcmp(sub, "get") == 0 || strcmp(sub, "set") == 0) ? find_field(argv[2]) : NULL;
+    if (!f) {
+        if (argc <= 2) printf("uso: cfg [show] | get <campo> | set <campo> <valor> | reset\n");
+        return 1;
+    }
+    if (strcmp(sub, "set") == 0) {
+        if (!field_parse(&edit, f, argc - 3, argv + 3)) return 1;
+        // Se aplica ya; la escritura en flash espera a que dejen de llegar ajustes
+        app_config_set(&edit);
+        if (strcmp(f->name, "led_gpio") == 0) printf("el pin nuevo se aplica al reiniciar\n");
+    }
+    field_show(&edit, f);
+    return 0;
+}
+
+static void setlist_show(const app_config_t *cfg) {
+    for (int i = 0; i < cfg->setlist_len; i++) {
+        const setlist_song_t *s = &cfg->setlist[i];
+        char bank_name[3];
+        printf("%2d: %s%d", i + 1, zoom_bank_name(s->bank_lsb, bank_name), s->program + 1);
+        if (s->scene != SETLIST_SCENE_NONE) printf("  escena %d (CC%d)", s->scene, cfg->setlist_scene_cc);
+        printf("\n");
+    }
+    printf("%d de %d canciones\n", cfg->setlist_len, SETLIST_MAX_SONGS);
+}
+
+int config_cmd_setlist(int argc, char **argv) {
+    const char *sub = argc > 1 ? argv[1] : "show";
+    app_config_copy(&edit);
+    if (strcmp(sub, "show") == 0) {
+        setlist_show(&edit);
+        return 0;
+    }
+    if (strcmp(sub, "clear") == 0) {
+        edit.setlist_len = 0;
+        memset(edit.setlist, 0, sizeof(edit.setlist));
+    } else if (strcmp(sub, "add") == 0 && argc > 3) {
+        int bank = zoom_bank_parse(argv[2]);
+        int program = atoi(argv[3]) - 1;
+        int scene = argc > 4 ? atoi(argv[4]) : SETLIST_SCENE_NONE;
+        if (bank < 0 || program < 0 || program >= ZOOM_G6_PATCHES_PER_BANK || (argc > 4 && (scene < 0 || scene > 127))) {
+            printf("add: banco (A..AX o 0..%d), parche (1..%d) o escena (0..127) no validos\n", ZOOM_G6_NUM_BANKS - 1,
+                   ZOOM_G6_PATCHES_PER_BANK);
+            return 1;
+        }
+        if (edit.setlist_len >= SETLIST_MAX_SONGS) {
+            printf("add: el set list ya tiene %d canciones\n", SETLIST_MAX_SONGS);
+            return 1;
+        }
+        edit.setlist[edit.setlist_len++] = (setlist_song_t){
+            .bank_msb = 0, .bank_lsb = (uint8_t)bank, .program = (uint8_t)program, .scene = (uint8_t)scene };
+    } else {
+        printf("uso: setlist [show] | clear | add <banco> <parche> [escena]\n");
+        return 1;
+    }
+    app_config_set(&edit);
+    setlist_show(&edit);
+    return 0;
+}
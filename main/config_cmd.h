@@ -0,0 +1,15 @@
+#ifndef CONFIG_CMD_H
+#define CONFIG_CMD_H
+
+// Comandos de consola que editan la configuración (app_config.h). Cada uno hace una copia,
+// la cambia y la aplica con app_config_set(): la tarea de configuración la guarda en NVS
+// pasado APP_CONFIG_COMMIT_DELAY_MS sin más cambios. diag.c los registra; las pruebas en el PC
+// (test/host) los llaman con argc/argv como la consola.
+
+// cfg [show] | get <campo> | set <campo> <valor> (colores: <r> <g> <b>) | reset
+int config_cmd_cfg(int argc, char **argv);
+
+// setlist [show] | clear | add <banco> <parche> [escena]
+int config_cmd_setlist(int argc, char **argv);
+
+#endif
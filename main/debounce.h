@@ -0,0 +1,23 @@
+#ifndef DEBOUNCE_H
+#define DEBOUNCE_H
+
+#include <stdint.h>
+
+// Antirrebote sobre el estado crudo de cada escaneo (bit i = interruptor i pulsado). Lógica
+// pura, sin dependencias de ESP-IDF: la comparten la tarea hw y la reproducción de grabaciones.
+
+typedef struct {
+    uint32_t stable;    // Estado ya filtrado de rebotes
+    uint32_t last;      // Lectura cruda del escaneo anterior
+} debounce_t;
+
+// Un bit cambia cuando dos lecturas seguidas coinciden y difieren del estado estable.
+// Devuelve los bits que acaban de cambiar, ya aplicados a stable
+static inline uint32_t debounce_scan(debounce_t *d, uint32_t raw) {
+    uint32_t changes = (raw ^ d->stable) & ~(raw ^ d->last);
+    d->last = raw;
+    d->stable ^= changes;
+    return changes;
+}
+
+#endif
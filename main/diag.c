@@ -0,0 +1,408 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_console.h"
+#include "esp_heap_caps.h"
+#include "esp_system.h"
+#include "class_driver.h"
+#include "latency.h"
+#include "hardware.h"
+#include "power.h"
+#include "boot_prof.h"
+#include "led_bench.h"
+#include "led_feedback.h"
+#include "midi_probe.h"
+#include "input.h"
+#include "input_rec.h"
+#include "macro.h"
+#include "midi_clock.h"
+#include "expression.h"
+#include "config_cmd.h"
+#include "trace.h"
+#include "diag.h"
+
+static const char *TAG = "DIAG";
+
+// Tareas vigiladas más las dos idle; el consumo se mide desde el último "tasks" o "reset"
+static TaskHandle_t watched[DIAG_MAX_TASKS + portNUM_PROCESSORS];
+static uint32_t stack_size[DIAG_MAX_TASKS];
+static uint32_t last_runtime[DIAG_MAX_TASKS + portNUM_PROCESSORS];
+static int num_watched = 0;
+static int64_t last_sample_us = 0;
+
+void diag_watch_task(TaskHandle_t task, uint32_t stack) {
+    if (task == NULL || num_watched >= DIAG_MAX_TASKS) return;
+    stack_size[num_watched] = stack;
+    watched[num_watched++] = task;
+}
+
+// vTaskGetInfo en vez de uxTaskGetSystemState, que suspende el planificador para recorrer
+// todas las tareas. Se pasa un estado fijo (no se muestra) para que no llame a eTaskGetState;
+// sí se pide la marca de pila, que recorre la pila de cada tarea vigilada
+static void sample_tasks(bool print) {
+    int64_t now = esp_timer_get_time();
+    int64_t window = now - last_sample_us;
+
+    if (print) printf("%-8s %4s %6s %7s %7s\n", "tarea", "core", "cpu%", "libre", "pila");
+    for (int i = 0; i < num_watched + portNUM_PROCESSORS; i++) {
+        TaskHandle_t t = i < num_watched ? watched[i] : xTaskGetIdleTaskHandleForCore(i - num_watched);
+        TaskStatus_t st;
+        vTaskGetInfo(t, &st, pdTRUE, eRunning);
+
+        // El contador de ejecución va en µs de esp_timer y cada núcleo aporta el 100 %
+        uint32_t delta = st.ulRunTimeCounter - last_runtime[i];
+        last_runtime[i] = st.ulRunTimeCounter;
+        if (print) {
+            int core = st.xCoreID < portNUM_PROCESSORS ? (int)st.xCoreID : -1;
+            uint32_t pct_x10 = window > 0 ? (uint32_t)((int64_t)delta * 1000 / window) : 0;
+            printf("%-8s %4d %4lu.%lu %7lu %7lu\n", st.pcTaskName, core,
+                   (unsigned long)(pct_x10 / 10), (unsigned long)(pct_x10 % 10),
+                   (unsigned long)st.usStackHighWaterMark, (unsigned long)(i < num_watched ? stack_size[i] : 0));
+        }
+    }
+    if (print) printf("ventana %lld ms; libre = minimo historico de la pila (bytes)\n", (long long)(window / 1000));
+    last_sample_us = now;
+}
+
+static void print_hist(const char *name, const latency_hist_t *h) {
+    printf("%-8s n=%lu media=%ld max=%ld us\n", name, (unsigned long)h->count,
+           (long)latency_avg_us(h), (long)h->max_us);
+    for (int i = 0; i < LATENCY_BUCKETS; i++) {
+        int32_t bound = latency_bucket_bound_us(i);
+        if (bound == INT32_MAX) {
+            printf("   resto    %lu\n", (unsigned long)h->hist[i]);
+        } else {
+            printf("  <%-6ld   %lu\n", (long)bound, (unsigned long)h->hist[i]);
+        }
+    }
+}
+
+static int cmd_lat(int argc, char **argv) {
+    class_driver_stats_t s;
+    class_driver_get_stats(&s);
+    print_hist("pulsar", &s.press_to_midi);
+    print_hist("setlist", &s.setlist_to_midi);
+    print_hist("despert", &s.wake_to_midi);
+
+    led_fb_stats_t fb;
+    led_feedback_get_stats(&fb);
+    print_hist("foton", &fb.press_to_photon);
+    print_hist("trama", &fb.frame_to_photon);
+    printf("luz antes que MIDI %lu  MIDI antes que luz %lu  max retraso luz %ld us\n",
+           (unsigned long)fb.photon_first, (unsigned long)fb.midi_first, (long)fb.max_photon_lag_us);
+    print_hist("confirm", &fb.press_to_commit);
+    printf("confirmadas %lu  fallidas %lu  sin respuesta %lu  sustituidas %lu\n", (unsigned long)fb.committed,
+           (unsigned long)fb.failed, (unsigned long)fb.timeouts, (unsigned long)fb.superseded);
+#if CONFIG_APP_EXPRESSION_ENABLE
+    expression_stats_t ex;
+    expression_get_stats(&ex);
+    printf("expresion: enviados %lu  sustituidos %lu  muestra->cable ultima %lld us, max %lld us\n",
+           (unsigned long)ex.sent, (unsigned long)ex.replaced, (long long)ex.last_latency_us,
+           (long long)ex.max_latency_us);
+#endif
+    return 0;
+}
+
+static int cmd_usb(int argc, char **argv) {
+    class_driver_stats_t s;
+    class_driver_get_stats(&s);
+    uint32_t coalesced = s.packets > s.transfers ? s.packets - s.transfers : 0;
+    printf("transferencias %lu  paquetes %lu  agrupados %lu\n",
+           (unsigned long)s.transfers, (unsigned long)s.packets, (unsigned long)coalesced);
+    printf("errores %lu  fallidas %lu  mensajes descartados %lu\n",
+           (unsigned long)s.xfer_errors, (unsigned long)s.xfer_failed, (unsigned long)s.queue_drops);
+    printf("paquetes por transferencia:");
+    for (int i = 1; i <= MIDI_MAX_PACKETS_PER_XFER; i++) {
+        if (s.packets_per_xfer[i]) printf(" %d:%lu", i, (unsigned long)s.packets_per_xfer[i]);
+    }
+    printf("\n");
+    return 0;
+}
+
+static int cmd_leds(int argc, char **argv) {
+    hw_stats_t s;
+    hardware_get_stats(&s);
+    printf("frames enviados %lu  sin cambios %lu\n",
+           (unsigned long)s.led_frames_sent, (unsigned long)s.led_frames_skipped);
+    if (s.led_timed_frames) {
+        printf("componer %lu ciclos/frame\n", (unsigned long)(s.led_compose_cycles / s.led_timed_frames));
+    }
+    if (s.led_frames_sent) {
+        printf("envio %lu us/frame\n", (unsigned long)(s.led_refresh_us / s.led_frames_sent));
+    }
+#if CONFIG_APP_LED_FIXED_BACKEND
+    printf("backend: fijo (%d LEDs GRB)\n", CONFIG_APP_NUM_LEDS);
+#else
+    printf("backend: led_strip RMT\n");
+#endif
+    return 0;
+}
+
+static int cmd_tasks(int argc, char **argv) {
+    sample_tasks(true);
+    return 0;
+}
+
+static int cmd_mem(int argc, char **argv) {
+    printf("interna: libre %u  minimo %u  mayor bloque %u\n",
+           (unsigned)heap_caps_get_free_size(MALLOC_CAP_INTERNAL),
+           (unsigned)heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL),
+           (unsigned)heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL));
+    // Sin reservas tras el arranque, estas diferencias no deberían crecer (salvo la consola y la enumeración USB)
+    uint32_t now_free = esp_get_free_heap_size();
+    boot_phase_t phases[] = { BOOT_READY, BOOT_FIRST_DEVICE };
+    for (size_t i = 0; i < sizeof(phases) / sizeof(phases[0]); i++) {
+        if (boot_prof_get(phases[i]) == 0) continue;
+        printf("desde '%s': %ld bytes\n", boot_prof_name(phases[i]),
+               (long)now_free - (long)boot_prof_heap_free(phases[i]));
+    }
+#if CONFIG_SPIRAM
+    printf("psram:   libre %u  minimo %u  mayor bloque %u\n",
+           (unsigned)heap_caps_get_free_size(MALLOC_CAP_SPIRAM),
+           (unsigned)heap_caps_get_minimum_free_size(MALLOC_CAP_SPIRAM),
+           (unsigned)heap_caps_get_largest_free_block(MALLOC_CAP_SPIRAM));
+#endif
+    return 0;
+}
+
+static int cmd_power(int argc, char **argv) {
+    static const char *names[POWER_MODES] = { "activo", "standby" };
+    power_stats_t p;
+    power_get_stats(&p);
+    for (int m = 0; m < POWER_MODES; m++) {
+        printf("%-8s %lld s  idle %u%%  ~%u.%u mA\n", names[m], (long long)(p.time_us[m] / 1000000),
+               p.idle_pct[m], p.est_ma_x10[m] / 10, p.est_ma_x10[m] % 10);
+    }
+    printf("entradas en standby %lu  light sleep %s\n", (unsigned long)p.standby_entries,
+           p.light_sleep_allowed ? "permitido" : "bloqueado");
+    if (!p.pm_enabled) printf("gestion de energia no disponible: el standby no baja la CPU\n");
+    return 0;
+}
+
+static int cmd_boot(int argc, char **argv) {
+    boot_prof_log();
+    return 0;
+}
+
+static int cmd_ledbench(int argc, char **argv) {
+    if (argc < 2) {
+        printf("uso: ledbench <gpio libre> [frames]\n");
+        return 1;
+    }
+    int frames = argc > 2 ? atoi(argv[2]) : 50;
+    led_bench_run(atoi(argv[1]), frames > 0 ? frames : 50);
+    return 0;
+}
+
+static int cmd_ledgroup(int argc, char **argv) {
+    if (argc < 4) {
+        printf("uso: ledgroup <leds> <gpio> <gpio> [gpio] [gpio]\n");
+        return 1;
+    }
+    int gpios[4];
+    int n = 0;
+    for (int i = 2; i < argc && n < 4; i++) gpios[n++] = atoi(argv[i]);
+    int leds = atoi(argv[1]);
+    led_bench_group(gpios, n, leds > 0 ? leds : 8, 50);
+    return 0;
+}
+
+static int cmd_ledcomp(int argc, char **argv) {
+    int renders = argc > 1 ? atoi(argv[1]) : 1000;
+    led_bench_comp(renders > 0 ? renders : 1000);
+    return 0;
+}
+
+static int cmd_rtt(int argc, char **argv) {
+    int rounds = argc > 1 ? atoi(argv[1]) : 5;
+    int page = argc > 2 ? atoi(argv[2]) - 1 : 0;
+    // "sim" seguido de retardos en ms por botón: responde un dispositivo simulado
+    uint32_t sim_ms[CONFIG_APP_NUM_BUTTONS];
+    int num_sim = 0;
+    bool sim = argc > 3 && strcmp(argv[3], "sim") == 0;
+    for (int i = 4; sim && i < argc && num_sim < CONFIG_APP_NUM_BUTTONS; i++) sim_ms[num_sim++] = atoi(argv[i]);
+    if (sim && num_sim == 0) {
+        printf("uso: rtt [rondas] [pagina] [sim <ms> [ms]...]\n");
+        return 1;
+    }
+    midi_probe_run(page, rounds, sim ? sim_ms : NULL, num_sim);
+    return 0;
+}
+
+static int hex_nibble(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Hasta cap bytes de una cadena hexadecimal; se para en el primer carácter no válido
+static size_t parse_hex(const char *h, uint8_t *out, size_t cap) {
+    size_t n = 0;
+    for (; h[0] && h[1] && n < cap; h += 2) {
+        int hi = hex_nibble(h[0]), lo = hex_nibble(h[1]);
+        if (hi < 0 || lo < 0) break;
+        out[n++] = (uint8_t)(hi << 4 | lo);
+    }
+    return n;
+}
+
+static int cmd_inrec(int argc, char **argv) {
+    const char *sub = argc > 1 ? argv[1] : "";
+    if (strcmp(sub, "start") == 0) {
+        // El periodo de escaneo de los interruptores, para reproducir con el mismo reloj
+        input_rec_start(INPUT_SCAN_US);
+        printf("grabando\n");
+    } else if (strcmp(sub, "stop") == 0) {
+        input_rec_stop();
+        input_rec_dump();
+    } else if (strcmp(sub, "dump") == 0) {
+        input_rec_dump();
+    } else if (strcmp(sub, "load") == 0 && argc > 3) {
+        // Lo genera tools/input_rec.py load: offset y hasta 64 bytes en hexadecimal
+        uint8_t data[64];
+        size_t n = parse_hex(argv[3], data, sizeof(data));
+        if (!input_rec_load(strtoul(argv[2], NULL, 10), data, n)) {
+            printf("load: fuera de orden, demasiado grande o grabando\n");
+            return 1;
+        }
+    } else if (strcmp(sub, "replay") == 0) {
+        uint32_t scan_us = argc > 2 ? strtoul(argv[2], NULL, 10) * 1000 : 0;
+        uint32_t crc = argc > 3 ? strtoul(argv[3], NULL, 16) : 0;
+        input_rec_replay(scan_us, crc);
+    } else {
+        printf("uso: inrec start | stop | dump | load <offset> <hex> | replay [escaneo_ms] [crc]\n");
+        return 1;
+    }
+    return 0;
+}
+
+static int cmd_macro(int argc, char **argv) {
+    const char *sub = argc > 1 ? argv[1] : "";
+    if (strcmp(sub, "list") == 0) {
+        for (int i = 0; i < MACRO_MAX_BUTTONS; i++) {
+            size_t len = macro_len(i);
+            if (len) printf("boton %d: %u bytes\n", i + 1, (unsigned)len);
+        }
+        macro_stats_t st;
+        macro_get_stats(&st);
+        printf("ejecutadas %lu  interrumpidas %lu  ultima %lld us  max retraso %lld us\n", (unsigned long)st.runs,
+               (unsigned long)st.aborted, (long long)st.last_us, (long long)st.max_overrun_us);
+    } else if (strcmp(sub, "load") == 0 && argc > 3) {
+        // Lo genera tools/macro.py: offset y hasta 64 bytes de bytecode en hexadecimal
+        uint8_t data[64];
+        size_t n = parse_hex(argv[3], data, sizeof(data));
+        if (!macro_load(strtoul(argv[2], NULL, 10), data, n)) {
+            printf("load: fuera de orden, demasiado grande o hay otra macro pendiente\n");
+            return 1;
+        }
+    } else if ((strcmp(sub, "commit") == 0 || strcmp(sub, "clear") == 0) && argc > 2) {
+        int button = atoi(argv[2]) - 1;
+        uint8_t none = 0;
+        // Borrar es guardar una macro vacía
+        if (strcmp(sub, "clear") == 0 && !macro_load(0, &none, 0)) {
+            printf("hay otra macro pendiente\n");
+            return 1;
+        }
+        esp_err_t err = button >= 0 ? macro_commit(button) : ESP_ERR_INVALID_ARG;
+        if (err != ESP_OK) {
+            printf("%s: %s\n", sub, err == ESP_ERR_INVALID_ARG ? "boton o macro no valida" : esp_err_to_name(err));
+            return 1;
+        }
+        printf("boton %d: guardada\n", button + 1);
+    } else {
+        printf("uso: macro list | load <offset> <hex> | commit <boton> | clear <boton>\n");
+        return 1;
+    }
+    return 0;
+}
+
+#if CONFIG_APP_EXPRESSION_ENABLE
+static int cmd_expr(int argc, char **argv) {
+    int ms = argc > 1 ? atoi(argv[1]) : 2000;
+    expression_capture(ms > 0 ? ms : 2000);
+    return 0;
+}
+#endif
+
+#if CONFIG_APP_TRACE_ENABLE
+static int cmd_trace(int argc, char **argv) {
+    bool clear = argc > 1 && strcmp(argv[1], "clear") == 0;
+    if (argc > 2 || (argc > 1 && !clear)) {
+        printf("uso: trace [clear]\n");
+        return 1;
+    }
+    // Lo hace la tarea de trazas, la única que avanza la lectura de los anillos
+    if (!trace_request(clear)) {
+        printf("la tarea de trazas no esta en marcha\n");
+        return 1;
+    }
+    return 0;
+}
+#endif
+
+static int cmd_reset(int argc, char **argv) {
+    // Cada tarea pone a cero sus propios contadores; aquí solo se avisa
+    class_driver_reset_stats();    // También las de las macros, que son de la tarea MIDI
+    hardware_reset_stats();
+    led_feedback_reset_stats();
+    power_reset_stats();
+    midi_clock_reset_stats();
+    sample_tasks(false);
+    printf("contadores a cero\n");
+    return 0;
+}
+
+static const esp_console_cmd_t commands[] = {
+    { .command = "lat",   .help = "Latencia pulsacion -> MIDI, -> LED pendiente y -> confirmacion", .func = cmd_lat },
+    { .command = "usb",   .help = "Transferencias, agrupacion, errores y descartes", .func = cmd_usb },
+    { .command = "leds",  .help = "Frames de la tira enviados y omitidos", .func = cmd_leds },
+    { .command = "tasks", .help = "CPU por tarea desde la ultima lectura y pila minima", .func = cmd_tasks },
+    { .command = "mem",   .help = "Heap libre, minimo historico y mayor bloque", .func = cmd_mem },
+    { .command = "power", .help = "Tiempo y consumo estimado por modo", .func = cmd_power },
+    { .command = "boot",  .help = "Linea de tiempo del arranque", .func = cmd_boot },
+    { .command = "ledbench", .help = "Barrido de backends de la tira: ledbench <gpio libre> [frames]", .func = cmd_ledbench },
+    { .command = "ledgroup", .help = "Refresco secuencial frente a grupo: ledgroup <leds> <gpio> <gpio> [gpio] [gpio]", .func = cmd_ledgroup },
+    { .command = "ledcomp", .help = "Compositor de capas: nucleos escalares frente a PIE: ledcomp [renders]", .func = cmd_ledcomp },
+    { .command = "rtt",   .help = "Ida y vuelta MIDI por parche de una pagina: rtt [rondas] [pagina] [sim <ms> [ms]...]", .func = cmd_rtt },
+    { .command = "inrec", .help = "Graba los interruptores y reproduce con reloj virtual: inrec start|stop|dump|load|replay", .func = cmd_inrec },
+    { .command = "macro", .help = "Macros por boton guardadas en NVS: macro list|load|commit|clear", .func = cmd_macro },
+    { .command = "cfg", .help = "Configuracion en directo, guardada en NVS tras unos segundos sin cambios: cfg [show]|get <campo>|set <campo> <valor>|reset", .func = config_cmd_cfg },
+    { .command = "setlist", .help = "Canciones del set list en la configuracion: setlist [show]|clear|add <banco> <parche> [escena]", .func = config_cmd_setlist },
+#if CONFIG_APP_EXPRESSION_ENABLE
+    { .command = "expr",  .help = "Vuelca las medias del ADC del pedal como lineas E: (trazas de test/host): expr [ms]", .func = cmd_expr },
+#endif
+#if CONFIG_APP_TRACE_ENABLE
+    { .command = "trace", .help = "Vuelca ya las trazas pendientes (lineas T:) o las descarta: trace [clear]", .func = cmd_trace },
+#endif
+    { .command = "reset", .help = "Pone a cero los contadores de diagnostico", .func = cmd_reset },
+};
+
+void diag_console_start(void) {
+    esp_console_repl_t *repl = NULL;
+    esp_console_repl_config_t repl_config = ESP_CONSOLE_REPL_CONFIG_DEFAULT();
+    repl_config.prompt = "g6>";
+    // Por debajo de todo salvo la idle: la consola nunca roba tiempo al escaneo ni al USB
+    repl_config.task_priority = 1;
+    repl_config.task_core_id = 0;
+
+    esp_console_dev_uart_config_t uart_config = ESP_CONSOLE_DEV_UART_CONFIG_DEFAULT();
+    esp_err_t err = esp_console_new_repl_uart(&uart_config, &repl_config, &repl);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "No se pudo crear la consola: %s", esp_err_to_name(err));
+        return;
+    }
+
+    esp_console_register_help_command();
+    for (size_t i = 0; i < sizeof(commands) / sizeof(commands[0]); i++) {
+        ESP_ERROR_CHECK(esp_console_cmd_register(&commands[i]));
+    }
+
+    last_sample_us = esp_timer_get_time();
+    ESP_ERROR_CHECK(esp_console_start_repl(repl));
+    ESP_LOGI(TAG, "Consola de diagnostico lista (escribe 'help')");
+}
@@ -0,0 +1,19 @@
+#ifndef DIAG_H
+#define DIAG_H
+
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#define DIAG_MAX_TASKS 10
+
+#if CONFIG_APP_CONSOLE_ENABLE
+// Añade una tarea a la tabla de CPU y pila de la consola (las idle van siempre)
+void diag_watch_task(TaskHandle_t task, uint32_t stack_size);
+// Arranca el REPL por UART; los comandos solo copian contadores, nunca bloquean a las tareas vigiladas
+void diag_console_start(void);
+#else
+static inline void diag_watch_task(TaskHandle_t task, uint32_t stack_size) { (void)task; (void)stack_size; }
+#endif
+
+#endif
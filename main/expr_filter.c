@@ -0,0 +1,50 @@
+#include "expr_filter.h"
+
+#define STEPS_PER_CC 16
+#define FULL_SCALE   (128 * STEPS_PER_CC - 1)
+
+void expr_filter_init(expr_filter_t *f, uint16_t raw_min, uint16_t raw_max, uint8_t hysteresis) {
+    f->raw_min = raw_min;
+    f->raw_max = raw_max > raw_min ? raw_max : raw_min + 1;
+    f->hysteresis = hysteresis;
+    f->value = -1;
+}
+
+uint16_t expr_filter_average(const uint16_t *samples, int count) {
+    if (count <= 0) return 0;
+    uint32_t sum = 0;
+    for (int i = 0; i < count; i++) sum += samples[i];
+    return (uint16_t)((sum + count / 2) / count);
+}
+
+int expr_filter_update(expr_filter_t *f, uint16_t raw) {
+    // Posición en 1/16 de paso de CC para poder aplicar una histéresis fina
+    int32_t span = f->raw_max - f->raw_min;
+    int32_t pos = raw <= f->raw_min ? 0 : ((int32_t)(raw - f->raw_min) * FULL_SCALE + span / 2) / span;
+    if (pos > FULL_SCALE) pos = FULL_SCALE;
+
+    int value = pos / STEPS_PER_CC;
+    if (f->value >= 0) {
+        // Solo cambiamos si la posición sale de la franja del valor actual más el margen
+        int32_t low = f->value * STEPS_PER_CC - f->hysteresis;
+        int32_t high = f->value * STEPS_PER_CC + (STEPS_PER_CC - 1) + f->hysteresis;
+        if (pos >= low && pos <= high) return -1;
+    }
+    if (value == f->value) return -1;
+    f->value = (int16_t)value;
+    return value;
+}
+
+void expr_rate_limit_init(expr_rate_limit_t *r, uint32_t max_per_second) {
+    r->min_interval_us = max_per_second ? 1000000LL / max_per_second : 0;
+    r->last_sent_us = INT64_MIN / 2;
+}
+
+int64_t expr_rate_limit_wait(const expr_rate_limit_t *r, int64_t now_us) {
+    int64_t left = r->last_sent_us + r->min_interval_us - now_us;
+    return left > 0 ? left : 0;
+}
+
+void expr_rate_limit_mark(expr_rate_limit_t *r, int64_t now_us) {
+    r->last_sent_us = now_us;
+}
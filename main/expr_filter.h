@@ -0,0 +1,38 @@
+#ifndef EXPR_FILTER_H
+#define EXPR_FILTER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Lógica pura del pedal de expresión: no depende de ESP-IDF para poder
+// ejercitarla con trazas de muestras grabadas en un PC.
+
+// Histéresis con la que trabaja el firmware, en 1/16 de paso de CC
+#define EXPR_FILTER_HYSTERESIS 6
+
+typedef struct {
+    uint16_t raw_min;       // Lectura con el pedal arriba del todo
+    uint16_t raw_max;       // Lectura con el pedal a fondo
+    uint8_t hysteresis;     // Margen extra, en 1/16 de paso de CC, para cambiar de valor
+    int16_t value;          // Último valor CC emitido (-1 = ninguno)
+} expr_filter_t;
+
+typedef struct {
+    int64_t min_interval_us;
+    int64_t last_sent_us;
+} expr_rate_limit_t;
+
+void expr_filter_init(expr_filter_t *f, uint16_t raw_min, uint16_t raw_max, uint8_t hysteresis);
+
+// Promedia un bloque de muestras (sobremuestreo)
+uint16_t expr_filter_average(const uint16_t *samples, int count);
+
+// Devuelve el nuevo valor 0-127 o -1 si no hay cambio suficiente
+int expr_filter_update(expr_filter_t *f, uint16_t raw);
+
+void expr_rate_limit_init(expr_rate_limit_t *r, uint32_t max_per_second);
+// Microsegundos que faltan para poder enviar (0 = ya se puede)
+int64_t expr_rate_limit_wait(const expr_rate_limit_t *r, int64_t now_us);
+void expr_rate_limit_mark(expr_rate_limit_t *r, int64_t now_us);
+
+#endif
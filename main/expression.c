@@ -0,0 +1,167 @@
+#include <stdio.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_timer.h"
+#include "esp_adc/adc_continuous.h"
+#include "class_driver.h"
+#include "app_config.h"
+#include "expr_filter.h"
+#include "expression.h"
+
+static const char *TAG = "EXPRESSION";
+
+#define EXPR_SAMPLE_HZ    20000
+#define EXPR_FRAME_BYTES  256   // 64 muestras por bloque: ~3.2 ms a 20 kHz
+
+// ADC1 en el ESP32-S3 son los GPIO 1-10; Kconfig ya deja fuera los de los interruptores
+// (6-13), pero los del 74HC165 se eligen libremente
+#if CONFIG_APP_INPUT_SHIFT_REG
+_Static_assert(CONFIG_APP_EXPRESSION_GPIO != CONFIG_APP_SR_CLK_GPIO &&
+               CONFIG_APP_EXPRESSION_GPIO != CONFIG_APP_SR_DATA_GPIO &&
+               CONFIG_APP_EXPRESSION_GPIO != CONFIG_APP_SR_LOAD_GPIO,
+               "El pedal de expresion comparte GPIO con el 74HC165");
+#endif
+
+static adc_continuous_handle_t adc_hdl = NULL;
+static TaskHandle_t expr_task_hdl = NULL;
+
+// Buzón de un solo valor: lo nuevo pisa lo que aún no se ha enviado
+static portMUX_TYPE mailbox_lock = portMUX_INITIALIZER_UNLOCKED;
+static int16_t pending_value = -1;
+static int64_t pending_sample_us = 0;
+static expr_rate_limit_t rate;
+
+static expression_stats_t stats = {0};
+// Captura de medias crudas pedida desde la consola (0 = ninguna)
+static volatile int64_t capture_until_us = 0;
+static int64_t capture_start_us = 0;
+
+static bool IRAM_ATTR conv_done_cb(adc_continuous_handle_t handle, const adc_continuous_evt_data_t *edata, void *user_data) {
+    BaseType_t must_yield = pdFALSE;
+    vTaskNotifyGiveFromISR(expr_task_hdl, &must_yield);
+    return must_yield == pdTRUE;
+}
+
+static esp_err_t adc_setup(adc_channel_t *channel) {
+    adc_unit_t unit;
+    ESP_RETURN_ON_ERROR(adc_continuous_io_to_channel(CONFIG_APP_EXPRESSION_GPIO, &unit, channel), TAG, "GPIO sin ADC");
+    if (unit != ADC_UNIT_1) return ESP_ERR_NOT_SUPPORTED;
+
+    adc_continuous_handle_cfg_t handle_cfg = { .max_store_buf_size = EXPR_FRAME_BYTES * 4, .conv_frame_size = EXPR_FRAME_BYTES };
+    ESP_RETURN_ON_ERROR(adc_continuous_new_handle(&handle_cfg, &adc_hdl), TAG, "handle ADC");
+
+    adc_digi_pattern_config_t pattern = {
+        .atten = ADC_ATTEN_DB_12,
+        .channel = *channel,
+        .unit = ADC_UNIT_1,
+        .bit_width = SOC_ADC_DIGI_MAX_BITWIDTH,
+    };
+    adc_continuous_config_t cfg = {
+        .pattern_num = 1,
+        .adc_pattern = &pattern,
+        .sample_freq_hz = EXPR_SAMPLE_HZ,
+        .conv_mode = ADC_CONV_SINGLE_UNIT_1,
+        .format = ADC_DIGI_OUTPUT_FORMAT_TYPE2,
+    };
+    ESP_RETURN_ON_ERROR(adc_continuous_config(adc_hdl, &cfg), TAG, "config ADC");
+
+    adc_continuous_evt_cbs_t cbs = { .on_conv_done = conv_done_cb };
+    ESP_RETURN_ON_ERROR(adc_continuous_register_event_callbacks(adc_hdl, &cbs, NULL), TAG, "callbacks ADC");
+    return adc_continuous_start(adc_hdl);
+}
+
+static void post_value(int value, int64_t sample_us) {
+    portENTER_CRITICAL(&mailbox_lock);
+    if (pending_value >= 0) stats.replaced++;
+    pending_value = (int16_t)value;
+    pending_sample_us = sample_us;
+    portEXIT_CRITICAL(&mailbox_lock);
+    class_driver_wake();
+}
+
+bool expression_take(int64_t now_us, uint8_t *value, int64_t *sample_us) {
+    bool taken = false;
+    portENTER_CRITICAL(&mailbox_lock);
+    if (pending_value >= 0 && expr_rate_limit_wait(&rate, now_us) == 0) {
+        *value = (uint8_t)pending_value;
+        *sample_us = pending_sample_us;
+        pending_value = -1;
+        expr_rate_limit_mark(&rate, now_us);
+        taken = true;
+    }
+    portEXIT_CRITICAL(&mailbox_lock);
+    return taken;
+}
+
+int64_t expression_wait_us(int64_t now_us) {
+    portENTER_CRITICAL(&mailbox_lock);
+    int64_t wait = pending_value >= 0 ? expr_rate_limit_wait(&rate, now_us) : -1;
+    portEXIT_CRITICAL(&mailbox_lock);
+    return wait;
+}
+
+void expression_record_tx(int64_t done_us, int64_t sample_us, uint32_t count) {
+    stats.sent += count;
+    stats.last_latency_us = done_us - sample_us;
+    if (stats.last_latency_us > stats.max_latency_us) stats.max_latency_us = stats.last_latency_us;
+}
+
+void expression_get_stats(expression_stats_t *out) {
+    *out = stats;
+}
+
+void expression_capture(uint32_t ms) {
+    capture_start_us = esp_timer_get_time();
+    capture_until_us = capture_start_us + ms * 1000LL;
+}
+
+void expression_task(void *arg) {
+    expr_task_hdl = xTaskGetCurrentTaskHandle();
+    expr_rate_limit_init(&rate, CONFIG_APP_EXPRESSION_MAX_RATE);
+
+    expr_filter_t filter;
+    expr_filter_init(&filter, 0, 4095, EXPR_FILTER_HYSTERESIS);
+
+    // El pin de la tira se guarda en NVS: puede acabar en el mismo GPIO que el pedal
+    adc_channel_t channel;
+    static app_config_t cfg;
+    app_config_copy(&cfg);
+    if (cfg.led_gpio == CONFIG_APP_EXPRESSION_GPIO) {
+        ESP_LOGE(TAG, "El GPIO %d es a la vez la tira de LEDs y el pedal de expresion", CONFIG_APP_EXPRESSION_GPIO);
+        vTaskDelete(NULL);
+        return;
+    }
+    if (adc_setup(&channel) != ESP_OK) {
+        ESP_LOGE(TAG, "No se pudo iniciar el ADC del pedal de expresion");
+        vTaskDelete(NULL);
+        return;
+    }
+
+    static uint8_t frame[EXPR_FRAME_BYTES];
+    static uint16_t samples[EXPR_FRAME_BYTES / SOC_ADC_DIGI_RESULT_BYTES];
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        int64_t sample_us = esp_timer_get_time();
+
+        uint32_t len = 0;
+        while (adc_continuous_read(adc_hdl, frame, sizeof(frame), &len, 0) == ESP_OK) {
+            int count = 0;
+            for (uint32_t i = 0; i + SOC_ADC_DIGI_RESULT_BYTES <= len; i += SOC_ADC_DIGI_RESULT_BYTES) {
+                const adc_digi_output_data_t *p = (const adc_digi_output_data_t *)&frame[i];
+                if (p->type2.channel == channel) samples[count++] = p->type2.data;
+            }
+
+            if (count == 0) continue;
+            uint16_t raw = expr_filter_average(samples, count);
+            if (sample_us < capture_until_us) {
+                // Solo en diagnóstico: la escritura por la UART retrasa esta tarea
+                printf("E:%lld %u\n", (long long)(sample_us - capture_start_us), raw);
+            }
+            int value = expr_filter_update(&filter, raw);
+            if (value >= 0) post_value(value, sample_us);
+        }
+    }
+}
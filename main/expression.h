@@ -0,0 +1,28 @@
+#ifndef EXPRESSION_H
+#define EXPRESSION_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct {
+    uint32_t sent;              // Valores que llegaron a la pedalera (transferencia completada)
+    uint32_t replaced;          // Valores sustituidos por otro más nuevo antes de salir
+    int64_t last_latency_us;    // Desde el bloque de muestras hasta el fin de la transferencia USB
+    int64_t max_latency_us;
+} expression_stats_t;
+
+void expression_task(void *arg);
+
+// Uso interno del class driver: recoge el último valor si el límite de tasa lo permite
+bool expression_take(int64_t now_us, uint8_t *value, int64_t *sample_us);
+// Microsegundos hasta poder enviar el valor pendiente, o -1 si no hay ninguno
+int64_t expression_wait_us(int64_t now_us);
+// Desde el callback de la transferencia: count valores salieron; sample_us es el del más antiguo
+void expression_record_tx(int64_t done_us, int64_t sample_us, uint32_t count);
+void expression_get_stats(expression_stats_t *out);
+
+// Consola: durante ms milisegundos escribe una línea "E:<t_us> <media>" por bloque de muestras,
+// el formato de las trazas con que test/host prueba expr_filter
+void expression_capture(uint32_t ms);
+
+#endif
@@ -0,0 +1,112 @@
+#include <string.h>
+#include "gesture.h"
+
+#define DEFAULT_LONG_US   600000
+#define DEFAULT_DOUBLE_US 300000
+#define DEFAULT_CHORD_US  60000
+
+static void emit(gesture_engine_t *e, gesture_type_t type, int b, int b2, int64_t now_us) {
+    gesture_t g = { .type = type, .button = (uint8_t)b, .button2 = (uint8_t)b2, .time_us = now_us };
+    e->cb(&g, e->cb_arg);
+}
+
+static void update_deadline(gesture_engine_t *e) {
+    int64_t next = GESTURE_NO_DEADLINE;
+    for (int i = 0; i < e->num_buttons; i++) {
+        if (e->btn[i].deadline_us < next) next = e->btn[i].deadline_us;
+    }
+    e->next_deadline_us = next;
+}
+
+void gesture_init(gesture_engine_t *e, int num_buttons, gesture_cb_t cb, void *arg) {
+    memset(e, 0, sizeof(*e));
+    e->num_buttons = num_buttons > GESTURE_MAX_BUTTONS ? GESTURE_MAX_BUTTONS : num_buttons;
+    e->long_us = DEFAULT_LONG_US;
+    e->double_us = DEFAULT_DOUBLE_US;
+    e->chord_us = DEFAULT_CHORD_US;
+    e->cb = cb;
+    e->cb_arg = arg;
+    for (int i = 0; i < GESTURE_MAX_BUTTONS; i++) e->btn[i].deadline_us = GESTURE_NO_DEADLINE;
+    e->next_deadline_us = GESTURE_NO_DEADLINE;
+}
+
+void gesture_bind(gesture_engine_t *e, int button, uint8_t flags) {
+    if (button >= 0 && button < e->num_buttons) e->btn[button].bind = flags;
+}
+
+static bool try_chord(gesture_engine_t *e, int button, int64_t now_us) {
+    for (int i = 0; i < e->num_buttons; i++) {
+        gesture_btn_t *o = &e->btn[i];
+        if (i == button || !(o->bind & GESTURE_BIND_CHORD) || o->state != BTN_DOWN) continue;
+        if (now_us - o->down_us > e->chord_us) continue;
+
+        o->state = BTN_CONSUMED;
+        o->deadline_us = GESTURE_NO_DEADLINE;
+        e->btn[button].state = BTN_CONSUMED;
+        emit(e, GESTURE_CHORD, i, button, now_us);
+        return true;
+    }
+    return false;
+}
+
+void gesture_edge(gesture_engine_t *e, int button, bool pressed, int64_t now_us) {
+    if (button < 0 || button >= e->num_buttons) return;
+    gesture_btn_t *b = &e->btn[button];
+
+    if (b->bind == 0) {
+        // Sin gestos asociados: el toque sale en el primer flanco, sin esperar a nada
+        if (pressed) emit(e, GESTURE_TAP, button, button, now_us);
+        return;
+    }
+
+    if (pressed) {
+        if (b->state == BTN_WAIT_SECOND) {
+            b->state = BTN_CONSUMED;
+            b->deadline_us = GESTURE_NO_DEADLINE;
+            emit(e, GESTURE_DOUBLE_TAP, button, button, now_us);
+        } else if (b->state == BTN_IDLE) {
+            b->down_us = now_us;
+            if ((b->bind & GESTURE_BIND_CHORD) && try_chord(e, button, now_us)) {
+                b->deadline_us = GESTURE_NO_DEADLINE;
+            } else {
+                if (b->bind & GESTURE_BIND_TAP_FIRST) emit(e, GESTURE_TAP, button, button, now_us);
+                b->state = BTN_DOWN;
+                b->deadline_us = (b->bind & GESTURE_BIND_LONG) ? now_us + e->long_us : GESTURE_NO_DEADLINE;
+            }
+        }
+    } else {
+        if (b->state == BTN_DOWN) {
+            if (b->bind & GESTURE_BIND_DOUBLE) {
+                b->state = BTN_WAIT_SECOND;
+                b->deadline_us = now_us + e->double_us;
+            } else {
+                b->state = BTN_IDLE;
+                b->deadline_us = GESTURE_NO_DEADLINE;
+                if (!(b->bind & GESTURE_BIND_TAP_FIRST)) emit(e, GESTURE_TAP, button, button, b->down_us);
+            }
+        } else if (b->state == BTN_CONSUMED) {
+            b->state = BTN_IDLE;
+        }
+    }
+    update_deadline(e);
+}
+
+void gesture_poll(gesture_engine_t *e, int64_t now_us) {
+    if (now_us < e->next_deadline_us) return;
+
+    for (int i = 0; i < e->num_buttons; i++) {
+        gesture_btn_t *b = &e->btn[i];
+        if (now_us < b->deadline_us) continue;
+
+        b->deadline_us = GESTURE_NO_DEADLINE;
+        if (b->state == BTN_DOWN) {
+            b->state = BTN_CONSUMED;
+            emit(e, GESTURE_LONG_PRESS, i, i, now_us);
+        } else if (b->state == BTN_WAIT_SECOND) {
+            // No llegó el segundo toque: era un toque simple
+            b->state = BTN_IDLE;
+            if (!(b->bind & GESTURE_BIND_TAP_FIRST)) emit(e, GESTURE_TAP, i, i, b->down_us);
+        }
+    }
+    update_deadline(e);
+}
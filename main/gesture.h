@@ -0,0 +1,75 @@
+#ifndef GESTURE_H
+#define GESTURE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Reconocedor de gestos sobre flancos con marca de tiempo. Lógica pura, sin
+// dependencias de ESP-IDF, para poder alimentarla con líneas de tiempo sintéticas.
+
+#define GESTURE_MAX_BUTTONS 32
+
+#define GESTURE_BIND_LONG   (1u << 0)
+#define GESTURE_BIND_DOUBLE (1u << 1)
+#define GESTURE_BIND_CHORD  (1u << 2)
+// El toque sale en el primer flanco, como sin gestos; los asociados llegan después como
+// acción aparte (el toque ya emitido no se retira)
+#define GESTURE_BIND_TAP_FIRST (1u << 3)
+
+#define GESTURE_NO_DEADLINE INT64_MAX
+
+typedef enum {
+    GESTURE_TAP,
+    GESTURE_LONG_PRESS,
+    GESTURE_DOUBLE_TAP,
+    GESTURE_CHORD,
+} gesture_type_t;
+
+typedef struct {
+    gesture_type_t type;
+    uint8_t button;
+    uint8_t button2;    // Solo en GESTURE_CHORD
+    int64_t time_us;
+} gesture_t;
+
+typedef void (*gesture_cb_t)(const gesture_t *g, void *arg);
+
+typedef enum {
+    BTN_IDLE,
+    BTN_DOWN,
+    BTN_WAIT_SECOND,    // Soltado; esperando un posible segundo toque
+    BTN_CONSUMED,       // Ya produjo un gesto; se ignora hasta soltarlo
+} gesture_btn_state_t;
+
+typedef struct {
+    uint8_t state;
+    uint8_t bind;
+    int64_t down_us;
+    int64_t deadline_us;
+} gesture_btn_t;
+
+typedef struct {
+    gesture_btn_t btn[GESTURE_MAX_BUTTONS];
+    int num_buttons;
+    int64_t long_us;
+    int64_t double_us;
+    int64_t chord_us;
+    int64_t next_deadline_us;
+    gesture_cb_t cb;
+    void *cb_arg;
+} gesture_engine_t;
+
+void gesture_init(gesture_engine_t *e, int num_buttons, gesture_cb_t cb, void *arg);
+void gesture_bind(gesture_engine_t *e, int button, uint8_t flags);
+
+// Flanco ya filtrado de rebotes
+void gesture_edge(gesture_engine_t *e, int button, bool pressed, int64_t now_us);
+
+// Vence los temporizadores de cada botón; barato si no hay ninguno vencido
+void gesture_poll(gesture_engine_t *e, int64_t now_us);
+
+static inline int64_t gesture_next_deadline(const gesture_engine_t *e) {
+    return e->next_deadline_us;
+}
+
+#endif
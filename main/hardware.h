@@ -0,0 +1,23 @@
+#ifndef HARDWARE_H
+#define HARDWARE_H
+
+#include <stdint.h>
+
+// Vuelta de la tarea de interruptores y LEDs (usb_host_lib_main.c): escaneo de los GPIO directos
+// y plazo de los gestos. Con SPI o matriz cada cambio la despierta antes (input.h)
+#define HW_SCAN_PERIOD_MS 5
+
+typedef struct {
+    uint32_t led_frames_sent;       // Refrescos enviados a la tira
+    uint32_t led_frames_skipped;    // Huecos de frame sin nada que pintar
+    uint32_t led_timed_frames;      // Frames del bucle de LEDs con coste medido
+    uint64_t led_compose_cycles;    // Ciclos de CPU componiendo esos frames, sin contar el envío
+    uint64_t led_refresh_us;        // Tiempo total dentro del refresh, todos los frames
+} hw_stats_t;
+
+void hardware_control_task(void *arg);
+void hardware_get_stats(hw_stats_t *out);
+// La tarea pone los contadores a cero en su siguiente vuelta
+void hardware_reset_stats(void);
+
+#endif
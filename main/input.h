@@ -0,0 +1,62 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_err.h"
+#include "sdkconfig.h"
+#include "hardware.h"
+
+// Backend de interruptores: GPIO directos, registros de desplazamiento 74HC165
+// por SPI o matriz con diodos, según Kconfig. Todos entregan el estado completo
+// como máscara (bit i = interruptor i pulsado), sin filtrar rebotes.
+
+#define INPUT_MAX_BUTTONS 32
+
+#if CONFIG_APP_INPUT_GPIO
+// GPIO: la tarea hw lee input_read() en cada vuelta y filtra ella los rebotes
+#define INPUT_SCANS_ITSELF 0
+#define INPUT_SCAN_US (HW_SCAN_PERIOD_MS * 1000)
+#else
+// SPI y matriz escanean solos desde un temporizador a CONFIG_APP_INPUT_SCAN_HZ y en el mismo
+// escaneo filtran los rebotes, fechan cada cambio y lo encolan (input_scan.c). La tarea hw
+// despierta con el cambio en vez de muestrear la lectura a su ritmo.
+#define INPUT_SCANS_ITSELF 1
+#define INPUT_SCAN_US (1000000 / CONFIG_APP_INPUT_SCAN_HZ)
+#endif
+
+esp_err_t input_init(void);
+// Lectura cruda: la del momento (GPIO) o la del último escaneo
+uint32_t input_read(void);
+
+#if INPUT_SCANS_ITSELF
+typedef struct {
+    int64_t time_us;    // Escaneo en que se vio el cambio
+    uint32_t raw;       // Lectura cruda de ese escaneo
+    uint32_t stable;    // Estado ya filtrado de rebotes tras ese escaneo
+} input_event_t;
+
+// Para los backends: crea la cola antes de arrancar el temporizador
+esp_err_t input_scan_init(void);
+// Para los backends, desde el callback del escaneo con la lectura cruda
+void input_scan_publish(uint32_t raw);
+
+// Siguiente cambio encolado, sin esperar; false si no hay
+bool input_next_event(input_event_t *out);
+// Espera hasta ticks a que haya un cambio en la cola, sin sacarlo
+bool input_wait_event(TickType_t ticks);
+// Estado filtrado del último escaneo: recupera lo que no cupo en la cola
+uint32_t input_stable(void);
+#endif
+
+// Standby: el primer interruptor pulsado despierta al chip del light sleep y avisa a
+// 'notify'. Solo el backend GPIO lo admite; los demás devuelven ESP_ERR_NOT_SUPPORTED
+// y se siguen sondeando.
+esp_err_t input_arm_wakeup(TaskHandle_t notify);
+void input_disarm_wakeup(void);
+// Instante del flanco que despertó (0 si no ha habido ninguno desde input_arm_wakeup)
+int64_t input_wakeup_time(void);
+
+#endif
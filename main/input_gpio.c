@@ -0,0 +1,73 @@
+#include "driver/gpio.h"
+#include "esp_sleep.h"
+#include "esp_timer.h"
+#include "soc/soc.h"
+#include "soc/gpio_reg.h"
+#include "input.h"
+
+static const gpio_num_t pinesBotones[] = { GPIO_NUM_13, GPIO_NUM_12, GPIO_NUM_11, GPIO_NUM_10, GPIO_NUM_9, GPIO_NUM_8, GPIO_NUM_7, GPIO_NUM_6 };
+
+_Static_assert(CONFIG_APP_NUM_BUTTONS <= sizeof(pinesBotones) / sizeof(pinesBotones[0]), "Faltan pines en pinesBotones");
+
+esp_err_t input_init(void) {
+    for (int i = 0; i < CONFIG_APP_NUM_BUTTONS; i++) {
+        gpio_reset_pin(pinesBotones[i]);
+        gpio_set_direction(pinesBotones[i], GPIO_MODE_INPUT);
+        gpio_set_pull_mode(pinesBotones[i], GPIO_PULLUP_ONLY);
+    }
+    return ESP_OK;
+}
+
+uint32_t input_read(void) {
+    // Una sola lectura del registro de entrada captura todos los pines a la vez
+    uint32_t nivel = REG_READ(GPIO_IN_REG);
+    uint32_t mascara = 0;
+    for (int i = 0; i < CONFIG_APP_NUM_BUTTONS; i++) {
+        if (!(nivel & (1u << pinesBotones[i]))) mascara |= 1u << i;
+    }
+    return mascara;
+}
+
+static TaskHandle_t wake_task = NULL;
+static volatile int64_t wake_us = 0;
+static bool isr_installed = false;
+
+static void wake_isr(void *arg) {
+    // La interrupción es por nivel: se apaga en el primer aviso para no repetirse mientras se pisa
+    for (int i = 0; i < CONFIG_APP_NUM_BUTTONS; i++) gpio_intr_disable(pinesBotones[i]);
+    if (wake_us == 0) wake_us = esp_timer_get_time();
+
+    BaseType_t woken = pdFALSE;
+    if (wake_task) vTaskNotifyGiveFromISR(wake_task, &woken);
+    if (woken) portYIELD_FROM_ISR();
+}
+
+esp_err_t input_arm_wakeup(TaskHandle_t notify) {
+    if (!isr_installed) {
+        esp_err_t err = gpio_install_isr_service(0);
+        if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) return err;
+        for (int i = 0; i < CONFIG_APP_NUM_BUTTONS; i++) gpio_isr_handler_add(pinesBotones[i], wake_isr, NULL);
+        esp_sleep_enable_gpio_wakeup();
+        isr_installed = true;
+    }
+
+    wake_task = notify;
+    wake_us = 0;
+    // Interruptores con pull-up: pulsado = nivel bajo, que es también lo que despierta del light sleep
+    for (int i = 0; i < CONFIG_APP_NUM_BUTTONS; i++) {
+        gpio_wakeup_enable(pinesBotones[i], GPIO_INTR_LOW_LEVEL);
+        gpio_intr_enable(pinesBotones[i]);
+    }
+    return ESP_OK;
+}
+
+void input_disarm_wakeup(void) {
+    for (int i = 0; i < CONFIG_APP_NUM_BUTTONS; i++) {
+        gpio_intr_disable(pinesBotones[i]);
+        gpio_wakeup_disable(pinesBotones[i]);
+    }
+}
+
+int64_t input_wakeup_time(void) {
+    return wake_us;
+}
@@ -0,0 +1,71 @@
+#include "sdkconfig.h"
+#include "input_map.h"
+
+#define TAP_TEMPO (CONFIG_APP_MIDI_CLOCK_ENABLE && CONFIG_APP_TAP_TEMPO_BUTTON >= 0)
+
+// Gesto de los interruptores de página. Su toque sigue cambiando de parche al pisar
+#if CONFIG_APP_PAGE_GESTURE_DOUBLE
+#define PAGE_BIND GESTURE_BIND_DOUBLE
+#elif CONFIG_APP_PAGE_GESTURE_CHORD
+#define PAGE_BIND GESTURE_BIND_CHORD
+#else
+#define PAGE_BIND GESTURE_BIND_LONG
+#endif
+
+void input_map_bind(gesture_engine_t *e, int num_pages) {
+#if TAP_TEMPO
+    gesture_bind(e, CONFIG_APP_TAP_TEMPO_BUTTON, GESTURE_BIND_LONG);
+#endif
+    if (num_pages > 1) {
+        gesture_bind(e, CONFIG_APP_PAGE_DOWN_BUTTON, PAGE_BIND | GESTURE_BIND_TAP_FIRST);
+        gesture_bind(e, CONFIG_APP_PAGE_UP_BUTTON, PAGE_BIND | GESTURE_BIND_TAP_FIRST);
+    }
+}
+
+static input_action_t page_action(int button, int num_pages) {
+    if (num_pages <= 1) return INPUT_ACT_NONE;
+    if (button == CONFIG_APP_PAGE_DOWN_BUTTON) return INPUT_ACT_PAGE_DOWN;
+    if (button == CONFIG_APP_PAGE_UP_BUTTON) return INPUT_ACT_PAGE_UP;
+    return INPUT_ACT_NONE;
+}
+
+input_action_t input_map_gesture(const gesture_t *g, int num_pages) {
+    switch (g->type) {
+    case GESTURE_TAP:
+#if TAP_TEMPO
+        // El interruptor de tap no cambia de parche ni toca los LEDs
+        if (g->button == CONFIG_APP_TAP_TEMPO_BUTTON) return INPUT_ACT_TAP_TEMPO;
+#endif
+#if CONFIG_APP_SETLIST_ENABLE
+        // Los pasos del set list se iluminan igual que una pulsación directa
+        if (g->button == CONFIG_APP_SETLIST_NEXT_BUTTON) return INPUT_ACT_SETLIST_NEXT;
+        if (g->button == CONFIG_APP_SETLIST_PREV_BUTTON) return INPUT_ACT_SETLIST_PREV;
+#endif
+        return INPUT_ACT_PATCH;
+    case GESTURE_LONG_PRESS:
+#if TAP_TEMPO
+        // Mantener pulsado el tap arranca o para el reloj
+        if (g->button == CONFIG_APP_TAP_TEMPO_BUTTON) return INPUT_ACT_CLOCK_TOGGLE;
+#endif
+#if !CONFIG_APP_PAGE_GESTURE_DOUBLE && !CONFIG_APP_PAGE_GESTURE_CHORD
+        // Mantener pulsados los extremos recorre las páginas del mapa
+        return page_action(g->button, num_pages);
+#else
+        return INPUT_ACT_NONE;
+#endif
+#if CONFIG_APP_PAGE_GESTURE_DOUBLE
+    case GESTURE_DOUBLE_TAP:
+        return page_action(g->button, num_pages);
+#endif
+#if CONFIG_APP_PAGE_GESTURE_CHORD
+    case GESTURE_CHORD:
+        // Los dos a la vez: la página siguiente, que da la vuelta al llegar a la última
+        if (page_action(g->button, num_pages) != INPUT_ACT_NONE && page_action(g->button2, num_pages) != INPUT_ACT_NONE) {
+            return INPUT_ACT_PAGE_UP;
+        }
+        return INPUT_ACT_NONE;
+#endif
+    default:
+        return INPUT_ACT_NONE;
+    }
+}
@@ -0,0 +1,24 @@
+#ifndef INPUT_MAP_H
+#define INPUT_MAP_H
+
+#include "gesture.h"
+
+// Qué hace cada gesto según Kconfig y el número de páginas del mapa. Lógica pura, sin
+// dependencias de ESP-IDF: la comparten la tarea hw y la reproducción de grabaciones.
+
+typedef enum {
+    INPUT_ACT_NONE,             // Solo se anota en el log
+    INPUT_ACT_PATCH,            // Parche del botón en la página actual
+    INPUT_ACT_SETLIST_NEXT,
+    INPUT_ACT_SETLIST_PREV,
+    INPUT_ACT_TAP_TEMPO,
+    INPUT_ACT_CLOCK_TOGGLE,
+    INPUT_ACT_PAGE_DOWN,
+    INPUT_ACT_PAGE_UP,
+} input_action_t;
+
+// Asocia pulsación larga a los interruptores que la usan
+void input_map_bind(gesture_engine_t *e, int num_pages);
+input_action_t input_map_gesture(const gesture_t *g, int num_pages);
+
+#endif
@@ -0,0 +1,68 @@
+#include "driver/gpio.h"
+#include "esp_check.h"
+#include "esp_timer.h"
+#include "esp_rom_sys.h"
+#include "soc/soc.h"
+#include "soc/gpio_reg.h"
+#include "input.h"
+
+static const char *TAG = "INPUT_MATRIX";
+
+// Matriz con diodos: filas como salidas (activas a nivel bajo), columnas con pull-up
+static const gpio_num_t filas[] = { GPIO_NUM_13, GPIO_NUM_12, GPIO_NUM_11, GPIO_NUM_10 };
+static const gpio_num_t columnas[] = { GPIO_NUM_9, GPIO_NUM_8, GPIO_NUM_7, GPIO_NUM_6 };
+
+#define NUM_FILAS    ((int)(sizeof(filas) / sizeof(filas[0])))
+#define NUM_COLUMNAS ((int)(sizeof(columnas) / sizeof(columnas[0])))
+
+_Static_assert(CONFIG_APP_NUM_BUTTONS <= NUM_FILAS * NUM_COLUMNAS, "La matriz no tiene tantos cruces");
+
+static esp_timer_handle_t scan_timer;
+static uint32_t mascara_columnas = 0;
+
+static void scan_cb(void *arg) {
+    uint32_t estado = 0;
+    for (int f = 0; f < NUM_FILAS; f++) {
+        gpio_set_level(filas[f], 0);
+        esp_rom_delay_us(1);
+        // Una lectura del registro captura la fila entera
+        uint32_t nivel = ~REG_READ(GPIO_IN_REG) & mascara_columnas;
+        gpio_set_level(filas[f], 1);
+
+        for (int c = 0; c < NUM_COLUMNAS; c++) {
+            if (nivel & (1u << columnas[c])) estado |= 1u << (f * NUM_COLUMNAS + c);
+        }
+    }
+    input_scan_publish(estado & (CONFIG_APP_NUM_BUTTONS == 32 ? UINT32_MAX : ((1u << CONFIG_APP_NUM_BUTTONS) - 1)));
+}
+
+esp_err_t input_init(void) {
+    for (int f = 0; f < NUM_FILAS; f++) {
+        gpio_reset_pin(filas[f]);
+        gpio_set_direction(filas[f], GPIO_MODE_OUTPUT);
+        gpio_set_level(filas[f], 1);
+    }
+    for (int c = 0; c < NUM_COLUMNAS; c++) {
+        gpio_reset_pin(columnas[c]);
+        gpio_set_direction(columnas[c], GPIO_MODE_INPUT);
+        gpio_set_pull_mode(columnas[c], GPIO_PULLUP_ONLY);
+        mascara_columnas |= 1u << columnas[c];
+    }
+
+    ESP_RETURN_ON_ERROR(input_scan_init(), TAG, "cola de cambios");
+    const esp_timer_create_args_t args = { .callback = scan_cb, .name = "input_scan" };
+    ESP_RETURN_ON_ERROR(esp_timer_create(&args, &scan_timer), TAG, "timer");
+    return esp_timer_start_periodic(scan_timer, 1000000 / CONFIG_APP_INPUT_SCAN_HZ);
+}
+
+// El escaneo periódico mantiene despierto al chip: no hay despertar por GPIO
+esp_err_t input_arm_wakeup(TaskHandle_t notify) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+void input_disarm_wakeup(void) {
+}
+
+int64_t input_wakeup_time(void) {
+    return 0;
+}
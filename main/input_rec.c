@@ -0,0 +1,249 @@
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_log.h"
+#include "esp_cpu.h"
+#include "esp_timer.h"
+#include "esp_rom_crc.h"
+#include "class_driver.h"
+#include "patch_map.h"
+#include "app_config.h"
+#include "latency.h"
+#include "led_feedback.h"
+#include "press.h"
+#include "input_rec.h"
+
+static const char *TAG = "INPUT_REC";
+
+// Cada tantos escaneos se cede la CPU para que la idle atienda al watchdog
+#define REPLAY_YIELD_SCANS 8192
+// Lo que se espera a que la tarea MIDI vacíe la cola antes de cada pulsación
+#define REPLAY_QUEUE_WAIT_MS 1000
+
+// Cabecera y registros. Escribe la tarea hw mientras se graba; la consola solo lee o carga parada
+static uint8_t buf[INPUT_REC_BYTES] __attribute__((aligned(4)));
+static size_t len;
+static volatile bool start_pending;
+static volatile bool recording;
+static bool full;
+static uint32_t pending_scan_us;
+static uint32_t last_raw;
+static int64_t last_us;
+static portMUX_TYPE rec_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static input_rec_header_t *header(void) {
+    return (input_rec_header_t *)buf;
+}
+
+static size_t put_varint(uint8_t *out, uint64_t v) {
+    size_t n = 0;
+    do {
+        uint8_t b = v & 0x7F;
+        v >>= 7;
+        out[n++] = b | (v ? 0x80 : 0);
+    } while (v);
+    return n;
+}
+
+void input_rec_scan(int64_t now_us, uint32_t raw) {
+    if (start_pending) {
+        // La primera lectura fija el estado inicial: la consola no puede leer los interruptores
+        portENTER_CRITICAL(&rec_lock);
+        *header() = (input_rec_header_t){
+            .magic = INPUT_REC_MAGIC,
+            .version = INPUT_REC_VERSION,
+            .num_buttons = CONFIG_APP_NUM_BUTTONS,
+            .scan_us = pending_scan_us,
+            .initial = raw,
+        };
+        len = sizeof(input_rec_header_t);
+        last_raw = raw;
+        last_us = now_us;
+        full = false;
+        start_pending = false;
+        recording = true;
+        portEXIT_CRITICAL(&rec_lock);
+        return;
+    }
+    if (!recording || raw == last_raw) return;
+
+    uint8_t rec[20];
+    size_t n = put_varint(rec, (uint64_t)(now_us - last_us));
+    n += put_varint(rec + n, raw ^ last_raw);
+    portENTER_CRITICAL(&rec_lock);
+    if (recording) {
+        if (len + n > sizeof(buf)) {
+            recording = false;
+            full = true;
+        } else {
+            memcpy(buf + len, rec, n);
+            len += n;
+            header()->num_edges++;
+            last_raw = raw;
+            last_us = now_us;
+        }
+    }
+    portEXIT_CRITICAL(&rec_lock);
+}
+
+void input_rec_start(uint32_t scan_us) {
+    portENTER_CRITICAL(&rec_lock);
+    recording = false;
+    pending_scan_us = scan_us;
+    start_pending = true;
+    portEXIT_CRITICAL(&rec_lock);
+}
+
+void input_rec_stop(void) {
+    portENTER_CRITICAL(&rec_lock);
+    start_pending = false;
+    recording = false;
+    portEXIT_CRITICAL(&rec_lock);
+    if (full) ESP_LOGW(TAG, "Grabacion llena: se paro sola en %u bytes", (unsigned)len);
+}
+
+bool input_rec_recording(void) {
+    return recording || start_pending;
+}
+
+// Líneas "I:" + hasta 32 bytes en hexadecimal, como las "T:" de las trazas
+void input_rec_dump(void) {
+    char line[2 + 64 + 1] = "I:";
+    for (size_t off = 0; off < len; off += 32) {
+        size_t n = len - off < 32 ? len - off : 32;
+        for (size_t i = 0; i < n; i++) sprintf(&line[2 + 2 * i], "%02x", buf[off + i]);
+        puts(line);
+    }
+    printf("%u bytes, %lu flancos\n", (unsigned)len, (unsigned long)(len ? header()->num_edges : 0));
+}
+
+bool input_rec_load(size_t offset, const uint8_t *data, size_t n) {
+    if (input_rec_recording()) return false;
+    if (offset == 0) len = 0;
+    if (offset != len || len + n > sizeof(buf)) return false;
+    memcpy(buf + len, data, n);
+    len += n;
+    return true;
+}
+
+typedef struct {
+    uint32_t crc;
+    int64_t base_us;            // esp_timer al empezar: las pulsaciones llevan base_us + reloj virtual
+} replay_ctx_t;
+
+static void replay_line(input_replay_t *r, const char *line, size_t n) {
+    replay_ctx_t *c = r->arg;
+    c->crc = esp_rom_crc32_le(c->crc, (const uint8_t *)line, n);
+    printf("O:%s\n", line);
+}
+
+// Lo mismo que pulsar_boton: indicador pendiente y mensaje a la tarea MIDI. Con la cola vacía
+// antes de cada pulsación la salida no depende de lo rápido que corra la reproducción
+static void replay_press(input_replay_t *r, int button, input_action_t action) {
+    replay_ctx_t *c = r->arg;
+    for (int i = 0; i < REPLAY_QUEUE_WAIT_MS && uxQueueMessagesWaiting(midi_msg_queue); i++) {
+        vTaskDelay(pdMS_TO_TICKS(1));
+    }
+    int led = button < r->num_leds ? button : -1;
+    bool ok = press_post(button, led, press_msg_type(action), r->page, c->base_us + r->now_us);
+    if (button < r->num_leds) {
+        input_replay_out(r, "led %d %s", button, ok ? "pendiente" : "fallo");
+        r->led_changes++;
+    } else if (!ok) {
+        input_replay_out(r, "cola llena");
+    }
+}
+
+static const input_replay_hooks_t timing_hooks = { 0 };
+static const input_replay_hooks_t output_hooks = { .press = replay_press, .line = replay_line };
+
+static bool post_control(uint8_t type, uint8_t data1) {
+    const midi_msg_t m = { .status = type, .data1 = data1, .time_us = esp_timer_get_time() };
+    for (int i = 0; i < REPLAY_QUEUE_WAIT_MS / 10; i++) {
+        if (class_driver_post(&m)) return true;
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    return false;
+}
+
+static const char *replay_error(input_replay_err_t err) {
+    switch (err) {
+    case INPUT_REPLAY_NO_RECORDING: return "no hay grabacion valida";
+    case INPUT_REPLAY_BAD_SCAN: return "periodo de escaneo 0: indica uno con 'inrec replay <ms>'";
+    case INPUT_REPLAY_CORRUPT: return "grabacion corrupta";
+    default: return "";
+    }
+}
+
+void input_rec_replay(uint32_t scan_us, uint32_t expect_crc) {
+    const input_rec_header_t *h = header();
+    if (input_rec_recording()) {
+        printf("grabando: para antes con 'inrec stop'\n");
+        return;
+    }
+    if (scan_us == 0 && len >= sizeof(*h)) scan_us = h->scan_us;
+    static input_replay_t r;
+    int num_pages = patch_map_num_pages();
+    static app_config_t cfg;
+    app_config_copy(&cfg);
+    int num_leds = cfg.num_leds;
+    replay_ctx_t ctx = { 0 };
+    input_replay_err_t err = input_replay_open(&r, buf, len, scan_us, num_pages, num_leds, &timing_hooks, &ctx);
+    if (err != INPUT_REPLAY_OK) {
+        printf("%s\n", replay_error(err));
+        return;
+    }
+    if (h->num_buttons != CONFIG_APP_NUM_BUTTONS) {
+        printf("aviso: grabada con %d interruptores, este firmware tiene %d\n", h->num_buttons, CONFIG_APP_NUM_BUTTONS);
+    }
+
+    // Primera pasada sin ganchos para medir solo el coste del núcleo
+    uint64_t cycles = 0;
+    uint32_t c0 = esp_cpu_get_cycle_count();
+    while (input_replay_step(&r)) {
+        if (r.scans % REPLAY_YIELD_SCANS == 0) {
+            cycles += esp_cpu_get_cycle_count() - c0;
+            vTaskDelay(1);
+            c0 = esp_cpu_get_cycle_count();
+        }
+    }
+    cycles += esp_cpu_get_cycle_count() - c0;
+
+    // La segunda pasa por el camino de pulsación con la pedalera simulada: nada llega al bus y
+    // al terminar la tarea MIDI repone el parche y el set list
+    if (!post_control(MIDI_MSG_PROBE_BEGIN, 1)) {
+        printf("la tarea MIDI no atiende la cola\n");
+        return;
+    }
+    ctx.base_us = esp_timer_get_time();
+    input_replay_open(&r, buf, len, scan_us, num_pages, num_leds, &output_hooks, &ctx);
+    while (input_replay_step(&r)) {
+        if (r.scans % REPLAY_YIELD_SCANS == 0) vTaskDelay(1);
+    }
+    if (!post_control(MIDI_MSG_PROBE_END, 0)) printf("aviso: la tarea MIDI no recibio el fin de la reproduccion\n");
+    // El indicador se quedaría con la última pulsación reproducida
+    led_feedback_clear();
+
+    int64_t virtual_us = (int64_t)r.scans * scan_us;
+    printf("escaneos %lu cada %lu us (%lld ms virtuales), %lu ciclos/escaneo\n", (unsigned long)r.scans,
+           (unsigned long)scan_us, (long long)(virtual_us / 1000), (unsigned long)(r.scans ? cycles / r.scans : 0));
+    if (cycles) {
+        printf("%lld veces mas rapido que el tiempo real\n",
+               (long long)(virtual_us * CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ / cycles));
+    }
+    printf("flancos crudos %lu  pulsaciones crudas %lu  tras antirrebote %lu  gestos %lu\n",
+           (unsigned long)r.raw_edges, (unsigned long)r.raw_presses, (unsigned long)r.presses,
+           (unsigned long)r.gestures_seen);
+    printf("mensajes %lu  cambios de LED %lu\n", (unsigned long)r.press_actions, (unsigned long)r.led_changes);
+    printf("latencia flanco crudo -> pulsacion: n=%lu media=%ld max=%ld us\n", (unsigned long)r.latency.count,
+           (long)latency_avg_us(&r.latency), (long)r.latency.max_us);
+    if (r.raw_presses != r.presses) {
+        printf("aviso: %ld pulsaciones crudas sin su pulsacion filtrada (o al reves)\n",
+               (long)r.raw_presses - (long)r.presses);
+    }
+    printf("crc salida %08lx", (unsigned long)ctx.crc);
+    if (expect_crc) printf(" %s", ctx.crc == expect_crc ? "(coincide con la referencia)" : "(DISTINTA de la referencia)");
+    printf("\n");
+}
@@ -0,0 +1,39 @@
+#ifndef INPUT_REC_H
+#define INPUT_REC_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "sdkconfig.h"
+#include "input_replay.h"
+
+// Grabación del estado crudo de los interruptores, rebotes incluidos, en el formato de
+// input_replay.h, y reproducción con reloj virtual a través de input_replay.c y del camino de
+// pulsación de verdad (press.c) contra la pedalera simulada de la tarea MIDI. tools/input_rec.py
+// guarda la grabación en fichero, la vuelve a cargar y compara la salida con una referencia;
+// test/host/test_input_replay.c reproduce grabaciones guardadas contra sus referencias en el PC.
+#define INPUT_REC_BYTES   4096
+
+#if CONFIG_APP_CONSOLE_ENABLE
+// Tarea hw, una vez por escaneo: casi gratis mientras no se graba
+void input_rec_scan(int64_t now_us, uint32_t raw);
+#else
+static inline void input_rec_scan(int64_t now_us, uint32_t raw) {}
+#endif
+
+// Consola
+void input_rec_start(uint32_t scan_us);
+void input_rec_stop(void);
+bool input_rec_recording(void);
+// Líneas "I:" con la grabación en hexadecimal
+void input_rec_dump(void);
+// Escribe len bytes en offset; offset 0 descarta la grabación anterior. Solo se puede
+// escribir a continuación de lo ya cargado
+bool input_rec_load(size_t offset, const uint8_t *data, size_t len);
+// Reproduce con un escaneo cada scan_us (0 = el de la grabación). Nada sale al bus: la tarea
+// MIDI atiende la reproducción con la pedalera simulada de `rtt sim` y después repone el parche
+// y el set list. Emite una línea "O:" por gesto, página y cambio de LED y un resumen con
+// latencias, rendimiento y el CRC de la salida; si expect_crc != 0 indica si coincide
+void input_rec_replay(uint32_t scan_us, uint32_t expect_crc);
+
+#endif
@@ -0,0 +1,158 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include "input_replay.h"
+
+// Tras el último flanco se sigue escaneando lo que tardan en vencer los gestos pendientes
+#define REPLAY_TAIL_US 1000000
+// Una subida cruda separada de la bajada anterior por menos de esto es rebote de la misma pulsación
+#define QUIET_US 20000
+
+static bool get_varint(const uint8_t **p, const uint8_t *end, uint64_t *v) {
+    *v = 0;
+    for (int shift = 0; *p < end && shift < 64; shift += 7) {
+        uint8_t b = *(*p)++;
+        *v |= (uint64_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) return true;
+    }
+    return false;
+}
+
+// Ya validado en input_replay_open()
+static void next_edge(input_replay_t *r) {
+    uint64_t dt, mask;
+    get_varint(&r->next, r->end, &dt);
+    get_varint(&r->next, r->end, &mask);
+    r->edge_us += (int64_t)dt;
+    r->edge_mask = (uint32_t)mask;
+}
+
+void input_replay_out(input_replay_t *r, const char *fmt, ...) {
+    char line[64];
+    int n = snprintf(line, sizeof(line), "%lld ", (long long)r->now_us);
+    va_list ap;
+    va_start(ap, fmt);
+    n += vsnprintf(line + n, sizeof(line) - n, fmt, ap);
+    va_end(ap);
+    if (n >= (int)sizeof(line)) n = sizeof(line) - 1;
+    if (r->hooks->line) r->hooks->line(r, line, n);
+}
+
+static void on_gesture(const gesture_t *g, void *arg) {
+    input_replay_t *r = arg;
+    r->gestures_seen++;
+    input_action_t action = input_map_gesture(g, r->num_pages);
+    switch (action) {
+    case INPUT_ACT_PATCH:
+    case INPUT_ACT_SETLIST_NEXT:
+    case INPUT_ACT_SETLIST_PREV:
+        input_replay_out(r, "boton %d %s", g->button,
+                         action == INPUT_ACT_PATCH ? "parche" : action == INPUT_ACT_SETLIST_NEXT ? "setlist +1" : "setlist -1");
+        r->press_actions++;
+        if (r->rise_us[g->button] >= 0) {
+            latency_record(&r->latency, r->now_us - r->rise_us[g->button]);
+            r->rise_us[g->button] = -1;
+        }
+        if (r->hooks->press) r->hooks->press(r, g->button, action);
+        break;
+    case INPUT_ACT_TAP_TEMPO:
+        input_replay_out(r, "tap");
+        break;
+    case INPUT_ACT_CLOCK_TOGGLE:
+        input_replay_out(r, "reloj");
+        break;
+    case INPUT_ACT_PAGE_DOWN:
+    case INPUT_ACT_PAGE_UP:
+        // Lo mismo que cambiar_pagina: la página nueva en el LED de su mismo número
+        r->page = (r->page + (action == INPUT_ACT_PAGE_UP ? 1 : -1) + r->num_pages) % r->num_pages;
+        input_replay_out(r, "pagina %d", r->page + 1);
+        input_replay_out(r, "led %d pagina", r->page % r->num_leds);
+        r->led_changes++;
+        break;
+    default:
+        break;
+    }
+}
+
+static void apply_edge(input_replay_t *r, uint32_t mask, int64_t t) {
+    uint32_t rises = mask & ~r->raw;
+    uint32_t falls = mask & r->raw;
+    r->raw ^= mask;
+    r->raw_edges += __builtin_popcount(mask);
+    while (rises) {
+        int i = __builtin_ctz(rises);
+        rises &= rises - 1;
+        if (t - r->fall_us[i] >= QUIET_US) {
+            r->rise_us[i] = t;
+            r->raw_presses++;
+        }
+    }
+    while (falls) {
+        int i = __builtin_ctz(falls);
+        falls &= falls - 1;
+        r->fall_us[i] = t;
+    }
+}
+
+input_replay_err_t input_replay_open(input_replay_t *r, const uint8_t *data, size_t len, uint32_t scan_us,
+                                     int num_pages, int num_leds, const input_replay_hooks_t *hooks, void *arg) {
+    input_rec_header_t h;
+    if (len < sizeof(h)) return INPUT_REPLAY_NO_RECORDING;
+    memcpy(&h, data, sizeof(h));
+    if (h.magic != INPUT_REC_MAGIC || h.version != INPUT_REC_VERSION || h.num_buttons > GESTURE_MAX_BUTTONS) {
+        return INPUT_REPLAY_NO_RECORDING;
+    }
+    if (scan_us == 0) return INPUT_REPLAY_BAD_SCAN;
+
+    // Todos los registros, antes de emitir nada: una grabación cortada no produce media salida
+    const uint8_t *p = data + sizeof(h);
+    const uint8_t *end = data + len;
+    for (uint32_t i = 0; i < h.num_edges; i++) {
+        uint64_t dt, mask;
+        if (!get_varint(&p, end, &dt) || !get_varint(&p, end, &mask) || dt > INT32_MAX) return INPUT_REPLAY_CORRUPT;
+    }
+
+    memset(r, 0, sizeof(*r));
+    r->hooks = hooks;
+    r->arg = arg;
+    r->scan_us = scan_us;
+    r->num_pages = num_pages > 0 ? num_pages : 1;
+    r->num_leds = num_leds > 0 ? num_leds : 1;
+    r->raw = h.initial;
+    r->debounce = (debounce_t){ .stable = h.initial, .last = h.initial };
+    for (int i = 0; i < GESTURE_MAX_BUTTONS; i++) {
+        r->rise_us[i] = -1;
+        r->fall_us[i] = -QUIET_US;
+    }
+    gesture_init(&r->gestures, h.num_buttons, on_gesture, r);
+    input_map_bind(&r->gestures, r->num_pages);
+
+    r->next = data + sizeof(h);
+    r->end = end;
+    r->edges_left = h.num_edges;
+    if (r->edges_left) next_edge(r);
+    return INPUT_REPLAY_OK;
+}
+
+// Un escaneo cada scan_us, como el bucle de la tarea hw
+bool input_replay_step(input_replay_t *r) {
+    int64_t t = (int64_t)r->scans * r->scan_us;
+    while (r->edges_left && r->edge_us <= t) {
+        apply_edge(r, r->edge_mask, r->edge_us);
+        if (--r->edges_left) next_edge(r);
+    }
+    if (!r->edges_left && t > r->edge_us + REPLAY_TAIL_US) return false;
+
+    r->now_us = t;
+    uint32_t changes = debounce_scan(&r->debounce, r->raw);
+    while (changes) {
+        int i = __builtin_ctz(changes);
+        bool pressed = (r->debounce.stable >> i) & 1;
+        changes &= changes - 1;
+        if (pressed) r->presses++;
+        gesture_edge(&r->gestures, i, pressed, t);
+    }
+    gesture_poll(&r->gestures, t);
+    r->scans++;
+    return true;
+}
@@ -0,0 +1,87 @@
+#ifndef INPUT_REPLAY_H
+#define INPUT_REPLAY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "debounce.h"
+#include "gesture.h"
+#include "input_map.h"
+#include "latency.h"
+
+// Reproducción de las grabaciones de input_rec.c con reloj virtual: un escaneo cada scan_us a
+// través del mismo antirrebote, gestos y mapa que la tarea hw. Lógica pura, sin dependencias de
+// ESP-IDF: las acciones que van a la pedalera salen por un gancho, que en la placa y en el PC
+// (test/host/test_input_replay.c) es el camino de pulsación de verdad (press.c).
+//
+// Formato (little-endian, sin relleno): cabecera de 16 bytes y luego un registro por cada
+// escaneo en que cambió la lectura cruda: µs desde el registro anterior (o desde el inicio) y
+// máscara XOR de los bits que cambiaron, ambos como varint LEB128.
+#define INPUT_REC_MAGIC   0x52493647 // "G6IR"
+#define INPUT_REC_VERSION 1
+
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint8_t version;
+    uint8_t num_buttons;
+    uint16_t scan_us;       // Periodo de escaneo con el que se grabó
+    uint32_t initial;       // Lectura cruda al empezar
+    uint32_t num_edges;
+} input_rec_header_t;
+
+typedef enum {
+    INPUT_REPLAY_OK,
+    INPUT_REPLAY_NO_RECORDING,  // Cabecera ausente, de otra versión o con más interruptores de los admitidos
+    INPUT_REPLAY_BAD_SCAN,      // Periodo de escaneo 0: el reloj virtual no avanzaría nunca
+    INPUT_REPLAY_CORRUPT,       // Faltan registros o alguno está cortado
+} input_replay_err_t;
+
+typedef struct input_replay input_replay_t;
+
+typedef struct {
+    // Gesto que va a la pedalera (parche o paso del set list) en el escaneo r->now_us
+    void (*press)(input_replay_t *r, int button, input_action_t action);
+    // Línea de salida terminada en '\0', sin salto de línea
+    void (*line)(input_replay_t *r, const char *line, size_t len);
+} input_replay_hooks_t;
+
+struct input_replay {
+    const input_replay_hooks_t *hooks;
+    void *arg;                  // Del llamador; los ganchos lo leen de aquí
+    uint32_t scan_us;
+    int num_pages;
+    int num_leds;
+    int page;
+    int64_t now_us;             // Reloj virtual: instante del escaneo en curso
+    uint32_t raw;
+    debounce_t debounce;
+    gesture_engine_t gestures;
+    // Siguiente flanco crudo
+    const uint8_t *next;
+    const uint8_t *end;
+    uint32_t edges_left;
+    int64_t edge_us;
+    uint32_t edge_mask;
+    int64_t rise_us[GESTURE_MAX_BUTTONS];   // Inicio de la pulsación en curso con sus rebotes (-1 = ya atendida)
+    int64_t fall_us[GESTURE_MAX_BUTTONS];
+    // Estadísticas
+    uint32_t scans;
+    uint32_t raw_edges;
+    uint32_t raw_presses;       // Subidas crudas tras un rato sin pisar
+    uint32_t presses;           // Pulsaciones tras el antirrebote
+    uint32_t gestures_seen;
+    uint32_t press_actions;     // Gestos entregados al gancho press
+    uint32_t led_changes;       // Los de página; el gancho press suma los suyos
+    latency_hist_t latency;     // Primera subida cruda -> gancho press
+};
+
+// Valida la grabación entera y prepara la reproducción; scan_us es el periodo virtual (el
+// llamador decide si vale el de la cabecera). data tiene que seguir ahí hasta terminar
+input_replay_err_t input_replay_open(input_replay_t *r, const uint8_t *data, size_t len, uint32_t scan_us,
+                                     int num_pages, int num_leds, const input_replay_hooks_t *hooks, void *arg);
+// Un escaneo; false cuando ya han vencido los gestos pendientes tras el último flanco
+bool input_replay_step(input_replay_t *r);
+// Línea "<now_us> ..." hacia el gancho line
+void input_replay_out(input_replay_t *r, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+#endif
@@ -0,0 +1,50 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "esp_timer.h"
+#include "debounce.h"
+#include "input.h"
+
+// Parte común de los backends que escanean solos (input_shiftreg.c, input_matrix.c). Todo corre
+// en el callback del escaneo: el antirrebote ve cada lectura y el cambio sale fechado con el
+// instante del escaneo que lo vio, no con el de la vuelta de la tarea hw que lo recoge.
+
+// Holgura para ráfagas de rebotes mientras la tarea hw está ocupada con un frame
+#define EVENT_QUEUE_LEN 32
+
+static QueueHandle_t events;
+static debounce_t debounce;
+static uint32_t last_raw;
+static volatile uint32_t stable;
+
+esp_err_t input_scan_init(void) {
+    events = xQueueCreate(EVENT_QUEUE_LEN, sizeof(input_event_t));
+    return events ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+void input_scan_publish(uint32_t raw) {
+    uint32_t changes = debounce_scan(&debounce, raw);
+    // Solo se encola lo que cambia: la lectura cruda para la grabación y lo filtrado para los gestos
+    if (raw == last_raw && !changes) return;
+    last_raw = raw;
+    stable = debounce.stable;
+    input_event_t ev = { .time_us = esp_timer_get_time(), .raw = raw, .stable = debounce.stable };
+    // Con la cola llena el cambio se pierde pero no el estado: la tarea hw lo recoge de input_stable()
+    xQueueSend(events, &ev, 0);
+}
+
+uint32_t input_read(void) {
+    return last_raw;
+}
+
+bool input_next_event(input_event_t *out) {
+    return xQueueReceive(events, out, 0) == pdTRUE;
+}
+
+bool input_wait_event(TickType_t ticks) {
+    input_event_t ev;
+    return xQueuePeek(events, &ev, ticks) == pdTRUE;
+}
+
+uint32_t input_stable(void) {
+    return stable;
+}
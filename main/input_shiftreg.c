@@ -0,0 +1,77 @@
+#include "freertos/FreeRTOS.h"
+#include "driver/gpio.h"
+#include "driver/spi_master.h"
+#include "esp_check.h"
+#include "esp_timer.h"
+#include "input.h"
+
+static const char *TAG = "INPUT_SR";
+
+// 74HC165 en cascada: PL a nivel bajo carga las entradas, luego se desplazan por SPI
+#define SR_SPI_HOST    SPI2_HOST
+#define SR_CLOCK_HZ    (4 * 1000 * 1000)
+#define SR_BYTES       ((CONFIG_APP_NUM_BUTTONS + 7) / 8)
+
+static spi_device_handle_t sr_dev;
+static esp_timer_handle_t scan_timer;
+
+// Corre en la tarea de esp_timer y no en la alarma de un gptimer: esa es una ISR y el driver SPI
+// no se puede llamar desde ella. Tampoco hay DMA: hasta 4 bytes caben en rx_data y la transacción
+// por sondeo acaba antes de lo que cuesta preparar un descriptor
+static void scan_cb(void *arg) {
+    gpio_set_level(CONFIG_APP_SR_LOAD_GPIO, 0);
+    gpio_set_level(CONFIG_APP_SR_LOAD_GPIO, 1);
+
+    // Todos los interruptores en una sola transacción de hasta 4 bytes
+    spi_transaction_t t = { .flags = SPI_TRANS_USE_RXDATA, .length = SR_BYTES * 8, .rxlength = SR_BYTES * 8 };
+    if (spi_device_polling_transmit(sr_dev, &t) != ESP_OK) return;
+
+    uint32_t raw = 0;
+    for (int i = 0; i < SR_BYTES; i++) raw |= (uint32_t)t.rx_data[i] << (8 * i);
+
+    // Entradas con pull-up: pulsado = 0
+    input_scan_publish(~raw & (CONFIG_APP_NUM_BUTTONS == 32 ? UINT32_MAX : ((1u << CONFIG_APP_NUM_BUTTONS) - 1)));
+}
+
+esp_err_t input_init(void) {
+    gpio_config_t load = { .pin_bit_mask = 1ULL << CONFIG_APP_SR_LOAD_GPIO, .mode = GPIO_MODE_OUTPUT };
+    ESP_RETURN_ON_ERROR(gpio_config(&load), TAG, "pin PL");
+    gpio_set_level(CONFIG_APP_SR_LOAD_GPIO, 1);
+
+    spi_bus_config_t bus = {
+        .mosi_io_num = -1,
+        .miso_io_num = CONFIG_APP_SR_DATA_GPIO,
+        .sclk_io_num = CONFIG_APP_SR_CLK_GPIO,
+        .quadwp_io_num = -1,
+        .quadhd_io_num = -1,
+        .max_transfer_sz = 4,
+    };
+    ESP_RETURN_ON_ERROR(spi_bus_initialize(SR_SPI_HOST, &bus, SPI_DMA_CH_AUTO), TAG, "bus SPI");
+
+    spi_device_interface_config_t dev = {
+        .clock_speed_hz = SR_CLOCK_HZ,
+        .mode = 0,
+        .spics_io_num = -1,
+        .queue_size = 1,
+    };
+    ESP_RETURN_ON_ERROR(spi_bus_add_device(SR_SPI_HOST, &dev, &sr_dev), TAG, "dispositivo SPI");
+    // El bus es solo nuestro: lo reservamos para que cada escaneo no tenga que negociarlo
+    ESP_RETURN_ON_ERROR(spi_device_acquire_bus(sr_dev, portMAX_DELAY), TAG, "reserva SPI");
+
+    ESP_RETURN_ON_ERROR(input_scan_init(), TAG, "cola de cambios");
+    const esp_timer_create_args_t args = { .callback = scan_cb, .name = "input_scan" };
+    ESP_RETURN_ON_ERROR(esp_timer_create(&args, &scan_timer), TAG, "timer");
+    return esp_timer_start_periodic(scan_timer, 1000000 / CONFIG_APP_INPUT_SCAN_HZ);
+}
+
+// El escaneo periódico mantiene despierto al chip: no hay despertar por GPIO
+esp_err_t input_arm_wakeup(TaskHandle_t notify) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+void input_disarm_wakeup(void) {
+}
+
+int64_t input_wakeup_time(void) {
+    return 0;
+}
@@ -0,0 +1,24 @@
+#include <stdint.h>
+#include "latency.h"
+
+static const int32_t bounds_us[LATENCY_BUCKETS - 1] = { 250, 500, 1000, 2000, 5000, 10000 };
+
+void latency_record(latency_hist_t *h, int64_t us) {
+    if (us < 0) us = 0;
+    int32_t v = us > INT32_MAX ? INT32_MAX : (int32_t)us;
+
+    int b = 0;
+    while (b < LATENCY_BUCKETS - 1 && v >= bounds_us[b]) b++;
+    h->hist[b]++;
+    h->count++;
+    h->total_us += v;
+    if (v > h->max_us) h->max_us = v;
+}
+
+int32_t latency_avg_us(const latency_hist_t *h) {
+    return h->count ? (int32_t)(h->total_us / h->count) : 0;
+}
+
+int32_t latency_bucket_bound_us(int i) {
+    return i < LATENCY_BUCKETS - 1 ? bounds_us[i] : INT32_MAX;
+}
@@ -0,0 +1,22 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <stdint.h>
+
+// Histograma de latencias (µs): <250, <500, <1000, <2000, <5000, <10000, resto
+#define LATENCY_BUCKETS 7
+
+typedef struct {
+    uint32_t count;
+    uint32_t hist[LATENCY_BUCKETS];
+    int64_t total_us;
+    int32_t max_us;
+} latency_hist_t;
+
+// Un solo escritor por histograma; los lectores trabajan sobre una copia
+void latency_record(latency_hist_t *h, int64_t us);
+int32_t latency_avg_us(const latency_hist_t *h);
+// Límite superior del cubo i (INT32_MAX para el último)
+int32_t latency_bucket_bound_us(int i);
+
+#endif
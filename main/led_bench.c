@@ -0,0 +1,252 @@
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_cpu.h"
+#include "esp_random.h"
+#include "esp_heap_caps.h"
+#include "led_comp.h"
+#include "led_strip.h"
+#include "soc/soc_caps.h"
+#include "led_bench.h"
+
+static const char *TAG = "LED_BENCH";
+
+typedef enum {
+    BENCH_RMT,
+    BENCH_RMT_DMA,
+    BENCH_SPI,
+    BENCH_SPI_DMA,
+    BENCH_AUTO,
+} bench_backend_t;
+
+typedef struct {
+    bench_backend_t backend;
+    uint32_t mem_block_symbols;     // Solo RMT
+} bench_case_t;
+
+static const uint32_t lengths[] = { 8, 32, 64, 144, 300 };
+
+static const bench_case_t cases[] = {
+    { BENCH_RMT, 48 },
+    { BENCH_RMT, 96 },
+    { BENCH_RMT, 192 },
+#if SOC_RMT_SUPPORT_DMA
+    { BENCH_RMT_DMA, 1024 },
+    { BENCH_RMT_DMA, 4096 },
+#endif
+#if SOC_GPSPI_SUPPORTED
+    { BENCH_SPI, 0 },
+    { BENCH_SPI_DMA, 0 },
+#endif
+    { BENCH_AUTO, 0 },
+};
+
+static const char *const backend_names[] = {
+    [BENCH_RMT] = "rmt",
+    [BENCH_RMT_DMA] = "rmt+dma",
+    [BENCH_SPI] = "spi",
+    [BENCH_SPI_DMA] = "spi+dma",
+    [BENCH_AUTO] = "auto",
+};
+
+// Tiempo de la tarea idle de este núcleo: lo que no suma es CPU gastada en el envío (ISR incluidas)
+static uint32_t idle_runtime(void) {
+    TaskStatus_t st;
+    vTaskGetInfo(xTaskGetIdleTaskHandleForCore(xPortGetCoreID()), &st, pdFALSE, eInvalid);
+    return st.ulRunTimeCounter;
+}
+
+static esp_err_t create(const bench_case_t *c, int gpio, uint32_t len, led_strip_handle_t *strip, uint32_t *isr,
+                        led_strip_rmt_config_t *used) {
+    led_strip_config_t strip_config = {
+        .strip_gpio_num = gpio,
+        .max_leds = len,
+        .led_pixel_format = LED_PIXEL_FORMAT_GRB,
+        .led_model = LED_MODEL_WS2812,
+    };
+
+    if (c->backend == BENCH_SPI || c->backend == BENCH_SPI_DMA) {
+        // SPI3: el SPI2 puede estar ocupado por los registros de desplazamiento de la entrada
+        led_strip_spi_config_t spi_config = {
+            .clk_src = SPI_CLK_SRC_DEFAULT,
+            .spi_bus = SPI3_HOST,
+            .flags.with_dma = c->backend == BENCH_SPI_DMA,
+        };
+        *isr = 1;
+        return led_strip_new_spi_device(&strip_config, &spi_config, strip);
+    }
+
+    led_strip_rmt_config_t rmt_config = { .clk_src = RMT_CLK_SRC_DEFAULT, .resolution_hz = 10000000 };
+    if (c->backend == BENCH_AUTO) {
+        led_strip_rmt_config_for_length(len, LED_PIXEL_FORMAT_GRB, &rmt_config);
+    } else {
+        rmt_config.mem_block_symbols = c->mem_block_symbols;
+        rmt_config.flags.with_dma = c->backend == BENCH_RMT_DMA;
+    }
+    *used = rmt_config;
+    // El driver no tiene contador de interrupciones: las de recarga se calculan con la misma regla
+    // que sigue el driver (comprobada en test/host con el RMT simulado), más la de fin de transmisión
+    *isr = led_strip_rmt_refills_for_length(len, LED_PIXEL_FORMAT_GRB, &rmt_config) + 1;
+    return led_strip_new_rmt_device(&strip_config, &rmt_config, strip);
+}
+
+void led_bench_run(int gpio, int frames) {
+    printf("%5s %-8s %6s %9s %9s %6s\n", "leds", "backend", "bloque", "us/frame", "cpu us", "isr");
+    for (size_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++) {
+        uint32_t len = lengths[l];
+        for (size_t k = 0; k < sizeof(cases) / sizeof(cases[0]); k++) {
+            const bench_case_t *c = &cases[k];
+            led_strip_handle_t strip = NULL;
+            led_strip_rmt_config_t used = { 0 };
+            uint32_t isr = 0;
+            esp_err_t err = create(c, gpio, len, &strip, &isr, &used);
+            const char *name = backend_names[c->backend];
+            if (c->backend == BENCH_AUTO) name = used.flags.with_dma ? "auto/dma" : "auto/rmt";
+            if (err != ESP_OK) {
+                printf("%5lu %-8s %6lu %9s (%s)\n", (unsigned long)len, name, (unsigned long)used.mem_block_symbols,
+                       "-", esp_err_to_name(err));
+                continue;
+            }
+
+            // Un patrón que cambia en cada frame, como haría una animación
+            uint32_t idle0 = idle_runtime();
+            int64_t t0 = esp_timer_get_time();
+            for (int f = 0; f < frames; f++) {
+                for (uint32_t i = 0; i < len; i++) led_strip_set_pixel(strip, i, (i + f) & 0x1F, 0, 0);
+                led_strip_refresh(strip);
+            }
+            int64_t wall = esp_timer_get_time() - t0;
+            uint32_t idle = idle_runtime() - idle0;
+            int64_t busy = wall > idle ? wall - idle : 0;
+
+            printf("%5lu %-8s %6lu %9lld %9lld %6lu\n", (unsigned long)len, name,
+                   (unsigned long)used.mem_block_symbols, (long long)(wall / frames), (long long)(busy / frames),
+                   (unsigned long)isr);
+            led_strip_del(strip);
+        }
+    }
+
+    led_strip_rmt_config_t pick = { 0 };
+    led_strip_rmt_config_for_length(CONFIG_APP_NUM_LEDS, LED_PIXEL_FORMAT_GRB, &pick);
+    ESP_LOGI(TAG, "Configuracion automatica para %d LEDs: %s, %lu simbolos", CONFIG_APP_NUM_LEDS,
+             pick.flags.with_dma ? "RMT con DMA" : "RMT", (unsigned long)pick.mem_block_symbols);
+}
+
+static int64_t time_frames(led_strip_handle_t *strips, int n, led_strip_rmt_group_handle_t group, int frames) {
+    int64_t t0 = esp_timer_get_time();
+    for (int f = 0; f < frames; f++) {
+        if (group) {
+            led_strip_rmt_group_refresh(group);
+        } else {
+            for (int s = 0; s < n; s++) led_strip_refresh(strips[s]);
+        }
+    }
+    return (esp_timer_get_time() - t0) / frames;
+}
+
+void led_bench_group(const int *gpios, int num_gpios, uint32_t len, int frames) {
+    led_strip_handle_t strips[LED_STRIP_RMT_GROUP_MAX_STRIPS] = { 0 };
+    int created = 0;
+
+    // Un bloque de memoria por tira: así caben tantos canales como sea posible
+    for (int i = 0; i < num_gpios && i < LED_STRIP_RMT_GROUP_MAX_STRIPS; i++) {
+        led_strip_config_t strip_config = {
+            .strip_gpio_num = gpios[i],
+            .max_leds = len,
+            .led_pixel_format = LED_PIXEL_FORMAT_GRB,
+            .led_model = LED_MODEL_WS2812,
+        };
+        led_strip_rmt_config_t rmt_config = {
+            .clk_src = RMT_CLK_SRC_DEFAULT,
+            .resolution_hz = 10000000,
+            .mem_block_symbols = SOC_RMT_MEM_WORDS_PER_CHANNEL,
+        };
+        esp_err_t err = led_strip_new_rmt_device(&strip_config, &rmt_config, &strips[created]);
+        if (err != ESP_OK) {
+            printf("GPIO %d: sin canal RMT libre (%s)\n", gpios[i], esp_err_to_name(err));
+            break;
+        }
+        for (uint32_t p = 0; p < len; p++) led_strip_set_pixel(strips[created], p, 0, 0, (p * 8) & 0xFF);
+        created++;
+    }
+
+    printf("%6s %5s %12s %9s\n", "tiras", "leds", "secuencial", "grupo");
+    for (int n = 2; n <= created; n++) {
+        int64_t seq = time_frames(strips, n, NULL, frames);
+        led_strip_rmt_group_handle_t group = NULL;
+        if (led_strip_rmt_new_group(strips, n, &group) != ESP_OK) {
+            printf("%6d %5lu %9lld us %9s\n", n, (unsigned long)len, (long long)seq, "-");
+            continue;
+        }
+        int64_t par = time_frames(strips, n, group, frames);
+        led_strip_rmt_del_group(group);
+        printf("%6d %5lu %9lld us %6lld us\n", n, (unsigned long)len, (long long)seq, (long long)par);
+    }
+    if (created < 2) printf("hacen falta al menos dos tiras\n");
+
+    for (int i = 0; i < created; i++) led_strip_del(strips[i]);
+}
+
+// Una capa de cada modo, con alfa y cobertura al azar
+static void random_layers(led_comp_t *c) {
+    for (int l = 0; l < c->num_layers; l++) {
+        led_comp_layer_mode(c, l, (led_blend_t)(l % 4));
+        uint32_t r = esp_random();
+        led_comp_layer_alpha(c, l, (r & 3) == 0 ? 255 : r >> 24);
+        for (int i = 0; i < LED_COMP_MAX_LEDS; i++) {
+            uint32_t v = esp_random();
+            if (v & 1) {
+                led_comp_set(c, l, i, v >> 8, v >> 16, v >> 24);
+            } else {
+                led_comp_unset(c, l, i);
+            }
+        }
+    }
+}
+
+static uint32_t time_render(led_comp_t *c, const int16_t **out) {
+    uint32_t c0 = esp_cpu_get_cycle_count();
+    *out = led_comp_render(c);
+    return esp_cpu_get_cycle_count() - c0;
+}
+
+void led_bench_comp(int renders) {
+    led_comp_t *comp = heap_caps_aligned_calloc(16, 1, sizeof(led_comp_t), MALLOC_CAP_INTERNAL);
+    if (!comp) {
+        printf("sin memoria para el compositor\n");
+        return;
+    }
+    led_comp_init(comp, 4);
+
+    uint64_t scalar_cycles = 0;
+#if CONFIG_APP_LED_COMP_SIMD
+    uint64_t simd_cycles = 0;
+    uint32_t mismatches = 0;
+#endif
+    static int16_t ref[LED_COMP_LANES];
+    for (int n = 0; n < renders; n++) {
+        random_layers(comp);
+        const int16_t *out;
+        led_comp_use(comp, &led_comp_scalar);
+        scalar_cycles += time_render(comp, &out);
+        memcpy(ref, out, sizeof(ref));
+#if CONFIG_APP_LED_COMP_SIMD
+        led_comp_use(comp, &led_comp_pie);
+        simd_cycles += time_render(comp, &out);
+        if (memcmp(ref, out, sizeof(ref)) != 0) mismatches++;
+#endif
+    }
+    heap_caps_free(comp);
+
+    printf("%d renders de 4 capas, %d LEDs (%d canales)\n", renders, LED_COMP_MAX_LEDS, LED_COMP_LANES);
+    printf("escalar: %lu ciclos/render\n", (unsigned long)(scalar_cycles / renders));
+#if CONFIG_APP_LED_COMP_SIMD
+    printf("pie:     %lu ciclos/render, %lu renders distintos del escalar\n", (unsigned long)(simd_cycles / renders),
+           (unsigned long)mismatches);
+#else
+    printf("pie:     no disponible (APP_LED_COMP_SIMD)\n");
+#endif
+}
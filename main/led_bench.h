@@ -0,0 +1,17 @@
+#ifndef LED_BENCH_H
+#define LED_BENCH_H
+
+#include <stdint.h>
+
+// Barrido de longitud de tira, backend (RMT, RMT+DMA, SPI, SPI+DMA) y tamaño de bloque sobre un
+// GPIO libre: tiempo por frame, CPU ocupada y una estimación de interrupciones. Solo desde la consola.
+void led_bench_run(int gpio, int frames);
+
+// Refresco de 2 a 4 tiras de len LEDs, una tras otra frente a un grupo en paralelo
+void led_bench_group(const int *gpios, int num_gpios, uint32_t len, int frames);
+
+// Compositor de capas con capas aleatorias: compara los núcleos escalares con los PIE
+// (deben coincidir canal a canal) y da los ciclos por render de cada uno
+void led_bench_comp(int renders);
+
+#endif
@@ -0,0 +1,167 @@
+#include <string.h>
+#include "led_comp.h"
+
+// Alfa 0..255 a peso 0..256: con 255 la capa tapa por completo lo de debajo
+static inline int16_t peso(uint8_t alpha) {
+    return alpha + (alpha >> 7);
+}
+
+static void scalar_add(int16_t *out, const int16_t *a, const int16_t *b, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        int16_t s = a[i] + b[i];
+        out[i] = s > 255 ? 255 : s;
+    }
+}
+
+static void scalar_max(int16_t *out, const int16_t *a, const int16_t *b, size_t n) {
+    for (size_t i = 0; i < n; i++) out[i] = a[i] > b[i] ? a[i] : b[i];
+}
+
+static void scalar_mul(int16_t *out, const int16_t *a, const int16_t *b, size_t n) {
+    for (size_t i = 0; i < n; i++) out[i] = (a[i] * b[i]) >> 8;
+}
+
+// Los dos productos se desplazan por separado, como hace EE.VMUL.S16 con SAR = 8
+static void scalar_mix(int16_t *dst, const int16_t *src, const int16_t *w, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        dst[i] = ((src[i] * w[i]) >> 8) + ((dst[i] * (256 - w[i])) >> 8);
+    }
+}
+
+const led_comp_kernels_t led_comp_scalar = {
+    .add = scalar_add,
+    .max = scalar_max,
+    .mul = scalar_mul,
+    .mix = scalar_mix,
+    .name = "escalar",
+};
+
+#if CONFIG_APP_LED_COMP_SIMD
+// led_comp_pie.S
+void led_comp_pie_add(int16_t *out, const int16_t *a, const int16_t *b, size_t n);
+void led_comp_pie_max(int16_t *out, const int16_t *a, const int16_t *b, size_t n);
+void led_comp_pie_mul(int16_t *out, const int16_t *a, const int16_t *b, size_t n);
+void led_comp_pie_mix(int16_t *dst, const int16_t *src, const int16_t *w, size_t n);
+
+const led_comp_kernels_t led_comp_pie = {
+    .add = led_comp_pie_add,
+    .max = led_comp_pie_max,
+    .mul = led_comp_pie_mul,
+    .mix = led_comp_pie_mix,
+    .name = "pie",
+};
+#endif
+
+static void set_weight(led_layer_t *l, int led, int16_t w) {
+    l->w[led * 3] = w;
+    l->w[led * 3 + 1] = w;
+    l->w[led * 3 + 2] = w;
+}
+
+void led_comp_init(led_comp_t *c, int num_layers) {
+    memset(c, 0, sizeof(*c));
+    c->num_layers = num_layers > LED_COMP_MAX_LAYERS ? LED_COMP_MAX_LAYERS : num_layers;
+    for (int i = 0; i < LED_COMP_MAX_LAYERS; i++) {
+        c->layer[i].mode = LED_BLEND_REPLACE;
+        c->layer[i].alpha = 255;
+    }
+#if CONFIG_APP_LED_COMP_SIMD
+    c->k = &led_comp_pie;
+#else
+    c->k = &led_comp_scalar;
+#endif
+    c->dirty = true;
+}
+
+void led_comp_use(led_comp_t *c, const led_comp_kernels_t *k) {
+    c->k = k;
+    c->dirty = true;
+}
+
+void led_comp_layer_mode(led_comp_t *c, int layer, led_blend_t mode) {
+    if (layer < 0 || layer >= c->num_layers || c->layer[layer].mode == mode) return;
+    c->layer[layer].mode = mode;
+    c->dirty = true;
+}
+
+void led_comp_layer_alpha(led_comp_t *c, int layer, uint8_t alpha) {
+    if (layer < 0 || layer >= c->num_layers) return;
+    led_layer_t *l = &c->layer[layer];
+    if (l->alpha == alpha) return;
+    l->alpha = alpha;
+    for (int i = 0; i < LED_COMP_MAX_LEDS; i++) {
+        if (l->cover[i / 32] & (1u << (i % 32))) set_weight(l, i, peso(alpha));
+    }
+    c->dirty = true;
+}
+
+void led_comp_set(led_comp_t *c, int layer, int led, uint8_t r, uint8_t g, uint8_t b) {
+    if (layer < 0 || layer >= c->num_layers || led < 0 || led >= LED_COMP_MAX_LEDS) return;
+    led_layer_t *l = &c->layer[layer];
+    int16_t *p = &l->px[led * 3];
+    uint32_t bit = 1u << (led % 32);
+    if ((l->cover[led / 32] & bit) && p[0] == r && p[1] == g && p[2] == b) return;
+    if (!(l->cover[led / 32] & bit)) {
+        l->cover[led / 32] |= bit;
+        l->count++;
+        set_weight(l, led, peso(l->alpha));
+    }
+    p[0] = r;
+    p[1] = g;
+    p[2] = b;
+    c->dirty = true;
+}
+
+void led_comp_unset(led_comp_t *c, int layer, int led) {
+    if (!led_comp_covers(c, layer, led)) return;
+    led_layer_t *l = &c->layer[layer];
+    l->cover[led / 32] &= ~(1u << (led % 32));
+    l->count--;
+    set_weight(l, led, 0);
+    c->dirty = true;
+}
+
+void led_comp_clear(led_comp_t *c, int layer) {
+    if (layer < 0 || layer >= c->num_layers || c->layer[layer].count == 0) return;
+    led_layer_t *l = &c->layer[layer];
+    memset(l->w, 0, sizeof(l->w));
+    memset(l->cover, 0, sizeof(l->cover));
+    l->count = 0;
+    c->dirty = true;
+}
+
+bool led_comp_covers(const led_comp_t *c, int layer, int led) {
+    if (layer < 0 || layer >= c->num_layers || led < 0 || led >= LED_COMP_MAX_LEDS) return false;
+    return (c->layer[layer].cover[led / 32] & (1u << (led % 32))) != 0;
+}
+
+const int16_t *led_comp_render(led_comp_t *c) {
+    const led_comp_kernels_t *k = c->k;
+    memset(c->acc, 0, sizeof(c->acc));
+    for (int i = 0; i < c->num_layers; i++) {
+        led_layer_t *l = &c->layer[i];
+        if (l->count == 0 || l->alpha == 0) continue;
+
+        // Resultado del modo en todos los canales; los pesos dejan intactos los no cubiertos
+        const int16_t *blend = l->px;
+        switch (l->mode) {
+        case LED_BLEND_ADD:
+            k->add(c->tmp, c->acc, l->px, LED_COMP_LANES);
+            blend = c->tmp;
+            break;
+        case LED_BLEND_MAX:
+            k->max(c->tmp, c->acc, l->px, LED_COMP_LANES);
+            blend = c->tmp;
+            break;
+        case LED_BLEND_MULTIPLY:
+            k->mul(c->tmp, c->acc, l->px, LED_COMP_LANES);
+            blend = c->tmp;
+            break;
+        default:
+            break;
+        }
+        k->mix(c->acc, blend, l->w, LED_COMP_LANES);
+    }
+    c->dirty = false;
+    return c->acc;
+}
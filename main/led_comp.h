@@ -0,0 +1,80 @@
+#ifndef LED_COMP_H
+#define LED_COMP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "sdkconfig.h"
+
+// Compositor de capas para la tira. Cada capa guarda sus colores a escala completa y
+// qué LEDs cubre; el frame sale de mezclar las capas en orden (0 = fondo) según su modo
+// y su alfa. Sin más dependencias de ESP-IDF que sdkconfig.h (número de LEDs y núcleos PIE),
+// así que se prueba en el PC: los núcleos de mezcla tienen una versión escalar y otra con
+// las instrucciones PIE del ESP32-S3 que dan el mismo resultado.
+
+#define LED_COMP_MAX_LAYERS 6
+#define LED_COMP_MAX_LEDS   CONFIG_APP_NUM_LEDS
+
+// Canales R,G,B de todos los LEDs como int16, con relleno hasta vectores de 8 (128 bits)
+#define LED_COMP_LANES (((LED_COMP_MAX_LEDS * 3) + 7) & ~7)
+
+typedef enum {
+    LED_BLEND_REPLACE,
+    LED_BLEND_ADD,          // Suma saturada a 255
+    LED_BLEND_MAX,
+    LED_BLEND_MULTIPLY,     // (abajo * capa) >> 8: 255 * 255 da 254
+} led_blend_t;
+
+// Núcleos sobre n canales (múltiplo de 8) con punteros alineados a 16 bytes
+typedef struct {
+    void (*add)(int16_t *out, const int16_t *a, const int16_t *b, size_t n);
+    void (*max)(int16_t *out, const int16_t *a, const int16_t *b, size_t n);
+    void (*mul)(int16_t *out, const int16_t *a, const int16_t *b, size_t n);
+    // dst = (src * w) >> 8 + (dst * (256 - w)) >> 8, con w en 0..256 por canal
+    void (*mix)(int16_t *dst, const int16_t *src, const int16_t *w, size_t n);
+    const char *name;
+} led_comp_kernels_t;
+
+extern const led_comp_kernels_t led_comp_scalar;
+#if CONFIG_APP_LED_COMP_SIMD
+extern const led_comp_kernels_t led_comp_pie;
+#endif
+
+typedef struct {
+    int16_t px[LED_COMP_LANES] __attribute__((aligned(16)));
+    int16_t w[LED_COMP_LANES] __attribute__((aligned(16)));    // Peso de la capa en cada canal cubierto
+    uint32_t cover[(LED_COMP_MAX_LEDS + 31) / 32];
+    uint16_t count;         // LEDs cubiertos
+    uint8_t alpha;
+    uint8_t mode;           // led_blend_t
+} led_layer_t;
+
+typedef struct {
+    led_layer_t layer[LED_COMP_MAX_LAYERS];
+    int16_t acc[LED_COMP_LANES] __attribute__((aligned(16)));
+    int16_t tmp[LED_COMP_LANES] __attribute__((aligned(16)));
+    int num_layers;
+    const led_comp_kernels_t *k;
+    bool dirty;
+} led_comp_t;
+
+// Empieza con todas las capas vacías en modo REPLACE y alfa 255, y los núcleos más rápidos disponibles
+void led_comp_init(led_comp_t *c, int num_layers);
+void led_comp_use(led_comp_t *c, const led_comp_kernels_t *k);
+void led_comp_layer_mode(led_comp_t *c, int layer, led_blend_t mode);
+void led_comp_layer_alpha(led_comp_t *c, int layer, uint8_t alpha);
+
+void led_comp_set(led_comp_t *c, int layer, int led, uint8_t r, uint8_t g, uint8_t b);
+void led_comp_unset(led_comp_t *c, int layer, int led);
+void led_comp_clear(led_comp_t *c, int layer);
+bool led_comp_covers(const led_comp_t *c, int layer, int led);
+
+// Hay algún cambio desde el último render
+static inline bool led_comp_dirty(const led_comp_t *c) {
+    return c->dirty;
+}
+
+// Mezcla las capas sobre negro; devuelve R,G,B de cada LED (0..255) en canales consecutivos
+const int16_t *led_comp_render(led_comp_t *c);
+
+#endif
@@ -0,0 +1,147 @@
+#include <stdint.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "sdkconfig.h"
+#include "led_feedback.h"
+
+#define TIMEOUT_US (CONFIG_APP_LED_FEEDBACK_TIMEOUT_MS * 1000LL)
+#if CONFIG_APP_LED_COMMIT_ON_MIDI_IN
+#define COMMIT_ON_MIDI_IN true
+#else
+#define COMMIT_ON_MIDI_IN false
+#endif
+
+typedef struct {
+    led_fb_view_t view;
+    bool expect_valid;      // Hay un parche que MIDI IN puede confirmar
+    uint8_t bank;
+    uint8_t program;
+    int64_t photon_us;      // Fin de la transmisión del primer frame (0 = aún no)
+    int64_t midi_us;        // Transferencia completada (0 = aún no)
+} led_fb_t;
+
+static led_fb_t fb = { .view = { .state = LED_FB_IDLE, .led = -1 } };
+static led_fb_stats_t stats;
+static portMUX_TYPE fb_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Con el lock tomado
+static void set_state(led_fb_state_t state) {
+    fb.view.state = state;
+    fb.view.version++;
+}
+
+// Con el lock tomado, cuando ya se conocen los dos instantes de la pulsación
+static void compare_photon_midi(void) {
+    if (!fb.photon_us || !fb.midi_us) return;
+    int64_t lag = fb.photon_us - fb.midi_us;
+    if (lag > 0) {
+        stats.midi_first++;
+        if (lag > stats.max_photon_lag_us) stats.max_photon_lag_us = lag > INT32_MAX ? INT32_MAX : (int32_t)lag;
+    } else {
+        stats.photon_first++;
+    }
+}
+
+static void commit(int64_t now_us) {
+    set_state(LED_FB_COMMITTED);
+    latency_record(&stats.press_to_commit, now_us - fb.view.press_us);
+    stats.committed++;
+}
+
+void led_feedback_press(int led, int64_t press_us) {
+    portENTER_CRITICAL(&fb_lock);
+    if (fb.view.state == LED_FB_PENDING) stats.superseded++;
+    fb.view.led = led;
+    fb.view.press_us = press_us;
+    fb.expect_valid = false;
+    fb.photon_us = 0;
+    fb.midi_us = 0;
+    set_state(LED_FB_PENDING);
+    portEXIT_CRITICAL(&fb_lock);
+}
+
+void led_feedback_clear(void) {
+    portENTER_CRITICAL(&fb_lock);
+    fb.view.led = -1;
+    fb.expect_valid = false;
+    set_state(LED_FB_IDLE);
+    portEXIT_CRITICAL(&fb_lock);
+}
+
+void led_feedback_photon(int64_t press_us, int64_t start_us, int64_t done_us) {
+    portENTER_CRITICAL(&fb_lock);
+    if (press_us == fb.view.press_us && !fb.photon_us) {
+        fb.photon_us = done_us;
+        latency_record(&stats.press_to_photon, done_us - press_us);
+        latency_record(&stats.frame_to_photon, done_us - start_us);
+        compare_photon_midi();
+    }
+    portEXIT_CRITICAL(&fb_lock);
+}
+
+void led_feedback_poll(int64_t now_us, led_fb_view_t *out) {
+    portENTER_CRITICAL(&fb_lock);
+    if (fb.view.state == LED_FB_PENDING && now_us - fb.view.press_us > TIMEOUT_US) {
+        set_state(LED_FB_FAILED);
+        stats.timeouts++;
+    }
+    *out = fb.view;
+    portEXIT_CRITICAL(&fb_lock);
+}
+
+void led_feedback_expect(int64_t press_us, uint8_t bank, uint8_t program) {
+    portENTER_CRITICAL(&fb_lock);
+    if (press_us == fb.view.press_us) {
+        fb.expect_valid = true;
+        fb.bank = bank;
+        fb.program = program;
+    }
+    portEXIT_CRITICAL(&fb_lock);
+}
+
+void led_feedback_sent(int64_t press_us, bool ok, int64_t now_us) {
+    portENTER_CRITICAL(&fb_lock);
+    if (press_us == fb.view.press_us && ok && !fb.midi_us) {
+        fb.midi_us = now_us;
+        compare_photon_midi();
+    }
+    if (press_us == fb.view.press_us && fb.view.state == LED_FB_PENDING) {
+        if (!ok) {
+            set_state(LED_FB_FAILED);
+            stats.failed++;
+        } else if (!COMMIT_ON_MIDI_IN || !fb.expect_valid) {
+            // Sin cambio de parche que confirmar (macros) basta con que la transferencia llegue
+            commit(now_us);
+        }
+    }
+    portEXIT_CRITICAL(&fb_lock);
+}
+
+void led_feedback_confirm(uint8_t bank, uint8_t program, int64_t now_us) {
+    portENTER_CRITICAL(&fb_lock);
+    if (fb.view.state == LED_FB_PENDING && fb.expect_valid && fb.bank == bank && fb.program == program) {
+        commit(now_us);
+    }
+    portEXIT_CRITICAL(&fb_lock);
+}
+
+void led_feedback_fail(int64_t press_us) {
+    portENTER_CRITICAL(&fb_lock);
+    if (press_us == fb.view.press_us && fb.view.state == LED_FB_PENDING) {
+        set_state(LED_FB_FAILED);
+        stats.failed++;
+    }
+    portEXIT_CRITICAL(&fb_lock);
+}
+
+void led_feedback_get_stats(led_fb_stats_t *out) {
+    portENTER_CRITICAL(&fb_lock);
+    *out = stats;
+    portEXIT_CRITICAL(&fb_lock);
+}
+
+void led_feedback_reset_stats(void) {
+    portENTER_CRITICAL(&fb_lock);
+    memset(&stats, 0, sizeof(stats));
+    portEXIT_CRITICAL(&fb_lock);
+}
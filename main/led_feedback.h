@@ -0,0 +1,63 @@
+#ifndef LED_FEEDBACK_H
+#define LED_FEEDBACK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "latency.h"
+
+// Estado del indicador de parche compartido entre la tarea hw (pulsación, tiempo límite,
+// pintado) y la tarea MIDI (envío y confirmación). La pulsación se identifica por la marca
+// de tiempo de su flanco, la misma que viaja en midi_msg_t.time_us: un resultado que llega
+// tarde para una pulsación ya sustituida se ignora.
+
+typedef enum {
+    LED_FB_IDLE,        // Sin indicador
+    LED_FB_PENDING,     // Pulsación encolada, aún sin confirmar
+    LED_FB_COMMITTED,   // Transferencia completada o parche confirmado por MIDI IN
+    LED_FB_FAILED,      // Sin pedalera, error de envío, cola llena o sin respuesta a tiempo
+} led_fb_state_t;
+
+typedef struct {
+    led_fb_state_t state;
+    int led;            // -1 si el interruptor no tiene LED propio
+    int64_t press_us;
+    uint32_t version;   // Cambia con cada transición: solo entonces hay que repintar
+} led_fb_view_t;
+
+typedef struct {
+    latency_hist_t press_to_photon;     // Flanco -> fin de la transmisión RMT del frame con el color pendiente
+    latency_hist_t frame_to_photon;     // Inicio del refresco -> fin de la transmisión (incluye el código de reset)
+    latency_hist_t press_to_commit;     // Flanco -> confirmación
+    // Misma pulsación: qué llegó antes, la luz o la transferencia MIDI completada
+    uint32_t photon_first;
+    uint32_t midi_first;
+    int32_t max_photon_lag_us;          // Mayor retraso de la luz respecto al MIDI
+    uint32_t committed;
+    uint32_t failed;
+    uint32_t timeouts;
+    uint32_t superseded;                // Pulsaciones sustituidas por otra antes de confirmarse
+} led_fb_stats_t;
+
+// Tarea hw
+void led_feedback_press(int led, int64_t press_us);
+void led_feedback_clear(void);
+// Primer frame enviado con el color pendiente: start_us al pedir el refresco, done_us en el
+// callback de fin de transmisión del RMT
+void led_feedback_photon(int64_t press_us, int64_t start_us, int64_t done_us);
+// Aplica el tiempo límite y copia el estado actual
+void led_feedback_poll(int64_t now_us, led_fb_view_t *out);
+
+// Tarea MIDI
+// La pulsación lleva un cambio de parche: MIDI IN puede confirmarlo
+void led_feedback_expect(int64_t press_us, uint8_t bank, uint8_t program);
+// La transferencia que llevaba la pulsación terminó (ok = completada sin error)
+void led_feedback_sent(int64_t press_us, bool ok, int64_t now_us);
+// Program Change recibido de la pedalera
+void led_feedback_confirm(uint8_t bank, uint8_t program, int64_t now_us);
+// La pulsación no produjo nada que enviar
+void led_feedback_fail(int64_t press_us);
+
+void led_feedback_get_stats(led_fb_stats_t *out);
+void led_feedback_reset_stats(void);
+
+#endif
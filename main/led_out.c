@@ -0,0 +1,98 @@
+#include <stdint.h>
+#include "esp_attr.h"
+#include "esp_cpu.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "driver/rmt_tx.h"
+#include "led_strip.h"
+#include "sdkconfig.h"
+#include "led_out.h"
+
+static const char *TAG = "LED_OUT";
+
+#if CONFIG_APP_LED_FIXED_BACKEND
+// Longitud, formato y modelo fijos en compilación: set/clear en línea y bucles desenrollables
+#define LED_STRIP_FIXED_LEN   CONFIG_APP_NUM_LEDS
+#define LED_STRIP_FIXED_BPP   3
+#define LED_STRIP_FIXED_MODEL LED_STRIP_FIXED_MODEL_WS2812
+#include "led_strip_fixed.h"
+static led_strip_fixed_t tira;
+#else
+static led_strip_handle_t tira;
+#endif
+static bool nivelEnEncoder = false;
+static bool conCallback = false;
+static volatile int64_t finEnvioUs = 0;
+
+static IRAM_ATTR bool fin_envio_cb(rmt_channel_handle_t chan, const rmt_tx_done_event_data_t *edata, void *arg) {
+    finEnvioUs = esp_timer_get_time();
+    return false;
+}
+
+esp_err_t led_out_init(int gpio_num) {
+    rmt_channel_handle_t canal = NULL;
+#if CONFIG_APP_LED_FIXED_BACKEND
+    esp_err_t err = led_strip_fixed_init(&tira, gpio_num);
+    if (err != ESP_OK) return err;
+    canal = tira.chan;
+    // La tabla de niveles se aplica al enviar, como en el encoder RMT de led_strip
+    nivelEnEncoder = led_strip_fixed_set_gamma(&tira, CONFIG_APP_LED_GAMMA_X10 / 10.0f) == ESP_OK;
+#else
+    led_strip_config_t strip_config = { .strip_gpio_num = gpio_num, .max_leds = CONFIG_APP_NUM_LEDS, .led_pixel_format = LED_PIXEL_FORMAT_GRB, .led_model = LED_MODEL_WS2812 };
+    led_strip_rmt_config_t rmt_config = { .clk_src = RMT_CLK_SRC_DEFAULT, .resolution_hz = 10000000 };
+    // Bloque de memoria y DMA según la longitud (ver el comando ledbench de la consola)
+    led_strip_rmt_config_for_length(CONFIG_APP_NUM_LEDS, LED_PIXEL_FORMAT_GRB, &rmt_config);
+#if CONFIG_APP_STATIC_MEMORY
+    // Objeto y buffer de píxeles fuera del heap; el canal RMT y su encoder los reserva el driver aquí, en el arranque
+    static uint32_t tiraMem[LED_STRIP_RMT_STATIC_MEM_WORDS(CONFIG_APP_NUM_LEDS, 3)];
+    esp_err_t err = led_strip_new_rmt_device_with_mem(&strip_config, &rmt_config, tiraMem, sizeof(tiraMem), &tira);
+#else
+    esp_err_t err = led_strip_new_rmt_device(&strip_config, &rmt_config, &tira);
+#endif
+    if (err != ESP_OK) return err;
+    // Sin encoder simple (IDF < 5.3) el brillo se sigue aplicando píxel a píxel
+    nivelEnEncoder = led_strip_rmt_set_gamma(tira, CONFIG_APP_LED_GAMMA_X10 / 10.0f) == ESP_OK;
+    led_strip_rmt_get_channel(tira, &canal);
+#endif
+    const rmt_tx_event_callbacks_t cbs = { .on_trans_done = fin_envio_cb };
+    conCallback = canal && rmt_tx_register_event_callbacks(canal, &cbs, NULL) == ESP_OK;
+    if (!conCallback) ESP_LOGW(TAG, "Sin callback de fin de transmision: la luz se mide a la vuelta del refresco");
+    return ESP_OK;
+}
+
+bool led_out_level_in_encoder(void) {
+    return nivelEnEncoder;
+}
+
+void led_out_set_level(uint8_t level) {
+    if (!nivelEnEncoder) return;
+#if CONFIG_APP_LED_FIXED_BACKEND
+    led_strip_fixed_set_brightness(&tira, level);
+#else
+    led_strip_rmt_set_brightness(tira, level);
+#endif
+}
+
+void led_out_set(int i, uint8_t r, uint8_t g, uint8_t b) {
+#if CONFIG_APP_LED_FIXED_BACKEND
+    led_strip_fixed_set(&tira, i, r, g, b);
+#else
+    led_strip_set_pixel(tira, i, r, g, b);
+#endif
+}
+
+esp_err_t led_out_refresh(led_out_frame_t *frame) {
+    finEnvioUs = 0;
+    frame->start_us = esp_timer_get_time();
+    uint32_t c0 = esp_cpu_get_cycle_count();
+#if CONFIG_APP_LED_FIXED_BACKEND
+    esp_err_t err = led_strip_fixed_refresh(&tira);
+#else
+    esp_err_t err = led_strip_refresh(tira);
+#endif
+    frame->cycles = esp_cpu_get_cycle_count() - c0;
+    frame->return_us = esp_timer_get_time();
+    // El envío espera a que termine: si el callback no está registrado vale la vuelta del refresco
+    frame->done_us = conCallback && finEnvioUs != 0 ? finEnvioUs : frame->return_us;
+    return err;
+}
@@ -0,0 +1,30 @@
+#ifndef LED_OUT_H
+#define LED_OUT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+// Salida de la tira para la tarea hw: el backend elegido en menuconfig (led_strip o
+// led_strip_fixed.h), su tabla de niveles (gamma y brillo) y el instante en que los LEDs
+// muestran cada frame, que marca el callback de fin de transmisión del RMT.
+
+typedef struct {
+    int64_t start_us;   // Al pedir el refresco
+    int64_t done_us;    // Fin de la transmisión, después del código de reset: los LEDs ya muestran el frame
+    int64_t return_us;  // Vuelta del refresco
+    uint32_t cycles;    // Ciclos de CPU dentro del refresco
+} led_out_frame_t;
+
+// Crea la tira de CONFIG_APP_NUM_LEDS LEDs y registra el callback de fin de transmisión
+esp_err_t led_out_init(int gpio_num);
+// La tabla de niveles del backend aplica gamma y brillo (IDF 5.3 o posterior); si no, el
+// brillo se escala píxel a píxel antes de led_out_set() y la gamma no se aplica
+bool led_out_level_in_encoder(void);
+// Brillo de la tabla de niveles (255 = escala completa); sin tabla no hace nada
+void led_out_set_level(uint8_t level);
+void led_out_set(int i, uint8_t r, uint8_t g, uint8_t b);
+// Envía el frame y espera a que termine; sin el callback registrado, done_us es la vuelta
+esp_err_t led_out_refresh(led_out_frame_t *frame);
+
+#endif
@@ -0,0 +1,209 @@
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "nvs.h"
+#include "sysex.h"
+#include "macro.h"
+
+static const char *TAG = "MACRO";
+
+#define NVS_NAMESPACE "zoomctl"
+
+// Macro por botón, leída de NVS. Vacía = comportamiento por defecto (Bank Select + Program Change)
+static uint8_t macro_code[MACRO_MAX_BUTTONS][MACRO_MAX_CODE_LEN];
+static size_t macro_size[MACRO_MAX_BUTTONS];
+static bool macro_valid[MACRO_MAX_BUTTONS];
+static macro_stats_t stats = {0};
+
+// Área de preparación de la consola. Mientras hay una macro pendiente solo la lee la tarea MIDI
+static uint8_t staging[MACRO_MAX_CODE_LEN];
+static size_t staging_len = 0;
+static int pending_button = -1;
+static portMUX_TYPE staging_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Longitud del mensaje MIDI que empieza en p, o 0 si no es válido
+static size_t msg_len(const uint8_t *p, size_t avail) {
+    uint8_t status = p[0];
+    if (status == 0xF0) {
+        for (size_t i = 1; i < avail && i < SYSEX_MAX_TX_LEN; i++) {
+            if (p[i] == 0xF7) return i + 1;
+            if (p[i] & 0x80) return 0;
+        }
+        return 0;
+    }
+    if (status < 0x80 || status >= 0xF0) return 0;
+    size_t len = ((status & 0xF0) == 0xC0 || (status & 0xF0) == 0xD0) ? 2 : 3;
+    if (len > avail) return 0;
+    for (size_t i = 1; i < len; i++) {
+        if (p[i] & 0x80) return 0;
+    }
+    return len;
+}
+
+bool macro_validate(const uint8_t *code, size_t len) {
+    uint32_t total_ms = 0;
+    size_t i = 0;
+
+    if (len > MACRO_MAX_CODE_LEN) return false;
+    while (i < len) {
+        if (code[i] == MACRO_OP_END) return true;
+        if (code[i] == MACRO_OP_DELAY) {
+            // Los dos bytes de la espera tienen que estar dentro del código
+            if (len - i < 3 || ((code[i + 1] | code[i + 2]) & 0x80)) return false;
+            total_ms += code[i + 1] | (code[i + 2] << 7);
+            if (total_ms > MACRO_MAX_BURST_MS) return false;
+            i += 3;
+            continue;
+        }
+        size_t n = msg_len(&code[i], len - i);
+        if (n == 0) return false;
+        i += n;
+    }
+    return false;
+}
+
+static void nvs_key(uint8_t button, char key[8]) {
+    snprintf(key, 8, "macro%u", (unsigned)button);
+}
+
+void macro_init(void) {
+    nvs_handle_t h;
+    if (nvs_open(NVS_NAMESPACE, NVS_READONLY, &h) != ESP_OK) return;
+
+    // Se valida una sola vez al cargar; en caliente el intérprete no comprueba nada
+    int loaded = 0;
+    for (int i = 0; i < MACRO_MAX_BUTTONS; i++) {
+        char key[8];
+        size_t len = sizeof(macro_code[i]);
+        nvs_key(i, key);
+        if (nvs_get_blob(h, key, macro_code[i], &len) != ESP_OK) continue;
+        macro_size[i] = len;
+        macro_valid[i] = macro_validate(macro_code[i], len);
+        if (macro_valid[i]) {
+            loaded++;
+        } else {
+            ESP_LOGE(TAG, "Macro del boton %d invalida, se usa el cambio de parche normal", i + 1);
+        }
+    }
+    nvs_close(h);
+    if (loaded) ESP_LOGI(TAG, "%d macros cargadas", loaded);
+}
+
+const uint8_t *macro_for_button(uint8_t button) {
+    if (button >= MACRO_MAX_BUTTONS || !macro_valid[button]) return NULL;
+    return macro_code[button];
+}
+
+bool macro_load(size_t offset, const uint8_t *data, size_t len) {
+    bool ok = false;
+    portENTER_CRITICAL(&staging_lock);
+    if (pending_button < 0) {
+        if (offset == 0) staging_len = 0;
+        if (offset == staging_len && len <= sizeof(staging) - offset) {
+            memcpy(&staging[offset], data, len);
+            staging_len += len;
+            ok = true;
+        }
+    }
+    portEXIT_CRITICAL(&staging_lock);
+    return ok;
+}
+
+esp_err_t macro_commit(uint8_t button) {
+    if (button >= MACRO_MAX_BUTTONS) return ESP_ERR_INVALID_ARG;
+    portENTER_CRITICAL(&staging_lock);
+    bool busy = pending_button >= 0;
+    portEXIT_CRITICAL(&staging_lock);
+    if (busy) return ESP_ERR_INVALID_STATE;
+    if (staging_len > 0 && !macro_validate(staging, staging_len)) return ESP_ERR_INVALID_ARG;
+
+    // Primero a flash: si la escritura falla, lo que está en uso tampoco cambia
+    char key[8];
+    nvs_key(button, key);
+    nvs_handle_t h;
+    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &h);
+    if (err != ESP_OK) return err;
+    if (staging_len > 0) {
+        err = nvs_set_blob(h, key, staging, staging_len);
+    } else {
+        err = nvs_erase_key(h, key);
+        if (err == ESP_ERR_NVS_NOT_FOUND) err = ESP_OK;
+    }
+    if (err == ESP_OK) err = nvs_commit(h);
+    nvs_close(h);
+    if (err != ESP_OK) return err;
+
+    portENTER_CRITICAL(&staging_lock);
+    pending_button = button;
+    portEXIT_CRITICAL(&staging_lock);
+    return ESP_OK;
+}
+
+size_t macro_len(uint8_t button) {
+    if (button >= MACRO_MAX_BUTTONS || !macro_valid[button]) return 0;
+    return macro_size[button];
+}
+
+void macro_sync(const macro_runner_t *r) {
+    if (r->active) return;
+    portENTER_CRITICAL(&staging_lock);
+    int button = pending_button;
+    portEXIT_CRITICAL(&staging_lock);
+    if (button < 0) return;
+
+    // La consola no toca el área de preparación mientras haya una macro pendiente
+    macro_valid[button] = false;
+    memcpy(macro_code[button], staging, staging_len);
+    macro_size[button] = staging_len;
+    macro_valid[button] = staging_len > 0;
+
+    portENTER_CRITICAL(&staging_lock);
+    pending_button = -1;
+    portEXIT_CRITICAL(&staging_lock);
+    ESP_LOGI(TAG, "Macro del boton %d: %u bytes", button + 1, (unsigned)staging_len);
+}
+
+void macro_start(macro_runner_t *r, const uint8_t *code, int64_t now_us) {
+    if (r->active) stats.aborted++;
+    r->pc = code;
+    r->start_us = now_us;
+    r->resume_us = now_us;
+    r->planned_us = 0;
+    r->active = true;
+}
+
+macro_status_t macro_step(macro_runner_t *r, int64_t now_us, macro_emit_t emit, void *arg) {
+    if (!r->active) return MACRO_DONE;
+    if (now_us < r->resume_us) return MACRO_WAIT;
+
+    while (*r->pc != MACRO_OP_END) {
+        if (*r->pc == MACRO_OP_DELAY) {
+            int64_t delay_us = (r->pc[1] | (r->pc[2] << 7)) * 1000LL;
+            r->pc += 3;
+            // Las esperas se cuentan desde el inicio de la ráfaga para no acumular deriva
+            r->planned_us += delay_us;
+            r->resume_us = r->start_us + r->planned_us;
+            return MACRO_WAIT;
+        }
+        size_t len = msg_len(r->pc, MACRO_MAX_CODE_LEN);
+        if (!emit(r->pc, len, arg)) return MACRO_BLOCKED;
+        r->pc += len;
+    }
+
+    r->active = false;
+    stats.runs++;
+    stats.last_us = now_us - r->start_us;
+    if (stats.last_us - r->planned_us > stats.max_overrun_us) {
+        stats.max_overrun_us = stats.last_us - r->planned_us;
+    }
+    return MACRO_DONE;
+}
+
+void macro_get_stats(macro_stats_t *out) {
+    *out = stats;
+}
+
+void macro_reset_stats(void) {
+    memset(&stats, 0, sizeof(stats));
+}
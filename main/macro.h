@@ -0,0 +1,82 @@
+#ifndef MACRO_H
+#define MACRO_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "sdkconfig.h"
+
+// Bytecode de macros: mensajes MIDI crudos (status + datos) intercalados con
+// códigos de control, cuyo primer byte nunca es un status (< 0x80).
+#define MACRO_OP_END   0x00
+#define MACRO_OP_DELAY 0x01 // Siguen 2 bytes de 7 bits: milisegundos (LSB, MSB)
+
+#define MACRO_MAX_BUTTONS  CONFIG_APP_NUM_BUTTONS
+#define MACRO_MAX_BURST_MS 2000 // Suma máxima de esperas de una macro
+#define MACRO_MAX_CODE_LEN 256
+
+// Las macros se guardan en NVS, una por botón. tools/macro.py las compila desde texto y
+// genera los comandos "macro load" / "macro commit" de la consola. Ayudas para escribir
+// el mismo bytecode en C (pruebas, valores de fábrica). Ejemplo de escena:
+//   static const uint8_t escena_solo[] = {
+//       M_BANK(0, 0x00, 0x19), M_PC(0, 2),
+//       M_DELAY(20),
+//       M_CC(0, 64, 127), M_CC(0, 65, 0),
+//       M_END
+//   };
+#define M_CC(ch, cc, val)      (0xB0 | (ch)), (cc), (val)
+#define M_PC(ch, prog)         (0xC0 | (ch)), (prog)
+#define M_BANK(ch, msb, lsb)   M_CC(ch, 0x00, msb), M_CC(ch, 0x20, lsb)
+#define M_DELAY(ms)            MACRO_OP_DELAY, ((ms) & 0x7F), (((ms) >> 7) & 0x7F)
+#define M_END                  MACRO_OP_END
+
+typedef enum {
+    MACRO_DONE,     // La macro terminó
+    MACRO_WAIT,     // Esperando a resume_us
+    MACRO_BLOCKED,  // La salida está llena; reintentar en la siguiente vuelta
+} macro_status_t;
+
+// Envía un mensaje MIDI completo; devuelve false si no hay hueco ahora mismo
+typedef bool (*macro_emit_t)(const uint8_t *msg, size_t len, void *arg);
+
+typedef struct {
+    const uint8_t *pc;
+    int64_t start_us;
+    int64_t resume_us;
+    int64_t planned_us;     // Suma de esperas ejecutadas, para medir el retraso real
+    bool active;
+} macro_runner_t;
+
+typedef struct {
+    uint32_t runs;
+    uint32_t aborted;
+    int64_t last_us;        // Duración de la última ráfaga completa
+    int64_t max_overrun_us; // Peor desvío respecto a las esperas programadas
+} macro_stats_t;
+
+// Lee de NVS las macros guardadas y las valida; las inválidas se ignoran
+void macro_init(void);
+const uint8_t *macro_for_button(uint8_t button);
+
+// Comprueba que el bytecode termina dentro de len bytes, con mensajes y esperas completos
+bool macro_validate(const uint8_t *code, size_t len);
+
+// Consola: la macro nueva se escribe por trozos en un área de preparación (offset 0 la
+// vacía; solo se puede escribir a continuación de lo ya cargado) y macro_commit() la valida,
+// la guarda en NVS y la deja pendiente. Un área vacía borra la macro del botón.
+bool macro_load(size_t offset, const uint8_t *data, size_t len);
+esp_err_t macro_commit(uint8_t button);
+size_t macro_len(uint8_t button);
+
+// Tarea MIDI, una vez por vuelta: instala la macro pendiente cuando no hay ninguna en curso,
+// para no cambiar el bytecode bajo los pies del intérprete
+void macro_sync(const macro_runner_t *r);
+
+void macro_start(macro_runner_t *r, const uint8_t *code, int64_t now_us);
+macro_status_t macro_step(macro_runner_t *r, int64_t now_us, macro_emit_t emit, void *arg);
+void macro_get_stats(macro_stats_t *out);
+// Solo desde la tarea MIDI, dueña de las estadísticas (class_driver_reset_stats lo pide)
+void macro_reset_stats(void);
+
+#endif
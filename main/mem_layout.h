@@ -0,0 +1,41 @@
+#ifndef MEM_LAYOUT_H
+#define MEM_LAYOUT_H
+
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// Pilas de las tareas (bytes). Son los tamaños con los que se creaban las tareas antes de
+// centralizarlos aquí, sin recortar. Para ajustarlos hay que medir: el comando "tasks" de la
+// consola da el mínimo libre histórico de cada pila (pila asignada - mínimo libre = pico de
+// uso) y tools/mem_budget.py --hwm propone pico + STACK_MARGIN redondeado a 256 a partir de
+// capturas de ese comando tras ejercitar cada tarea.
+#define STACK_MARGIN 512
+
+#define STACK_HW     4096   // Escaneo, gestos y led_strip_refresh (rmt_transmit)
+#define STACK_MIDI   4096   // Cola, macros, set list y ESP_LOGI de cambios de parche
+#define STACK_USB    4096   // usb_host_lib_handle_events
+#define STACK_CACHE  3072   // Peticiones SysEx
+#define STACK_CFG    3072   // nvs_set_blob + nvs_commit
+#define STACK_TRACE  3072   // printf de las líneas T:
+#define STACK_EXPR   3072   // Lectura continua del ADC
+
+#define MIDI_QUEUE_LEN 10
+
+// Crea una tarea fijada a un núcleo y devuelve su manejador. En modo estático la pila y el
+// TCB son variables estáticas propias de cada punto de llamada: nada sale del heap.
+#if CONFIG_APP_STATIC_MEMORY
+#define APP_TASK_CREATE(fn, name, stack, arg, prio, core) ({                                  \
+    static StackType_t task_stack_[(stack) / sizeof(StackType_t)];                            \
+    static StaticTask_t task_tcb_;                                                            \
+    xTaskCreateStaticPinnedToCore((fn), (name), (stack), (arg), (prio), task_stack_, &task_tcb_, (core)); \
+})
+#else
+#define APP_TASK_CREATE(fn, name, stack, arg, prio, core) ({                                  \
+    TaskHandle_t task_hdl_ = NULL;                                                            \
+    xTaskCreatePinnedToCore((fn), (name), (stack), (arg), (prio), &task_hdl_, (core));        \
+    task_hdl_;                                                                                \
+})
+#endif
+
+#endif
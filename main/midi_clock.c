@@ -0,0 +1,216 @@
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "class_driver.h"
+#include "midi_clock.h"
+
+static const char *TAG = "MIDI_CLOCK";
+
+#define TAP_HISTORY 4
+#define TAP_TIMEOUT_US 2000000 // Una pausa mayor empieza una serie nueva de taps
+
+static const int32_t jitter_bounds_us[MIDI_CLOCK_JITTER_BUCKETS - 1] = { 50, 100, 200, 500, 1000 };
+
+static esp_timer_handle_t clock_timer = NULL;
+// Arrancar, parar y cambiar el tempo llegan de la tarea hw (interruptores) y de la tarea MIDI
+// (conexión) a la vez: cada operación completa va bajo control_mutex. clock_lock protege lo
+// que además lee el temporizador o el envío (record_tx), que no pueden esperar a un mutex.
+static StaticSemaphore_t control_mutex_buf;
+static SemaphoreHandle_t control_mutex = NULL;
+static portMUX_TYPE clock_lock = portMUX_INITIALIZER_UNLOCKED;
+static bool enabled = true;     // Lo que pidió el usuario; sin pedalera se guarda para la conexión
+static bool connected = false;
+static volatile bool running = false;
+static volatile uint32_t bpm = 120;
+static uint32_t period_us = 0;
+
+// Estado compartido entre el temporizador y la tarea MIDI
+static uint32_t pending_ticks = 0;
+static bool pending_start = false;
+static bool pending_stop = false;
+
+static midi_clock_stats_t stats = {0};
+static int64_t last_tx_us = 0;
+
+static int64_t last_tap_us = 0;
+static uint32_t tap_intervals[TAP_HISTORY];
+static int tap_count = 0;
+static int tap_head = 0;
+static int tap_outliers = 0;
+
+static void tick_cb(void *arg) {
+    portENTER_CRITICAL(&clock_lock);
+    // Sin pedalera que los consuma no acumulamos más de un pulso de negra
+    if (pending_ticks < MIDI_CLOCK_PPQN) pending_ticks++;
+    portEXIT_CRITICAL(&clock_lock);
+    class_driver_wake();
+}
+
+esp_err_t midi_clock_init(void) {
+    const esp_timer_create_args_t args = { .callback = tick_cb, .name = "midi_clock" };
+    control_mutex = xSemaphoreCreateMutexStatic(&control_mutex_buf);
+    period_us = 60000000UL / (bpm * MIDI_CLOCK_PPQN);
+    return esp_timer_create(&args, &clock_timer);
+}
+
+// Con control_mutex tomado
+static void start_locked(void) {
+    if (running) return;
+    portENTER_CRITICAL(&clock_lock);
+    pending_ticks = 0;
+    pending_start = true;
+    pending_stop = false;
+    last_tx_us = 0;
+    running = true;
+    portEXIT_CRITICAL(&clock_lock);
+    esp_timer_start_periodic(clock_timer, period_us);
+    class_driver_wake();
+    ESP_LOGI(TAG, "Reloj MIDI en marcha a %lu BPM", (unsigned long)bpm);
+}
+
+static void stop_locked(void) {
+    if (!running) return;
+    esp_timer_stop(clock_timer);
+    portENTER_CRITICAL(&clock_lock);
+    running = false;
+    pending_ticks = 0;
+    pending_start = false;
+    pending_stop = true;
+    portEXIT_CRITICAL(&clock_lock);
+    class_driver_wake();
+}
+
+void midi_clock_toggle(void) {
+    xSemaphoreTake(control_mutex, portMAX_DELAY);
+    enabled = !enabled;
+    if (enabled && connected) start_locked();
+    else stop_locked();
+    xSemaphoreGive(control_mutex);
+}
+
+void midi_clock_on_connect(void) {
+    xSemaphoreTake(control_mutex, portMAX_DELAY);
+    connected = true;
+    if (enabled) start_locked();
+    xSemaphoreGive(control_mutex);
+}
+
+void midi_clock_on_disconnect(void) {
+    xSemaphoreTake(control_mutex, portMAX_DELAY);
+    connected = false;
+    stop_locked();
+    // El Stop no tiene a quién llegar: se descarta junto con los ticks pendientes
+    portENTER_CRITICAL(&clock_lock);
+    pending_stop = false;
+    portEXIT_CRITICAL(&clock_lock);
+    xSemaphoreGive(control_mutex);
+}
+
+void midi_clock_set_bpm(uint32_t new_bpm) {
+    if (new_bpm < MIDI_CLOCK_MIN_BPM) new_bpm = MIDI_CLOCK_MIN_BPM;
+    if (new_bpm > MIDI_CLOCK_MAX_BPM) new_bpm = MIDI_CLOCK_MAX_BPM;
+    xSemaphoreTake(control_mutex, portMAX_DELAY);
+    if (new_bpm != bpm) {
+        portENTER_CRITICAL(&clock_lock);
+        bpm = new_bpm;
+        period_us = 60000000UL / (new_bpm * MIDI_CLOCK_PPQN);
+        last_tx_us = 0;
+        portEXIT_CRITICAL(&clock_lock);
+        if (running) esp_timer_restart(clock_timer, period_us);
+        ESP_LOGI(TAG, "Tempo: %lu BPM", (unsigned long)new_bpm);
+    }
+    xSemaphoreGive(control_mutex);
+}
+
+bool midi_clock_running(void) {
+    return running;
+}
+
+uint32_t midi_clock_get_bpm(void) {
+    return bpm;
+}
+
+void midi_clock_tap(int64_t now_us) {
+    int64_t dt = now_us - last_tap_us;
+    last_tap_us = now_us;
+
+    if (dt > TAP_TIMEOUT_US) {
+        tap_count = 0;
+        tap_outliers = 0;
+        return;
+    }
+
+    uint32_t sum = 0;
+    for (int i = 0; i < tap_count; i++) sum += tap_intervals[i];
+
+    if (tap_count > 0) {
+        uint32_t avg = sum / tap_count;
+        if (dt < avg / 2 || dt > avg + avg / 2) {
+            // Un tap suelto fuera de rango se ignora; dos seguidos significan un tempo nuevo
+            if (++tap_outliers < 2) return;
+            tap_count = 0;
+            sum = 0;
+        }
+    }
+    tap_outliers = 0;
+
+    if (tap_count == TAP_HISTORY) sum -= tap_intervals[tap_head];
+    tap_intervals[tap_head] = (uint32_t)dt;
+    tap_head = (tap_head + 1) % TAP_HISTORY;
+    if (tap_count < TAP_HISTORY) tap_count++;
+    sum += (uint32_t)dt;
+
+    midi_clock_set_bpm((60000000UL * tap_count + sum / 2) / sum);
+}
+
+size_t midi_clock_take_pending(uint8_t *out, size_t cap) {
+    size_t n = 0;
+
+    portENTER_CRITICAL(&clock_lock);
+    if (pending_stop && n < cap) {
+        out[n++] = 0xFC;
+        pending_stop = false;
+    }
+    if (pending_start && n < cap) {
+        out[n++] = 0xFA;
+        pending_start = false;
+    }
+    while (pending_ticks > 0 && n < cap) {
+        out[n++] = 0xF8;
+        pending_ticks--;
+    }
+    portEXIT_CRITICAL(&clock_lock);
+    return n;
+}
+
+void midi_clock_record_tx(int64_t now_us, uint32_t ticks) {
+    if (ticks == 0) return;
+    portENTER_CRITICAL(&clock_lock);
+    stats.ticks_sent += ticks;
+    stats.ticks_merged += ticks - 1;
+
+    if (last_tx_us != 0) {
+        int32_t dev = abs((int32_t)(now_us - last_tx_us) - (int32_t)(period_us * ticks));
+        int b = 0;
+        while (b < MIDI_CLOCK_JITTER_BUCKETS - 1 && dev >= jitter_bounds_us[b]) b++;
+        stats.jitter_hist[b]++;
+        if (dev > stats.max_jitter_us) stats.max_jitter_us = dev;
+    }
+    last_tx_us = now_us;
+    portEXIT_CRITICAL(&clock_lock);
+}
+
+void midi_clock_get_stats(midi_clock_stats_t *out) {
+    portENTER_CRITICAL(&clock_lock);
+    *out = stats;
+    portEXIT_CRITICAL(&clock_lock);
+}
+
+void midi_clock_reset_stats(void) {
+    portENTER_CRITICAL(&clock_lock);
+    memset(&stats, 0, sizeof(stats));
+    portEXIT_CRITICAL(&clock_lock);
+}
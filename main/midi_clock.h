@@ -0,0 +1,45 @@
+#ifndef MIDI_CLOCK_H
+#define MIDI_CLOCK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#define MIDI_CLOCK_PPQN 24
+#define MIDI_CLOCK_MIN_BPM 30
+#define MIDI_CLOCK_MAX_BPM 300
+
+// Desviación entre ticks enviados respecto al periodo nominal (µs): <50, <100, <200, <500, <1000, resto
+#define MIDI_CLOCK_JITTER_BUCKETS 6
+
+typedef struct {
+    uint32_t ticks_sent;
+    uint32_t ticks_merged;  // Ticks que salieron juntos porque el anterior seguía en vuelo
+    int32_t max_jitter_us;
+    uint32_t jitter_hist[MIDI_CLOCK_JITTER_BUCKETS];
+} midi_clock_stats_t;
+
+esp_err_t midi_clock_init(void);
+// Interruptor del reloj: lo activa o lo desactiva. Sin pedalera conectada solo se recuerda,
+// y el reloj arranca al conectar si quedó activado (lo está al encender)
+void midi_clock_toggle(void);
+// Ticks saliendo: activado y con la pedalera conectada
+bool midi_clock_running(void);
+void midi_clock_set_bpm(uint32_t bpm);
+uint32_t midi_clock_get_bpm(void);
+
+// Pulsación del interruptor de tap tempo
+void midi_clock_tap(int64_t now_us);
+
+// Uso interno del class driver: conexión y desconexión de la pedalera (al desconectar se
+// descartan el Stop y los ticks pendientes)
+void midi_clock_on_connect(void);
+void midi_clock_on_disconnect(void);
+// Bytes de tiempo real pendientes (F8/FA/FC) en orden
+size_t midi_clock_take_pending(uint8_t *out, size_t cap);
+void midi_clock_record_tx(int64_t now_us, uint32_t ticks);
+void midi_clock_get_stats(midi_clock_stats_t *out);
+void midi_clock_reset_stats(void);
+
+#endif
@@ -0,0 +1,178 @@
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "class_driver.h"
+#include "patch_map.h"
+#include "patch_cache.h"
+#include "midi_probe.h"
+
+static const char *TAG = "MIDI_PROBE";
+
+#define PROBE_BUTTONS CONFIG_APP_NUM_BUTTONS
+#define PROBE_TIMEOUT_MS 2000
+// Tras cada respuesta la pedalera termina de cargar el parche antes del siguiente envío
+#define PROBE_SETTLE_MS 300
+
+// Parche que se espera de vuelta; lo comparten la consola y la tarea MIDI
+typedef struct {
+    bool active;
+    uint8_t bank;
+    uint8_t program;
+    int64_t reply_us;   // 0 = aún sin respuesta
+} probe_wait_t;
+
+static probe_wait_t wait;
+static portMUX_TYPE probe_lock = portMUX_INITIALIZER_UNLOCKED;
+static SemaphoreHandle_t reply_sem;
+static StaticSemaphore_t reply_sem_buf;
+
+// µs desde el envío hasta la confirmación, por botón y ronda (-1 = sin respuesta)
+static int32_t samples[PROBE_BUTTONS][MIDI_PROBE_MAX_ROUNDS];
+
+void midi_probe_pc(uint8_t bank, uint8_t program, int64_t now_us) {
+    bool matched = false;
+    portENTER_CRITICAL(&probe_lock);
+    if (wait.active && wait.bank == bank && wait.program == program) {
+        wait.active = false;
+        wait.reply_us = now_us;
+        matched = true;
+    }
+    portEXIT_CRITICAL(&probe_lock);
+    if (matched) xSemaphoreGive(reply_sem);
+}
+
+// Espera la confirmación de un parche; devuelve los µs desde el envío o -1
+static int32_t probe_one(int page, int button, const uint32_t *sim_ms, int num_sim) {
+    patch_map_entry_t entry = patch_map_get(page, button);
+    xSemaphoreTake(reply_sem, 0);
+
+    int64_t sent_us = esp_timer_get_time();
+    portENTER_CRITICAL(&probe_lock);
+    wait.active = true;
+    wait.bank = entry.bank_lsb;
+    wait.program = entry.program;
+    wait.reply_us = 0;
+    portEXIT_CRITICAL(&probe_lock);
+
+    // Con la pedalera simulada el envío sigue el mismo camino: cola, lote y transferencia
+    midi_msg_t m = { .status = MIDI_MSG_PROBE, .data1 = button, .data2 = page, .time_us = sent_us };
+    if (sim_ms) {
+        uint32_t ms = sim_ms[button < num_sim ? button : num_sim - 1];
+        m.sim_ms = ms > UINT16_MAX ? UINT16_MAX : ms;
+    }
+    if (!class_driver_post(&m)) {
+        portENTER_CRITICAL(&probe_lock);
+        wait.active = false;
+        portEXIT_CRITICAL(&probe_lock);
+        return -1;
+    }
+
+    xSemaphoreTake(reply_sem, pdMS_TO_TICKS(PROBE_TIMEOUT_MS));
+    // La respuesta puede colarse justo al vencer la espera: manda lo que diga el estado compartido
+    portENTER_CRITICAL(&probe_lock);
+    wait.active = false;
+    int64_t reply_us = wait.reply_us;
+    portEXIT_CRITICAL(&probe_lock);
+    return reply_us ? (int32_t)(reply_us - sent_us) : -1;
+}
+
+static void sort_samples(int32_t *v, int n) {
+    for (int i = 1; i < n; i++) {
+        int32_t x = v[i];
+        int j = i - 1;
+        for (; j >= 0 && v[j] > x; j--) v[j + 1] = v[j];
+        v[j + 1] = x;
+    }
+}
+
+static void print_report(int page, int rounds) {
+    printf("%-4s %-10s %-10s %3s %4s %8s %8s %8s %8s\n",
+           "bot", "parche", "nombre", "n", "sin", "min", "mediana", "p90", "max");
+    int slowest = -1;
+    int32_t slowest_median = 0;
+    for (int b = 0; b < PROBE_BUTTONS; b++) {
+        int32_t ok[MIDI_PROBE_MAX_ROUNDS];
+        int n = 0;
+        for (int r = 0; r < rounds; r++) {
+            if (samples[b][r] >= 0) ok[n++] = samples[b][r];
+        }
+        patch_map_entry_t entry = patch_map_get(page, b);
+        char bank_name[3];
+        char label[12];
+        snprintf(label, sizeof(label), "%s%d", zoom_bank_name(entry.bank_lsb, bank_name), entry.program + 1);
+        patch_info_t info;
+        const char *name = patch_cache_lookup(entry.bank_lsb, entry.program, &info) ? info.name : "?";
+        if (n == 0) {
+            printf("%-4d %-10s %-10s %3d %4d %8s %8s %8s %8s\n", b, label, name, 0, rounds, "-", "-", "-", "-");
+            continue;
+        }
+        sort_samples(ok, n);
+        int32_t median = ok[n / 2];
+        printf("%-4d %-10s %-10s %3d %4d %8ld %8ld %8ld %8ld\n", b, label, name, n, rounds - n,
+               (long)ok[0], (long)median, (long)ok[(n * 9) / 10], (long)ok[n - 1]);
+        if (median > slowest_median) {
+            slowest_median = median;
+            slowest = b;
+        }
+    }
+    printf("tiempos en us desde el envio hasta el Program Change de vuelta\n");
+    if (slowest >= 0) printf("mas lento: boton %d (mediana %ld us)\n", slowest, (long)slowest_median);
+}
+
+// Los mensajes de principio y fin no pueden perderse: se reintenta un rato con la cola llena
+static bool post_control(uint8_t type, uint8_t data1) {
+    const midi_msg_t m = { .status = type, .data1 = data1, .time_us = esp_timer_get_time() };
+    for (int i = 0; i < PROBE_TIMEOUT_MS / 10; i++) {
+        if (class_driver_post(&m)) return true;
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    return false;
+}
+
+int32_t midi_probe_sample(int button, int round) {
+    if (button < 0 || button >= PROBE_BUTTONS || round < 0 || round >= MIDI_PROBE_MAX_ROUNDS) return -1;
+    return samples[button][round];
+}
+
+void midi_probe_run(int page, int rounds, const uint32_t *sim_ms, int num_sim) {
+    if (!reply_sem) {
+        reply_sem = xSemaphoreCreateBinaryStatic(&reply_sem_buf);
+    }
+    if (rounds < 1) rounds = 1;
+    if (rounds > MIDI_PROBE_MAX_ROUNDS) rounds = MIDI_PROBE_MAX_ROUNDS;
+    if (page < 0 || page >= patch_map_num_pages()) page = 0;
+    if (sim_ms && num_sim <= 0) sim_ms = NULL;
+
+    ESP_LOGI(TAG, "Midiendo pagina %d: %d rondas de %d parches%s", page + 1, rounds, PROBE_BUTTONS,
+             sim_ms ? " (dispositivo simulado)" : "");
+    for (int b = 0; b < PROBE_BUTTONS; b++) {
+        for (int r = 0; r < MIDI_PROBE_MAX_ROUNDS; r++) samples[b][r] = -1;
+    }
+    // La tarea MIDI guarda el parche actual y el set list, y los repone al terminar
+    if (!post_control(MIDI_MSG_PROBE_BEGIN, sim_ms != NULL)) {
+        printf("la tarea MIDI no atiende la cola\n");
+        return;
+    }
+    bool any_reply = false;
+    int done = 0;
+    for (int r = 0; r < rounds; r++) {
+        for (int b = 0; b < PROBE_BUTTONS; b++) {
+            samples[b][r] = probe_one(page, b, sim_ms, num_sim);
+            if (samples[b][r] >= 0) any_reply = true;
+            vTaskDelay(pdMS_TO_TICKS(PROBE_SETTLE_MS));
+        }
+        done = r + 1;
+        // Si en toda una ronda no contesta nada no merece la pena seguir esperando
+        if (!any_reply) break;
+    }
+    if (!post_control(MIDI_MSG_PROBE_END, 0)) ESP_LOGE(TAG, "No se pudo reponer el parche de antes de la medida");
+    if (!any_reply) {
+        printf("sin respuesta de la pedalera: conectada y con MIDI IN activo?\n");
+        return;
+    }
+    print_report(page, done);
+}
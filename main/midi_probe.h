@@ -0,0 +1,25 @@
+#ifndef MIDI_PROBE_H
+#define MIDI_PROBE_H
+
+#include <stdint.h>
+
+// Ida y vuelta MIDI con la pedalera: envía el cambio de parche de cada botón de una página
+// del mapa y mide hasta el Program Change con el que la G6 confirma la carga. Solo desde la
+// consola; bloquea a quien la llama hasta terminar. Al acabar, la tarea MIDI deja el parche
+// actual y el set list como estaban (y con la pedalera de verdad le vuelve a mandar el parche).
+#define MIDI_PROBE_MAX_ROUNDS 32
+
+// sim_ms != NULL: en vez de la pedalera responde una simulada en la tarea MIDI con el
+// retardo sim_ms[i] para el botón i (el último valor vale para el resto). El envío pasa por
+// la cola, el lote y la transferencia, y la respuesta por el análisis de MIDI IN, así que
+// la medida es la misma que con la pedalera salvo el bus. Un retardo por encima del tiempo
+// límite cuenta como sin respuesta.
+void midi_probe_run(int page, int rounds, const uint32_t *sim_ms, int num_sim);
+
+// µs de la última medida del botón en la ronda (-1 = sin respuesta o sin medir)
+int32_t midi_probe_sample(int button, int round);
+
+// Tarea MIDI: Program Change recibido por MIDI IN
+void midi_probe_pc(uint8_t bank, uint8_t program, int64_t now_us);
+
+#endif
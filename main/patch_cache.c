@@ -0,0 +1,259 @@
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_rom_crc.h"
+#include "esp_heap_caps.h"
+#include "sysex.h"
+#include "class_driver.h"
+#include "patch_map.h"
+#include "patch_cache.h"
+
+static const char *TAG = "PATCH_CACHE";
+
+// Comandos SysEx de Zoom (ingeniería inversa de la familia G6/G11)
+#define ZOOM_CMD_PATCH_REQUEST 0x46 // F0 52 00 id 46 bankL bankM progL progM F7
+#define ZOOM_CMD_PATCH_REPLY   0x45 // F0 52 00 id 45 bankL bankM progL progM lenL lenM <datos 7 bits> <crc 5 bytes> F7
+#define ZOOM_CMD_PARAM_EDIT    0x31 // Parámetro editado en la pedalera (modo editor)
+#define ZOOM_CMD_EDITOR_ON     0x50
+
+#define REPLY_HEADER_LEN 11
+#define REPLY_CRC_LEN    5
+#define PTCF_NAME_OFFSET 28         // El nombre va dentro del bloque PTCF desempaquetado
+
+#define REPLY_TIMEOUT_MS 1000
+#define REPLY_ATTEMPTS   2          // Peticiones por parche antes de dejarlo para la próxima vuelta
+#define CONNECT_SETTLE_MS 500
+
+#define NOTIFY_CONNECT    (1u << 0)
+#define NOTIFY_INVALIDATE (1u << 1)
+
+// Índice directo por banco y parche: cualquier entrada del mapa tiene su hueco
+#define NUM_ENTRIES (ZOOM_G6_NUM_BANKS * ZOOM_G6_PATCHES_PER_BANK)
+
+typedef struct {
+    patch_info_t info;
+    bool valid;
+} cache_entry_t;
+
+#if CONFIG_APP_PATCH_CACHE_PSRAM
+static cache_entry_t *entries = NULL;
+#else
+static cache_entry_t entries[NUM_ENTRIES];
+#endif
+
+static portMUX_TYPE cache_lock = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t cache_task_hdl = NULL;
+static SemaphoreHandle_t reply_sem = NULL;
+static StaticSemaphore_t reply_sem_buf;
+static volatile bool connected = false;
+// Conexión anterior al arranque de la tarea: la recoge ella al empezar (protegido por cache_lock)
+static bool connect_pending = false;
+static int current_entry = -1;
+// Parche pedido por fetch_missing (-1 = ninguno): solo su respuesta la despierta (protegido por cache_lock)
+static int requested_entry = -1;
+
+static int entry_index(uint8_t bank, uint8_t program) {
+    if (program >= ZOOM_G6_PATCHES_PER_BANK || bank >= ZOOM_G6_NUM_BANKS) return -1;
+    return bank * ZOOM_G6_PATCHES_PER_BANK + program;
+}
+
+static void invalidate(int idx) {
+    if (idx < 0) return;
+    portENTER_CRITICAL(&cache_lock);
+    entries[idx].valid = false;
+    portEXIT_CRITICAL(&cache_lock);
+}
+
+// Desempaqueta los datos de 7 bits (un byte con los MSB por cada 7 bytes) al vuelo,
+// acumulando el CRC y copiando solo el nombre; no hace falta un buffer intermedio.
+static uint32_t scan_payload(const uint8_t *src, size_t len, char *name) {
+    uint32_t crc = 0;
+    size_t out = 0;
+    uint8_t group[7];
+
+    for (size_t i = 0; i < len; i += 8) {
+        uint8_t msbs = src[i];
+        size_t n = (len - i - 1) < 7 ? (len - i - 1) : 7;
+        for (size_t j = 0; j < n; j++) {
+            group[j] = src[i + 1 + j] | (((msbs >> j) & 1) << 7);
+            size_t pos = out + j;
+            if (pos >= PTCF_NAME_OFFSET && pos < PTCF_NAME_OFFSET + PATCH_NAME_LEN) {
+                name[pos - PTCF_NAME_OFFSET] = (char)group[j];
+            }
+        }
+        crc = esp_rom_crc32_le(crc, group, n);
+        out += n;
+    }
+    return crc;
+}
+
+static void on_zoom_sysex(const uint8_t *msg, size_t len, void *arg) {
+    uint8_t cmd = msg[4];
+
+    if (cmd == ZOOM_CMD_PARAM_EDIT) {
+        // El parche activo se ha editado en la pedalera: su nombre puede haber cambiado
+        invalidate(current_entry);
+        if (cache_task_hdl) xTaskNotify(cache_task_hdl, NOTIFY_INVALIDATE, eSetBits);
+        return;
+    }
+
+    if (cmd != ZOOM_CMD_PATCH_REPLY || len < REPLY_HEADER_LEN + REPLY_CRC_LEN + 1) return;
+
+    int idx = entry_index(msg[5], msg[7]);
+    if (idx < 0) return;
+
+    const uint8_t *data = &msg[REPLY_HEADER_LEN];
+    size_t data_len = len - REPLY_HEADER_LEN - REPLY_CRC_LEN - 1;
+    const uint8_t *c = &msg[len - 1 - REPLY_CRC_LEN];
+    uint32_t pedal_crc = c[0] | (c[1] << 7) | (c[2] << 14) | ((uint32_t)c[3] << 21) | ((uint32_t)c[4] << 28);
+
+    patch_info_t info = { .bank = msg[5], .program = msg[7] };
+    uint32_t crc = scan_payload(data, data_len, info.name);
+    if (crc != pedal_crc) {
+        ESP_LOGW(TAG, "CRC incorrecto en banco 0x%02x parche %d", info.bank, info.program + 1);
+        return;
+    }
+
+    // Los nombres vienen rellenos con espacios
+    for (int i = PATCH_NAME_LEN - 1; i >= 0 && (info.name[i] == ' ' || info.name[i] == '\0'); i--) {
+        info.name[i] = '\0';
+    }
+    info.crc = crc;
+
+    portENTER_CRITICAL(&cache_lock);
+    entries[idx].info = info;
+    entries[idx].valid = true;
+    bool requested = idx == requested_entry;
+    portEXIT_CRITICAL(&cache_lock);
+
+    // Una respuesta tardía o de otro parche queda en su hueco, pero no es la que se espera
+    if (requested) xSemaphoreGive(reply_sem);
+}
+
+esp_err_t patch_cache_init(void) {
+#if CONFIG_APP_PATCH_CACHE_PSRAM
+    entries = heap_caps_calloc(NUM_ENTRIES, sizeof(cache_entry_t), MALLOC_CAP_SPIRAM);
+    if (!entries) return ESP_ERR_NO_MEM;
+#endif
+    reply_sem = xSemaphoreCreateBinaryStatic(&reply_sem_buf);
+    if (!reply_sem) return ESP_ERR_NO_MEM;
+    return sysex_register_handler(SYSEX_MANUFACTURER_ZOOM, SYSEX_MODEL_ZOOM_G6, on_zoom_sysex, NULL);
+}
+
+bool patch_cache_lookup(uint8_t bank, uint8_t program, patch_info_t *out) {
+    int idx = entry_index(bank, program);
+    if (idx < 0) return false;
+
+    portENTER_CRITICAL(&cache_lock);
+    bool valid = entries[idx].valid;
+    if (valid) *out = entries[idx].info;
+    portEXIT_CRITICAL(&cache_lock);
+    return valid;
+}
+
+void patch_cache_on_connect(void) {
+    portENTER_CRITICAL(&cache_lock);
+    connected = true;
+    TaskHandle_t task = cache_task_hdl;
+    if (!task) connect_pending = true;
+    portEXIT_CRITICAL(&cache_lock);
+    if (task) xTaskNotify(task, NOTIFY_CONNECT, eSetBits);
+}
+
+void patch_cache_on_disconnect(void) {
+    portENTER_CRITICAL(&cache_lock);
+    connected = false;
+    connect_pending = false;
+    portEXIT_CRITICAL(&cache_lock);
+    current_entry = -1;
+    // Al reconectar no sabemos qué se tocó en la pedalera: todo vuelve a validarse
+    for (size_t i = 0; i < NUM_ENTRIES; i++) invalidate((int)i);
+}
+
+void patch_cache_set_current(uint8_t bank, uint8_t program) {
+    current_entry = entry_index(bank, program);
+}
+
+bool patch_cache_get_current(uint8_t *bank, uint8_t *program) {
+    int idx = current_entry;
+    if (idx < 0) return false;
+    *bank = idx / ZOOM_G6_PATCHES_PER_BANK;
+    *program = idx % ZOOM_G6_PATCHES_PER_BANK;
+    return true;
+}
+
+static void fetch_missing(void) {
+    int fetched = 0;
+    int total = patch_map_num_pages() * CONFIG_APP_NUM_BUTTONS;
+
+    // Solo se piden los parches alcanzables desde algún botón del mapa
+    for (int i = 0; i < total && connected; i++) {
+        patch_map_entry_t e = patch_map_get(i / CONFIG_APP_NUM_BUTTONS, i % CONFIG_APP_NUM_BUTTONS);
+        int idx = entry_index(e.bank_lsb, e.program);
+        if (idx < 0) continue;
+
+        portENTER_CRITICAL(&cache_lock);
+        bool valid = entries[idx].valid;
+        portEXIT_CRITICAL(&cache_lock);
+        if (valid) continue;
+
+        uint8_t bank = e.bank_lsb;
+        uint8_t program = e.program;
+        const uint8_t req[] = { 0xF0, SYSEX_MANUFACTURER_ZOOM, 0x00, SYSEX_MODEL_ZOOM_G6, ZOOM_CMD_PATCH_REQUEST,
+                                bank, 0x00, program, 0x00, 0xF7 };
+
+        portENTER_CRITICAL(&cache_lock);
+        requested_entry = idx;
+        portEXIT_CRITICAL(&cache_lock);
+        xSemaphoreTake(reply_sem, 0);
+
+        // La respuesta de un intento anterior que llegue tarde también vale
+        bool replied = false;
+        bool send_failed = false;
+        for (int attempt = 0; attempt < REPLY_ATTEMPTS && !replied && connected; attempt++) {
+            if (sysex_send(req, sizeof(req), pdMS_TO_TICKS(100)) != ESP_OK) {
+                send_failed = true;
+                break;
+            }
+            replied = xSemaphoreTake(reply_sem, pdMS_TO_TICKS(REPLY_TIMEOUT_MS)) == pdTRUE;
+        }
+
+        portENTER_CRITICAL(&cache_lock);
+        requested_entry = -1;
+        portEXIT_CRITICAL(&cache_lock);
+
+        if (send_failed) break;
+        if (replied) {
+            fetched++;
+        } else {
+            ESP_LOGW(TAG, "Sin respuesta para banco 0x%02x parche %d", bank, program + 1);
+        }
+    }
+    ESP_LOGI(TAG, "%d nombres de parche actualizados", fetched);
+}
+
+void patch_cache_task(void *arg) {
+    // La pedalera puede haberse conectado antes de que esta tarea existiera
+    portENTER_CRITICAL(&cache_lock);
+    cache_task_hdl = xTaskGetCurrentTaskHandle();
+    bool pending = connect_pending;
+    connect_pending = false;
+    portEXIT_CRITICAL(&cache_lock);
+    if (pending) xTaskNotify(cache_task_hdl, NOTIFY_CONNECT, eSetBits);
+
+    while (1) {
+        uint32_t bits = 0;
+        xTaskNotifyWait(0, UINT32_MAX, &bits, portMAX_DELAY);
+        if (!connected) continue;
+
+        if (bits & NOTIFY_CONNECT) {
+            // Damos tiempo a la pedalera a terminar su propio arranque
+            vTaskDelay(pdMS_TO_TICKS(CONNECT_SETTLE_MS));
+            const uint8_t editor_on[] = { 0xF0, SYSEX_MANUFACTURER_ZOOM, 0x00, SYSEX_MODEL_ZOOM_G6, ZOOM_CMD_EDITOR_ON, 0xF7 };
+            sysex_send(editor_on, sizeof(editor_on), pdMS_TO_TICKS(100));
+        }
+        fetch_missing();
+    }
+}
@@ -0,0 +1,31 @@
+#ifndef PATCH_CACHE_H
+#define PATCH_CACHE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#define PATCH_NAME_LEN 10
+
+typedef struct {
+    uint8_t bank;                   // Bank Select LSB (0x19 = Z, 0x1A = AA)
+    uint8_t program;                // Parche dentro del banco
+    char name[PATCH_NAME_LEN + 1];
+    uint32_t crc;                   // CRC-32 informado por la pedalera
+} patch_info_t;
+
+esp_err_t patch_cache_init(void);
+void patch_cache_task(void *arg);
+
+// Copia la entrada cacheada; devuelve false si aún no se ha leído o fue invalidada
+bool patch_cache_lookup(uint8_t bank, uint8_t program, patch_info_t *out);
+
+// Llamadas desde la tarea MIDI
+void patch_cache_on_connect(void);
+void patch_cache_on_disconnect(void);
+// Un banco o parche fuera de rango deja la caché sin parche actual
+void patch_cache_set_current(uint8_t bank, uint8_t program);
+// false si no hay parche actual
+bool patch_cache_get_current(uint8_t *bank, uint8_t *program);
+
+#endif
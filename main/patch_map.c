@@ -0,0 +1,64 @@
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "esp_rom_crc.h"
+#include "class_driver.h"
+#include "patch_map.h"
+
+static const char *TAG = "PATCH_MAP";
+
+// Entradas leídas directamente de flash a través de la MMU: ni copia ni parseo
+static const patch_map_header_t *map_hdr = NULL;
+static const patch_map_entry_t *map_entries = NULL;
+
+esp_err_t patch_map_init(void) {
+    const esp_partition_t *part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, PATCH_MAP_SUBTYPE, "patchmap");
+    if (!part) {
+        ESP_LOGW(TAG, "Sin particion patchmap: se usa el mapa por defecto");
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    const void *ptr;
+    esp_partition_mmap_handle_t handle;
+    esp_err_t err = esp_partition_mmap(part, 0, part->size, ESP_PARTITION_MMAP_DATA, &ptr, &handle);
+    if (err != ESP_OK) return err;
+
+    const patch_map_header_t *hdr = ptr;
+    size_t entries_size = (size_t)hdr->num_pages * hdr->num_buttons * sizeof(patch_map_entry_t);
+    if (hdr->magic != PATCH_MAP_MAGIC || hdr->version != PATCH_MAP_VERSION ||
+        hdr->num_pages == 0 || hdr->num_buttons == 0 || sizeof(*hdr) + entries_size > part->size) {
+        ESP_LOGW(TAG, "Mapa de parches vacio o invalido: se usa el mapa por defecto");
+        esp_partition_munmap(handle);
+        return ESP_ERR_INVALID_VERSION;
+    }
+
+    const patch_map_entry_t *entries = (const patch_map_entry_t *)(hdr + 1);
+    if (esp_rom_crc32_le(0, (const uint8_t *)entries, entries_size) != hdr->crc32) {
+        ESP_LOGW(TAG, "CRC del mapa de parches incorrecto: se usa el mapa por defecto");
+        esp_partition_munmap(handle);
+        return ESP_ERR_INVALID_CRC;
+    }
+
+    // Mapa válido: la proyección se queda abierta mientras dure el programa
+    map_hdr = hdr;
+    map_entries = entries;
+    ESP_LOGI(TAG, "Mapa de parches: %d paginas de %d botones", hdr->num_pages, hdr->num_buttons);
+    return ESP_OK;
+}
+
+int patch_map_num_pages(void) {
+    return map_hdr ? map_hdr->num_pages : 1;
+}
+
+patch_map_entry_t patch_map_get(int page, int button) {
+    if (map_hdr && page < map_hdr->num_pages && button < map_hdr->num_buttons) {
+        return map_entries[page * map_hdr->num_buttons + button];
+    }
+
+    // Mapa por defecto: grupos de 4 botones a partir del banco Z
+    patch_map_entry_t def = {
+        .bank_msb = 0,
+        .bank_lsb = ZOOM_G6_FIRST_BANK + button / ZOOM_G6_PATCHES_PER_BANK,
+        .program = button % ZOOM_G6_PATCHES_PER_BANK,
+    };
+    return def;
+}
@@ -0,0 +1,35 @@
+#ifndef PATCH_MAP_H
+#define PATCH_MAP_H
+
+#include <stdint.h>
+#include "esp_err.h"
+
+// Formato de la partición "patchmap" (little-endian, sin relleno):
+//   cabecera de 16 bytes + num_pages * num_buttons entradas de 4 bytes,
+//   ordenadas por página y luego por botón. Se genera con tools/patchmap.py.
+#define PATCH_MAP_MAGIC   0x50414D50 // "PMAP"
+#define PATCH_MAP_VERSION 1
+#define PATCH_MAP_SUBTYPE 0x40
+
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint8_t version;
+    uint8_t num_buttons;
+    uint8_t num_pages;
+    uint8_t reserved;
+    uint32_t crc32;     // CRC-32 de las entradas
+    uint32_t reserved2;
+} patch_map_header_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t bank_msb;
+    uint8_t bank_lsb;
+    uint8_t program;
+    uint8_t flags;
+} patch_map_entry_t;
+
+esp_err_t patch_map_init(void);
+int patch_map_num_pages(void);
+patch_map_entry_t patch_map_get(int page, int button);
+
+#endif
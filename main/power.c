@@ -0,0 +1,161 @@
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_pm.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+#include "power.h"
+
+static const char *TAG = "POWER";
+
+// Valores típicos de la hoja de datos del ESP32-S3 con los periféricos en marcha (décimas de mA).
+// Sirven para comparar modos, no sustituyen a una medida con amperímetro.
+#define MA_X10_BUSY_MAX   917 // 240 MHz, dos núcleos trabajando
+#define MA_X10_IDLE_MAX   500 // 240 MHz, núcleos en WAITI
+#define MA_X10_BUSY_MIN   431 // 80 MHz
+#define MA_X10_IDLE_MIN   250
+#define MA_X10_LIGHT_SLEEP  2 // ~240 µA
+
+#if CONFIG_APP_STANDBY_LIGHT_SLEEP
+#define LIGHT_SLEEP_ENABLED true
+#else
+#define LIGHT_SLEEP_ENABLED false
+#endif
+
+typedef struct {
+    int64_t time_us;
+    int64_t idle_us;        // Media de los dos núcleos
+    int64_t sleep_idle_us;  // Parte de idle_us con light sleep permitido
+} mode_acc_t;
+
+static SemaphoreHandle_t power_mutex = NULL;
+static StaticSemaphore_t power_mutex_buf;
+static esp_pm_lock_handle_t cpu_lock = NULL;
+static esp_pm_lock_handle_t usb_lock = NULL;
+static power_mode_t mode = POWER_ACTIVE;
+static bool usb_present = false;
+static bool pm_enabled = false;
+static mode_acc_t acc[POWER_MODES];
+static uint32_t standby_entries = 0;
+static int64_t last_us = 0;
+static uint32_t last_idle[portNUM_PROCESSORS];
+
+static bool sleep_allowed(void) {
+    return LIGHT_SLEEP_ENABLED && pm_enabled && !usb_present;
+}
+
+// Reparte el tiempo transcurrido desde la última muestra al modo en curso.
+// El contador de ejecución de FreeRTOS va en µs y es de 32 bits: la resta sin signo
+// aguanta la vuelta siempre que se muestree al menos cada 71 minutos.
+static void account(void) {
+    int64_t now = esp_timer_get_time();
+    uint32_t idle_sum = 0;
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        TaskStatus_t st;
+        vTaskGetInfo(xTaskGetIdleTaskHandleForCore(core), &st, pdFALSE, eInvalid);
+        idle_sum += st.ulRunTimeCounter - last_idle[core];
+        last_idle[core] = st.ulRunTimeCounter;
+    }
+
+    mode_acc_t *a = &acc[mode];
+    int64_t idle = idle_sum / portNUM_PROCESSORS;
+    a->time_us += now - last_us;
+    a->idle_us += idle;
+    if (mode == POWER_STANDBY && sleep_allowed()) a->sleep_idle_us += idle;
+    last_us = now;
+}
+
+esp_err_t power_init(void) {
+    // La contabilidad por modo funciona aunque no haya gestión de energía
+    power_mutex = xSemaphoreCreateMutexStatic(&power_mutex_buf);
+    if (!power_mutex) return ESP_ERR_NO_MEM;
+    last_us = esp_timer_get_time();
+#if CONFIG_PM_ENABLE
+    esp_pm_config_t pm = {
+        .max_freq_mhz = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ,
+        .min_freq_mhz = 80,
+        .light_sleep_enable = LIGHT_SLEEP_ENABLED,
+    };
+    esp_err_t err = esp_pm_configure(&pm);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Gestion de energia no disponible: %s; el standby no baja la CPU", esp_err_to_name(err));
+        return err;
+    }
+    esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "activo", &cpu_lock);
+    esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "usb", &usb_lock);
+    // Se arranca en modo activo: sin el bloqueo, DFS bajaría la CPU en cuanto hubiera un hueco
+    esp_pm_lock_acquire(cpu_lock);
+    pm_enabled = true;
+#endif
+    return ESP_OK;
+}
+
+void power_set_mode(power_mode_t new_mode) {
+    if (!power_mutex) return;
+    xSemaphoreTake(power_mutex, portMAX_DELAY);
+    account();
+    if (new_mode != mode) {
+        if (cpu_lock) {
+            if (new_mode == POWER_ACTIVE) esp_pm_lock_acquire(cpu_lock);
+            else esp_pm_lock_release(cpu_lock);
+        }
+        if (new_mode == POWER_STANDBY) standby_entries++;
+        mode = new_mode;
+    }
+    xSemaphoreGive(power_mutex);
+}
+
+void power_usb_device(bool present) {
+    if (!power_mutex) return;
+    xSemaphoreTake(power_mutex, portMAX_DELAY);
+    account();
+    if (present != usb_present && usb_lock) {
+        if (present) esp_pm_lock_acquire(usb_lock);
+        else esp_pm_lock_release(usb_lock);
+    }
+    usb_present = present;
+    xSemaphoreGive(power_mutex);
+}
+
+static uint16_t estimate(power_mode_t m, const mode_acc_t *a) {
+    if (a->time_us <= 0) return 0;
+    int64_t busy = a->time_us - a->idle_us;
+    int64_t awake_idle = a->idle_us - a->sleep_idle_us;
+    int64_t charge = a->sleep_idle_us * MA_X10_LIGHT_SLEEP;
+    // Sin gestión de energía el standby sigue a frecuencia máxima
+    if (m == POWER_ACTIVE || !pm_enabled) {
+        charge += busy * MA_X10_BUSY_MAX + awake_idle * MA_X10_IDLE_MAX;
+    } else {
+        charge += busy * MA_X10_BUSY_MIN + awake_idle * MA_X10_IDLE_MIN;
+    }
+    return (uint16_t)(charge / a->time_us);
+}
+
+void power_get_stats(power_stats_t *out) {
+    memset(out, 0, sizeof(*out));
+    if (!power_mutex) return;
+
+    xSemaphoreTake(power_mutex, portMAX_DELAY);
+    account();
+    for (int m = 0; m < POWER_MODES; m++) {
+        out->time_us[m] = acc[m].time_us;
+        out->idle_pct[m] = acc[m].time_us ? (uint8_t)(acc[m].idle_us * 100 / acc[m].time_us) : 0;
+        out->est_ma_x10[m] = estimate(m, &acc[m]);
+    }
+    out->standby_entries = standby_entries;
+    out->light_sleep_allowed = sleep_allowed();
+    out->pm_enabled = pm_enabled;
+    xSemaphoreGive(power_mutex);
+}
+
+void power_reset_stats(void) {
+    if (!power_mutex) return;
+    xSemaphoreTake(power_mutex, portMAX_DELAY);
+    // Lo transcurrido hasta ahora se cierra y se descarta; el modo en curso sigue igual
+    account();
+    memset(acc, 0, sizeof(acc));
+    standby_entries = 0;
+    xSemaphoreGive(power_mutex);
+}
@@ -0,0 +1,33 @@
+#ifndef POWER_H
+#define POWER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef enum {
+    POWER_ACTIVE,   // CPU a frecuencia máxima, escaneo cada 5 ms
+    POWER_STANDBY,  // Frecuencia mínima y light sleep automático si el USB lo permite
+    POWER_MODES
+} power_mode_t;
+
+typedef struct {
+    int64_t time_us[POWER_MODES];   // Tiempo acumulado en cada modo
+    uint8_t idle_pct[POWER_MODES];  // Fracción del tiempo en la tarea idle (media de los dos núcleos)
+    uint16_t est_ma_x10[POWER_MODES]; // Consumo medio estimado del ESP32-S3, sin LEDs (décimas de mA)
+    uint32_t standby_entries;
+    bool light_sleep_allowed;       // Ahora mismo: sin pedalera conectada y activado en Kconfig
+    bool pm_enabled;                // false si esp_pm_configure falló: CPU siempre a tope, sin light sleep
+} power_stats_t;
+
+esp_err_t power_init(void);
+void power_set_mode(power_mode_t mode);
+
+// El host USB no sobrevive a un light sleep con un dispositivo conectado
+void power_usb_device(bool present);
+
+void power_get_stats(power_stats_t *out);
+// Empieza de cero el tiempo por modo y las entradas en standby (comando `reset` de la consola)
+void power_reset_stats(void);
+
+#endif
@@ -0,0 +1,26 @@
+#include "class_driver.h"
+#include "led_feedback.h"
+#include "trace.h"
+#include "press.h"
+
+int press_msg_type(input_action_t action) {
+    switch (action) {
+    case INPUT_ACT_PATCH:
+        return MIDI_MSG_BUTTON;
+    case INPUT_ACT_SETLIST_NEXT:
+        return MIDI_MSG_SETLIST_NEXT;
+    case INPUT_ACT_SETLIST_PREV:
+        return MIDI_MSG_SETLIST_PREV;
+    default:
+        return -1;
+    }
+}
+
+bool press_post(int button, int led, uint8_t type, int page, int64_t when_us) {
+    TRACE(TRACE_EV_PRESS, button, type, 0);
+    midi_msg_t msg = { .status = type, .data1 = (uint8_t)button, .data2 = (uint8_t)page, .time_us = when_us };
+    led_feedback_press(led, when_us);
+    if (class_driver_post(&msg)) return true;
+    led_feedback_fail(when_us);
+    return false;
+}
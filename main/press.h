@@ -0,0 +1,18 @@
+#ifndef PRESS_H
+#define PRESS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "input_map.h"
+
+// Pulsación que va a la pedalera: indicador pendiente y mensaje a la tarea MIDI. La usan la
+// tarea hw (pulsar_boton) y la reproducción de grabaciones (input_rec.c y su prueba en el PC).
+
+// Tipo de mensaje (MIDI_MSG_*) de las acciones que van a la pedalera; -1 para las demás
+int press_msg_type(input_action_t action);
+
+// El color pendiente sale ya en led (-1 si el interruptor no tiene indicador propio); la tarea
+// MIDI lo confirma o lo da por fallido. Con la cola llena devuelve false y el indicador queda en fallo
+bool press_post(int button, int led, uint8_t type, int page, int64_t when_us);
+
+#endif
@@ -0,0 +1,72 @@
+#include <string.h>
+#include "setlist.h"
+
+static void put_packet(setlist_burst_t *b, uint8_t status, uint8_t d1, uint8_t d2) {
+    uint8_t *pkt = &b->pkt[b->len];
+    pkt[0] = status >> 4; // CIN = nibble alto del status en mensajes de canal
+    pkt[1] = status;
+    pkt[2] = d1;
+    pkt[3] = d2;
+    b->len += 4;
+}
+
+// Ráfaga mínima para pasar de 'from' (NULL = desconocido) a 'to'
+static void compile_transition(setlist_burst_t *b, const setlist_song_t *from, const setlist_song_t *to,
+                               uint8_t scene_cc) {
+    bool bank_changed = !from || from->bank_msb != to->bank_msb || from->bank_lsb != to->bank_lsb;
+    bool patch_changed = bank_changed || from->program != to->program;
+
+    b->len = 0;
+    // El Bank Select queda memorizado en la pedalera: solo hace falta si cambia el banco
+    if (bank_changed) {
+        put_packet(b, 0xB0, 0x00, to->bank_msb);
+        put_packet(b, 0xB0, 0x20, to->bank_lsb);
+    }
+    if (patch_changed) put_packet(b, 0xC0, to->program, 0);
+    // Un parche recién cargado arranca en su escena guardada: la de la canción va siempre detrás
+    if (to->scene != SETLIST_SCENE_NONE && (patch_changed || from->scene != to->scene)) {
+        put_packet(b, 0xB0, scene_cc, to->scene);
+    }
+}
+
+void setlist_init(setlist_t *sl) {
+    memset(sl, 0, sizeof(*sl));
+    sl->pos = -1;
+}
+
+void setlist_compile(setlist_t *sl, const setlist_song_t *songs, int count, uint8_t scene_cc) {
+    if (count < 0) count = 0;
+    if (count > SETLIST_MAX_SONGS) count = SETLIST_MAX_SONGS;
+
+    memcpy(sl->songs, songs, count * sizeof(*songs));
+    for (int i = 0; i < count; i++) {
+        compile_transition(&sl->full[i], NULL, &songs[i], scene_cc);
+        compile_transition(&sl->next[i], i > 0 ? &songs[i - 1] : NULL, &songs[i], scene_cc);
+        compile_transition(&sl->prev[i], i + 1 < count ? &songs[i + 1] : NULL, &songs[i], scene_cc);
+    }
+
+    // Con la lista cambiada no podemos fiarnos de lo que tenga cargado la pedalera
+    if (sl->pos >= count) sl->pos = -1;
+    sl->count = count;
+    sl->scene_cc = scene_cc;
+    sl->synced = false;
+}
+
+const setlist_burst_t *setlist_peek(const setlist_t *sl, int dir) {
+    int pos = sl->pos + (dir > 0 ? 1 : -1);
+    if (pos < 0 || pos >= sl->count) return NULL;
+
+    if (!sl->synced) return &sl->full[pos];
+    return dir > 0 ? &sl->next[pos] : &sl->prev[pos];
+}
+
+void setlist_commit(setlist_t *sl, int dir) {
+    int pos = sl->pos + (dir > 0 ? 1 : -1);
+    if (pos < 0 || pos >= sl->count) return;
+    sl->pos = pos;
+    sl->synced = true;
+}
+
+void setlist_desync(setlist_t *sl) {
+    sl->synced = false;
+}
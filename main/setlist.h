@@ -0,0 +1,50 @@
+#ifndef SETLIST_H
+#define SETLIST_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SETLIST_MAX_SONGS  32
+#define SETLIST_SCENE_NONE 0xFF
+// Peor caso: Bank MSB + Bank LSB + Program Change + CC de escena, en paquetes USB MIDI
+#define SETLIST_MAX_BURST  16
+
+typedef struct __attribute__((packed)) {
+    uint8_t bank_msb;
+    uint8_t bank_lsb;
+    uint8_t program;
+    uint8_t scene;      // Valor del CC de escena, o SETLIST_SCENE_NONE
+} setlist_song_t;
+
+// Paquetes USB MIDI listos para copiar a la transferencia
+typedef struct {
+    uint8_t len;
+    uint8_t pkt[SETLIST_MAX_BURST];
+} setlist_burst_t;
+
+typedef struct {
+    // next[i]: de la canción i-1 a la i; prev[i]: de la i+1 a la i; full[i]: desde un estado desconocido
+    setlist_burst_t next[SETLIST_MAX_SONGS];
+    setlist_burst_t prev[SETLIST_MAX_SONGS];
+    setlist_burst_t full[SETLIST_MAX_SONGS];
+    setlist_song_t songs[SETLIST_MAX_SONGS];
+    int count;
+    uint8_t scene_cc;   // Con el que se compilaron las ráfagas
+    int pos;            // -1 antes de la primera canción
+    bool synced;        // La pedalera está en songs[pos]: vale la transición precalculada
+} setlist_t;
+
+void setlist_init(setlist_t *sl);
+
+// Precalcula todas las transiciones; conserva la posición si sigue dentro de la lista
+void setlist_compile(setlist_t *sl, const setlist_song_t *songs, int count, uint8_t scene_cc);
+
+// Ráfaga para avanzar (dir > 0) o retroceder, o NULL en los extremos. No mueve la posición:
+// se confirma con setlist_commit() una vez que la ráfaga tiene sitio en la salida
+const setlist_burst_t *setlist_peek(const setlist_t *sl, int dir);
+void setlist_commit(setlist_t *sl, int dir);
+
+// Algo cambió el parche por otro camino: el siguiente paso manda la ráfaga completa
+void setlist_desync(setlist_t *sl);
+
+#endif
@@ -0,0 +1,166 @@
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/message_buffer.h"
+#include "esp_log.h"
+#include "class_driver.h"
+#include "sysex.h"
+
+static const char *TAG = "SYSEX";
+
+#define SYSEX_TX_BUFFER_SIZE 2048
+#define SYSEX_MAX_HANDLERS   8
+
+// Code Index Numbers (USB MIDI 1.0, tabla 4-1)
+#define CIN_SYSEX_START   0x04 // Inicio o continuación, 3 bytes
+#define CIN_SYSEX_END_1   0x05 // Fin con 1 byte (o mensaje común de 1 byte)
+#define CIN_SYSEX_END_2   0x06 // Fin con 2 bytes
+#define CIN_SYSEX_END_3   0x07 // Fin con 3 bytes
+
+typedef struct {
+    uint8_t manufacturer;
+    uint8_t model;
+    sysex_handler_t handler;
+    void *arg;
+} sysex_route_t;
+
+static MessageBufferHandle_t tx_buffer = NULL;
+static StaticMessageBuffer_t tx_buffer_struct;
+static uint8_t tx_buffer_storage[SYSEX_TX_BUFFER_SIZE + 1];
+static sysex_route_t routes[SYSEX_MAX_HANDLERS];
+static size_t num_routes = 0;
+
+// Mensaje en curso de transmisión: puede repartirse en varias transferencias
+static uint8_t tx_msg[SYSEX_MAX_TX_LEN];
+static size_t tx_len = 0;
+static size_t tx_off = 0;
+
+// Arena de recepción: los paquetes se vuelcan directamente en su posición final
+static uint8_t rx_arena[SYSEX_RX_ARENA_SIZE];
+static size_t rx_len = 0;
+static bool rx_active = false;
+static bool rx_overflow = false;
+
+esp_err_t sysex_init(void) {
+    if (tx_buffer != NULL) return ESP_OK;
+    tx_buffer = xMessageBufferCreateStatic(SYSEX_TX_BUFFER_SIZE, tx_buffer_storage, &tx_buffer_struct);
+    return tx_buffer ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+esp_err_t sysex_register_handler(uint8_t manufacturer, uint8_t model, sysex_handler_t handler, void *arg) {
+    if (!handler) return ESP_ERR_INVALID_ARG;
+    if (num_routes >= SYSEX_MAX_HANDLERS) return ESP_ERR_NO_MEM;
+    routes[num_routes++] = (sysex_route_t){ .manufacturer = manufacturer, .model = model, .handler = handler, .arg = arg };
+    return ESP_OK;
+}
+
+esp_err_t sysex_send(const uint8_t *msg, size_t len, TickType_t timeout) {
+    if (!tx_buffer) return ESP_ERR_INVALID_STATE;
+    if (!msg || len < 2 || len > SYSEX_MAX_TX_LEN || msg[0] != 0xF0 || msg[len - 1] != 0xF7) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (xMessageBufferSend(tx_buffer, msg, len, timeout) != len) return ESP_ERR_TIMEOUT;
+    class_driver_wake();
+    return ESP_OK;
+}
+
+bool sysex_tx_pending(void) {
+    return tx_off < tx_len || (tx_buffer && !xMessageBufferIsEmpty(tx_buffer));
+}
+
+bool sysex_tx_partial(void) {
+    return tx_off > 0 && tx_off < tx_len;
+}
+
+size_t sysex_pack(uint8_t *pkt, const uint8_t *msg, size_t len, size_t off) {
+    // Cada paquete USB MIDI lleva hasta 3 bytes; el CIN indica si el mensaje termina aquí
+    size_t remaining = len - off;
+    size_t chunk = remaining > 3 ? 3 : remaining;
+    pkt[0] = remaining > 3 ? CIN_SYSEX_START : (uint8_t)(CIN_SYSEX_END_1 + chunk - 1);
+    pkt[1] = pkt[2] = pkt[3] = 0;
+    memcpy(&pkt[1], &msg[off], chunk);
+    return chunk;
+}
+
+size_t sysex_tx_fill(uint8_t *buf, size_t cap) {
+    size_t used = 0;
+    while (used + 4 <= cap) {
+        if (tx_off >= tx_len) {
+            tx_len = xMessageBufferReceive(tx_buffer, tx_msg, sizeof(tx_msg), 0);
+            tx_off = 0;
+            if (tx_len == 0) break;
+        }
+
+        tx_off += sysex_pack(&buf[used], tx_msg, tx_len, tx_off);
+        used += 4;
+    }
+    return used;
+}
+
+static void dispatch(const uint8_t *msg, size_t len) {
+    if (len < 4) return;
+    for (size_t i = 0; i < num_routes; i++) {
+        if (routes[i].manufacturer == msg[1] && routes[i].model == msg[3]) {
+            routes[i].handler(msg, len, routes[i].arg);
+            return;
+        }
+    }
+    ESP_LOGD(TAG, "SysEx sin handler: fab 0x%02x modelo 0x%02x (%u bytes)", msg[1], msg[3], (unsigned)len);
+}
+
+void sysex_rx_packet(const uint8_t *pkt) {
+    uint8_t cin = pkt[0] & 0x0F;
+    size_t n;
+
+    switch (cin) {
+    case CIN_SYSEX_START:
+        if (pkt[1] == 0xF0) {
+            rx_len = 0;
+            rx_active = true;
+            rx_overflow = false;
+        }
+        n = 3;
+        break;
+    case CIN_SYSEX_END_1:
+        // Un CIN 0x5 fuera de un SysEx es un mensaje común de 1 byte, no nos interesa
+        if (!rx_active) return;
+        n = 1;
+        break;
+    case CIN_SYSEX_END_2:
+        n = 2;
+        break;
+    case CIN_SYSEX_END_3:
+        n = 3;
+        break;
+    default:
+        return;
+    }
+
+    if (!rx_active) return;
+
+    if (rx_len + n <= SYSEX_RX_ARENA_SIZE) {
+        memcpy(&rx_arena[rx_len], &pkt[1], n);
+        rx_len += n;
+    } else {
+        rx_overflow = true;
+    }
+
+    if (cin != CIN_SYSEX_START) {
+        rx_active = false;
+        if (rx_overflow) {
+            ESP_LOGW(TAG, "SysEx descartado: supera %d bytes", SYSEX_RX_ARENA_SIZE);
+        } else {
+            dispatch(rx_arena, rx_len);
+        }
+        rx_len = 0;
+    }
+}
+
+void sysex_reset(void) {
+    // Al desconectar descartamos cualquier mensaje a medias en ambos sentidos
+    rx_len = 0;
+    rx_active = false;
+    rx_overflow = false;
+    tx_len = 0;
+    tx_off = 0;
+    if (tx_buffer) xMessageBufferReset(tx_buffer);
+}
@@ -0,0 +1,45 @@
+#ifndef SYSEX_H
+#define SYSEX_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+// Identificadores SysEx de Zoom: F0 52 00 <modelo> <comando> ... F7
+#define SYSEX_MANUFACTURER_ZOOM 0x52
+#define SYSEX_MODEL_ZOOM_G6     0x64
+
+// Mensajes universales (Identity Reply: F0 7E <canal> 06 02 ... F7)
+#define SYSEX_MANUFACTURER_UNIVERSAL 0x7E
+#define SYSEX_UNIVERSAL_GENERAL_INFO 0x06
+
+#define SYSEX_MAX_TX_LEN     512
+#define SYSEX_RX_ARENA_SIZE  4096
+
+// Recibe el mensaje completo (F0 ... F7). El puntero apunta al arena de
+// recepción y solo es válido durante la llamada.
+typedef void (*sysex_handler_t)(const uint8_t *msg, size_t len, void *arg);
+
+esp_err_t sysex_init(void);
+
+// Los handlers se eligen por el byte de fabricante (msg[1]) y el de modelo (msg[3])
+esp_err_t sysex_register_handler(uint8_t manufacturer, uint8_t model, sysex_handler_t handler, void *arg);
+
+// Encola un mensaje completo (F0 ... F7) para la tarea MIDI. Seguro desde cualquier tarea.
+esp_err_t sysex_send(const uint8_t *msg, size_t len, TickType_t timeout);
+
+// Escribe en pkt el paquete USB MIDI con los bytes de msg a partir de off (hasta 3) y
+// devuelve cuántos consumió. Para quien intercala un SysEx con otros mensajes en su propio lote
+size_t sysex_pack(uint8_t *pkt, const uint8_t *msg, size_t len, size_t off);
+
+// Uso interno del class driver (se llaman desde la tarea MIDI)
+size_t sysex_tx_fill(uint8_t *buf, size_t cap);
+bool sysex_tx_pending(void);
+// Un mensaje ya empezado en el cable y sin terminar: hasta que acabe no puede salir nada más
+bool sysex_tx_partial(void);
+void sysex_rx_packet(const uint8_t *pkt);
+void sysex_reset(void);
+
+#endif
@@ -0,0 +1,145 @@
+#include <stdio.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_cpu.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "class_driver.h"
+#include "patch_cache.h"
+#include "trace.h"
+
+static const char *TAG = "TRACE";
+
+#define RING_RECORDS CONFIG_APP_TRACE_RING_RECORDS
+
+_Static_assert((RING_RECORDS & (RING_RECORDS - 1)) == 0, "El anillo de trazas debe ser potencia de 2");
+_Static_assert(sizeof(trace_rec_t) == 16, "trace_rec_t cambia el formato del volcado");
+
+// Un anillo por núcleo: la posición se reserva con un incremento atómico, así que una
+// interrupción o una tarea que migre de núcleo a mitad de escritura no pisa a nadie.
+// Cada hueco lleva además una palabra de confirmación (posición + 1) que el escritor publica
+// con release al terminar de rellenarlo y pone a 0 antes de empezar: el lector no vuelca un
+// hueco reservado y aún sin escribir, y descarta como perdido el que se pise mientras lo copia.
+static trace_rec_t ring[portNUM_PROCESSORS][RING_RECORDS];
+static uint32_t commit[portNUM_PROCESSORS][RING_RECORDS];
+static uint32_t head[portNUM_PROCESSORS];
+static uint32_t tail[portNUM_PROCESSORS];   // Solo lo toca trace_task
+static uint32_t lost = 0;
+static TaskHandle_t trace_task_hdl = NULL;
+
+#define REQUEST_FLUSH (1u << 0)
+#define REQUEST_CLEAR (1u << 1)
+
+void IRAM_ATTR trace_write(uint16_t id, uint8_t a0, uint32_t a1, uint32_t a2) {
+    int core = esp_cpu_get_core_id();
+    uint32_t pos = __atomic_fetch_add(&head[core], 1, __ATOMIC_RELAXED);
+    uint32_t slot = pos & (RING_RECORDS - 1);
+    trace_rec_t *r = &ring[core][slot];
+    __atomic_store_n(&commit[core][slot], 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    r->ts_us = (uint32_t)esp_timer_get_time();
+    r->id = id;
+    r->core = (uint8_t)core;
+    r->a0 = a0;
+    r->a1 = a1;
+    r->a2 = a2;
+    __atomic_store_n(&commit[core][slot], pos + 1, __ATOMIC_RELEASE);
+}
+
+// Líneas "T:" + 32 dígitos hexadecimales, fáciles de separar del resto del log
+static void emit(const trace_rec_t *r) {
+    const uint8_t *b = (const uint8_t *)r;
+    char line[2 + 2 * sizeof(*r) + 1];
+    line[0] = 'T';
+    line[1] = ':';
+    for (size_t i = 0; i < sizeof(*r); i++) sprintf(&line[2 + 2 * i], "%02x", b[i]);
+    puts(line);
+}
+
+// Registro en texto de los eventos que antes escribía la propia ruta crítica
+static void log_deferred(const trace_rec_t *r) {
+    char bank_name[3];
+    patch_info_t info;
+    if (r->id == TRACE_EV_PATCH) {
+        uint8_t bank = r->a1 >> 8, program = r->a1 & 0xFF;
+        ESP_LOGI(TAG, "Enviado: Pagina %lu Boton %d -> Banco %s Parche %d (%s)", (unsigned long)r->a2 + 1, r->a0,
+                 zoom_bank_name(bank, bank_name), program + 1,
+                 patch_cache_lookup(bank, program, &info) ? info.name : "?");
+    } else if (r->id == TRACE_EV_SETLIST) {
+        uint8_t bank = r->a2 >> 8, program = r->a2 & 0xFF;
+        ESP_LOGI(TAG, "Set list %d -> Banco %s Parche %d (%lu bytes)", r->a0 + 1,
+                 zoom_bank_name(bank, bank_name), program + 1, (unsigned long)r->a1);
+    }
+}
+
+static void trace_flush(void) {
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        uint32_t end = __atomic_load_n(&head[core], __ATOMIC_ACQUIRE);
+        if (end - tail[core] > RING_RECORDS) {
+            lost += end - tail[core] - RING_RECORDS;
+            tail[core] = end - RING_RECORDS;
+        }
+        while (tail[core] != end) {
+            uint32_t slot = tail[core] & (RING_RECORDS - 1);
+            uint32_t want = tail[core] + 1;
+            uint32_t seq = __atomic_load_n(&commit[core][slot], __ATOMIC_ACQUIRE);
+            if (seq != want) {
+                // Reservado pero sin terminar de escribir: se recoge en el siguiente volcado.
+                // Si ya lo ha reservado una vuelta posterior del anillo, este registro se perdió
+                if (seq != 0 && seq - want < 0x80000000u) {
+                    lost++;
+                    tail[core]++;
+                    continue;
+                }
+                break;
+            }
+            trace_rec_t r = ring[core][slot];
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            tail[core]++;
+            // Si el escritor ha dado la vuelta mientras copiábamos, la copia puede estar mezclada
+            if (__atomic_load_n(&commit[core][slot], __ATOMIC_RELAXED) != want) {
+                lost++;
+                continue;
+            }
+            emit(&r);
+            log_deferred(&r);
+        }
+    }
+    if (lost) {
+        ESP_LOGW(TAG, "%lu registros perdidos", (unsigned long)lost);
+        lost = 0;
+    }
+}
+
+// Lo pendiente se da por leído sin volcarlo, para empezar una captura limpia
+static void trace_clear(void) {
+    uint32_t dropped = 0;
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        uint32_t end = __atomic_load_n(&head[core], __ATOMIC_ACQUIRE);
+        dropped += end - tail[core];
+        tail[core] = end;
+    }
+    lost = 0;
+    ESP_LOGI(TAG, "%lu registros descartados", (unsigned long)dropped);
+}
+
+bool trace_request(bool clear) {
+    TaskHandle_t task = trace_task_hdl;
+    if (!task) return false;
+    xTaskNotify(task, clear ? REQUEST_CLEAR : REQUEST_FLUSH, eSetBits);
+    return true;
+}
+
+void trace_task(void *arg) {
+    trace_task_hdl = xTaskGetCurrentTaskHandle();
+    while (1) {
+        // Volcado periódico o en cuanto lo pide la consola
+        uint32_t bits = 0;
+        xTaskNotifyWait(0, UINT32_MAX, &bits, pdMS_TO_TICKS(CONFIG_APP_TRACE_FLUSH_MS));
+        if (bits & REQUEST_CLEAR) {
+            trace_clear();
+        } else {
+            trace_flush();
+        }
+    }
+}
@@ -0,0 +1,43 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "sdkconfig.h"
+
+// Identificadores de evento. tools/trace_decode.py tiene la misma tabla: mantenerlas iguales.
+typedef enum {
+    TRACE_EV_PRESS = 1,     // a0 = botón, a1 = tipo de mensaje (MIDI_MSG_*)
+    TRACE_EV_PATCH,         // a0 = botón, a1 = banco << 8 | parche, a2 = página
+    TRACE_EV_SETLIST,       // a0 = posición, a1 = bytes de la ráfaga, a2 = banco << 8 | parche
+    TRACE_EV_XFER_SUBMIT,   // a0 = paquetes, a1 = bytes
+    TRACE_EV_XFER_DONE,     // a0 = estado, a1 = latencia desde la pulsación (µs), 0 si no había
+    TRACE_EV_STANDBY,       // a0 = 1 al entrar, 0 al salir
+    TRACE_EV_CONNECT,       // a0 = 1 conectada, 0 desconectada
+} trace_event_t;
+
+// Registro binario de tamaño fijo, tal cual se vuelca
+typedef struct __attribute__((packed)) {
+    uint32_t ts_us;     // esp_timer truncado a 32 bits; el decodificador lo desenrolla
+    uint16_t id;
+    uint8_t core;
+    uint8_t a0;
+    uint32_t a1;
+    uint32_t a2;
+} trace_rec_t;
+
+#if CONFIG_APP_TRACE_ENABLE
+#define TRACE(id, a0, a1, a2) trace_write((id), (a0), (a1), (a2))
+#else
+#define TRACE(id, a0, a1, a2) ((void)0)
+#endif
+
+void trace_write(uint16_t id, uint8_t a0, uint32_t a1, uint32_t a2);
+void trace_task(void *arg);
+
+// Pide a trace_task que vuelque ya lo pendiente de todos los núcleos o, con clear, que lo
+// descarte sin volcarlo. Solo esa tarea avanza la lectura, así que se puede llamar desde
+// cualquier otra (la consola); false si la tarea aún no está en marcha
+bool trace_request(bool clear);
+
+#endif
@@ -3,24 +3,92 @@
 #include "freertos/task.h"
 #include "driver/gpio.h"
 #include "esp_log.h"
-#include "led_strip.h"
+#include "nvs_flash.h"
+#include "esp_cpu.h"
 #include "esp_timer.h"
 #include "usb/usb_host.h"
 #include "class_driver.h"
+#include "sysex.h"
+#include "patch_cache.h"
+#include "midi_clock.h"
+#include "expression.h"
+#include "gesture.h"
+#include "input.h"
+#include "input_map.h"
+#include "input_rec.h"
+#include "press.h"
+#include "debounce.h"
+#include "patch_map.h"
+#include "app_config.h"
+#include "power.h"
+#include "boot_prof.h"
+#include "trace.h"
+#include "hardware.h"
+#include "diag.h"
+#include "led_comp.h"
+#include "led_feedback.h"
+#include "led_out.h"
+#include "mem_layout.h"
 
-#define PIN_TIRA 39
-#define NUM_LEDS 8
-#define CANTIDAD 8
-
-// TIEMPO_STANDBY configurado a 10 minuto (600,000,000 microsegundos)
-#define TIEMPO_STANDBY (10LL * 60LL * 1000000LL)
+// Pin de la tira, número de LEDs, tiempo de standby, colores y brillo salen de app_config
+#define NUM_LEDS (configuracion.num_leds)
+#define CANTIDAD CONFIG_APP_NUM_BUTTONS
+#define PERIODO_ESCANEO_MS HW_SCAN_PERIOD_MS
+#define PERIODO_LEDS_MS 20
+#define PERIODO_LEDS_STANDBY_MS 100 // El arcoíris del standby no necesita 50 fps
+#define VENTANA_DESPERTAR_US (50LL * 1000LL) // Lo que puede tardar el antirrebote en confirmar el flanco que despertó
+#define TIEMPO_INDICADOR_PAGINA (1000LL * 1000LL)
+#define DURACION_PULSO_RELOJ_US (80LL * 1000LL)
+#define COLOR_PULSO_RELOJ 0x30, 0x30, 0x30 // Se suma a lo que haya debajo
 
 static const char *TAG = "MAIN_HW";
-static const gpio_num_t pinesBotones[CANTIDAD] = { GPIO_NUM_13, GPIO_NUM_12, GPIO_NUM_11, GPIO_NUM_10, GPIO_NUM_9, GPIO_NUM_8, GPIO_NUM_7, GPIO_NUM_6 };
-static led_strip_handle_t led_strip;
-static int ultimoLedEncendido = -1;
+// Capas de la tira, de abajo arriba: cada cosa pinta en la suya sin borrar las demás
+enum {
+    CAPA_FONDO,     // Bienvenida y arcoíris del standby
+    CAPA_PARCHE,    // Parche activo: pendiente, confirmado o fallido (led_feedback)
+    CAPA_RELOJ,     // Pulso de negra del reloj MIDI, sumado
+    CAPA_PAGINA,    // Indicador de página
+    NUM_CAPAS
+};
+static led_comp_t capas;
+static app_config_t configuracion;   // Copia de la tarea hw (app_config_sync), refrescada en cada vuelta
+static uint32_t generacionConfig = 0;
+static uint32_t versionIndicador = UINT32_MAX; // Estado de led_feedback pintado en CAPA_PARCHE
 static int64_t ultimaVezInteractuado = 0;
 static bool enModoStandBy = false;
+static gesture_engine_t gestos;
+static int pagina = 0;
+static int64_t indicadorPaginaHasta = 0; // Mientras se muestra la página no se repinta el último LED
+static bool standbyPorInterrupcion = false;  // Light sleep: el primer flanco despierta por interrupción
+static int64_t tiempoDespertar = 0;          // Flanco que despertó, hasta que su pulsación sale a la cola
+static bool despertarPendiente = false;
+static bool animandoBienvenida = false;
+static hw_stats_t hwStats;
+static volatile bool hwStatsReset = false;
+static uint32_t ciclosEnvio = 0;    // Ciclos en tira_refresh desde el último frame medido
+static led_out_frame_t ultimoEnvio;  // Inicio y fin (los LEDs ya lo muestran) del último frame
+static bool nivelEnEncoder = false; // Brillo y atenuación del standby los aplica la tabla de niveles del backend
+static int nivelAplicado = -1;
+static uint32_t estadoBotones = 0;   // Interruptores pulsados, ya filtrados de rebotes
+static uint32_t despertadores = 0;   // Botones que sacaron del standby: su pulsación no cuenta
+
+// Con el brillo en la tabla de niveles, cambiarlo (o atenuar el standby) no reescribe ningún píxel
+static void ajustar_nivel(void) {
+    if (!nivelEnEncoder) return;
+    int nivel = configuracion.brightness;
+    if (enModoStandBy && configuracion.standby_dim) nivel /= configuracion.standby_dim;
+    if (nivel != nivelAplicado) {
+        led_out_set_level(nivel);
+        nivelAplicado = nivel;
+    }
+}
+
+static void tira_refresh(void) {
+    ajustar_nivel();
+    led_out_refresh(&ultimoEnvio);
+    ciclosEnvio += ultimoEnvio.cycles;
+    hwStats.led_refresh_us += ultimoEnvio.return_us - ultimoEnvio.start_us;
+}
 
 uint32_t color_wheel(uint8_t pos) {
     pos = 255 - pos;
@@ -30,13 +98,37 @@ uint32_t color_wheel(uint8_t pos) {
     return ((uint32_t)(pos * 3) << 16) | ((uint32_t)(255 - pos * 3) << 8);
 }
 
+// Aplica el brillo global de la configuración si no lo hace el encoder
+static inline uint32_t brillo(uint32_t c) {
+    return nivelEnEncoder ? c : c * configuracion.brightness / 255;
+}
+
+static void pintar(int capa, int i, app_rgb_t c) {
+    led_comp_set(&capas, capa, i, c.r, c.g, c.b);
+}
+
+static void pintar_rueda(int i, uint32_t col) {
+    led_comp_set(&capas, CAPA_FONDO, i, (col >> 16) & 0xFF, (col >> 8) & 0xFF, col & 0xFF);
+}
+
+// Mezcla las capas y envía el frame si algo ha cambiado; el brillo se aplica aquí, a la salida
+static void enviar_frame(void) {
+    if (!led_comp_dirty(&capas)) return;
+    const int16_t *f = led_comp_render(&capas);
+    uint32_t divisor = enModoStandBy && configuracion.standby_dim && !nivelEnEncoder ? configuracion.standby_dim : 1;
+    for (int i = 0; i < NUM_LEDS; i++) {
+        led_out_set(i, brillo(f[i * 3]) / divisor, brillo(f[i * 3 + 1]) / divisor, brillo(f[i * 3 + 2]) / divisor);
+    }
+    tira_refresh();
+    hwStats.led_frames_sent++;
+}
+
 void efectoStandBy(void) {
     static uint8_t hue = 0;
     for (int j = 0; j < NUM_LEDS; j++) {
-        uint32_t col = color_wheel((hue + j * 32) & 255);
-        led_strip_set_pixel(led_strip, j, ((col >> 16) & 0xFF) / 10, ((col >> 8) & 0xFF) / 10, (col & 0xFF) / 10);
+        pintar_rueda(j, color_wheel((hue + j * 32) & 255));
     }
-    led_strip_refresh(led_strip);
+    enviar_frame();
     hue++;
 }
 
@@ -47,8 +139,8 @@ void secuencia_bloqueante_inicial(void) {
 
     // 1. Azul
     for (int i = 0; i < NUM_LEDS; i++) {
-        led_strip_set_pixel(led_strip, i, 0, 0, 100); 
-        led_strip_refresh(led_strip);
+        pintar(CAPA_FONDO, i, configuracion.color_welcome);
+        enviar_frame();
         vTaskDelay(pdMS_TO_TICKS(50));
     }
     vTaskDelay(pdMS_TO_TICKS(5000));
@@ -57,79 +149,365 @@ void secuencia_bloqueante_inicial(void) {
     for (int loops = 0; loops < 4; loops++) {
         for (int hue = 0; hue < 256; hue += 5) {
             for (int j = 0; j < NUM_LEDS; j++) {
-                uint32_t col = color_wheel((hue + j * 32) & 255);
-                led_strip_set_pixel(led_strip, j, (col >> 16) & 0xFF, (col >> 8) & 0xFF, col & 0xFF);
+                pintar_rueda(j, color_wheel((hue + j * 32) & 255));
             }
-            led_strip_refresh(led_strip);
+            enviar_frame();
             vTaskDelay(pdMS_TO_TICKS(10));
         }
     }
 
     // 3. Morado 4 veces
     for (int i = 0; i < 4; i++) {
-        for (int j = 0; j < NUM_LEDS; j++) led_strip_set_pixel(led_strip, j, 150, 0, 200);
-        led_strip_refresh(led_strip);
+        for (int j = 0; j < NUM_LEDS; j++) pintar(CAPA_FONDO, j, configuracion.color_ready);
+        enviar_frame();
         vTaskDelay(pdMS_TO_TICKS(300));
-        led_strip_clear(led_strip);
-        led_strip_refresh(led_strip);
+        led_comp_clear(&capas, CAPA_FONDO);
+        enviar_frame();
         vTaskDelay(pdMS_TO_TICKS(300));
     }
     ESP_LOGI(TAG, "Hardware listo.");
 }
 
+// La misma bienvenida, calculada a partir del tiempo transcurrido para pintarla
+// desde el bucle de escaneo sin bloquearlo. Devuelve false cuando ha terminado.
+static bool bienvenida_frame(int64_t transcurrido_us) {
+    int64_t ms = transcurrido_us / 1000;
+
+    // 1. Azul, un LED cada 50 ms, y se mantiene 5 s
+    int64_t fase = NUM_LEDS * 50 + 5000;
+    if (ms < fase) {
+        int encendidos = ms / 50 + 1;
+        for (int i = 0; i < encendidos && i < NUM_LEDS; i++) pintar(CAPA_FONDO, i, configuracion.color_welcome);
+        enviar_frame();
+        return true;
+    }
+    ms -= fase;
+
+    // 2. Arcoiris 4 veces: 52 pasos de 10 ms por vuelta
+    fase = 4 * 52 * 10;
+    if (ms < fase) {
+        int hue = (ms / 10 % 52) * 5;
+        for (int j = 0; j < NUM_LEDS; j++) pintar_rueda(j, color_wheel((hue + j * 32) & 255));
+        enviar_frame();
+        return true;
+    }
+    ms -= fase;
+
+    // 3. Morado 4 veces
+    if (ms < 4 * 600) {
+        if (ms % 600 < 300) {
+            for (int j = 0; j < NUM_LEDS; j++) pintar(CAPA_FONDO, j, configuracion.color_ready);
+        } else {
+            led_comp_clear(&capas, CAPA_FONDO);
+        }
+        enviar_frame();
+        return true;
+    }
+    return false;
+}
+
+// Pinta el indicador del parche si su estado cambió (pulsación, confirmación, fallo o tiempo agotado)
+static void actualizar_indicador(int64_t ahora) {
+    led_fb_view_t v;
+    led_feedback_poll(ahora, &v);
+    if (v.version == versionIndicador) return;
+    versionIndicador = v.version;
+
+    led_comp_clear(&capas, CAPA_PARCHE);
+    if (v.led < 0 || v.state == LED_FB_IDLE) return;
+    app_rgb_t c = configuracion.color_failed;
+    if (v.state == LED_FB_PENDING) c = configuracion.color_pending;
+    else if (v.state == LED_FB_COMMITTED) c = configuracion.color_active;
+    pintar(CAPA_PARCHE, v.led, c);
+}
+
+static void pulsar_boton(int i, uint8_t tipo, int64_t cuando) {
+    if (tiempoDespertar != 0 && cuando == tiempoDespertar) {
+        tipo |= MIDI_MSG_FLAG_WAKE;
+        tiempoDespertar = 0;
+    }
+    press_post(i, i < NUM_LEDS ? i : -1, tipo, pagina, cuando);
+    led_comp_clear(&capas, CAPA_PAGINA);
+    indicadorPaginaHasta = 0;
+    actualizar_indicador(esp_timer_get_time());
+    uint32_t enviados = hwStats.led_frames_sent;
+    enviar_frame();
+    if (i < NUM_LEDS && hwStats.led_frames_sent != enviados) led_feedback_photon(cuando, ultimoEnvio.start_us, ultimoEnvio.done_us);
+}
+
+// Cambia de página y la muestra en azul en el LED de su mismo número
+static void cambiar_pagina(int delta, int64_t ahora) {
+    int paginas = patch_map_num_pages();
+    pagina = (pagina + delta + paginas) % paginas;
+    ESP_LOGI(TAG, "Pagina %d de %d", pagina + 1, paginas);
+
+    led_feedback_clear(); // El parche activo pertenece a otra página
+    actualizar_indicador(ahora);
+    led_comp_clear(&capas, CAPA_PAGINA);
+    pintar(CAPA_PAGINA, pagina % NUM_LEDS, configuracion.color_page);
+    enviar_frame();
+    indicadorPaginaHasta = ahora + TIEMPO_INDICADOR_PAGINA;
+}
+
+static void on_gesture(const gesture_t *g, void *arg) {
+    input_action_t accion = input_map_gesture(g, patch_map_num_pages());
+    // Parche y pasos del set list: el mismo camino que la reproducción de grabaciones
+    int tipo = press_msg_type(accion);
+    if (tipo >= 0) {
+        pulsar_boton(g->button, tipo, g->time_us);
+        return;
+    }
+    switch (accion) {
+#if CONFIG_APP_MIDI_CLOCK_ENABLE && CONFIG_APP_TAP_TEMPO_BUTTON >= 0
+    case INPUT_ACT_TAP_TEMPO:
+        midi_clock_tap(g->time_us);
+        break;
+    case INPUT_ACT_CLOCK_TOGGLE:
+        midi_clock_toggle();
+        break;
+#endif
+    case INPUT_ACT_PAGE_DOWN:
+        cambiar_pagina(-1, g->time_us);
+        break;
+    case INPUT_ACT_PAGE_UP:
+        cambiar_pagina(1, g->time_us);
+        break;
+    default:
+        if (g->type == GESTURE_LONG_PRESS) ESP_LOGI(TAG, "Pulsacion larga en boton %d", g->button);
+        else if (g->type == GESTURE_DOUBLE_TAP) ESP_LOGI(TAG, "Doble toque en boton %d", g->button);
+        else if (g->type == GESTURE_CHORD) ESP_LOGI(TAG, "Acorde de botones %d + %d", g->button, g->button2);
+        break;
+    }
+}
+
+static void entrar_standby(void) {
+    enModoStandBy = true;
+    // El arcoíris ocupa toda la tira: las capas de encima se ocultan sin perder su contenido
+    for (int c = CAPA_FONDO + 1; c < NUM_CAPAS; c++) led_comp_layer_alpha(&capas, c, 0);
+    despertarPendiente = false;
+    tiempoDespertar = 0;
+    power_set_mode(POWER_STANDBY);
+    TRACE(TRACE_EV_STANDBY, 1, 0, 0);
+#if CONFIG_APP_STANDBY_LIGHT_SLEEP
+    ulTaskNotifyTake(pdTRUE, 0);
+    standbyPorInterrupcion = input_arm_wakeup(xTaskGetCurrentTaskHandle()) == ESP_OK;
+#endif
+}
+
+static void salir_standby(void) {
+    enModoStandBy = false;
+    power_set_mode(POWER_ACTIVE);
+    TRACE(TRACE_EV_STANDBY, 0, 0, 0);
+    if (standbyPorInterrupcion) {
+        input_disarm_wakeup();
+        standbyPorInterrupcion = false;
+        tiempoDespertar = input_wakeup_time();
+        despertarPendiente = tiempoDespertar != 0;
+    }
+    led_comp_clear(&capas, CAPA_FONDO);
+    for (int c = CAPA_FONDO + 1; c < NUM_CAPAS; c++) led_comp_layer_alpha(&capas, c, 255);
+    enviar_frame();
+
+    power_stats_t p;
+    power_get_stats(&p);
+    ESP_LOGI(TAG, "Fin del standby: inactivo %d%% del tiempo, ~%d.%d mA (activo: inactivo %d%%, ~%d.%d mA)",
+             p.idle_pct[POWER_STANDBY], p.est_ma_x10[POWER_STANDBY] / 10, p.est_ma_x10[POWER_STANDBY] % 10,
+             p.idle_pct[POWER_ACTIVE], p.est_ma_x10[POWER_ACTIVE] / 10, p.est_ma_x10[POWER_ACTIVE] % 10);
+}
+
+#if CONFIG_APP_MIDI_CLOCK_ENABLE && CONFIG_APP_TAP_TEMPO_BUTTON >= 0
+// Destello en el LED del interruptor de tap con cada negra enviada a la pedalera
+static void pulso_reloj(int64_t ahora) {
+    static uint32_t negra = 0;
+    static int64_t hasta = 0;
+    if (CONFIG_APP_TAP_TEMPO_BUTTON >= NUM_LEDS) return;
+    midi_clock_stats_t s;
+    midi_clock_get_stats(&s);
+    uint32_t n = s.ticks_sent / MIDI_CLOCK_PPQN;
+    if (midi_clock_running() && n != negra) {
+        negra = n;
+        hasta = ahora + DURACION_PULSO_RELOJ_US;
+        led_comp_set(&capas, CAPA_RELOJ, CONFIG_APP_TAP_TEMPO_BUTTON, COLOR_PULSO_RELOJ);
+    } else if (hasta && ahora >= hasta) {
+        hasta = 0;
+        led_comp_unset(&capas, CAPA_RELOJ, CONFIG_APP_TAP_TEMPO_BUTTON);
+    }
+}
+#endif
+
+void hardware_get_stats(hw_stats_t *out) {
+    // Solo la tarea hw escribe; basta una copia
+    *out = hwStats;
+}
+
+// Lleva a los gestos los interruptores que cambiaron respecto a estadoBotones; cuando es el
+// instante del escaneo que confirmó el cambio
+static void aplicar_estado(uint32_t estado, int64_t cuando) {
+    uint32_t cambios = estado ^ estadoBotones;
+    estadoBotones = estado;
+    while (cambios) {
+        int i = __builtin_ctz(cambios);
+        uint32_t bit = 1u << i;
+        bool pulsado = (estado & bit) != 0;
+        cambios &= cambios - 1;
+        ultimaVezInteractuado = cuando;
+        if (animandoBienvenida) {
+            // Pisar un interruptor corta la bienvenida
+            animandoBienvenida = false;
+            boot_prof_mark(BOOT_WELCOME_DONE);
+            led_comp_clear(&capas, CAPA_FONDO);
+            enviar_frame();
+        }
+
+        // Sondeando en standby, la pulsación que despierta no cuenta
+        if (pulsado && enModoStandBy) {
+            salir_standby();
+            despertadores |= bit;
+            continue;
+        }
+        if (despertadores & bit) {
+            if (!pulsado) despertadores &= ~bit;
+            continue;
+        }
+        // Tras un despertar por interrupción la pulsación sí cuenta, desde el flanco original
+        int64_t flanco = cuando;
+        if (pulsado && despertarPendiente) {
+            flanco = tiempoDespertar;
+            despertarPendiente = false;
+        }
+        gesture_edge(&gestos, i, pulsado, flanco);
+    }
+}
+
+void hardware_reset_stats(void) {
+    hwStatsReset = true;
+}
+
 void hardware_control_task(void *arg) {
-    led_strip_config_t strip_config = { .strip_gpio_num = PIN_TIRA, .max_leds = NUM_LEDS, .led_pixel_format = LED_PIXEL_FORMAT_GRB, .led_model = LED_MODEL_WS2812 };
-    led_strip_rmt_config_t rmt_config = { .clk_src = RMT_CLK_SRC_DEFAULT, .resolution_hz = 10000000 };
-    led_strip_new_rmt_device(&strip_config, &rmt_config, &led_strip);
+    // Primero los interruptores: es lo único que hace falta para aceptar pulsaciones
+    if (input_init() != ESP_OK) {
+        ESP_LOGE(TAG, "No se pudo iniciar la lectura de interruptores");
+    }
+    boot_prof_mark(BOOT_INPUT);
 
-    for (int i = 0; i < CANTIDAD; i++) {
-        gpio_reset_pin(pinesBotones[i]);
-        gpio_set_direction(pinesBotones[i], GPIO_MODE_INPUT);
-        gpio_set_pull_mode(pinesBotones[i], GPIO_PULLUP_ONLY);
+    app_config_sync(&configuracion, &generacionConfig);
+    if (led_out_init(configuracion.led_gpio) != ESP_OK) {
+        ESP_LOGE(TAG, "No se pudo crear la tira de LEDs");
     }
+    nivelEnEncoder = led_out_level_in_encoder();
+    led_comp_init(&capas, NUM_CAPAS);
+    led_comp_layer_mode(&capas, CAPA_RELOJ, LED_BLEND_ADD);
+    boot_prof_mark(BOOT_LEDS);
 
+    gesture_init(&gestos, CANTIDAD, on_gesture, NULL);
+    input_map_bind(&gestos, patch_map_num_pages());
+
+#if CONFIG_APP_FAST_READY
+    // La bienvenida se pinta desde el bucle: los interruptores funcionan desde ya
+    ESP_LOGI(TAG, "Iniciando secuencia de bienvenida...");
+    animandoBienvenida = true;
+#else
     secuencia_bloqueante_inicial();
+    boot_prof_mark(BOOT_WELCOME_DONE);
+#endif
     ultimaVezInteractuado = esp_timer_get_time();
+    int64_t inicioBienvenida = ultimaVezInteractuado;
+    boot_prof_mark(BOOT_READY);
+    boot_prof_log();
+
+#if !INPUT_SCANS_ITSELF
+    debounce_t rebotes = {0};
+#endif
+    int64_t ultimoFrame = 0;
 
     while (1) {
+        if (hwStatsReset) {
+            hwStatsReset = false;
+            hwStats = (hw_stats_t){0};
+        }
+        // Un ajuste en directo desde la consola se aplica en la siguiente vuelta
+        app_config_sync(&configuracion, &generacionConfig);
+#if INPUT_SCANS_ITSELF
+        // El escaneo ya filtró y fechó cada cambio: aquí solo se recogen
+        input_event_t evento;
+        while (input_next_event(&evento)) {
+            input_rec_scan(evento.time_us, evento.raw);
+            aplicar_estado(evento.stable, evento.time_us);
+        }
         int64_t tiempoAhora = esp_timer_get_time();
-        bool algunBotonPulsado = false;
-
-        for (int i = 0; i < CANTIDAD; i++) {
-            if (gpio_get_level(pinesBotones[i]) == 0) { 
-                algunBotonPulsado = true;
-                if (enModoStandBy) {
-                    enModoStandBy = false;
-                    led_strip_clear(led_strip);
-                } else {
-                    if (midi_msg_queue != NULL) {
-                        midi_msg_t msg = { .data1 = (uint8_t)i }; 
-                        xQueueSend(midi_msg_queue, &msg, 0);
-                    }
-                    led_strip_clear(led_strip);
-                    led_strip_set_pixel(led_strip, i, 0, 200, 0); // Verde para todos
-                    ultimoLedEncendido = i;
+        aplicar_estado(input_stable(), tiempoAhora);
+#else
+        int64_t tiempoAhora = esp_timer_get_time();
+        uint32_t lectura = input_read();
+        input_rec_scan(tiempoAhora, lectura);
+        debounce_scan(&rebotes, lectura);
+        aplicar_estado(rebotes.stable, tiempoAhora);
+#endif
+        gesture_poll(&gestos, tiempoAhora);
+
+        if (despertarPendiente && tiempoAhora - tiempoDespertar > VENTANA_DESPERTAR_US) {
+            // Falsa alarma: el flanco no llegó a ser una pulsación
+            despertarPendiente = false;
+            tiempoDespertar = 0;
+        }
+
+        // Los LEDs se siguen refrescando al ritmo de antes aunque el escaneo sea más rápido
+        int periodoLeds = enModoStandBy ? PERIODO_LEDS_STANDBY_MS : PERIODO_LEDS_MS;
+        if (tiempoAhora - ultimoFrame >= periodoLeds * 1000LL) {
+            ultimoFrame = tiempoAhora;
+            int64_t standby_us = configuracion.standby_s * 1000000LL;
+            uint32_t ciclosFrame = esp_cpu_get_cycle_count();
+            uint32_t enviados = hwStats.led_frames_sent;
+            ciclosEnvio = 0;
+            if (animandoBienvenida) {
+                if (!bienvenida_frame(tiempoAhora - inicioBienvenida)) {
+                    animandoBienvenida = false;
+                    led_comp_clear(&capas, CAPA_FONDO);
+                    boot_prof_mark(BOOT_WELCOME_DONE);
+                    ESP_LOGI(TAG, "Hardware listo.");
+                }
+            } else if (estadoBotones == 0 && (tiempoAhora - ultimaVezInteractuado > standby_us)) {
+                if (!enModoStandBy) entrar_standby();
+                efectoStandBy();
+            } else {
+                if (indicadorPaginaHasta && tiempoAhora >= indicadorPaginaHasta) {
+                    indicadorPaginaHasta = 0;
+                    led_comp_clear(&capas, CAPA_PAGINA);
                 }
-                led_strip_refresh(led_strip);
-                ultimaVezInteractuado = tiempoAhora;
-                vTaskDelay(pdMS_TO_TICKS(250)); 
+                actualizar_indicador(tiempoAhora);
+#if CONFIG_APP_MIDI_CLOCK_ENABLE && CONFIG_APP_TAP_TEMPO_BUTTON >= 0
+                pulso_reloj(tiempoAhora);
+#endif
+                // Solo se envía si alguna capa ha cambiado desde el último frame
+                enviar_frame();
+            }
+            if (hwStats.led_frames_sent == enviados) hwStats.led_frames_skipped++;
+            if (hwStats.led_frames_sent != enviados) {
+                // Coste de componer el frame en CPU, sin la espera del envío por RMT
+                hwStats.led_compose_cycles += esp_cpu_get_cycle_count() - ciclosFrame - ciclosEnvio;
+                hwStats.led_timed_frames++;
             }
         }
 
-        if (!algunBotonPulsado && (tiempoAhora - ultimaVezInteractuado > TIEMPO_STANDBY)) {
-            enModoStandBy = true;
-            efectoStandBy(); 
-        } else if (!enModoStandBy && ultimoLedEncendido != -1 && !algunBotonPulsado) {
-            led_strip_set_pixel(led_strip, ultimoLedEncendido, 0, 200, 0);
-            led_strip_refresh(led_strip);
+        if (standbyPorInterrupcion) {
+            // Nada que sondear: dormimos hasta el siguiente frame o hasta que un interruptor nos despierte
+            if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(PERIODO_LEDS_STANDBY_MS)) > 0) salir_standby();
+        } else {
+#if INPUT_SCANS_ITSELF
+            // Un cambio encolado por el escaneo despierta a la tarea sin esperar a la vuelta siguiente
+            input_wait_event(pdMS_TO_TICKS(PERIODO_ESCANEO_MS));
+#else
+            vTaskDelay(pdMS_TO_TICKS(PERIODO_ESCANEO_MS));
+#endif
         }
-        vTaskDelay(pdMS_TO_TICKS(20));
     }
 }
 
 void usb_host_lib_task(void *arg) {
     const usb_host_config_t host_config = { .intr_flags = ESP_INTR_FLAG_LEVEL1 };
     usb_host_install(&host_config);
+    boot_prof_mark(BOOT_USB_INSTALL);
+    // La tarea MIDI espera a esta notificación para registrarse como cliente
     xTaskNotifyGive((TaskHandle_t)arg);
     while (1) {
         usb_host_lib_handle_events(portMAX_DELAY, NULL);
@@ -138,18 +516,69 @@ void usb_host_lib_task(void *arg) {
 
 // ESTA PARTE ES LA QUE FALTABA O TENÍA ERROR DE ENLACE
 void app_main(void) {
+    boot_prof_mark(BOOT_APP_MAIN);
     ESP_LOGI(TAG, "Iniciando Aplicacion...");
-    midi_msg_queue = xQueueCreate(10, sizeof(midi_msg_t));
+#if CONFIG_APP_STATIC_MEMORY
+    static StaticQueue_t colaMidiEstado;
+    static uint8_t colaMidiBuf[MIDI_QUEUE_LEN * sizeof(midi_msg_t)];
+    midi_msg_queue = xQueueCreateStatic(MIDI_QUEUE_LEN, sizeof(midi_msg_t), colaMidiBuf, &colaMidiEstado);
+#else
+    midi_msg_queue = xQueueCreate(MIDI_QUEUE_LEN, sizeof(midi_msg_t));
+#endif
+    esp_err_t err = nvs_flash_init();
+    if (err == ESP_ERR_NVS_NO_FREE_PAGES || err == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        ESP_ERROR_CHECK(nvs_flash_erase());
+        err = nvs_flash_init();
+    }
+    ESP_ERROR_CHECK(err);
+    app_config_init();
+    boot_prof_mark(BOOT_CONFIG);
+    power_init();
+    sysex_init();
+    patch_map_init();
+    patch_cache_init();
+    midi_clock_init();
+#if CONFIG_APP_MIDI_CLOCK_ENABLE
+    midi_clock_set_bpm(CONFIG_APP_MIDI_CLOCK_BPM);
+#endif
     
+    // Los manejadores se guardan para el consumo de CPU y la pila en la consola de diagnóstico
+    TaskHandle_t hdl;
+
     // Core 1 para Hardware y LEDs
-    xTaskCreatePinnedToCore(hardware_control_task, "hw", 4096, NULL, 5, NULL, 1);
-    
+    hdl = APP_TASK_CREATE(hardware_control_task, "hw", STACK_HW, NULL, 5, 1);
+    diag_watch_task(hdl, STACK_HW);
+
+    // Tarea MIDI: se crea ya y espera ella sola a que el host USB esté instalado,
+    // así app_main no bloquea y la instalación corre en paralelo con los interruptores
+    TaskHandle_t midi_hdl = APP_TASK_CREATE(class_driver_task, "midi", STACK_MIDI, NULL, 3, 0);
+    diag_watch_task(midi_hdl, STACK_MIDI);
+
     // Core 0 para USB
-    TaskHandle_t main_hdl = xTaskGetCurrentTaskHandle();
-    xTaskCreatePinnedToCore(usb_host_lib_task, "usb", 4096, (void *)main_hdl, 2, NULL, 0);
-    
-    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
-    
-    // Tarea MIDI
-    xTaskCreatePinnedToCore(class_driver_task, "midi", 4096, NULL, 3, NULL, 0);
+    hdl = APP_TASK_CREATE(usb_host_lib_task, "usb", STACK_USB, (void *)midi_hdl, 2, 0);
+    diag_watch_task(hdl, STACK_USB);
+
+    // Lectura de nombres de parche en segundo plano, por debajo de todo lo demás
+    hdl = APP_TASK_CREATE(patch_cache_task, "cache", STACK_CACHE, NULL, 1, 0);
+    diag_watch_task(hdl, STACK_CACHE);
+
+    // Las escrituras de configuración en NVS van agrupadas en su propia tarea de baja prioridad
+    hdl = APP_TASK_CREATE(app_config_task, "cfg", STACK_CFG, NULL, 1, 0);
+    diag_watch_task(hdl, STACK_CFG);
+
+#if CONFIG_APP_TRACE_ENABLE
+    // El volcado de trazas es lo último: solo corre cuando nadie más tiene trabajo
+    hdl = APP_TASK_CREATE(trace_task, "trace", STACK_TRACE, NULL, 0, 0);
+    diag_watch_task(hdl, STACK_TRACE);
+#endif
+
+#if CONFIG_APP_EXPRESSION_ENABLE
+    // El pedal de expresión comparte el core 1 con los botones, justo por debajo de ellos
+    hdl = APP_TASK_CREATE(expression_task, "expr", STACK_EXPR, NULL, 4, 1);
+    diag_watch_task(hdl, STACK_EXPR);
+#endif
+
+#if CONFIG_APP_CONSOLE_ENABLE
+    diag_console_start();
+#endif
 }
\ No newline at end of file
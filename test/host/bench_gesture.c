@@ -0,0 +1,51 @@
+// Rendimiento de gesture.c en el PC: flancos por segundo con los cuatro tipos de gesto
+// activos y coste de gesture_poll() con y sin temporizadores pendientes.
+#include <stdio.h>
+#include <stdlib.h>
+#include "host_bench.h"
+#include "gesture.h"
+
+static void on_gesture(const gesture_t *g, void *arg) {
+    bench_sink += g->type + g->button;
+}
+
+int main(int argc, char **argv) {
+    int rounds = argc > 1 ? atoi(argv[1]) : 200000;
+    gesture_engine_t e;
+    gesture_init(&e, 32, on_gesture, NULL);
+    for (int b = 0; b < 32; b++) {
+        static const uint8_t binds[] = { 0, GESTURE_BIND_LONG, GESTURE_BIND_DOUBLE, GESTURE_BIND_CHORD };
+        gesture_bind(&e, b, binds[b % 4]);
+    }
+
+    // Cada ronda pisa y suelta los 32 botones con separaciones que provocan todos los gestos
+    int64_t t = 0, edges = 0, polls = 0;
+    int64_t start = bench_now_ns();
+    for (int r = 0; r < rounds; r++) {
+        for (int b = 0; b < 32; b++) {
+            gesture_edge(&e, b, true, t);
+            gesture_poll(&e, t);
+            t += 5000 + (b % 4) * 20000;
+            gesture_edge(&e, b, false, t);
+            gesture_poll(&e, t);
+            edges += 2;
+            polls += 2;
+        }
+        t += 700000;
+        gesture_poll(&e, t);
+        polls++;
+    }
+    int64_t busy_ns = bench_now_ns() - start;
+
+    // Sin nada pendiente, sondear es comparar con next_deadline_us
+    gesture_poll(&e, t + 1000000);
+    start = bench_now_ns();
+    for (int i = 0; i < rounds * 10; i++) gesture_poll(&e, t + 1000000 + i);
+    int64_t idle_ns = bench_now_ns() - start;
+
+    printf("gesture: %lld flancos y %lld sondeos en %.1f ms: %.1f ns por operacion, %.1f M flancos/s\n",
+           (long long)edges, (long long)polls, busy_ns / 1e6, (double)busy_ns / (edges + polls),
+           edges * 1e3 / busy_ns);
+    printf("gesture_poll sin temporizadores: %.2f ns\n", (double)idle_ns / (rounds * 10));
+    return 0;
+}
@@ -0,0 +1,47 @@
+// Rendimiento de led_comp.c en el PC con los núcleos escalares: cada núcleo sobre todos los
+// canales de la tira y un render de 4 capas (una de cada modo) con cobertura al azar.
+// Las versiones PIE solo corren en la placa: `ledcomp` da allí los ciclos de las dos.
+#include <stdio.h>
+#include <stdlib.h>
+#include "host_bench.h"
+#include "led_comp.h"
+
+static led_comp_t comp __attribute__((aligned(16)));
+
+static double time_kernel(void (*f)(int16_t *, const int16_t *, const int16_t *, size_t), int rounds) {
+    int16_t *a = comp.layer[0].px, *b = comp.layer[1].px, *out = comp.tmp;
+    int64_t start = bench_now_ns();
+    for (int r = 0; r < rounds; r++) {
+        f(out, a, b, LED_COMP_LANES);
+        bench_sink += out[r % LED_COMP_LANES];
+    }
+    return (double)(bench_now_ns() - start) / rounds;
+}
+
+int main(int argc, char **argv) {
+    int rounds = argc > 1 ? atoi(argv[1]) : 1000000;
+    led_comp_init(&comp, 4);
+    led_comp_use(&comp, &led_comp_scalar);
+    srand(46);
+    for (int l = 0; l < 4; l++) {
+        led_comp_layer_mode(&comp, l, (led_blend_t)(l % 4));
+        led_comp_layer_alpha(&comp, l, l == 0 ? 255 : rand());
+        for (int i = 0; i < LED_COMP_MAX_LEDS; i++) {
+            if (rand() & 1) led_comp_set(&comp, l, i, rand(), rand(), rand());
+        }
+    }
+
+    printf("%d LEDs (%d canales), nucleos %s\n", LED_COMP_MAX_LEDS, LED_COMP_LANES, comp.k->name);
+    printf("add %.1f ns, max %.1f ns, mul %.1f ns, mix %.1f ns\n",
+           time_kernel(led_comp_scalar.add, rounds), time_kernel(led_comp_scalar.max, rounds),
+           time_kernel(led_comp_scalar.mul, rounds), time_kernel(led_comp_scalar.mix, rounds));
+
+    int64_t start = bench_now_ns();
+    for (int r = 0; r < rounds; r++) {
+        // Un cambio por frame, como el pulso del reloj
+        led_comp_set(&comp, 2, r % LED_COMP_MAX_LEDS, r, r >> 8, 0);
+        bench_sink += led_comp_render(&comp)[0];
+    }
+    printf("render de 4 capas: %.1f ns\n", (double)(bench_now_ns() - start) / rounds);
+    return 0;
+}
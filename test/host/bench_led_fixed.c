@@ -0,0 +1,76 @@
+// led_strip_fixed.h frente a led_strip con tabla de funciones, los dos sobre el driver RMT simulado:
+// coste de escribir los píxeles y de codificar el frame (lo que en el chip hacen la tarea y las
+// interrupciones del RMT). El tiempo de envío por el cable no cuenta: el reloj del mock es aparte.
+// La columna de frame incluye los encoders de bytes y copia del mock, que no son los de ESP-IDF:
+// sirve para seguir un mismo backend entre versiones; la de píxeles compara los dos backends.
+#include <stdio.h>
+#include <stdlib.h>
+#include "sdkconfig.h"
+#include "host_bench.h"
+#include "mock_rmt.h"
+#include "led_strip.h"
+
+#define LED_STRIP_FIXED_LEN   CONFIG_APP_NUM_LEDS
+#define LED_STRIP_FIXED_BPP   3
+#define LED_STRIP_FIXED_MODEL LED_STRIP_FIXED_MODEL_WS2812
+#include "led_strip_fixed.h"
+
+static int64_t bench_fixed(int frames, int64_t *set_ns) {
+    static led_strip_fixed_t strip;
+    if (led_strip_fixed_init(&strip, 39) != ESP_OK) {
+        fprintf(stderr, "led_strip_fixed_init\n");
+        exit(1);
+    }
+    int64_t set = 0, start = bench_now_ns();
+    for (int f = 0; f < frames; f++) {
+        int64_t t0 = bench_now_ns();
+        for (uint32_t i = 0; i < LED_STRIP_FIXED_LEN; i++) led_strip_fixed_set(&strip, i, (i + f) & 0x1F, f & 0xFF, 0);
+        set += bench_now_ns() - t0;
+        led_strip_fixed_refresh(&strip);
+    }
+    int64_t total = bench_now_ns() - start;
+    bench_sink += strip.pixels[0];
+    strip.encoder.base.del(&strip.encoder.base);
+    rmt_del_channel(strip.chan);
+    *set_ns = set;
+    return total;
+}
+
+static int64_t bench_generic(int frames, int64_t *set_ns) {
+    led_strip_config_t strip_config = {
+        .strip_gpio_num = 39,
+        .max_leds = CONFIG_APP_NUM_LEDS,
+        .led_pixel_format = LED_PIXEL_FORMAT_GRB,
+        .led_model = LED_MODEL_WS2812,
+    };
+    led_strip_rmt_config_t rmt_config = { .clk_src = RMT_CLK_SRC_DEFAULT, .resolution_hz = 10000000 };
+    led_strip_handle_t strip;
+    if (led_strip_new_rmt_device(&strip_config, &rmt_config, &strip) != ESP_OK) {
+        fprintf(stderr, "led_strip_new_rmt_device\n");
+        exit(1);
+    }
+    int64_t set = 0, start = bench_now_ns();
+    for (int f = 0; f < frames; f++) {
+        int64_t t0 = bench_now_ns();
+        for (uint32_t i = 0; i < CONFIG_APP_NUM_LEDS; i++) led_strip_set_pixel(strip, i, (i + f) & 0x1F, f & 0xFF, 0);
+        set += bench_now_ns() - t0;
+        led_strip_refresh(strip);
+    }
+    int64_t total = bench_now_ns() - start;
+    led_strip_del(strip);
+    *set_ns = set;
+    return total;
+}
+
+int main(int argc, char **argv) {
+    int frames = argc > 1 ? atoi(argv[1]) : 200000;
+    int64_t fixed_set, generic_set;
+    int64_t fixed = bench_fixed(frames, &fixed_set);
+    int64_t generic = bench_generic(frames, &generic_set);
+
+    printf("%d LEDs, %d frames\n", CONFIG_APP_NUM_LEDS, frames);
+    printf("%-10s %12s %12s\n", "backend", "pixeles ns", "frame ns");
+    printf("%-10s %12.1f %12.1f\n", "fijo", (double)fixed_set / frames, (double)fixed / frames);
+    printf("%-10s %12.1f %12.1f\n", "led_strip", (double)generic_set / frames, (double)generic / frames);
+    return 0;
+}
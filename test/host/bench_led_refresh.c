@@ -0,0 +1,68 @@
+// El barrido de `ledbench` sobre el RMT simulado: por longitud y configuración, interrupciones
+// medidas, duración del frame en el cable (reloj simulado) y coste de codificarlo en el PC.
+#include <stdio.h>
+#include <stdlib.h>
+#include "host_bench.h"
+#include "mock_rmt.h"
+#include "led_strip.h"
+
+typedef struct {
+    const char *name;
+    size_t mem_block_symbols;       // 0 = led_strip_rmt_config_for_length()
+    bool dma;
+} bench_case_t;
+
+static const uint32_t lengths[] = { 8, 32, 64, 144, 300 };
+
+static const bench_case_t cases[] = {
+    { "rmt", 48, false },
+    { "rmt", 96, false },
+    { "rmt", 192, false },
+    { "rmt+dma", 1024, true },
+    { "rmt+dma", 4096, true },
+    { "auto", 0, false },
+};
+
+int main(int argc, char **argv) {
+    int frames = argc > 1 ? atoi(argv[1]) : 2000;
+    printf("%5s %-8s %6s %9s %6s %11s\n", "leds", "backend", "bloque", "us/frame", "isr", "ns cpu/frame");
+    for (size_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++) {
+        for (size_t k = 0; k < sizeof(cases) / sizeof(cases[0]); k++) {
+            uint32_t len = lengths[l];
+            led_strip_rmt_config_t cfg = {
+                .resolution_hz = 10000000,
+                .mem_block_symbols = cases[k].mem_block_symbols,
+                .flags.with_dma = cases[k].dma,
+            };
+            if (cases[k].mem_block_symbols == 0) led_strip_rmt_config_for_length(len, LED_PIXEL_FORMAT_GRB, &cfg);
+            led_strip_config_t strip_config = {
+                .strip_gpio_num = 39,
+                .max_leds = len,
+                .led_pixel_format = LED_PIXEL_FORMAT_GRB,
+                .led_model = LED_MODEL_WS2812,
+            };
+            led_strip_handle_t strip;
+            if (led_strip_new_rmt_device(&strip_config, &cfg, &strip) != ESP_OK) {
+                fprintf(stderr, "sin canal para %lu LEDs\n", (unsigned long)len);
+                return 1;
+            }
+            rmt_channel_handle_t chan;
+            led_strip_rmt_get_channel(strip, &chan);
+
+            int64_t start = bench_now_ns();
+            for (int f = 0; f < frames; f++) {
+                for (uint32_t i = 0; i < len; i++) led_strip_set_pixel(strip, i, (i + f) & 0x1F, 0, 0);
+                led_strip_refresh(strip);
+            }
+            int64_t cpu = bench_now_ns() - start;
+            mock_rmt_stats_t st;
+            mock_rmt_get_stats(chan, &st);
+
+            const char *name = cases[k].mem_block_symbols ? cases[k].name : cfg.flags.with_dma ? "auto/dma" : "auto/rmt";
+            printf("%5lu %-8s %6zu %9.1f %6lu %11.0f\n", (unsigned long)len, name, cfg.mem_block_symbols,
+                   (st.end_ns - st.start_ns) / 1e3, (unsigned long)st.isr, (double)cpu / frames);
+            led_strip_del(strip);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,31 @@
+// Módulos de main/ a los que llama la tarea MIDI pero que las pruebas de class_driver.c no
+// ejercitan: pedal de expresión, energía y arranque (el SysEx está en fake_sysex.c). No hacen
+// nada; lo que llega por el camino de los cambios de parche es todo código de main/
+#include "class_driver.h"
+#include "expression.h"
+#include "power.h"
+#include "boot_prof.h"
+
+bool expression_take(int64_t now_us, uint8_t *value, int64_t *sample_us) {
+    return false;
+}
+
+int64_t expression_wait_us(int64_t now_us) {
+    return -1;
+}
+
+void expression_record_tx(int64_t done_us, int64_t sample_us, uint32_t count) {
+}
+
+void power_usb_device(bool present) {
+}
+
+void boot_prof_mark(boot_phase_t phase) {
+}
+
+int64_t boot_prof_get(boot_phase_t phase) {
+    return 1;
+}
+
+void boot_prof_log(void) {
+}
@@ -0,0 +1,33 @@
+// SysEx apagado para las pruebas de class_driver.c que no lo ejercitan: nada sale ni se
+// encola. Las que sí lo necesitan enlazan main/sysex.c sobre los búferes de mock_os.c
+#include "sysex.h"
+
+esp_err_t sysex_register_handler(uint8_t manufacturer, uint8_t model, sysex_handler_t handler, void *arg) {
+    return ESP_OK;
+}
+
+esp_err_t sysex_send(const uint8_t *msg, size_t len, TickType_t timeout) {
+    return ESP_ERR_TIMEOUT;
+}
+
+size_t sysex_pack(uint8_t *pkt, const uint8_t *msg, size_t len, size_t off) {
+    return len - off;
+}
+
+size_t sysex_tx_fill(uint8_t *buf, size_t cap) {
+    return 0;
+}
+
+bool sysex_tx_pending(void) {
+    return false;
+}
+
+bool sysex_tx_partial(void) {
+    return false;
+}
+
+void sysex_rx_packet(const uint8_t *pkt) {
+}
+
+void sysex_reset(void) {
+}
@@ -0,0 +1,18 @@
+#ifndef HOST_BENCH_H
+#define HOST_BENCH_H
+
+#include <stdint.h>
+#include <time.h>
+
+// Reloj para las medidas de rendimiento en el PC. Los números sirven para comparar
+// versiones en la misma máquina, no como estimación de lo que tarda el ESP32-S3.
+static inline int64_t bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// Evita que el compilador elimine un resultado que no se usa
+static volatile uint32_t bench_sink;
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+#include <stdio.h>
+
+// Comprobaciones mínimas: cada fallo se imprime y la prueba sigue; main devuelve
+// HOST_TEST_RESULT() para que ctest la marque como fallida
+static int host_test_failures = 0;
+
+#define CHECK(cond) do {                                                          \
+    if (!(cond)) {                                                                \
+        fprintf(stderr, "%s:%d: fallo: %s\n", __FILE__, __LINE__, #cond);        \
+        host_test_failures++;                                                     \
+    }                                                                             \
+} while (0)
+
+#define CHECK_EQ(a, b) do {                                                       \
+    long long a_ = (long long)(a), b_ = (long long)(b);                           \
+    if (a_ != b_) {                                                               \
+        fprintf(stderr, "%s:%d: fallo: %s == %s (%lld != %lld)\n", __FILE__,      \
+                __LINE__, #a, #b, a_, b_);                                        \
+        host_test_failures++;                                                     \
+    }                                                                             \
+} while (0)
+
+#define HOST_TEST_RESULT() (host_test_failures ? (printf("%d fallos\n", host_test_failures), 1) : (printf("ok\n"), 0))
+
+#endif
@@ -0,0 +1,155 @@
+// Servicios de ESP-IDF para el código de main/ compilado en el PC, sobre el reloj del RMT simulado
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "esp_cpu.h"
+#include "esp_err.h"
+#include "esp_partition.h"
+#include "esp_rom_crc.h"
+#include "esp_timer.h"
+#include "nvs.h"
+#include "mock_idf.h"
+#include "mock_rmt.h"
+
+int64_t esp_timer_get_time(void) {
+    return mock_rmt_now_ns() / 1000;
+}
+
+uint32_t esp_cpu_get_cycle_count(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000000000LL + ts.tv_nsec);
+}
+
+const char *esp_err_to_name(esp_err_t code) {
+    static char buf[16];
+    snprintf(buf, sizeof(buf), "0x%x", code);
+    return buf;
+}
+
+uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t *buf, uint32_t len) {
+    crc = ~crc;
+    for (uint32_t i = 0; i < len; i++) {
+        crc ^= buf[i];
+        for (int b = 0; b < 8; b++) crc = (crc >> 1) ^ (0xEDB88320u & -(crc & 1));
+    }
+    return ~crc;
+}
+
+// Sin NVS hasta que la prueba llama a mock_idf_nvs_init(): los módulos arrancan con sus valores
+// por defecto y no guardan nada. Con ella, unas pocas claves en memoria por espacio de nombres
+#define NVS_MAX_KEYS  8
+#define NVS_MAX_BLOB  512
+
+typedef struct {
+    char ns[16];
+    char key[16];
+    uint8_t data[NVS_MAX_BLOB];
+    size_t len;
+} nvs_entry_t;
+
+static bool nvs_ready;
+static nvs_entry_t nvs_entries[NVS_MAX_KEYS];
+static char nvs_namespaces[NVS_MAX_KEYS][16];
+static int nvs_commit_count;
+
+void mock_idf_nvs_init(void) {
+    memset(nvs_entries, 0, sizeof(nvs_entries));
+    memset(nvs_namespaces, 0, sizeof(nvs_namespaces));
+    nvs_commit_count = 0;
+    nvs_ready = true;
+}
+
+int mock_idf_nvs_commits(void) {
+    return nvs_commit_count;
+}
+
+// El manejador es el índice del espacio de nombres más uno
+static nvs_entry_t *nvs_find(nvs_handle_t handle, const char *key, bool create) {
+    if (handle == 0 || handle > NVS_MAX_KEYS) return NULL;
+    const char *ns = nvs_namespaces[handle - 1];
+    nvs_entry_t *free_entry = NULL;
+    for (int i = 0; i < NVS_MAX_KEYS; i++) {
+        nvs_entry_t *e = &nvs_entries[i];
+        if (e->ns[0] && strcmp(e->ns, ns) == 0 && strcmp(e->key, key) == 0) return e;
+        if (!e->ns[0] && !free_entry) free_entry = e;
+    }
+    if (!create || !free_entry) return NULL;
+    snprintf(free_entry->ns, sizeof(free_entry->ns), "%s", ns);
+    snprintf(free_entry->key, sizeof(free_entry->key), "%s", key);
+    return free_entry;
+}
+
+esp_err_t nvs_open(const char *name, nvs_open_mode_t mode, nvs_handle_t *out) {
+    if (!nvs_ready) return ESP_ERR_NVS_NOT_FOUND;
+    for (int i = 0; i < NVS_MAX_KEYS; i++) {
+        if (!nvs_namespaces[i][0]) snprintf(nvs_namespaces[i], sizeof(nvs_namespaces[i]), "%s", name);
+        if (strcmp(nvs_namespaces[i], name) == 0) {
+            *out = i + 1;
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NVS_NOT_FOUND;
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out, size_t *len) {
+    nvs_entry_t *e = nvs_find(handle, key, false);
+    if (!e) return ESP_ERR_NVS_NOT_FOUND;
+    if (out && *len < e->len) return ESP_ERR_NVS_INVALID_LENGTH;
+    if (out) memcpy(out, e->data, e->len);
+    *len = e->len;
+    return ESP_OK;
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t len) {
+    if (len > NVS_MAX_BLOB) return ESP_ERR_NVS_INVALID_LENGTH;
+    nvs_entry_t *e = nvs_find(handle, key, true);
+    if (!e) return ESP_ERR_NVS_NOT_FOUND;
+    memcpy(e->data, value, len);
+    e->len = len;
+    return ESP_OK;
+}
+
+esp_err_t nvs_erase_key(nvs_handle_t handle, const char *key) {
+    nvs_entry_t *e = nvs_find(handle, key, false);
+    if (!e) return ESP_ERR_NVS_NOT_FOUND;
+    memset(e, 0, sizeof(*e));
+    return ESP_OK;
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle) {
+    if (handle == 0 || handle > NVS_MAX_KEYS) return ESP_ERR_NVS_NOT_FOUND;
+    nvs_commit_count++;
+    return ESP_OK;
+}
+
+void nvs_close(nvs_handle_t handle) {
+}
+
+// Sin particiones salvo la que prepare la prueba; sin ella el mapa de parches es el de por defecto
+static esp_partition_t partition;
+static const void *partition_data;
+
+void mock_idf_set_partition(const char *label, const void *data, size_t size) {
+    partition = (esp_partition_t){ .type = ESP_PARTITION_TYPE_DATA, .size = size };
+    snprintf(partition.label, sizeof(partition.label), "%s", label);
+    partition_data = data;
+}
+
+const esp_partition_t *esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype,
+                                                const char *label) {
+    return partition_data && label && strcmp(label, partition.label) == 0 ? &partition : NULL;
+}
+
+esp_err_t esp_partition_mmap(const esp_partition_t *part, size_t offset, size_t size,
+                             esp_partition_mmap_memory_t memory, const void **out_ptr,
+                             esp_partition_mmap_handle_t *out_handle) {
+    if (part != &partition || offset + size > part->size) return ESP_ERR_NOT_FOUND;
+    *out_ptr = (const uint8_t *)partition_data + offset;
+    *out_handle = 1;
+    return ESP_OK;
+}
+
+void esp_partition_munmap(esp_partition_mmap_handle_t handle) {
+}
@@ -0,0 +1,17 @@
+#ifndef MOCK_IDF_H
+#define MOCK_IDF_H
+
+// Servicios de ESP-IDF de mock_idf.c que la prueba puede preparar
+#include <stddef.h>
+
+// Una partición en memoria: esp_partition_find_first() la encuentra por su etiqueta y
+// esp_partition_mmap() devuelve data tal cual. data tiene que seguir ahí mientras se use
+void mock_idf_set_partition(const char *label, const void *data, size_t size);
+
+// NVS en memoria, vacío. Sin llamarlo nvs_open() falla como en una placa sin partición y los
+// módulos se quedan con sus valores por defecto
+void mock_idf_nvs_init(void);
+// Llamadas a nvs_commit() desde mock_idf_nvs_init()
+int mock_idf_nvs_commits(void);
+
+#endif
@@ -0,0 +1,302 @@
+// FreeRTOS y esp_timer de un solo hilo (ver mock_os.h)
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/message_buffer.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "mock_rmt.h"
+#include "mock_os.h"
+
+#define MAX_QUEUES  16
+#define MAX_TIMERS  16
+#define MAX_MESSAGE_BUFFERS 4
+// Una espera sin límite de la que no sale nadie acabaría colgando ctest
+#define FOREVER_MS  (3600 * 1000)
+
+struct QueueDefinition {
+    bool used;
+    uint8_t *items;
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t count;
+    UBaseType_t head;
+};
+
+// Mensajes seguidos en storage, cada uno tras su longitud; recibir desplaza el resto al principio
+struct MessageBufferDefinition {
+    uint8_t *storage;
+    size_t size;
+    size_t used;
+};
+
+struct esp_timer {
+    bool used;
+    bool active;
+    esp_timer_cb_t cb;
+    void *arg;
+    int64_t due_us;
+    uint64_t period_us;     // 0 = una sola vez
+};
+
+static struct QueueDefinition queues[MAX_QUEUES];
+static struct esp_timer timers[MAX_TIMERS];
+static struct MessageBufferDefinition message_buffers[MAX_MESSAGE_BUFFERS];
+static void (*background)(void);
+static bool in_background;
+static uint32_t notify_value;
+// La única tarea: un identificador cualquiera distinto de NULL
+static int test_task;
+
+void mock_os_set_background(void (*fn)(void)) {
+    background = fn;
+}
+
+void mock_os_reset(void) {
+    for (int i = 0; i < MAX_QUEUES; i++) free(queues[i].items);
+    memset(queues, 0, sizeof(queues));
+    memset(timers, 0, sizeof(timers));
+    memset(message_buffers, 0, sizeof(message_buffers));
+    background = NULL;
+    notify_value = 0;
+}
+
+static void run_timers(void) {
+    int64_t now = esp_timer_get_time();
+    for (int i = 0; i < MAX_TIMERS; i++) {
+        struct esp_timer *t = &timers[i];
+        if (!t->used || !t->active || t->due_us > now) continue;
+        if (t->period_us) {
+            t->due_us += t->period_us;
+        } else {
+            t->active = false;
+        }
+        t->cb(t->arg);
+    }
+}
+
+// Un milisegundo de espera de la prueba. false si no se puede esperar más: se agotó el tiempo
+// límite o quien espera es la propia función de fondo
+static bool wait_step(TickType_t ticks, uint32_t *waited) {
+    if (in_background || *waited >= ticks || *waited >= FOREVER_MS) {
+        if (*waited >= FOREVER_MS) fprintf(stderr, "mock_os: espera sin fin\n");
+        return false;
+    }
+    (*waited)++;
+    mock_rmt_advance_ns(1000000);
+    run_timers();
+    if (background) {
+        in_background = true;
+        background();
+        in_background = false;
+    }
+    return true;
+}
+
+void mock_os_run_ms(uint32_t ms) {
+    uint32_t waited = 0;
+    while (wait_step(ms, &waited)) {
+    }
+}
+
+// ---- Tareas ----
+
+void vTaskDelay(TickType_t ticks) {
+    // Dentro del fondo el respiro no cuenta: el siguiente milisegundo lo da la prueba
+    if (!in_background) mock_os_run_ms(ticks);
+}
+
+TickType_t xTaskGetTickCount(void) {
+    return (TickType_t)(esp_timer_get_time() / 1000);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+    return (TaskHandle_t)&test_task;
+}
+
+BaseType_t xTaskNotify(TaskHandle_t task, uint32_t value, eNotifyAction action) {
+    switch (action) {
+    case eSetBits: notify_value |= value; break;
+    case eIncrement: notify_value++; break;
+    case eSetValueWithOverwrite: notify_value = value; break;
+    default: break;
+    }
+    return pdPASS;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    return xTaskNotify(task, 0, eIncrement);
+}
+
+BaseType_t xTaskNotifyWait(uint32_t clear_on_entry, uint32_t clear_on_exit, uint32_t *value, TickType_t ticks) {
+    notify_value &= ~clear_on_entry;
+    uint32_t waited = 0;
+    while (notify_value == 0) {
+        if (!wait_step(ticks, &waited)) return pdFALSE;
+    }
+    if (value) *value = notify_value;
+    notify_value &= ~clear_on_exit;
+    return pdTRUE;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks) {
+    uint32_t waited = 0;
+    while (notify_value == 0) {
+        if (!wait_step(ticks, &waited)) return 0;
+    }
+    uint32_t v = notify_value;
+    notify_value = clear ? 0 : v - 1;
+    return v;
+}
+
+// ---- Colas y semáforos ----
+
+static QueueHandle_t queue_new(UBaseType_t length, UBaseType_t item_size) {
+    for (int i = 0; i < MAX_QUEUES; i++) {
+        if (queues[i].used) continue;
+        queues[i] = (struct QueueDefinition){ .used = true, .length = length, .item_size = item_size };
+        // Los semáforos son colas sin datos: solo cuentan
+        if (item_size) queues[i].items = calloc(length, item_size);
+        return &queues[i];
+    }
+    return NULL;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size) {
+    return queue_new(length, item_size);
+}
+
+BaseType_t xQueueSend(QueueHandle_t q, const void *item, TickType_t ticks) {
+    uint32_t waited = 0;
+    while (q->count == q->length) {
+        if (!wait_step(ticks, &waited)) return pdFALSE;
+    }
+    memcpy(q->items + ((q->head + q->count) % q->length) * q->item_size, item, q->item_size);
+    q->count++;
+    return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t q, void *item, TickType_t ticks) {
+    uint32_t waited = 0;
+    while (q->count == 0) {
+        if (!wait_step(ticks, &waited)) return pdFALSE;
+    }
+    memcpy(item, q->items + q->head * q->item_size, q->item_size);
+    q->head = (q->head + 1) % q->length;
+    q->count--;
+    return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q) {
+    return q->count;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t *buf) {
+    return queue_new(1, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t *buf) {
+    SemaphoreHandle_t m = queue_new(1, 0);
+    if (m) m->count = 1;
+    return m;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks) {
+    uint32_t waited = 0;
+    while (sem->count == 0) {
+        if (!wait_step(ticks, &waited)) return pdFALSE;
+    }
+    sem->count--;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) {
+    if (sem->count == sem->length) return pdFALSE;
+    sem->count++;
+    return pdTRUE;
+}
+
+// ---- Búferes de mensajes ----
+
+MessageBufferHandle_t xMessageBufferCreateStatic(size_t size, uint8_t *storage, StaticMessageBuffer_t *buf) {
+    for (int i = 0; i < MAX_MESSAGE_BUFFERS; i++) {
+        if (message_buffers[i].storage) continue;
+        message_buffers[i] = (struct MessageBufferDefinition){ .storage = storage, .size = size };
+        return &message_buffers[i];
+    }
+    return NULL;
+}
+
+size_t xMessageBufferSend(MessageBufferHandle_t mb, const void *data, size_t len, TickType_t ticks) {
+    if (mb->used + sizeof(size_t) + len > mb->size) return 0;
+    memcpy(mb->storage + mb->used, &len, sizeof(len));
+    memcpy(mb->storage + mb->used + sizeof(len), data, len);
+    mb->used += sizeof(len) + len;
+    return len;
+}
+
+size_t xMessageBufferReceive(MessageBufferHandle_t mb, void *data, size_t cap, TickType_t ticks) {
+    size_t len;
+    if (mb->used == 0) return 0;
+    memcpy(&len, mb->storage, sizeof(len));
+    if (len > cap) return 0;
+    memcpy(data, mb->storage + sizeof(len), len);
+    mb->used -= sizeof(len) + len;
+    memmove(mb->storage, mb->storage + sizeof(len) + len, mb->used);
+    return len;
+}
+
+BaseType_t xMessageBufferIsEmpty(MessageBufferHandle_t mb) {
+    return mb->used == 0;
+}
+
+BaseType_t xMessageBufferReset(MessageBufferHandle_t mb) {
+    mb->used = 0;
+    return pdPASS;
+}
+
+// ---- esp_timer ----
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *args, esp_timer_handle_t *out) {
+    for (int i = 0; i < MAX_TIMERS; i++) {
+        if (timers[i].used) continue;
+        timers[i] = (struct esp_timer){ .used = true, .cb = args->callback, .arg = args->arg };
+        *out = &timers[i];
+        return ESP_OK;
+    }
+    return ESP_ERR_NO_MEM;
+}
+
+static esp_err_t timer_start(esp_timer_handle_t t, uint64_t timeout_us, uint64_t period_us) {
+    if (t->active) return ESP_ERR_INVALID_STATE;
+    t->active = true;
+    t->due_us = esp_timer_get_time() + (int64_t)timeout_us;
+    t->period_us = period_us;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t t, uint64_t timeout_us) {
+    return timer_start(t, timeout_us, 0);
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t t, uint64_t period_us) {
+    return timer_start(t, period_us, period_us);
+}
+
+esp_err_t esp_timer_restart(esp_timer_handle_t t, uint64_t timeout_us) {
+    if (!t->active) return ESP_ERR_INVALID_STATE;
+    t->active = false;
+    return timer_start(t, timeout_us, t->period_us ? timeout_us : 0);
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t t) {
+    if (!t->active) return ESP_ERR_INVALID_STATE;
+    t->active = false;
+    return ESP_OK;
+}
+
+bool esp_timer_is_active(esp_timer_handle_t t) {
+    return t->active;
+}
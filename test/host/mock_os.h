@@ -0,0 +1,19 @@
+#ifndef MOCK_OS_H
+#define MOCK_OS_H
+
+// FreeRTOS y temporizadores de esp_timer simulados para las pruebas en el PC, sobre el reloj de
+// mock_rmt.c. Solo corre la tarea de la prueba; el resto del sistema (la tarea MIDI) es una
+// función de fondo. Cuando la prueba se bloquea con tiempo límite (vTaskDelay, xSemaphoreTake,
+// xQueueReceive...), cada milisegundo de espera avanza el reloj, dispara los temporizadores
+// vencidos y da una vuelta a la función de fondo. Dentro de ella las esperas no bloquean.
+#include <stdint.h>
+
+void mock_os_set_background(void (*fn)(void));
+
+// Espera ms milisegundos dejando correr el fondo, como un vTaskDelay() de la prueba
+void mock_os_run_ms(uint32_t ms);
+
+// Borra colas, semáforos, temporizadores y notificaciones (no el reloj)
+void mock_os_reset(void);
+
+#endif
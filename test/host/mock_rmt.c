@@ -0,0 +1,482 @@
+// Driver RMT simulado (ver mock_rmt.h). Los encoders de bytes, copia y simple siguen la misma
+// interfaz que los de ESP-IDF: escriben en la ventana [mem_off, mem_end) del canal y devuelven
+// RMT_ENCODING_MEM_FULL cuando se llena, para seguir en la siguiente llamada.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mock_rmt.h"
+
+struct rmt_channel_t {
+    bool used;
+    bool enabled;
+    bool dma;
+    int blocks;                     // Bloques de memoria ocupados, desde el propio canal
+    size_t mem_symbols;             // Memoria del canal o buffer DMA
+    uint32_t resolution_hz;
+    rmt_sync_manager_handle_t sync;
+    rmt_tx_done_callback_t on_done;
+    void *user;
+
+    // Ventana que el encoder puede escribir en la llamada en curso
+    rmt_symbol_word_t *mem;
+    size_t mem_off;
+    size_t mem_end;
+
+    // Trama: codificada entera en rmt_transmit(), ocupa el canal de start_ns a end_ns
+    rmt_symbol_word_t *frame;
+    size_t frame_len;
+    size_t frame_cap;
+    int64_t frame_ns;
+    bool armed;                     // En cola esperando al resto del gestor de sincronización
+    bool busy;
+    mock_rmt_stats_t stats;
+};
+
+struct rmt_sync_manager_t {
+    rmt_channel_handle_t chans[MOCK_RMT_CHANNELS];
+    size_t num;
+};
+
+static struct rmt_channel_t channels[MOCK_RMT_CHANNELS];
+static int64_t now_ns;
+static uint32_t stalls;
+static int64_t wake_delay_ns;
+
+// ---- Encoders ----
+
+typedef struct {
+    rmt_encoder_t base;
+    rmt_symbol_word_t bit0;
+    rmt_symbol_word_t bit1;
+    bool msb_first;
+    size_t pos;                     // Bit (bytes) o símbolo (copia) por el que va la sesión
+} mock_encoder_t;
+
+typedef struct {
+    rmt_encoder_t base;
+    rmt_encode_simple_cb_t callback;
+    void *arg;
+    size_t min_chunk;
+    size_t written;                 // symbols_written que se pasa a la función
+    bool done;
+    rmt_symbol_word_t *ovf;         // Un trozo mínimo que no cabía en la memoria
+    size_t ovf_len;
+    size_t ovf_pos;
+} mock_simple_encoder_t;
+
+static rmt_encode_state_t window_state(const struct rmt_channel_t *ch, rmt_encode_state_t state) {
+    return ch->mem_off == ch->mem_end ? state | RMT_ENCODING_MEM_FULL : state;
+}
+
+static size_t encode_bytes(rmt_encoder_t *encoder, rmt_channel_handle_t ch, const void *data, size_t size,
+                           rmt_encode_state_t *ret_state) {
+    mock_encoder_t *e = (mock_encoder_t *)encoder;
+    const uint8_t *bytes = data;
+    size_t n = 0;
+    for (; e->pos < size * 8; e->pos++, n++) {
+        if (ch->mem_off == ch->mem_end) {
+            *ret_state = RMT_ENCODING_MEM_FULL;
+            return n;
+        }
+        int bit = e->pos % 8;
+        int v = (bytes[e->pos / 8] >> (e->msb_first ? 7 - bit : bit)) & 1;
+        ch->mem[ch->mem_off++] = v ? e->bit1 : e->bit0;
+    }
+    e->pos = 0;
+    *ret_state = window_state(ch, RMT_ENCODING_COMPLETE);
+    return n;
+}
+
+static size_t encode_copy(rmt_encoder_t *encoder, rmt_channel_handle_t ch, const void *data, size_t size,
+                          rmt_encode_state_t *ret_state) {
+    mock_encoder_t *e = (mock_encoder_t *)encoder;
+    const rmt_symbol_word_t *symbols = data;
+    size_t n = 0;
+    for (; e->pos < size / sizeof(rmt_symbol_word_t); e->pos++, n++) {
+        if (ch->mem_off == ch->mem_end) {
+            *ret_state = RMT_ENCODING_MEM_FULL;
+            return n;
+        }
+        ch->mem[ch->mem_off++] = symbols[e->pos];
+    }
+    e->pos = 0;
+    *ret_state = window_state(ch, RMT_ENCODING_COMPLETE);
+    return n;
+}
+
+static size_t encode_simple(rmt_encoder_t *encoder, rmt_channel_handle_t ch, const void *data, size_t size,
+                            rmt_encode_state_t *ret_state) {
+    mock_simple_encoder_t *e = (mock_simple_encoder_t *)encoder;
+    size_t n = 0;
+    for (;;) {
+        // Primero lo que quedó del trozo que no cabía
+        while (e->ovf_pos < e->ovf_len) {
+            if (ch->mem_off == ch->mem_end) {
+                *ret_state = RMT_ENCODING_MEM_FULL;
+                return n;
+            }
+            ch->mem[ch->mem_off++] = e->ovf[e->ovf_pos++];
+            n++;
+        }
+        if (e->done) break;
+        size_t free_symbols = ch->mem_end - ch->mem_off;
+        if (free_symbols == 0) {
+            *ret_state = RMT_ENCODING_MEM_FULL;
+            return n;
+        }
+        size_t len = e->callback(data, size, e->written, free_symbols, &ch->mem[ch->mem_off], &e->done, e->arg);
+        if (len == 0 && !e->done) {
+            // No cabe ni un trozo mínimo: se codifica aparte y se copia en esta y la siguiente ventana
+            e->ovf_len = e->callback(data, size, e->written, e->min_chunk, e->ovf, &e->done, e->arg);
+            e->ovf_pos = 0;
+            e->written += e->ovf_len;
+            if (e->ovf_len == 0 && !e->done) {
+                *ret_state = RMT_ENCODING_RESET;
+                return n;
+            }
+            continue;
+        }
+        ch->mem_off += len;
+        e->written += len;
+        n += len;
+    }
+    e->written = 0;
+    e->done = false;
+    e->ovf_len = e->ovf_pos = 0;
+    *ret_state = window_state(ch, RMT_ENCODING_COMPLETE);
+    return n;
+}
+
+static esp_err_t reset_encoder(rmt_encoder_t *encoder) {
+    ((mock_encoder_t *)encoder)->pos = 0;
+    return ESP_OK;
+}
+
+static esp_err_t reset_simple(rmt_encoder_t *encoder) {
+    mock_simple_encoder_t *e = (mock_simple_encoder_t *)encoder;
+    e->written = 0;
+    e->done = false;
+    e->ovf_len = e->ovf_pos = 0;
+    return ESP_OK;
+}
+
+static esp_err_t del_encoder(rmt_encoder_t *encoder) {
+    free(encoder);
+    return ESP_OK;
+}
+
+static esp_err_t del_simple(rmt_encoder_t *encoder) {
+    free(((mock_simple_encoder_t *)encoder)->ovf);
+    free(encoder);
+    return ESP_OK;
+}
+
+esp_err_t rmt_new_bytes_encoder(const rmt_bytes_encoder_config_t *config, rmt_encoder_handle_t *ret_encoder) {
+    if (!config || !ret_encoder) return ESP_ERR_INVALID_ARG;
+    mock_encoder_t *e = calloc(1, sizeof(*e));
+    if (!e) return ESP_ERR_NO_MEM;
+    e->base = (rmt_encoder_t){ .encode = encode_bytes, .reset = reset_encoder, .del = del_encoder };
+    e->bit0 = config->bit0;
+    e->bit1 = config->bit1;
+    e->msb_first = config->flags.msb_first;
+    *ret_encoder = &e->base;
+    return ESP_OK;
+}
+
+esp_err_t rmt_new_copy_encoder(const rmt_copy_encoder_config_t *config, rmt_encoder_handle_t *ret_encoder) {
+    if (!config || !ret_encoder) return ESP_ERR_INVALID_ARG;
+    mock_encoder_t *e = calloc(1, sizeof(*e));
+    if (!e) return ESP_ERR_NO_MEM;
+    e->base = (rmt_encoder_t){ .encode = encode_copy, .reset = reset_encoder, .del = del_encoder };
+    *ret_encoder = &e->base;
+    return ESP_OK;
+}
+
+esp_err_t rmt_new_simple_encoder(const rmt_simple_encoder_config_t *config, rmt_encoder_handle_t *ret_encoder) {
+    if (!config || !ret_encoder || !config->callback) return ESP_ERR_INVALID_ARG;
+    mock_simple_encoder_t *e = calloc(1, sizeof(*e));
+    size_t min_chunk = config->min_chunk_size ? config->min_chunk_size : 64;
+    rmt_symbol_word_t *ovf = calloc(min_chunk, sizeof(rmt_symbol_word_t));
+    if (!e || !ovf) {
+        free(e);
+        free(ovf);
+        return ESP_ERR_NO_MEM;
+    }
+    e->base = (rmt_encoder_t){ .encode = encode_simple, .reset = reset_simple, .del = del_simple };
+    e->callback = config->callback;
+    e->arg = config->arg;
+    e->min_chunk = min_chunk;
+    e->ovf = ovf;
+    *ret_encoder = &e->base;
+    return ESP_OK;
+}
+
+esp_err_t rmt_del_encoder(rmt_encoder_handle_t encoder) {
+    if (!encoder) return ESP_ERR_INVALID_ARG;
+    return encoder->del(encoder);
+}
+
+esp_err_t rmt_encoder_reset(rmt_encoder_handle_t encoder) {
+    if (!encoder) return ESP_ERR_INVALID_ARG;
+    return encoder->reset(encoder);
+}
+
+// ---- Canales ----
+
+static bool blocks_free(int first, int count, rmt_channel_handle_t except) {
+    if (first + count > MOCK_RMT_CHANNELS) return false;
+    for (int i = 0; i < MOCK_RMT_CHANNELS; i++) {
+        struct rmt_channel_t *c = &channels[i];
+        if (!c->used || c == except) continue;
+        // Los bloques de c van de i a i + c->blocks - 1
+        if (i < first + count && first < i + c->blocks) return false;
+    }
+    return true;
+}
+
+esp_err_t rmt_new_tx_channel(const rmt_tx_channel_config_t *config, rmt_channel_handle_t *ret_chan) {
+    if (!config || !ret_chan || config->resolution_hz == 0) return ESP_ERR_INVALID_ARG;
+    size_t mem = config->mem_block_symbols;
+    if (mem < MOCK_RMT_BLOCK_SYMBOLS || (mem & 1)) return ESP_ERR_INVALID_ARG;
+
+    // Con DMA solo vale el canal 3 y usa su propio bloque; sin DMA, tantos bloques seguidos como haga falta
+    int blocks = config->flags.with_dma ? 1 : (int)((mem + MOCK_RMT_BLOCK_SYMBOLS - 1) / MOCK_RMT_BLOCK_SYMBOLS);
+    int first = config->flags.with_dma ? MOCK_RMT_CHANNELS - 1 : 0;
+    int found = -1;
+    for (int i = first; i < MOCK_RMT_CHANNELS && found < 0; i++) {
+        if (blocks_free(i, blocks, NULL)) found = i;
+    }
+    if (found < 0) return ESP_ERR_NOT_FOUND;
+
+    struct rmt_channel_t *ch = &channels[found];
+    memset(ch, 0, sizeof(*ch));
+    ch->mem = calloc(mem, sizeof(rmt_symbol_word_t));
+    if (!ch->mem) return ESP_ERR_NO_MEM;
+    ch->used = true;
+    ch->dma = config->flags.with_dma;
+    ch->blocks = blocks;
+    ch->mem_symbols = mem;
+    ch->resolution_hz = config->resolution_hz;
+    *ret_chan = ch;
+    return ESP_OK;
+}
+
+esp_err_t rmt_del_channel(rmt_channel_handle_t ch) {
+    if (!ch || !ch->used) return ESP_ERR_INVALID_ARG;
+    if (ch->enabled || ch->sync) return ESP_ERR_INVALID_STATE;
+    free(ch->mem);
+    free(ch->frame);
+    memset(ch, 0, sizeof(*ch));
+    return ESP_OK;
+}
+
+// Termina, en orden, las tramas que acaban antes de until_ns
+static void run_until(int64_t until_ns) {
+    for (;;) {
+        struct rmt_channel_t *next = NULL;
+        for (int i = 0; i < MOCK_RMT_CHANNELS; i++) {
+            struct rmt_channel_t *c = &channels[i];
+            if (c->busy && c->stats.end_ns <= until_ns && (!next || c->stats.end_ns < next->stats.end_ns)) next = c;
+        }
+        if (!next) break;
+        if (next->stats.end_ns > now_ns) now_ns = next->stats.end_ns;
+        next->busy = false;
+        next->stats.frames++;
+        if (next->on_done) {
+            rmt_tx_done_event_data_t edata = { .num_symbols = next->frame_len };
+            next->on_done(next, &edata, next->user);
+        }
+    }
+    if (until_ns > now_ns) now_ns = until_ns;
+}
+
+esp_err_t rmt_enable(rmt_channel_handle_t ch) {
+    if (!ch || !ch->used) return ESP_ERR_INVALID_ARG;
+    if (ch->enabled) return ESP_ERR_INVALID_STATE;
+    ch->enabled = true;
+    return ESP_OK;
+}
+
+esp_err_t rmt_disable(rmt_channel_handle_t ch) {
+    if (!ch || !ch->used) return ESP_ERR_INVALID_ARG;
+    if (!ch->enabled) return ESP_ERR_INVALID_STATE;
+    // Como en el driver: lo que está en curso se aborta
+    ch->busy = false;
+    ch->armed = false;
+    ch->enabled = false;
+    return ESP_OK;
+}
+
+esp_err_t rmt_tx_register_event_callbacks(rmt_channel_handle_t ch, const rmt_tx_event_callbacks_t *cbs, void *user_data) {
+    if (!ch || !ch->used || !cbs) return ESP_ERR_INVALID_ARG;
+    // El driver solo deja registrarlas con el canal deshabilitado
+    if (ch->enabled) return ESP_ERR_INVALID_STATE;
+    ch->on_done = cbs->on_trans_done;
+    ch->user = user_data;
+    return ESP_OK;
+}
+
+static void frame_append(struct rmt_channel_t *ch, size_t count) {
+    if (ch->frame_len + count > ch->frame_cap) {
+        size_t cap = ch->frame_cap ? ch->frame_cap : 256;
+        while (cap < ch->frame_len + count) cap *= 2;
+        ch->frame = realloc(ch->frame, cap * sizeof(rmt_symbol_word_t));
+        if (!ch->frame) abort();
+        ch->frame_cap = cap;
+    }
+    memcpy(&ch->frame[ch->frame_len], ch->mem, count * sizeof(rmt_symbol_word_t));
+    ch->frame_len += count;
+}
+
+// Codifica la trama entera como lo harían la carga inicial y las interrupciones de umbral
+static esp_err_t encode_frame(struct rmt_channel_t *ch, rmt_encoder_handle_t encoder, const void *data, size_t size) {
+    rmt_encoder_reset(encoder);
+    ch->frame_len = 0;
+    uint32_t refills = 0;
+    size_t window = ch->mem_symbols;
+    for (;;) {
+        rmt_encode_state_t state = RMT_ENCODING_RESET;
+        ch->mem_off = 0;
+        ch->mem_end = window;
+        encoder->encode(encoder, ch, data, size, &state);
+        frame_append(ch, ch->mem_off);
+        if (state & RMT_ENCODING_COMPLETE) {
+            // La marca de fin ocupa un símbolo: si no cabe, hace falta otra vuelta
+            if (ch->mem_off == ch->mem_end) refills++;
+            break;
+        }
+        if (!(state & RMT_ENCODING_MEM_FULL)) return ESP_FAIL;
+        refills++;
+        window = ch->mem_symbols / 2;
+    }
+
+    uint64_t ticks = 0;
+    for (size_t i = 0; i < ch->frame_len; i++) ticks += ch->frame[i].duration0 + ch->frame[i].duration1;
+    ch->frame_ns = (int64_t)(ticks * 1000000000ULL / ch->resolution_hz);
+    ch->stats.refills = refills;
+    ch->stats.isr = refills + 1;
+    ch->stats.symbols = ch->frame_len;
+    return ESP_OK;
+}
+
+static void start_frame(struct rmt_channel_t *ch, int64_t at_ns) {
+    ch->armed = false;
+    ch->busy = true;
+    ch->stats.start_ns = at_ns;
+    ch->stats.end_ns = at_ns + ch->frame_ns;
+}
+
+esp_err_t rmt_transmit(rmt_channel_handle_t ch, rmt_encoder_handle_t encoder, const void *payload, size_t payload_bytes,
+                       const rmt_transmit_config_t *config) {
+    if (!ch || !ch->used || !encoder || !payload || !config) return ESP_ERR_INVALID_ARG;
+    if (!ch->enabled) return ESP_ERR_INVALID_STATE;
+    // Una trama detrás de otra en el mismo canal: la cola del driver se resuelve esperando
+    if (ch->busy) run_until(ch->stats.end_ns);
+    esp_err_t err = encode_frame(ch, encoder, payload, payload_bytes);
+    if (err != ESP_OK) return err;
+
+    if (!ch->sync) {
+        start_frame(ch, now_ns);
+        return ESP_OK;
+    }
+    ch->armed = true;
+    rmt_sync_manager_handle_t sync = ch->sync;
+    for (size_t i = 0; i < sync->num; i++) {
+        if (!sync->chans[i]->armed) return ESP_OK;
+    }
+    for (size_t i = 0; i < sync->num; i++) start_frame(sync->chans[i], now_ns);
+    return ESP_OK;
+}
+
+esp_err_t rmt_tx_wait_all_done(rmt_channel_handle_t ch, int timeout_ms) {
+    if (!ch || !ch->used) return ESP_ERR_INVALID_ARG;
+    if (ch->armed) {
+        // En el chip no empieza nunca: sin límite la tarea se quedaría aquí para siempre
+        if (timeout_ms < 0) stalls++;
+        if (timeout_ms > 0) run_until(now_ns + timeout_ms * 1000000LL);
+        return ESP_ERR_TIMEOUT;
+    }
+    if (ch->busy) run_until(ch->stats.end_ns + wake_delay_ns);
+    return ESP_OK;
+}
+
+esp_err_t rmt_new_sync_manager(const rmt_sync_manager_config_t *config, rmt_sync_manager_handle_t *ret_synchro) {
+    if (!config || !ret_synchro || !config->tx_channel_array || config->array_size == 0 ||
+        config->array_size > MOCK_RMT_CHANNELS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (size_t i = 0; i < config->array_size; i++) {
+        rmt_channel_handle_t ch = config->tx_channel_array[i];
+        if (!ch || !ch->used) return ESP_ERR_INVALID_ARG;
+        if (!ch->enabled || ch->sync) return ESP_ERR_INVALID_STATE;
+    }
+    struct rmt_sync_manager_t *sync = calloc(1, sizeof(*sync));
+    if (!sync) return ESP_ERR_NO_MEM;
+    for (size_t i = 0; i < config->array_size; i++) {
+        sync->chans[i] = config->tx_channel_array[i];
+        sync->chans[i]->sync = sync;
+    }
+    sync->num = config->array_size;
+    *ret_synchro = sync;
+    return ESP_OK;
+}
+
+esp_err_t rmt_sync_reset(rmt_sync_manager_handle_t sync) {
+    if (!sync) return ESP_ERR_INVALID_ARG;
+    for (size_t i = 0; i < sync->num; i++) sync->chans[i]->armed = false;
+    return ESP_OK;
+}
+
+esp_err_t rmt_del_sync_manager(rmt_sync_manager_handle_t sync) {
+    if (!sync) return ESP_ERR_INVALID_ARG;
+    for (size_t i = 0; i < sync->num; i++) {
+        sync->chans[i]->sync = NULL;
+        sync->chans[i]->armed = false;
+    }
+    free(sync);
+    return ESP_OK;
+}
+
+// ---- Consultas de las pruebas ----
+
+void mock_rmt_reset(void) {
+    for (int i = 0; i < MOCK_RMT_CHANNELS; i++) {
+        free(channels[i].mem);
+        free(channels[i].frame);
+    }
+    memset(channels, 0, sizeof(channels));
+    now_ns = 0;
+    stalls = 0;
+    wake_delay_ns = 0;
+}
+
+bool mock_rmt_get_stats(rmt_channel_handle_t ch, mock_rmt_stats_t *out) {
+    if (!ch || !ch->used) return false;
+    *out = ch->stats;
+    return true;
+}
+
+const rmt_symbol_word_t *mock_rmt_frame(rmt_channel_handle_t ch, size_t *num_symbols) {
+    *num_symbols = ch && ch->used ? ch->frame_len : 0;
+    return *num_symbols ? ch->frame : NULL;
+}
+
+int64_t mock_rmt_now_ns(void) {
+    return now_ns;
+}
+
+void mock_rmt_advance_ns(int64_t ns) {
+    run_until(now_ns + ns);
+}
+
+uint32_t mock_rmt_stalls(void) {
+    return stalls;
+}
+
+void mock_rmt_set_wake_delay_ns(int64_t ns) {
+    wake_delay_ns = ns;
+}
+
+rmt_channel_handle_t mock_rmt_channel(int index) {
+    return index >= 0 && index < MOCK_RMT_CHANNELS && channels[index].used ? &channels[index] : NULL;
+}
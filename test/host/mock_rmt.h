@@ -0,0 +1,53 @@
+#ifndef MOCK_RMT_H
+#define MOCK_RMT_H
+
+// Driver RMT simulado para las pruebas en el PC. Reproduce lo que cuesta CPU en el chip:
+// el encoder llena primero toda la memoria del canal (o el buffer DMA) y después media memoria
+// en cada interrupción de umbral, hasta que devuelve RMT_ENCODING_COMPLETE y queda sitio para
+// la marca de fin. El envío no tarda nada de verdad: cada trama ocupa el canal lo que durarían
+// sus símbolos en el reloj simulado, que solo avanza en rmt_tx_wait_all_done() o con
+// mock_rmt_advance_ns().
+//
+// Como el ESP32-S3: cuatro canales TX de 48 símbolos; un canal con más memoria ocupa los
+// bloques de los siguientes, y solo el canal 3 tiene DMA. Con un gestor de sincronización,
+// ninguna trama empieza hasta que todos sus canales tienen una en cola.
+#include <stdint.h>
+#include <stdbool.h>
+#include "driver/rmt_tx.h"
+
+#define MOCK_RMT_CHANNELS       4
+#define MOCK_RMT_BLOCK_SYMBOLS  48
+
+typedef struct {
+    uint32_t frames;        // Tramas terminadas desde que se creó el canal
+    uint32_t refills;       // Interrupciones de umbral de la última trama
+    uint32_t isr;           // Interrupciones de la última trama: umbral + fin de transmisión
+    size_t symbols;         // Símbolos de la última trama, sin la marca de fin
+    int64_t start_ns;       // Inicio y fin de la última trama en el reloj simulado
+    int64_t end_ns;
+} mock_rmt_stats_t;
+
+// Borra canales, gestores y reloj. Los encoders son memoria normal y no se tocan
+void mock_rmt_reset(void);
+
+bool mock_rmt_get_stats(rmt_channel_handle_t chan, mock_rmt_stats_t *out);
+
+// Símbolos de la última trama en el orden en que salieron por el pin
+const rmt_symbol_word_t *mock_rmt_frame(rmt_channel_handle_t chan, size_t *num_symbols);
+
+int64_t mock_rmt_now_ns(void);
+
+// Avanza el reloj simulado; las tramas que terminan por el camino llaman a su on_trans_done
+void mock_rmt_advance_ns(int64_t ns);
+
+// Esperas sin límite que en el chip no volverían nunca (un canal sincronizado esperando a los demás)
+uint32_t mock_rmt_stalls(void);
+
+// Lo que tarda la tarea en volver de rmt_tx_wait_all_done() después del fin de la trama (0 por
+// defecto): separa el instante del callback on_trans_done de la vuelta del envío
+void mock_rmt_set_wake_delay_ns(int64_t ns);
+
+// Canal por su número (0..3), NULL si no está creado
+rmt_channel_handle_t mock_rmt_channel(int index);
+
+#endif
@@ -0,0 +1,229 @@
+// Host USB y Zoom G6 simulados (ver mock_usb.h)
+#include <stdlib.h>
+#include <string.h>
+#include "esp_timer.h"
+#include "usb/usb_host.h"
+#include "mock_usb.h"
+
+#define G6_ADDRESS  1
+#define EP_OUT      0x02
+#define EP_IN       0x81
+#define MAX_PENDING 8
+#define OUT_LOG     1024
+
+// Configuración con solo la interfaz MIDI: la 4, como en la G6
+static const uint8_t config_desc[] = {
+    9, 2, 32, 0, 1, 1, 0, 0x80, 50,
+    9, 4, 4, 0, 2, 0x01, 0x03, 0x00, 0,
+    7, 5, EP_OUT, 0x02, 64, 0, 0,
+    7, 5, EP_IN, 0x02, 64, 0, 0,
+};
+
+static struct {
+    usb_host_client_event_cb_t event_cb;
+    void *event_arg;
+    bool present;           // En el bus
+    bool open;              // Abierta por el cliente
+    bool new_dev;           // Eventos pendientes de entregar
+    bool dev_gone;
+    usb_transfer_t *out[MAX_PENDING];
+    int num_out;
+    usb_transfer_t *in[MAX_PENDING];
+    int num_in;
+    int64_t reply_us;       // < 0 = no contesta
+    uint8_t echo[64];
+    int echo_len;
+    int64_t echo_due_us;
+    uint8_t out_log[OUT_LOG];
+    size_t out_len;
+} bus;
+
+static int client;
+static int device;
+
+void mock_usb_reset(void) {
+    memset(&bus, 0, sizeof(bus));
+    bus.reply_us = -1;
+}
+
+void mock_usb_connect(void) {
+    bus.present = true;
+    bus.new_dev = true;
+}
+
+void mock_usb_disconnect(void) {
+    bus.present = false;
+    bus.dev_gone = bus.open;
+}
+
+void mock_usb_set_reply_ms(int32_t ms) {
+    bus.reply_us = ms * 1000LL;
+}
+
+size_t mock_usb_take_out(uint8_t *buf, size_t max) {
+    size_t n = bus.out_len < max ? bus.out_len : max;
+    memcpy(buf, bus.out_log, n);
+    bus.out_len = 0;
+    return n;
+}
+
+// La pedalera recibe los paquetes: los cambios de banco y parche vuelven pasado el retardo
+static void g6_receive(const uint8_t *data, int len) {
+    for (int i = 0; i + 4 <= len; i += 4) {
+        if (bus.out_len + 4 <= OUT_LOG) {
+            memcpy(&bus.out_log[bus.out_len], &data[i], 4);
+            bus.out_len += 4;
+        }
+        uint8_t cin = data[i] & 0x0F;
+        bool bank_lsb = cin == 0x0B && data[i + 2] == 0x20;
+        if (bus.reply_us >= 0 && (bank_lsb || cin == 0x0C) && bus.echo_len + 4 <= (int)sizeof(bus.echo)) {
+            memcpy(&bus.echo[bus.echo_len], &data[i], 4);
+            bus.echo_len += 4;
+            bus.echo_due_us = esp_timer_get_time() + bus.reply_us;
+        }
+    }
+}
+
+static void complete(usb_transfer_t *xfer, usb_transfer_status_t status) {
+    xfer->status = status;
+    xfer->callback(xfer);
+}
+
+const usb_intf_desc_t *usb_parse_interface_descriptor(const usb_config_desc_t *config, uint8_t intf_num,
+                                                      uint8_t alt, int *offset) {
+    const uint8_t *p = (const uint8_t *)config;
+    for (int off = 0; off + 2 <= config->wTotalLength && p[off] != 0; off += p[off]) {
+        const usb_intf_desc_t *intf = (const usb_intf_desc_t *)&p[off];
+        if (intf->bDescriptorType == 4 && intf->bInterfaceNumber == intf_num && intf->bAlternateSetting == alt) {
+            *offset = off;
+            return intf;
+        }
+    }
+    return NULL;
+}
+
+const usb_ep_desc_t *usb_parse_endpoint_descriptor_by_index(const usb_intf_desc_t *intf, int index,
+                                                            uint16_t total_len, int *offset) {
+    const uint8_t *p = (const uint8_t *)intf;
+    int n = 0;
+    for (int off = intf->bLength; *offset + off + 2 <= total_len && p[off] != 0; off += p[off]) {
+        if (p[off + 1] == 4) break;
+        if (p[off + 1] == 5 && n++ == index) {
+            *offset += off;
+            return (const usb_ep_desc_t *)&p[off];
+        }
+    }
+    return NULL;
+}
+
+esp_err_t usb_host_client_register(const usb_host_client_config_t *config, usb_host_client_handle_t *out) {
+    bus.event_cb = config->async.client_event_callback;
+    bus.event_arg = config->async.callback_arg;
+    *out = (usb_host_client_handle_t)&client;
+    return ESP_OK;
+}
+
+esp_err_t usb_host_client_handle_events(usb_host_client_handle_t hdl, TickType_t ticks) {
+    // Lo enviado ya está en la pedalera
+    while (bus.num_out > 0) {
+        usb_transfer_t *xfer = bus.out[0];
+        memmove(&bus.out[0], &bus.out[1], --bus.num_out * sizeof(bus.out[0]));
+        if (bus.present) g6_receive(xfer->data_buffer, xfer->num_bytes);
+        xfer->actual_num_bytes = bus.present ? xfer->num_bytes : 0;
+        complete(xfer, bus.present ? USB_TRANSFER_STATUS_COMPLETED : USB_TRANSFER_STATUS_NO_DEVICE);
+    }
+    // La respuesta entra por la primera lectura en vuelo
+    if (bus.echo_len && esp_timer_get_time() >= bus.echo_due_us && bus.num_in > 0) {
+        usb_transfer_t *xfer = bus.in[0];
+        memmove(&bus.in[0], &bus.in[1], --bus.num_in * sizeof(bus.in[0]));
+        memcpy(xfer->data_buffer, bus.echo, bus.echo_len);
+        xfer->actual_num_bytes = bus.echo_len;
+        bus.echo_len = 0;
+        complete(xfer, USB_TRANSFER_STATUS_COMPLETED);
+    }
+    if (bus.new_dev) {
+        bus.new_dev = false;
+        usb_host_client_event_msg_t msg = { .event = USB_HOST_CLIENT_EVENT_NEW_DEV, .new_dev.address = G6_ADDRESS };
+        bus.event_cb(&msg, bus.event_arg);
+    }
+    if (bus.dev_gone) {
+        bus.dev_gone = false;
+        usb_host_client_event_msg_t msg = { .event = USB_HOST_CLIENT_EVENT_DEV_GONE,
+                                            .dev_gone.dev_hdl = (usb_device_handle_t)&device };
+        bus.event_cb(&msg, bus.event_arg);
+    }
+    return ESP_OK;
+}
+
+esp_err_t usb_host_client_unblock(usb_host_client_handle_t hdl) {
+    return ESP_OK;
+}
+
+esp_err_t usb_host_device_open(usb_host_client_handle_t hdl, uint8_t address, usb_device_handle_t *out) {
+    if (!bus.present || address != G6_ADDRESS) return ESP_ERR_NOT_FOUND;
+    bus.open = true;
+    *out = (usb_device_handle_t)&device;
+    return ESP_OK;
+}
+
+esp_err_t usb_host_device_close(usb_host_client_handle_t hdl, usb_device_handle_t dev) {
+    bus.open = false;
+    return ESP_OK;
+}
+
+esp_err_t usb_host_get_active_config_descriptor(usb_device_handle_t dev, const usb_config_desc_t **out) {
+    *out = (const usb_config_desc_t *)config_desc;
+    return ESP_OK;
+}
+
+esp_err_t usb_host_interface_claim(usb_host_client_handle_t hdl, usb_device_handle_t dev, uint8_t intf,
+                                   uint8_t alt) {
+    return intf == 4 && alt == 0 ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t usb_host_interface_release(usb_host_client_handle_t hdl, usb_device_handle_t dev, uint8_t intf) {
+    return ESP_OK;
+}
+
+esp_err_t usb_host_endpoint_halt(usb_device_handle_t dev, uint8_t ep) {
+    return ESP_OK;
+}
+
+// Las transferencias en vuelo del endpoint vuelven canceladas
+esp_err_t usb_host_endpoint_flush(usb_device_handle_t dev, uint8_t ep) {
+    usb_transfer_t **list = ep == EP_IN ? bus.in : bus.out;
+    int *num = ep == EP_IN ? &bus.num_in : &bus.num_out;
+    while (*num > 0) complete(list[--*num], USB_TRANSFER_STATUS_CANCELED);
+    return ESP_OK;
+}
+
+esp_err_t usb_host_endpoint_clear(usb_device_handle_t dev, uint8_t ep) {
+    return ESP_OK;
+}
+
+esp_err_t usb_host_transfer_alloc(size_t size, int num_isoc_packets, usb_transfer_t **out) {
+    // data_buffer y data_buffer_size son const: se rellenan a través de una plantilla
+    usb_transfer_t *xfer = calloc(1, sizeof(*xfer));
+    uint8_t *buf = calloc(1, size);
+    if (!xfer || !buf) {
+        free(xfer);
+        free(buf);
+        return ESP_ERR_NO_MEM;
+    }
+    usb_transfer_t init = { .data_buffer = buf, .data_buffer_size = size, .num_isoc_packets = num_isoc_packets };
+    memcpy(xfer, &init, sizeof(init));
+    *out = xfer;
+    return ESP_OK;
+}
+
+esp_err_t usb_host_transfer_submit(usb_transfer_t *xfer) {
+    if (!bus.open || xfer->device_handle != (usb_device_handle_t)&device) return ESP_ERR_INVALID_STATE;
+    if (xfer->num_bytes <= 0 || (size_t)xfer->num_bytes > xfer->data_buffer_size) return ESP_ERR_INVALID_ARG;
+    bool in = xfer->bEndpointAddress == EP_IN;
+    if (!in && xfer->bEndpointAddress != EP_OUT) return ESP_ERR_INVALID_ARG;
+    usb_transfer_t **list = in ? bus.in : bus.out;
+    int *num = in ? &bus.num_in : &bus.num_out;
+    if (*num == MAX_PENDING) return ESP_ERR_NO_MEM;
+    list[(*num)++] = xfer;
+    return ESP_OK;
+}
@@ -0,0 +1,24 @@
+#ifndef MOCK_USB_H
+#define MOCK_USB_H
+
+// Biblioteca host USB simulada con una Zoom G6 detrás: la interfaz MIDI 4 con el endpoint OUT
+// 0x02 y el IN 0x81, de 64 bytes. Como la biblioteca de verdad, las transferencias terminan y los
+// eventos llegan dentro de usb_host_client_handle_events(). La pedalera confirma cada Bank Select
+// LSB y Program Change que recibe devolviéndolo por MIDI IN pasado su retardo, si se le pide.
+#include <stddef.h>
+#include <stdint.h>
+
+void mock_usb_reset(void);
+
+// La pedalera aparece o desaparece del bus; el class driver se entera en su siguiente vuelta
+void mock_usb_connect(void);
+void mock_usb_disconnect(void);
+
+// Milisegundos desde que llega un cambio de parche hasta que la pedalera lo devuelve; negativo
+// (por defecto) = no lo devuelve, como con MIDI IN desactivado en la pedalera
+void mock_usb_set_reply_ms(int32_t ms);
+
+// Bytes recibidos por el endpoint OUT desde la última llamada (se vacía al leer)
+size_t mock_usb_take_out(uint8_t *buf, size_t max);
+
+#endif
@@ -0,0 +1,11 @@
+#ifndef DRIVER_RMT_COMMON_H
+#define DRIVER_RMT_COMMON_H
+
+#include "esp_err.h"
+#include "driver/rmt_types.h"
+
+esp_err_t rmt_del_channel(rmt_channel_handle_t channel);
+esp_err_t rmt_enable(rmt_channel_handle_t channel);
+esp_err_t rmt_disable(rmt_channel_handle_t channel);
+
+#endif
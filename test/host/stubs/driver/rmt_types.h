@@ -0,0 +1,32 @@
+#ifndef DRIVER_RMT_TYPES_H
+#define DRIVER_RMT_TYPES_H
+
+// Tipos del driver RMT de ESP-IDF 5.x; la implementación es test/host/mock_rmt.c
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef int rmt_clock_source_t;
+#define RMT_CLK_SRC_DEFAULT 0
+
+typedef struct rmt_channel_t *rmt_channel_handle_t;
+typedef struct rmt_sync_manager_t *rmt_sync_manager_handle_t;
+typedef struct rmt_encoder_t rmt_encoder_t;
+
+typedef union {
+    struct {
+        uint16_t duration0 : 15;
+        uint16_t level0 : 1;
+        uint16_t duration1 : 15;
+        uint16_t level1 : 1;
+    };
+    uint32_t val;
+} rmt_symbol_word_t;
+
+typedef struct {
+    size_t num_symbols;
+} rmt_tx_done_event_data_t;
+
+typedef bool (*rmt_tx_done_callback_t)(rmt_channel_handle_t tx_chan, const rmt_tx_done_event_data_t *edata, void *user_ctx);
+
+#endif
@@ -0,0 +1,12 @@
+#ifndef DRIVER_SPI_MASTER_H
+#define DRIVER_SPI_MASTER_H
+
+// Solo los tipos que aparecen en led_strip_spi.h; el backend SPI no se compila en el PC
+typedef int spi_host_device_t;
+typedef int spi_clock_source_t;
+
+#define SPI2_HOST           1
+#define SPI3_HOST           2
+#define SPI_CLK_SRC_DEFAULT 0
+
+#endif
@@ -0,0 +1,8 @@
+#ifndef ESP_ATTR_H
+#define ESP_ATTR_H
+
+// En el PC no hay IRAM ni DRAM: los atributos de sección no hacen nada
+#define IRAM_ATTR
+#define DRAM_ATTR
+
+#endif
@@ -0,0 +1,9 @@
+#ifndef ESP_CPU_H
+#define ESP_CPU_H
+
+#include <stdint.h>
+
+// Nanosegundos del reloj del PC en lugar de ciclos (mock_idf.c)
+uint32_t esp_cpu_get_cycle_count(void);
+
+#endif
@@ -0,0 +1,12 @@
+#ifndef ESP_HEAP_CAPS_H
+#define ESP_HEAP_CAPS_H
+
+#include <stdlib.h>
+
+// Un solo tipo de memoria en el PC: las capacidades no cuentan
+#define MALLOC_CAP_SPIRAM   (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+
+#define heap_caps_calloc(n, size, caps) calloc((n), (size))
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef FREERTOS_H
+#define FREERTOS_H
+
+// Lo que usan las pruebas en el PC: un solo hilo, así que las secciones críticas no hacen nada.
+// Las esperas con tiempo límite las resuelve el planificador de mock_os.c. Como el de ESP-IDF,
+// trae consigo sdkconfig.h
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "sdkconfig.h"
+#include "esp_attr.h"
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define pdTRUE              1
+#define pdFALSE             0
+#define pdPASS              pdTRUE
+#define pdFAIL              pdFALSE
+#define portMAX_DELAY       UINT32_MAX
+#define configTICK_RATE_HZ  1000
+#define portTICK_PERIOD_MS  1
+#define pdMS_TO_TICKS(ms)   ((TickType_t)(ms))
+
+typedef struct {
+    int unused;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED    { 0 }
+#define portENTER_CRITICAL(mux)         ((void)(mux))
+#define portEXIT_CRITICAL(mux)          ((void)(mux))
+
+// Memoria de los objetos estáticos: el mock guarda ahí su estado
+typedef struct {
+    uint8_t storage[64];
+} StaticQueue_t;
+typedef StaticQueue_t StaticSemaphore_t;
+
+#endif
@@ -0,0 +1,17 @@
+#ifndef MESSAGE_BUFFER_H
+#define MESSAGE_BUFFER_H
+
+#include "freertos/FreeRTOS.h"
+
+// Como el de FreeRTOS: cada mensaje ocupa su longitud más una cabecera en storage
+typedef struct MessageBufferDefinition *MessageBufferHandle_t;
+typedef StaticQueue_t StaticMessageBuffer_t;
+
+MessageBufferHandle_t xMessageBufferCreateStatic(size_t size, uint8_t *storage, StaticMessageBuffer_t *buf);
+// Sin espera: con el búfer lleno no envía nada y devuelve 0
+size_t xMessageBufferSend(MessageBufferHandle_t mb, const void *data, size_t len, TickType_t ticks);
+size_t xMessageBufferReceive(MessageBufferHandle_t mb, void *data, size_t cap, TickType_t ticks);
+BaseType_t xMessageBufferIsEmpty(MessageBufferHandle_t mb);
+BaseType_t xMessageBufferReset(MessageBufferHandle_t mb);
+
+#endif
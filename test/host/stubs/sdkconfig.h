@@ -0,0 +1,33 @@
+#ifndef SDKCONFIG_H
+#define SDKCONFIG_H
+
+// Configuración fija de las pruebas en el PC: la de fábrica de Kconfig.projbuild
+#define CONFIG_APP_NUM_BUTTONS 8
+#define CONFIG_APP_NUM_LEDS 8
+#define CONFIG_APP_LED_GPIO 39
+#define CONFIG_APP_STANDBY_MINUTES 10
+#define CONFIG_APP_CONSOLE_ENABLE 1
+
+// test_midi_order_coalesce la compila con ventana de agrupación
+#ifndef CONFIG_APP_MIDI_COALESCE_MS
+#define CONFIG_APP_MIDI_COALESCE_MS 0
+#endif
+#define CONFIG_APP_TAP_TEMPO_BUTTON -1
+#define CONFIG_APP_SETLIST_PREV_BUTTON 5
+#define CONFIG_APP_SETLIST_NEXT_BUTTON 6
+#define CONFIG_APP_SETLIST_SCENE_CC 64
+#define CONFIG_APP_PAGE_DOWN_BUTTON 0
+#define CONFIG_APP_PAGE_UP_BUTTON 7
+// test_input_map_double y test_input_map_chord eligen otro gesto de página
+#if !defined(CONFIG_APP_PAGE_GESTURE_DOUBLE) && !defined(CONFIG_APP_PAGE_GESTURE_CHORD)
+#define CONFIG_APP_PAGE_GESTURE_LONG 1
+#endif
+
+#define CONFIG_APP_EXPRESSION_ENABLE 1
+#define CONFIG_APP_EXPRESSION_MAX_RATE 100
+#define CONFIG_APP_EXPRESSION_CC 11
+
+#define CONFIG_APP_LED_GAMMA_X10 10
+#define CONFIG_APP_LED_FEEDBACK_TIMEOUT_MS 1000
+
+#endif
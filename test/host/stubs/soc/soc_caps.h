@@ -0,0 +1,11 @@
+#ifndef SOC_CAPS_H
+#define SOC_CAPS_H
+
+// Capacidades del ESP32-S3 que consulta el código compilado en el PC
+#define SOC_RMT_MEM_WORDS_PER_CHANNEL       48
+#define SOC_RMT_TX_CANDIDATES_PER_GROUP     4
+#define SOC_RMT_SUPPORT_DMA                 1
+#define SOC_RMT_SUPPORT_TX_SYNCHRO          1
+#define SOC_GPSPI_SUPPORTED                 1
+
+#endif
@@ -0,0 +1,12 @@
+#ifndef HOST_SYS_CDEFS_H
+#define HOST_SYS_CDEFS_H
+
+// La de glibc más __containerof, que en ESP-IDF viene de la de newlib
+#include_next <sys/cdefs.h>
+#include <stddef.h>
+
+#ifndef __containerof
+#define __containerof(ptr, type, member) ((type *)((char *)(ptr) - offsetof(type, member)))
+#endif
+
+#endif
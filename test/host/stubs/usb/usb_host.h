@@ -0,0 +1,126 @@
+#ifndef USB_HOST_H
+#define USB_HOST_H
+
+// Biblioteca host USB simulada (mock_usb.c): una Zoom G6 con la interfaz MIDI que conecta y
+// desconecta la prueba. Solo lo que usa el class driver
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+typedef struct usb_host_client_handle_s *usb_host_client_handle_t;
+typedef struct usb_device_handle_s *usb_device_handle_t;
+
+typedef enum {
+    USB_TRANSFER_STATUS_COMPLETED,
+    USB_TRANSFER_STATUS_ERROR,
+    USB_TRANSFER_STATUS_TIMED_OUT,
+    USB_TRANSFER_STATUS_CANCELED,
+    USB_TRANSFER_STATUS_STALL,
+    USB_TRANSFER_STATUS_OVERFLOW,
+    USB_TRANSFER_STATUS_SKIPPED,
+    USB_TRANSFER_STATUS_NO_DEVICE,
+} usb_transfer_status_t;
+
+typedef struct usb_transfer_s usb_transfer_t;
+typedef void (*usb_transfer_cb_t)(usb_transfer_t *transfer);
+
+struct usb_transfer_s {
+    uint8_t *const data_buffer;
+    const size_t data_buffer_size;
+    int num_bytes;
+    int actual_num_bytes;
+    uint32_t flags;
+    usb_device_handle_t device_handle;
+    uint8_t bEndpointAddress;
+    usb_transfer_status_t status;
+    uint32_t timeout_ms;
+    usb_transfer_cb_t callback;
+    void *context;
+    const int num_isoc_packets;
+};
+
+typedef enum {
+    USB_HOST_CLIENT_EVENT_NEW_DEV = 1,
+    USB_HOST_CLIENT_EVENT_DEV_GONE,
+} usb_host_client_event_t;
+
+typedef struct {
+    usb_host_client_event_t event;
+    union {
+        struct {
+            uint8_t address;
+        } new_dev;
+        struct {
+            usb_device_handle_t dev_hdl;
+        } dev_gone;
+    };
+} usb_host_client_event_msg_t;
+
+typedef void (*usb_host_client_event_cb_t)(const usb_host_client_event_msg_t *msg, void *arg);
+
+typedef struct {
+    bool is_synchronous;
+    int max_num_event_msg;
+    union {
+        struct {
+            usb_host_client_event_cb_t client_event_callback;
+            void *callback_arg;
+        } async;
+    };
+} usb_host_client_config_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t bLength;
+    uint8_t bDescriptorType;
+    uint16_t wTotalLength;
+    uint8_t bNumInterfaces;
+    uint8_t bConfigurationValue;
+    uint8_t iConfiguration;
+    uint8_t bmAttributes;
+    uint8_t bMaxPower;
+} usb_config_desc_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t bLength;
+    uint8_t bDescriptorType;
+    uint8_t bInterfaceNumber;
+    uint8_t bAlternateSetting;
+    uint8_t bNumEndpoints;
+    uint8_t bInterfaceClass;
+    uint8_t bInterfaceSubClass;
+    uint8_t bInterfaceProtocol;
+    uint8_t iInterface;
+} usb_intf_desc_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t bLength;
+    uint8_t bDescriptorType;
+    uint8_t bEndpointAddress;
+    uint8_t bmAttributes;
+    uint16_t wMaxPacketSize;
+    uint8_t bInterval;
+} usb_ep_desc_t;
+
+#define USB_B_ENDPOINT_ADDRESS_EP_DIR_MASK  0x80
+#define USB_EP_DESC_GET_MPS(desc)           ((desc)->wMaxPacketSize & 0x7FF)
+
+const usb_intf_desc_t *usb_parse_interface_descriptor(const usb_config_desc_t *config, uint8_t intf_num,
+                                                      uint8_t alt, int *offset);
+const usb_ep_desc_t *usb_parse_endpoint_descriptor_by_index(const usb_intf_desc_t *intf, int index,
+                                                            uint16_t total_len, int *offset);
+
+esp_err_t usb_host_client_register(const usb_host_client_config_t *config, usb_host_client_handle_t *out);
+esp_err_t usb_host_client_handle_events(usb_host_client_handle_t client, TickType_t ticks);
+esp_err_t usb_host_client_unblock(usb_host_client_handle_t client);
+esp_err_t usb_host_device_open(usb_host_client_handle_t client, uint8_t address, usb_device_handle_t *out);
+esp_err_t usb_host_device_close(usb_host_client_handle_t client, usb_device_handle_t dev);
+esp_err_t usb_host_get_active_config_descriptor(usb_device_handle_t dev, const usb_config_desc_t **out);
+esp_err_t usb_host_interface_claim(usb_host_client_handle_t client, usb_device_handle_t dev, uint8_t intf,
+                                   uint8_t alt);
+esp_err_t usb_host_interface_release(usb_host_client_handle_t client, usb_device_handle_t dev, uint8_t intf);
+esp_err_t usb_host_endpoint_halt(usb_device_handle_t dev, uint8_t ep);
+esp_err_t usb_host_endpoint_flush(usb_device_handle_t dev, uint8_t ep);
+esp_err_t usb_host_endpoint_clear(usb_device_handle_t dev, uint8_t ep);
+esp_err_t usb_host_transfer_alloc(size_t size, int num_isoc_packets, usb_transfer_t **out);
+esp_err_t usb_host_transfer_submit(usb_transfer_t *transfer);
+
+#endif
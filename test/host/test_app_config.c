@@ -0,0 +1,120 @@
+// Ajustes en directo con el comando `cfg` de la consola (config_cmd.c): se aplican al momento,
+// los lectores los ven en su copia (app_config_sync) y la tarea de configuración los escribe
+// en el NVS de mock_idf.c una sola vez, APP_CONFIG_COMMIT_DELAY_MS después del último.
+#include <string.h>
+#include "sdkconfig.h"
+#include "host_test.h"
+#include "esp_timer.h"
+#include "mock_idf.h"
+#include "mock_os.h"
+#include "mock_rmt.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "app_config.h"
+#include "config_cmd.h"
+
+static int cmd(const char *line) {
+    char buf[128];
+    char *argv[8];
+    int argc = 0;
+    snprintf(buf, sizeof(buf), "%s", line);
+    for (char *tok = strtok(buf, " "); tok && argc < 8; tok = strtok(NULL, " ")) argv[argc++] = tok;
+    return config_cmd_cfg(argc, argv);
+}
+
+// Ráfaga de ajustes desde la consola mientras la tarea de configuración espera: uno por segundo
+static int64_t start_us;
+static int tweaks_sent;
+static const char *const tweaks[] = {
+    "cfg set brightness 10",
+    "cfg set brightness 20",
+    "cfg set color_active 1 2 3",
+};
+#define NUM_TWEAKS (int)(sizeof(tweaks) / sizeof(tweaks[0]))
+
+static void live_tweaks(void) {
+    int64_t ms = (esp_timer_get_time() - start_us) / 1000;
+    if (tweaks_sent < NUM_TWEAKS && ms >= (tweaks_sent + 1) * 1000) CHECK_EQ(cmd(tweaks[tweaks_sent++]), 0);
+}
+
+static void test_debounce(void) {
+    start_us = esp_timer_get_time();
+    mock_os_set_background(live_tweaks);
+    app_config_loop();
+    int64_t ms = (esp_timer_get_time() - start_us) / 1000;
+    mock_os_set_background(NULL);
+
+    // Una sola escritura, cuando pasa el retardo sin cambios desde el último ajuste
+    CHECK_EQ(tweaks_sent, NUM_TWEAKS);
+    CHECK_EQ(mock_idf_nvs_commits(), 1);
+    CHECK(ms >= NUM_TWEAKS * 1000 + APP_CONFIG_COMMIT_DELAY_MS);
+    CHECK(ms <= NUM_TWEAKS * 1000 + APP_CONFIG_COMMIT_DELAY_MS + 2);
+
+    // Cambiar un valor y dejarlo como estaba no vuelve a escribir
+    CHECK_EQ(cmd("cfg set brightness 40"), 0);
+    CHECK_EQ(cmd("cfg set brightness 20"), 0);
+    app_config_loop();
+    CHECK_EQ(mock_idf_nvs_commits(), 1);
+}
+
+// Lo guardado es lo que se carga al arrancar
+static void test_reload(void) {
+    static app_config_t cfg;
+    CHECK_EQ(app_config_init(), ESP_OK);
+    app_config_copy(&cfg);
+    CHECK_EQ(cfg.brightness, 20);
+    CHECK_EQ(cfg.color_active.r, 1);
+    CHECK_EQ(cfg.color_active.g, 2);
+    CHECK_EQ(cfg.color_active.b, 3);
+    CHECK_EQ(cfg.num_leds, CONFIG_APP_NUM_LEDS);
+}
+
+// La copia del lector solo se refresca cuando hay algo nuevo
+static void test_sync(void) {
+    static app_config_t copy;
+    uint32_t gen = 0;
+    CHECK(app_config_sync(&copy, &gen));
+    CHECK(!app_config_sync(&copy, &gen));
+    CHECK_EQ(cmd("cfg set standby_s 90"), 0);
+    CHECK(app_config_sync(&copy, &gen));
+    CHECK_EQ(copy.standby_s, 90);
+    CHECK(!app_config_sync(&copy, &gen));
+    app_config_loop();
+    CHECK_EQ(mock_idf_nvs_commits(), 2);
+}
+
+// Lo que el comando rechaza no cambia la configuración ni despierta a la tarea
+static void test_errors(void) {
+    uint32_t gen = 0;
+    static app_config_t copy;
+    app_config_sync(&copy, &gen);
+    CHECK_EQ(cmd("cfg set brightness 256"), 1);
+    CHECK_EQ(cmd("cfg set brightness"), 1);
+    CHECK_EQ(cmd("cfg set color_page 1 2"), 1);
+    CHECK_EQ(cmd("cfg set num_leds 0"), 1);
+    CHECK_EQ(cmd("cfg set standby_s 5x"), 1);
+    CHECK_EQ(cmd("cfg set nada 1"), 1);
+    CHECK_EQ(cmd("cfg get nada"), 1);
+    CHECK_EQ(cmd("cfg set"), 1);
+    CHECK_EQ(cmd("cfg get brightness"), 0);
+    CHECK_EQ(cmd("cfg"), 0);
+    CHECK(!app_config_sync(&copy, &gen));
+    CHECK_EQ(ulTaskNotifyTake(pdTRUE, 0), 0);
+}
+
+int main(void) {
+    mock_rmt_reset();
+    mock_os_reset();
+    mock_idf_nvs_init();
+    CHECK_EQ(app_config_init(), ESP_OK);
+    // Los valores por defecto no se escriben hasta que alguien cambie algo
+    app_config_setup();
+    CHECK_EQ(ulTaskNotifyTake(pdTRUE, 0), 0);
+
+    test_debounce();
+    test_reload();
+    test_sync();
+    test_errors();
+    CHECK_EQ(mock_idf_nvs_commits(), 2);
+    return HOST_TEST_RESULT();
+}
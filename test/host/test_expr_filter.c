@@ -0,0 +1,158 @@
+// expr_filter con trazas del ADC (test/host/data/*.trace) y la misma cadena que el firmware:
+// media por bloque -> filtro con histéresis -> buzón de un valor -> límite de tasa.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sdkconfig.h"
+#include "host_test.h"
+#include "expr_filter.h"
+
+#define MAX_BLOCKS 4096
+#define MAX_SENT   1024
+#define LOOP_US    1000     // Vuelta de la tarea MIDI cuando no hay nada que hacer
+
+typedef struct {
+    int64_t t_us;
+    uint16_t raw;
+} block_t;
+
+typedef struct {
+    int64_t t_us;           // Cuando el class driver lo recoge
+    int64_t sample_us;      // Bloque del que salió
+    int value;
+} sent_t;
+
+static int load_trace(const char *dir, const char *name, block_t *out) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "no se puede abrir %s\n", path);
+        exit(2);
+    }
+    char line[128];
+    int n = 0;
+    while (fgets(line, sizeof(line), f) && n < MAX_BLOCKS) {
+        // Vale tanto el fichero limpio como una captura del log con las líneas "E:"
+        const char *p = strstr(line, "E:");
+        p = p ? p + 2 : line;
+        long long t;
+        unsigned raw;
+        if (p[0] == '#' || sscanf(p, "%lld %u", &t, &raw) != 2) continue;
+        out[n].t_us = t;
+        out[n].raw = (uint16_t)raw;
+        n++;
+    }
+    fclose(f);
+    return n;
+}
+
+// Reproduce la traza con el reloj del firmware: el filtro corre en cada bloque y el
+// class driver recoge el buzón en cada vuelta si el límite de tasa lo permite
+static int run(const block_t *blocks, int n, sent_t *sent, uint32_t *replaced) {
+    expr_filter_t filter;
+    expr_rate_limit_t rate;
+    expr_filter_init(&filter, 0, 4095, EXPR_FILTER_HYSTERESIS);
+    expr_rate_limit_init(&rate, CONFIG_APP_EXPRESSION_MAX_RATE);
+
+    int pending = -1, num_sent = 0, next = 0;
+    int64_t pending_us = 0;
+    *replaced = 0;
+    int64_t end = n ? blocks[n - 1].t_us + 100000 : 0;
+    for (int64_t t = 0; t <= end; t += LOOP_US) {
+        for (; next < n && blocks[next].t_us <= t; next++) {
+            int value = expr_filter_update(&filter, blocks[next].raw);
+            if (value < 0) continue;
+            if (pending >= 0) (*replaced)++;
+            pending = value;
+            pending_us = blocks[next].t_us;
+        }
+        if (pending >= 0 && expr_rate_limit_wait(&rate, t) == 0 && num_sent < MAX_SENT) {
+            sent[num_sent++] = (sent_t){ .t_us = t, .sample_us = pending_us, .value = pending };
+            expr_rate_limit_mark(&rate, t);
+            pending = -1;
+        }
+    }
+    return num_sent;
+}
+
+static void check_common(const sent_t *sent, int n) {
+    int64_t min_interval = 1000000 / CONFIG_APP_EXPRESSION_MAX_RATE;
+    for (int i = 1; i < n; i++) {
+        CHECK(sent[i].t_us - sent[i - 1].t_us >= min_interval);
+        CHECK(sent[i].value != sent[i - 1].value);
+    }
+    // Un valor nunca espera más que un intervalo del límite más una vuelta del bucle
+    for (int i = 0; i < n; i++) CHECK(sent[i].t_us - sent[i].sample_us <= min_interval + LOOP_US);
+}
+
+static void test_rest(const char *dir) {
+    static block_t blocks[MAX_BLOCKS];
+    static sent_t sent[MAX_SENT];
+    uint32_t replaced;
+    int n = load_trace(dir, "expr_rest.trace", blocks);
+    CHECK(n > 100);
+    int num = run(blocks, n, sent, &replaced);
+    // Con el pedal quieto el ruido no pasa la histéresis: sale el primer valor y, como mucho,
+    // un ajuste si la primera media cayó justo en el borde entre dos valores
+    CHECK(num >= 1 && num <= 2);
+    if (num == 2) CHECK(abs(sent[1].value - sent[0].value) == 1);
+    check_common(sent, num);
+    printf("reposo: %d bloques, %d valores\n", n, num);
+}
+
+static void test_sweep(const char *dir) {
+    static block_t blocks[MAX_BLOCKS];
+    static sent_t sent[MAX_SENT];
+    uint32_t replaced;
+    int n = load_trace(dir, "expr_sweep.trace", blocks);
+    CHECK(n > 100);
+    int num = run(blocks, n, sent, &replaced);
+    CHECK(num > 50);
+    check_common(sent, num);
+
+    // Sube sin retrocesos hasta 127 y baja sin retrocesos hasta 0
+    int peak = 0;
+    for (int i = 1; i < num; i++) {
+        if (sent[i].value > sent[peak].value) peak = i;
+    }
+    CHECK_EQ(sent[0].value, 0);
+    CHECK_EQ(sent[peak].value, 127);
+    CHECK_EQ(sent[num - 1].value, 0);
+    for (int i = 1; i <= peak; i++) CHECK(sent[i].value > sent[i - 1].value);
+    for (int i = peak + 1; i < num; i++) CHECK(sent[i].value < sent[i - 1].value);
+    printf("barrido: %d bloques, %d valores, %u sustituidos\n", n, num, replaced);
+}
+
+static void test_units(void) {
+    const uint16_t s[] = { 10, 11, 11, 12 };
+    CHECK_EQ(expr_filter_average(s, 4), 11);
+    CHECK_EQ(expr_filter_average(s, 0), 0);
+
+    // Extremos invertidos o iguales no dividen por cero
+    expr_filter_t f;
+    expr_filter_init(&f, 100, 100, 0);
+    CHECK_EQ(expr_filter_update(&f, 0), 0);
+    CHECK_EQ(expr_filter_update(&f, 4095), 127);
+
+    // Con histéresis, rozar el borde del valor actual no lo cambia; pasarlo de largo sí
+    expr_filter_init(&f, 0, 2047, 4);
+    CHECK_EQ(expr_filter_update(&f, 160), 10);
+    CHECK_EQ(expr_filter_update(&f, 176), -1);
+    CHECK_EQ(expr_filter_update(&f, 200), 12);
+
+    expr_rate_limit_t r;
+    expr_rate_limit_init(&r, 100);
+    CHECK_EQ(expr_rate_limit_wait(&r, 0), 0);
+    expr_rate_limit_mark(&r, 0);
+    CHECK_EQ(expr_rate_limit_wait(&r, 4000), 6000);
+    CHECK_EQ(expr_rate_limit_wait(&r, 10000), 0);
+}
+
+int main(int argc, char **argv) {
+    const char *dir = argc > 1 ? argv[1] : "data";
+    test_units();
+    test_rest(dir);
+    test_sweep(dir);
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,168 @@
+// gesture.c con líneas de tiempo sintéticas: flancos ya sin rebotes y sondeos como los de la
+// tarea hw (uno cada 5 ms), comparando los gestos emitidos con los esperados.
+#include <string.h>
+#include "host_test.h"
+#include "gesture.h"
+
+#define SCAN_US  5000
+#define MAX_OUT  16
+
+typedef struct {
+    int t_ms;
+    int button;
+    int pressed;
+} step_t;
+
+typedef struct {
+    gesture_type_t type;
+    int button;
+    int button2;
+    int t_ms;
+} expect_t;
+
+typedef struct {
+    gesture_t out[MAX_OUT];
+    int count;
+} record_t;
+
+static void on_gesture(const gesture_t *g, void *arg) {
+    record_t *r = arg;
+    if (r->count < MAX_OUT) r->out[r->count++] = *g;
+}
+
+// Recorre la línea de tiempo hasta end_ms sondeando en cada escaneo, como la tarea hw
+static void run(const char *name, uint8_t bind0, uint8_t bind1, const step_t *steps, int num_steps,
+                int end_ms, const expect_t *expect, int num_expect) {
+    gesture_engine_t e;
+    record_t r = { .count = 0 };
+    gesture_init(&e, 8, on_gesture, &r);
+    gesture_bind(&e, 0, bind0);
+    gesture_bind(&e, 1, bind1);
+
+    int next = 0;
+    for (int64_t t = 0; t <= end_ms * 1000LL; t += SCAN_US) {
+        for (; next < num_steps && steps[next].t_ms * 1000LL <= t; next++) {
+            gesture_edge(&e, steps[next].button, steps[next].pressed, t);
+        }
+        gesture_poll(&e, t);
+    }
+
+    if (r.count != num_expect) fprintf(stderr, "%s:\n", name);
+    CHECK_EQ(r.count, num_expect);
+    for (int i = 0; i < num_expect && i < r.count; i++) {
+        if (r.out[i].type != expect[i].type || r.out[i].button != expect[i].button ||
+            r.out[i].time_us != expect[i].t_ms * 1000LL) {
+            fprintf(stderr, "%s: gesto %d\n", name, i);
+        }
+        CHECK_EQ(r.out[i].type, expect[i].type);
+        CHECK_EQ(r.out[i].button, expect[i].button);
+        if (expect[i].type == GESTURE_CHORD) CHECK_EQ(r.out[i].button2, expect[i].button2);
+        CHECK_EQ(r.out[i].time_us, expect[i].t_ms * 1000LL);
+    }
+}
+
+#define RUN(name, b0, b1, steps, end_ms, expect) \
+    run(name, b0, b1, steps, sizeof(steps) / sizeof(steps[0]), end_ms, expect, sizeof(expect) / sizeof(expect[0]))
+
+static void test_unbound(void) {
+    // Sin gestos asociados el toque sale en el flanco de bajada, sin esperar a soltar
+    const step_t steps[] = { { 10, 3, 1 }, { 200, 3, 0 }, { 400, 3, 1 }, { 420, 3, 0 } };
+    const expect_t expect[] = { { GESTURE_TAP, 3, 3, 10 }, { GESTURE_TAP, 3, 3, 400 } };
+    RUN("sin gestos", 0, 0, steps, 1000, expect);
+}
+
+static void test_long(void) {
+    // Toque corto: sale al soltar con la marca de la pulsación. Largo: al vencer 600 ms,
+    // y soltar después no produce nada más
+    const step_t steps[] = { { 0, 0, 1 }, { 100, 0, 0 }, { 1000, 0, 1 }, { 2500, 0, 0 } };
+    const expect_t expect[] = { { GESTURE_TAP, 0, 0, 0 }, { GESTURE_LONG_PRESS, 0, 0, 1600 } };
+    RUN("pulsacion larga", GESTURE_BIND_LONG, 0, steps, 3000, expect);
+}
+
+static void test_long_boundary(void) {
+    // Soltar un escaneo antes del límite sigue siendo un toque
+    const step_t steps[] = { { 0, 0, 1 }, { 595, 0, 0 } };
+    const expect_t expect[] = { { GESTURE_TAP, 0, 0, 0 } };
+    RUN("limite de la pulsacion larga", GESTURE_BIND_LONG, 0, steps, 1500, expect);
+}
+
+static void test_double(void) {
+    // Dos toques en menos de 300 ms son un doble toque; uno solo sale al vencer la espera
+    const step_t steps[] = { { 0, 0, 1 }, { 80, 0, 0 }, { 200, 0, 1 }, { 260, 0, 0 },
+                             { 1000, 0, 1 }, { 1050, 0, 0 } };
+    const expect_t expect[] = { { GESTURE_DOUBLE_TAP, 0, 0, 200 }, { GESTURE_TAP, 0, 0, 1000 } };
+    RUN("doble toque", GESTURE_BIND_DOUBLE, 0, steps, 2000, expect);
+}
+
+static void test_chord(void) {
+    // Dos botones de acorde pisados con menos de 60 ms de diferencia forman un acorde;
+    // con más, cada uno es un toque normal
+    const step_t steps[] = { { 0, 0, 1 }, { 40, 1, 1 }, { 300, 0, 0 }, { 310, 1, 0 },
+                             { 1000, 0, 1 }, { 1100, 1, 1 }, { 1200, 0, 0 }, { 1210, 1, 0 } };
+    const expect_t expect[] = { { GESTURE_CHORD, 0, 1, 40 }, { GESTURE_TAP, 0, 0, 1000 },
+                                { GESTURE_TAP, 1, 1, 1100 } };
+    RUN("acorde", GESTURE_BIND_CHORD, GESTURE_BIND_CHORD, steps, 2000, expect);
+}
+
+static void test_tap_first(void) {
+    // El toque sale al pisar aunque haya gestos asociados; la pulsación larga, el doble toque
+    // y el acorde llegan después, sin un segundo toque al soltar ni al vencer la espera
+    const step_t long_steps[] = { { 0, 0, 1 }, { 100, 0, 0 }, { 1000, 0, 1 }, { 2500, 0, 0 } };
+    const expect_t long_expect[] = { { GESTURE_TAP, 0, 0, 0 }, { GESTURE_TAP, 0, 0, 1000 },
+                                     { GESTURE_LONG_PRESS, 0, 0, 1600 } };
+    RUN("toque al pisar con pulsacion larga", GESTURE_BIND_LONG | GESTURE_BIND_TAP_FIRST, 0, long_steps, 3000,
+        long_expect);
+
+    const step_t double_steps[] = { { 0, 0, 1 }, { 80, 0, 0 }, { 200, 0, 1 }, { 260, 0, 0 },
+                                    { 1000, 0, 1 }, { 1050, 0, 0 } };
+    const expect_t double_expect[] = { { GESTURE_TAP, 0, 0, 0 }, { GESTURE_DOUBLE_TAP, 0, 0, 200 },
+                                       { GESTURE_TAP, 0, 0, 1000 } };
+    RUN("toque al pisar con doble toque", GESTURE_BIND_DOUBLE | GESTURE_BIND_TAP_FIRST, 0, double_steps, 2000,
+        double_expect);
+
+    const step_t chord_steps[] = { { 0, 0, 1 }, { 40, 1, 1 }, { 300, 0, 0 }, { 310, 1, 0 } };
+    const expect_t chord_expect[] = { { GESTURE_TAP, 0, 0, 0 }, { GESTURE_CHORD, 0, 1, 40 } };
+    RUN("toque al pisar con acorde", GESTURE_BIND_CHORD | GESTURE_BIND_TAP_FIRST,
+        GESTURE_BIND_CHORD | GESTURE_BIND_TAP_FIRST, chord_steps, 1000, chord_expect);
+}
+
+static void test_mixed_buttons(void) {
+    // Un botón con pulsación larga no retrasa a uno sin gestos pisado mientras tanto
+    const step_t steps[] = { { 0, 0, 1 }, { 100, 2, 1 }, { 150, 2, 0 }, { 800, 0, 0 } };
+    const expect_t expect[] = { { GESTURE_TAP, 2, 2, 100 }, { GESTURE_LONG_PRESS, 0, 0, 600 } };
+    RUN("botones mezclados", GESTURE_BIND_LONG, 0, steps, 1500, expect);
+}
+
+static void test_deadline(void) {
+    gesture_engine_t e;
+    record_t r = { .count = 0 };
+    gesture_init(&e, 4, on_gesture, &r);
+    gesture_bind(&e, 1, GESTURE_BIND_LONG | GESTURE_BIND_DOUBLE);
+    CHECK(gesture_next_deadline(&e) == GESTURE_NO_DEADLINE);
+
+    gesture_edge(&e, 1, true, 1000);
+    CHECK_EQ(gesture_next_deadline(&e), 1000 + 600000);
+    gesture_edge(&e, 1, false, 2000);
+    CHECK_EQ(gesture_next_deadline(&e), 2000 + 300000);
+    gesture_poll(&e, 302000);
+    CHECK(gesture_next_deadline(&e) == GESTURE_NO_DEADLINE);
+    CHECK_EQ(r.count, 1);
+
+    // Botones fuera de rango se ignoran
+    gesture_edge(&e, -1, true, 400000);
+    gesture_edge(&e, 4, true, 400000);
+    gesture_bind(&e, 7, GESTURE_BIND_LONG);
+    CHECK_EQ(r.count, 1);
+}
+
+int main(void) {
+    test_unbound();
+    test_long();
+    test_long_boundary();
+    test_double();
+    test_chord();
+    test_tap_first();
+    test_mixed_buttons();
+    test_deadline();
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,130 @@
+// input_map.c sobre gesture.c con los interruptores de fábrica de stubs/sdkconfig.h (página
+// anterior 0, siguiente 7) y un mapa de dos páginas. Se compila una vez por gesto de página
+// (APP_PAGE_GESTURE): los interruptores de página cambian de parche al pisar en los tres, y el
+// gesto llega después como acción aparte.
+#include "sdkconfig.h"
+#include "host_test.h"
+#include "input_map.h"
+
+#define SCAN_US  5000
+#define MAX_OUT  16
+#define PAGE_DOWN CONFIG_APP_PAGE_DOWN_BUTTON
+#define PAGE_UP   CONFIG_APP_PAGE_UP_BUTTON
+
+typedef struct {
+    int t_ms;
+    int button;
+    int pressed;
+} step_t;
+
+typedef struct {
+    input_action_t action;
+    int button;
+    int t_ms;
+} expect_t;
+
+typedef struct {
+    expect_t out[MAX_OUT];
+    int count;
+    int num_pages;
+} record_t;
+
+static void on_gesture(const gesture_t *g, void *arg) {
+    record_t *r = arg;
+    input_action_t action = input_map_gesture(g, r->num_pages);
+    if (action != INPUT_ACT_NONE && r->count < MAX_OUT) {
+        r->out[r->count++] = (expect_t){ action, g->button, (int)(g->time_us / 1000) };
+    }
+}
+
+// Como la tarea hw: flancos ya sin rebotes y un sondeo por escaneo
+static void run(const char *name, int num_pages, const step_t *steps, int num_steps, int end_ms,
+                const expect_t *expect, int num_expect) {
+    gesture_engine_t e;
+    record_t r = { .count = 0, .num_pages = num_pages };
+    gesture_init(&e, CONFIG_APP_NUM_BUTTONS, on_gesture, &r);
+    input_map_bind(&e, num_pages);
+
+    int next = 0;
+    for (int64_t t = 0; t <= end_ms * 1000LL; t += SCAN_US) {
+        for (; next < num_steps && steps[next].t_ms * 1000LL <= t; next++) {
+            gesture_edge(&e, steps[next].button, steps[next].pressed, t);
+        }
+        gesture_poll(&e, t);
+    }
+
+    if (r.count != num_expect) fprintf(stderr, "%s: %d acciones\n", name, r.count);
+    CHECK_EQ(r.count, num_expect);
+    for (int i = 0; i < num_expect && i < r.count; i++) {
+        if (r.out[i].action != expect[i].action || r.out[i].button != expect[i].button ||
+            r.out[i].t_ms != expect[i].t_ms) {
+            fprintf(stderr, "%s: accion %d\n", name, i);
+        }
+        CHECK_EQ(r.out[i].action, expect[i].action);
+        CHECK_EQ(r.out[i].button, expect[i].button);
+        CHECK_EQ(r.out[i].t_ms, expect[i].t_ms);
+    }
+}
+
+#define RUN(name, pages, steps, end_ms, expect) \
+    run(name, pages, steps, sizeof(steps) / sizeof(steps[0]), end_ms, expect, sizeof(expect) / sizeof(expect[0]))
+
+static void test_taps(void) {
+    // Un toque en cualquier interruptor, de página o no, es su parche en el flanco de bajada
+    const step_t steps[] = { { 0, PAGE_DOWN, 1 }, { 100, PAGE_DOWN, 0 }, { 1000, 3, 1 }, { 1100, 3, 0 },
+                             { 2000, PAGE_UP, 1 }, { 2100, PAGE_UP, 0 } };
+    const expect_t expect[] = { { INPUT_ACT_PATCH, PAGE_DOWN, 0 }, { INPUT_ACT_PATCH, 3, 1000 },
+                                { INPUT_ACT_PATCH, PAGE_UP, 2000 } };
+    RUN("toques", 2, steps, 3000, expect);
+}
+
+static void test_one_page(void) {
+    // Con una sola página no hay gestos de página: mantener, repetir o juntar solo cambian de parche
+    const step_t steps[] = { { 0, PAGE_DOWN, 1 }, { 1000, PAGE_DOWN, 0 }, { 1200, PAGE_UP, 1 },
+                             { 1250, PAGE_UP, 0 }, { 1350, PAGE_UP, 1 }, { 1400, PAGE_UP, 0 },
+                             { 2000, PAGE_DOWN, 1 }, { 2020, PAGE_UP, 1 }, { 2100, PAGE_DOWN, 0 },
+                             { 2100, PAGE_UP, 0 } };
+    const expect_t expect[] = { { INPUT_ACT_PATCH, PAGE_DOWN, 0 }, { INPUT_ACT_PATCH, PAGE_UP, 1200 },
+                                { INPUT_ACT_PATCH, PAGE_UP, 1350 }, { INPUT_ACT_PATCH, PAGE_DOWN, 2000 },
+                                { INPUT_ACT_PATCH, PAGE_UP, 2020 } };
+    RUN("una pagina", 1, steps, 3000, expect);
+}
+
+#if CONFIG_APP_PAGE_GESTURE_DOUBLE
+static void test_page_gesture(void) {
+    // Doble toque: el primero ya cambió de parche, el segundo solo cambia de página
+    const step_t steps[] = { { 0, PAGE_UP, 1 }, { 80, PAGE_UP, 0 }, { 200, PAGE_UP, 1 }, { 260, PAGE_UP, 0 },
+                             { 1000, PAGE_DOWN, 1 }, { 1050, PAGE_DOWN, 0 }, { 1150, PAGE_DOWN, 1 },
+                             { 1200, PAGE_DOWN, 0 } };
+    const expect_t expect[] = { { INPUT_ACT_PATCH, PAGE_UP, 0 }, { INPUT_ACT_PAGE_UP, PAGE_UP, 200 },
+                                { INPUT_ACT_PATCH, PAGE_DOWN, 1000 }, { INPUT_ACT_PAGE_DOWN, PAGE_DOWN, 1150 } };
+    RUN("doble toque", 2, steps, 2000, expect);
+}
+#elif CONFIG_APP_PAGE_GESTURE_CHORD
+static void test_page_gesture(void) {
+    // Los dos a la vez: el primero ya cambió de parche, el segundo da la página siguiente.
+    // Con más de 60 ms entre ellos son dos toques
+    const step_t steps[] = { { 0, PAGE_DOWN, 1 }, { 40, PAGE_UP, 1 }, { 300, PAGE_DOWN, 0 }, { 310, PAGE_UP, 0 },
+                             { 1000, PAGE_UP, 1 }, { 1100, PAGE_DOWN, 1 }, { 1200, PAGE_UP, 0 },
+                             { 1200, PAGE_DOWN, 0 } };
+    const expect_t expect[] = { { INPUT_ACT_PATCH, PAGE_DOWN, 0 }, { INPUT_ACT_PAGE_UP, PAGE_DOWN, 40 },
+                                { INPUT_ACT_PATCH, PAGE_UP, 1000 }, { INPUT_ACT_PATCH, PAGE_DOWN, 1100 } };
+    RUN("acorde", 2, steps, 2000, expect);
+}
+#else
+static void test_page_gesture(void) {
+    // Mantener pulsado: el parche al pisar y la página al vencer los 600 ms, nada al soltar
+    const step_t steps[] = { { 0, PAGE_UP, 1 }, { 1000, PAGE_UP, 0 }, { 2000, PAGE_DOWN, 1 },
+                             { 2700, PAGE_DOWN, 0 } };
+    const expect_t expect[] = { { INPUT_ACT_PATCH, PAGE_UP, 0 }, { INPUT_ACT_PAGE_UP, PAGE_UP, 600 },
+                                { INPUT_ACT_PATCH, PAGE_DOWN, 2000 }, { INPUT_ACT_PAGE_DOWN, PAGE_DOWN, 2600 } };
+    RUN("pulsacion larga", 2, steps, 3000, expect);
+}
+#endif
+
+int main(void) {
+    test_taps();
+    test_one_page();
+    test_page_gesture();
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,246 @@
+// `inrec replay` en el PC: las grabaciones de test/host/data (líneas "I:" de `inrec dump`) pasan
+// por input_replay.c y el camino de pulsación de verdad (press.c) hasta la tarea MIDI
+// (class_driver.c) y la G6 de mock_usb.c, con un mapa de parches de dos páginas. La salida (líneas
+// del núcleo, bytes que llegan a la pedalera y cambios del indicador) se compara con su referencia
+// (.ref); si difiere se imprime entera con el prefijo "O:", y `tools/input_rec.py golden` la
+// convierte en la referencia nueva. El reloj de la tarea MIDI (mock_os.h) y el virtual van a la par.
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sdkconfig.h"
+#include "host_test.h"
+#include "esp_rom_crc.h"
+#include "esp_timer.h"
+#include "mock_idf.h"
+#include "mock_os.h"
+#include "mock_rmt.h"
+#include "mock_usb.h"
+#include "freertos/queue.h"
+#include "class_driver.h"
+#include "app_config.h"
+#include "patch_map.h"
+#include "led_feedback.h"
+#include "press.h"
+#include "input_rec.h"
+
+#define MAX_LINES   512
+#define LINE_LEN    96
+#define REPLY_MS    2       // La G6 devuelve el parche por MIDI IN
+#define DRAIN_MS    100     // Tras la reproducción, lo que tarde en llegar la última confirmación
+#define NUM_PAGES   2
+
+typedef struct {
+    const char *rec;
+    uint32_t scan_us;       // 0 = el de la grabación
+    const char *ref;
+} replay_case_t;
+
+// La misma grabación con el escaneo con que se grabó y con uno más rápido: ahí cada rebote
+// grabado dura varios escaneos, pasa el antirrebote y es otra pulsación
+static const replay_case_t cases[] = {
+    { "pisadas.inrec", 0, "pisadas_5ms.ref" },
+    { "pisadas.inrec", 1000, "pisadas_1ms.ref" },
+};
+
+static char lines[MAX_LINES][LINE_LEN];
+static int num_lines;
+static int64_t base_us;
+static uint32_t fb_version;
+
+static struct __attribute__((packed)) {
+    patch_map_header_t hdr;
+    patch_map_entry_t entries[NUM_PAGES * CONFIG_APP_NUM_BUTTONS];
+} map;
+
+static void add_line(const char *line) {
+    if (num_lines < MAX_LINES) snprintf(lines[num_lines], LINE_LEN, "%s", line);
+    num_lines++;
+}
+
+// Líneas de la prueba con el mismo reloj que las del núcleo
+static void __attribute__((format(printf, 1, 2))) add_linef(const char *fmt, ...) {
+    char line[LINE_LEN];
+    int n = snprintf(line, sizeof(line), "%lld ", (long long)(esp_timer_get_time() - base_us));
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(line + n, sizeof(line) - n, fmt, ap);
+    va_end(ap);
+    add_line(line);
+}
+
+static void on_line(input_replay_t *r, const char *line, size_t len) {
+    add_line(line);
+}
+
+static void on_press(input_replay_t *r, int button, input_action_t action) {
+    int led = button < r->num_leds ? button : -1;
+    if (!press_post(button, led, press_msg_type(action), r->page, base_us + r->now_us)) input_replay_out(r, "cola llena");
+}
+
+static const input_replay_hooks_t hooks = { .press = on_press, .line = on_line };
+
+// Lo que ha llegado a la pedalera y el estado del indicador si cambió
+static void drain(void) {
+    uint8_t out[32];
+    size_t n = mock_usb_take_out(out, sizeof(out));
+    if (n) {
+        char hex[2 * sizeof(out) + 1];
+        for (size_t i = 0; i < n; i++) sprintf(&hex[2 * i], "%02x", out[i]);
+        add_linef("midi %s", hex);
+    }
+    led_fb_view_t v;
+    led_feedback_poll(esp_timer_get_time(), &v);
+    if (v.version == fb_version) return;
+    fb_version = v.version;
+    static const char *const names[] = { "apagado", "pendiente", "confirmado", "fallo" };
+    add_linef("led %d %s", v.led, names[v.state]);
+}
+
+// La tarea MIDI da una vuelta por milisegundo hasta el instante virtual del escaneo
+static void run_until(int64_t virtual_us) {
+    while (esp_timer_get_time() - base_us < virtual_us) {
+        mock_os_run_ms(1);
+        drain();
+    }
+}
+
+static size_t load_rec(const char *dir, const char *name, uint8_t *out, size_t cap) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "no se puede abrir %s\n", path);
+        exit(2);
+    }
+    // Como tools/input_rec.py extract: solo cuentan las líneas "I:"
+    char line[160];
+    size_t n = 0;
+    while (fgets(line, sizeof(line), f)) {
+        const char *p = strstr(line, "I:");
+        if (!p) continue;
+        unsigned b;
+        for (p += 2; n < cap && sscanf(p, "%2x", &b) == 1; p += 2) out[n++] = (uint8_t)b;
+    }
+    fclose(f);
+    return n;
+}
+
+static int load_ref(const char *dir, const char *name, char (*out)[LINE_LEN]) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "no se puede abrir %s\n", path);
+        exit(2);
+    }
+    int n = 0;
+    while (n < MAX_LINES && fgets(out[n], LINE_LEN, f)) {
+        out[n][strcspn(out[n], "\r\n")] = 0;
+        n++;
+    }
+    fclose(f);
+    return n;
+}
+
+static void run_case(const char *dir, const replay_case_t *c) {
+    static uint8_t rec[INPUT_REC_BYTES];
+    static input_replay_t r;
+    static char ref[MAX_LINES][LINE_LEN];
+    size_t len = load_rec(dir, c->rec, rec, sizeof(rec));
+    const input_rec_header_t *h = (const input_rec_header_t *)rec;
+    uint32_t scan_us = c->scan_us ? c->scan_us : h->scan_us;
+
+    // Cada caso empieza con la pedalera en silencio y sin indicador
+    mock_os_run_ms(DRAIN_MS);
+    uint8_t discard[256];
+    mock_usb_take_out(discard, sizeof(discard));
+    led_feedback_clear();
+    led_fb_view_t v;
+    led_feedback_poll(esp_timer_get_time(), &v);
+    fb_version = v.version;
+    num_lines = 0;
+    base_us = esp_timer_get_time();
+
+    static app_config_t cfg;
+    app_config_copy(&cfg);
+    CHECK_EQ(input_replay_open(&r, rec, len, scan_us, patch_map_num_pages(), cfg.num_leds, &hooks, NULL), INPUT_REPLAY_OK);
+    CHECK_EQ(scan_us % 1000, 0);
+    do {
+        run_until((int64_t)r.scans * scan_us);
+    } while (input_replay_step(&r));
+    run_until(r.now_us + DRAIN_MS * 1000);
+
+    // Las cuentas del resumen de `inrec replay` también forman parte de la referencia
+    add_linef("escaneos %lu crudas %lu filtradas %lu gestos %lu pulsaciones %lu", (unsigned long)r.scans,
+              (unsigned long)r.raw_presses, (unsigned long)r.presses, (unsigned long)r.gestures_seen,
+              (unsigned long)r.press_actions);
+
+    int n = load_ref(dir, c->ref, ref);
+    bool same = n == num_lines && num_lines <= MAX_LINES;
+    for (int i = 0; same && i < n; i++) same = strcmp(ref[i], lines[i]) == 0;
+    if (!same) {
+        fprintf(stderr, "%s cada %lu us: la salida no coincide con %s\n", c->rec, (unsigned long)scan_us, c->ref);
+        for (int i = 0; i < num_lines && i < MAX_LINES; i++) printf("O:%s\n", lines[i]);
+        host_test_failures++;
+    }
+}
+
+// Lo que input_replay_open() rechaza sin emitir nada
+static void test_errors(void) {
+    static input_replay_t r;
+    static const input_replay_hooks_t none = { 0 };
+    uint8_t rec[64];
+    input_rec_header_t h = { .magic = INPUT_REC_MAGIC, .version = INPUT_REC_VERSION, .num_buttons = 8,
+                             .scan_us = 0, .num_edges = 1 };
+    memcpy(rec, &h, sizeof(h));
+    // Un flanco: 5000 us, interruptor 0
+    rec[sizeof(h)] = 0x88;
+    rec[sizeof(h) + 1] = 0x27;
+    rec[sizeof(h) + 2] = 0x01;
+    size_t len = sizeof(h) + 3;
+
+    CHECK_EQ(input_replay_open(&r, rec, len, 5000, 1, 8, &none, NULL), INPUT_REPLAY_OK);
+    // Escaneo 0 (el de esta cabecera): el bucle no avanzaría nunca
+    CHECK_EQ(input_replay_open(&r, rec, len, 0, 1, 8, &none, NULL), INPUT_REPLAY_BAD_SCAN);
+    CHECK_EQ(input_replay_open(&r, rec, len - 1, 5000, 1, 8, &none, NULL), INPUT_REPLAY_CORRUPT);
+    CHECK_EQ(input_replay_open(&r, rec, sizeof(h) - 1, 5000, 1, 8, &none, NULL), INPUT_REPLAY_NO_RECORDING);
+    rec[4] = INPUT_REC_VERSION + 1;
+    CHECK_EQ(input_replay_open(&r, rec, len, 5000, 1, 8, &none, NULL), INPUT_REPLAY_NO_RECORDING);
+}
+
+// Dos páginas: la 1 con el banco 0 y la 2 con el 1, parches 0..7 y 8..15
+static void load_map(void) {
+    for (int p = 0; p < NUM_PAGES; p++) {
+        for (int b = 0; b < CONFIG_APP_NUM_BUTTONS; b++) {
+            map.entries[p * CONFIG_APP_NUM_BUTTONS + b] = (patch_map_entry_t){
+                .bank_lsb = p, .program = p * CONFIG_APP_NUM_BUTTONS + b };
+        }
+    }
+    map.hdr = (patch_map_header_t){
+        .magic = PATCH_MAP_MAGIC, .version = PATCH_MAP_VERSION,
+        .num_buttons = CONFIG_APP_NUM_BUTTONS, .num_pages = NUM_PAGES,
+        .crc32 = esp_rom_crc32_le(0, (const uint8_t *)map.entries, sizeof(map.entries)),
+    };
+    mock_idf_set_partition("patchmap", &map, sizeof(map));
+    CHECK_EQ(patch_map_init(), ESP_OK);
+    CHECK_EQ(patch_map_num_pages(), NUM_PAGES);
+}
+
+int main(int argc, char **argv) {
+    const char *dir = argc > 1 ? argv[1] : "data";
+    test_errors();
+
+    mock_rmt_reset();
+    mock_os_reset();
+    mock_usb_reset();
+    midi_msg_queue = xQueueCreate(16, sizeof(midi_msg_t));
+    app_config_init();
+    load_map();
+    class_driver_setup();
+    mock_os_set_background(class_driver_loop);
+    mock_usb_connect();
+    mock_usb_set_reply_ms(REPLY_MS);
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) run_case(dir, &cases[i]);
+    return HOST_TEST_RESULT();
+}
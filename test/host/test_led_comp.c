@@ -0,0 +1,225 @@
+// led_comp.c: núcleos escalares contra sus fórmulas en todo el rango de entrada, render
+// contra un modelo LED a LED que no usa pesos ni máscaras, y la secuencia de instrucciones
+// de led_comp_pie.S emulada canal a canal contra los núcleos escalares. En el PC no hay PIE:
+// lo que se comprueba es que el algoritmo vectorial da lo mismo si cada instrucción hace lo
+// que dice el manual; `ledcomp` en la consola lo repite con las instrucciones de verdad.
+#include <stdlib.h>
+#include <string.h>
+#include "host_test.h"
+#include "led_comp.h"
+
+#define N 264           // Múltiplo de 8; 257 valores (0..256) y relleno
+
+// Instrucciones PIE sobre un canal int16 (EE.VADDS.S16, EE.VSUBS.S16, EE.VMIN/VMAX.S16,
+// EE.VMUL.S16 con SAR = 8: producto de 32 bits desplazado y truncado a 16)
+static int16_t sat16(int32_t v) {
+    return v > 32767 ? 32767 : v < -32768 ? -32768 : v;
+}
+static int16_t vadds(int16_t a, int16_t b) { return sat16(a + b); }
+static int16_t vsubs(int16_t a, int16_t b) { return sat16(a - b); }
+static int16_t vmin(int16_t a, int16_t b) { return a < b ? a : b; }
+static int16_t vmax(int16_t a, int16_t b) { return a > b ? a : b; }
+static int16_t vmul(int16_t a, int16_t b) { return (int16_t)(((int32_t)a * b) >> 8); }
+
+// Las mismas secuencias que led_comp_pie.S
+static void pie_add(int16_t *out, const int16_t *a, const int16_t *b, size_t n) {
+    for (size_t i = 0; i < n; i++) out[i] = vmin(vadds(a[i], b[i]), 255);
+}
+static void pie_max(int16_t *out, const int16_t *a, const int16_t *b, size_t n) {
+    for (size_t i = 0; i < n; i++) out[i] = vmax(a[i], b[i]);
+}
+static void pie_mul(int16_t *out, const int16_t *a, const int16_t *b, size_t n) {
+    for (size_t i = 0; i < n; i++) out[i] = vmul(a[i], b[i]);
+}
+static void pie_mix(int16_t *dst, const int16_t *src, const int16_t *w, size_t n) {
+    for (size_t i = 0; i < n; i++) dst[i] = vadds(vmul(src[i], w[i]), vmul(dst[i], vsubs(256, w[i])));
+}
+
+static const led_comp_kernels_t pie_model = {
+    .add = pie_add, .max = pie_max, .mul = pie_mul, .mix = pie_mix, .name = "modelo pie",
+};
+
+// Todos los pares a, b en 0..256 (los valores que pueden llegar a los núcleos)
+static void test_kernels(const led_comp_kernels_t *k) {
+    static int16_t a[N] __attribute__((aligned(16))), b[N] __attribute__((aligned(16)));
+    static int16_t out[N] __attribute__((aligned(16)));
+    int fails = host_test_failures;
+    for (int x = 0; x <= 256; x++) {
+        for (int i = 0; i < N; i++) {
+            a[i] = x;
+            b[i] = i <= 256 ? i : 0;
+        }
+        k->add(out, a, b, N);
+        for (int i = 0; i <= 256; i++) CHECK_EQ(out[i], x + i > 255 ? 255 : x + i);
+        k->max(out, a, b, N);
+        for (int i = 0; i <= 256; i++) CHECK_EQ(out[i], x > i ? x : i);
+        k->mul(out, a, b, N);
+        for (int i = 0; i <= 256; i++) CHECK_EQ(out[i], (x * i) >> 8);
+    }
+    // mix: dst y src en 0..255, w en 0..256
+    for (int d = 0; d < 256; d++) {
+        for (int s = 0; s < 256; s++) {
+            for (int i = 0; i < N; i++) {
+                out[i] = d;
+                a[i] = s;
+                b[i] = i <= 256 ? i : 0;
+            }
+            k->mix(out, a, b, N);
+            for (int w = 0; w <= 256; w++) CHECK_EQ(out[w], ((s * w) >> 8) + ((d * (256 - w)) >> 8));
+            if (host_test_failures > fails + 20) return;
+        }
+    }
+    CHECK_EQ(out[0], 255);      // w = 0 deja dst
+    CHECK_EQ(out[256], 255);    // w = 256 deja src
+    if (host_test_failures != fails) fprintf(stderr, "nucleos %s\n", k->name);
+}
+
+// El modelo emulado y los escalares sobre los mismos datos al azar, como `ledcomp` en la placa
+static void test_pie_vs_scalar(void) {
+    static int16_t a[N] __attribute__((aligned(16))), b[N] __attribute__((aligned(16)));
+    static int16_t o1[N] __attribute__((aligned(16))), o2[N] __attribute__((aligned(16)));
+    srand(46);
+    for (int round = 0; round < 2000; round++) {
+        for (int i = 0; i < N; i++) {
+            a[i] = rand() % 256;
+            b[i] = rand() % 257;
+            o1[i] = o2[i] = rand() % 256;
+        }
+        led_comp_scalar.mix(o1, a, b, N);
+        pie_model.mix(o2, a, b, N);
+        CHECK(memcmp(o1, o2, sizeof(o1)) == 0);
+        led_comp_scalar.add(o1, a, b, N);
+        pie_model.add(o2, a, b, N);
+        CHECK(memcmp(o1, o2, sizeof(o1)) == 0);
+        led_comp_scalar.max(o1, a, b, N);
+        pie_model.max(o2, a, b, N);
+        CHECK(memcmp(o1, o2, sizeof(o1)) == 0);
+        led_comp_scalar.mul(o1, a, b, N);
+        pie_model.mul(o2, a, b, N);
+        CHECK(memcmp(o1, o2, sizeof(o1)) == 0);
+    }
+}
+
+// Modelo del render LED a LED: solo las capas que cubren el LED, en orden, sobre negro
+typedef struct {
+    bool on;
+    uint8_t rgb[3];
+} model_px_t;
+
+typedef struct {
+    model_px_t px[LED_COMP_MAX_LAYERS][LED_COMP_MAX_LEDS];
+    uint8_t alpha[LED_COMP_MAX_LAYERS];
+    uint8_t mode[LED_COMP_MAX_LAYERS];
+} model_t;
+
+static int blend(int mode, int below, int v) {
+    switch (mode) {
+    case LED_BLEND_ADD: return below + v > 255 ? 255 : below + v;
+    case LED_BLEND_MAX: return below > v ? below : v;
+    case LED_BLEND_MULTIPLY: return (below * v) >> 8;
+    default: return v;
+    }
+}
+
+static void model_render(const model_t *m, int layers, int16_t *out) {
+    for (int led = 0; led < LED_COMP_MAX_LEDS; led++) {
+        for (int ch = 0; ch < 3; ch++) {
+            int acc = 0;
+            for (int l = 0; l < layers; l++) {
+                if (!m->px[l][led].on || m->alpha[l] == 0) continue;
+                int w = m->alpha[l] + (m->alpha[l] >> 7);
+                int v = blend(m->mode[l], acc, m->px[l][led].rgb[ch]);
+                acc = ((v * w) >> 8) + ((acc * (256 - w)) >> 8);
+            }
+            out[led * 3 + ch] = acc;
+        }
+    }
+}
+
+static void check_render(led_comp_t *c, const model_t *m, const char *what) {
+    int16_t expect[LED_COMP_MAX_LEDS * 3];
+    model_render(m, c->num_layers, expect);
+    const int16_t *got = led_comp_render(c);
+    CHECK(!led_comp_dirty(c));
+    if (memcmp(got, expect, sizeof(expect)) != 0) {
+        fprintf(stderr, "%s (%s)\n", what, c->k->name);
+        host_test_failures++;
+    }
+    for (int i = LED_COMP_MAX_LEDS * 3; i < LED_COMP_LANES; i++) CHECK_EQ(got[i], 0);
+}
+
+static void test_render(const led_comp_kernels_t *k) {
+    static led_comp_t c __attribute__((aligned(16)));
+    static model_t m;
+    led_comp_init(&c, 4);
+    led_comp_use(&c, k);
+    memset(&m, 0, sizeof(m));
+    for (int l = 0; l < 4; l++) m.alpha[l] = 255;
+    check_render(&c, &m, "sin capas");
+
+    // Casos conocidos sobre un LED
+    led_comp_set(&c, 0, 0, 255, 128, 0);
+    led_comp_set(&c, 1, 0, 255, 255, 255);
+    led_comp_layer_mode(&c, 1, LED_BLEND_MULTIPLY);
+    const int16_t *out = led_comp_render(&c);
+    CHECK_EQ(out[0], 254);      // 255 * 255 >> 8
+    CHECK_EQ(out[1], 127);
+    CHECK_EQ(out[2], 0);
+    led_comp_layer_mode(&c, 1, LED_BLEND_ADD);
+    out = led_comp_render(&c);
+    CHECK_EQ(out[0], 255);
+    CHECK_EQ(out[1], 255);
+    led_comp_layer_alpha(&c, 1, 0);
+    CHECK(led_comp_dirty(&c));
+    out = led_comp_render(&c);
+    CHECK_EQ(out[0], 255);
+    CHECK_EQ(out[1], 128);      // Capa con alfa 0: como si no estuviera
+    led_comp_unset(&c, 0, 0);
+    led_comp_unset(&c, 1, 0);
+    led_comp_layer_alpha(&c, 1, 255);
+    led_comp_layer_mode(&c, 1, LED_BLEND_REPLACE);
+
+    // Cambios al azar: cobertura, colores, alfas, modos y capas vaciadas
+    srand(4646);
+    for (int step = 0; step < 3000; step++) {
+        int l = rand() % 4, led = rand() % LED_COMP_MAX_LEDS, op = rand() % 16;
+        if (op < 9) {
+            uint8_t r = rand(), g = rand(), b = rand();
+            led_comp_set(&c, l, led, r, g, b);
+            m.px[l][led] = (model_px_t){ true, { r, g, b } };
+        } else if (op < 12) {
+            led_comp_unset(&c, l, led);
+            m.px[l][led].on = false;
+        } else if (op < 14) {
+            uint8_t a = (rand() & 3) == 0 ? 255 : rand();
+            led_comp_layer_alpha(&c, l, a);
+            m.alpha[l] = a;
+        } else if (op < 15) {
+            led_comp_layer_mode(&c, l, (led_blend_t)(rand() % 4));
+            m.mode[l] = c.layer[l].mode;
+        } else {
+            led_comp_clear(&c, l);
+            for (int i = 0; i < LED_COMP_MAX_LEDS; i++) m.px[l][i].on = false;
+        }
+        for (int i = 0; i < LED_COMP_MAX_LEDS; i++) CHECK_EQ(led_comp_covers(&c, l, i), m.px[l][i].on);
+        if (step % 7 == 0) check_render(&c, &m, "render al azar");
+    }
+
+    // Fuera de rango: no hace nada
+    led_comp_render(&c);
+    led_comp_set(&c, 4, 0, 1, 2, 3);
+    led_comp_set(&c, 0, LED_COMP_MAX_LEDS, 1, 2, 3);
+    led_comp_set(&c, 0, -1, 1, 2, 3);
+    led_comp_layer_alpha(&c, -1, 3);
+    CHECK(!led_comp_dirty(&c));
+    CHECK(!led_comp_covers(&c, 4, 0));
+}
+
+int main(void) {
+    test_kernels(&led_comp_scalar);
+    test_kernels(&pie_model);
+    test_pie_vs_scalar();
+    test_render(&led_comp_scalar);
+    test_render(&pie_model);
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,77 @@
+// De la pulsación a la luz en el RMT simulado: led_out.c con el backend de la configuración
+// (led_strip o, con CONFIG_APP_LED_FIXED_BACKEND, led_strip_fixed.h) y led_feedback.c, en el
+// mismo orden que pulsar_boton(). El fin de la transmisión lo marca on_trans_done, que en el
+// mock llega antes que la vuelta del envío por el retraso de despertar de la tarea.
+#include "sdkconfig.h"
+#include "host_test.h"
+#include "mock_rmt.h"
+#include "esp_timer.h"
+#include "led_feedback.h"
+#include "led_out.h"
+
+#define WAKE_US 40
+// WS2812 a 10 MHz: 12 ticks por bit y el código de reset (2 x 1400 ticks). Con 8 LEDs son
+// 510,4 us: las medidas en us enteros pueden llevar uno más
+#define FRAME_US ((CONFIG_APP_NUM_LEDS * 24 * 12 + 2800) / 10)
+
+static void pulsar(int led, int64_t press_us, led_out_frame_t *f) {
+    led_feedback_press(led, press_us);
+    led_out_set(led, 0, 0, 255);
+    CHECK_EQ(led_out_refresh(f), ESP_OK);
+    led_feedback_photon(press_us, f->start_us, f->done_us);
+}
+
+int main(void) {
+    mock_rmt_reset();
+    mock_rmt_set_wake_delay_ns(WAKE_US * 1000);
+    CHECK_EQ(led_out_init(39), ESP_OK);
+    CHECK(led_out_level_in_encoder());
+    rmt_channel_handle_t chan = mock_rmt_channel(0);
+    CHECK(chan != NULL);
+
+    // Flanco a los 10 ms; el antirrebote y la tarea hw lo atienden 3 ms después
+    mock_rmt_advance_ns(10000000);
+    int64_t press = esp_timer_get_time();
+    mock_rmt_advance_ns(3000000);
+    led_out_frame_t f;
+    pulsar(0, press, &f);
+
+    mock_rmt_stats_t st;
+    mock_rmt_get_stats(chan, &st);
+    CHECK_EQ(st.frames, 1);
+    CHECK_EQ(f.start_us, st.start_ns / 1000);
+    CHECK_EQ(f.done_us, st.end_ns / 1000);          // Callback, no la vuelta
+    CHECK_EQ(f.return_us, st.end_ns / 1000 + WAKE_US);
+    CHECK(f.done_us - f.start_us >= FRAME_US && f.done_us - f.start_us <= FRAME_US + 1);
+
+    led_fb_stats_t s;
+    led_feedback_get_stats(&s);
+    CHECK_EQ(s.press_to_photon.count, 1);
+    CHECK_EQ(s.press_to_photon.max_us, 3000 + FRAME_US);
+    CHECK_EQ(s.frame_to_photon.max_us, FRAME_US);
+
+    // Solo el primer frame con el color pendiente cuenta
+    led_out_refresh(&f);
+    led_feedback_photon(press, f.start_us, f.done_us);
+    led_feedback_get_stats(&s);
+    CHECK_EQ(s.press_to_photon.count, 1);
+
+    // Brillo en la tabla de niveles: no cambia nada de la medida
+    led_out_set_level(64);
+    mock_rmt_advance_ns(20000000);
+    int64_t press2 = esp_timer_get_time();
+    mock_rmt_advance_ns(5000000);
+    pulsar(1, press2, &f);
+    led_feedback_get_stats(&s);
+    CHECK_EQ(s.press_to_photon.count, 2);
+    CHECK_EQ(s.press_to_photon.max_us, f.done_us - press2);
+    CHECK(f.done_us - press2 >= 5000 + FRAME_US && f.done_us - press2 <= 5000 + FRAME_US + 1);
+    CHECK_EQ(s.press_to_photon.total_us, 3000 + FRAME_US + f.done_us - press2);
+
+    // Un frame de una pulsación ya sustituida no se anota
+    led_feedback_photon(press, f.start_us, f.done_us);
+    led_feedback_get_stats(&s);
+    CHECK_EQ(s.press_to_photon.count, 2);
+    CHECK_EQ(mock_rmt_stalls(), 0);
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,278 @@
+// components/led_strip sobre el driver RMT simulado: interrupciones por frame frente a la
+// regla de led_strip_rmt_refills_for_length(), elección automática de bloque y DMA, grupos, y
+// tabla de niveles (gamma + brillo) de los dos backends frente a una codificación de referencia.
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "host_test.h"
+#include "mock_rmt.h"
+#include "led_strip.h"
+
+#define LED_STRIP_FIXED_LEN   8
+#define LED_STRIP_FIXED_BPP   3
+#define LED_STRIP_FIXED_MODEL LED_STRIP_FIXED_MODEL_WS2812
+#include "led_strip_fixed.h"
+
+static led_strip_handle_t new_strip(uint32_t len, const led_strip_rmt_config_t *rmt_config) {
+    led_strip_config_t strip_config = {
+        .strip_gpio_num = 39,
+        .max_leds = len,
+        .led_pixel_format = LED_PIXEL_FORMAT_GRB,
+        .led_model = LED_MODEL_WS2812,
+    };
+    led_strip_handle_t strip = NULL;
+    CHECK_EQ(led_strip_new_rmt_device(&strip_config, rmt_config, &strip), ESP_OK);
+    return strip;
+}
+
+// Interrupciones de recarga medidas en el RMT simulado para un frame
+static uint32_t measure_refills(uint32_t len, const led_strip_rmt_config_t *rmt_config) {
+    led_strip_handle_t strip = new_strip(len, rmt_config);
+    if (!strip) return UINT32_MAX;
+    for (uint32_t i = 0; i < len; i++) led_strip_set_pixel(strip, i, i, 255 - i, 0x5A);
+    CHECK_EQ(led_strip_refresh(strip), ESP_OK);
+
+    rmt_channel_handle_t chan;
+    mock_rmt_stats_t st = { 0 };
+    CHECK_EQ(led_strip_rmt_get_channel(strip, &chan), ESP_OK);
+    CHECK(mock_rmt_get_stats(chan, &st));
+    CHECK_EQ(st.frames, 1);
+    CHECK_EQ(st.symbols, len * 24 + 1);
+    led_strip_del(strip);
+    return st.refills;
+}
+
+static void test_refills(void) {
+    static const struct {
+        size_t mem_block_symbols;
+        bool dma;
+    } cases[] = { { 48, false }, { 96, false }, { 192, false }, { 1024, true }, { 4096, true } };
+
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        for (uint32_t len = 1; len <= 400; len++) {
+            led_strip_rmt_config_t cfg = {
+                .resolution_hz = 10000000,
+                .mem_block_symbols = cases[c].mem_block_symbols,
+                .flags.with_dma = cases[c].dma,
+            };
+            uint32_t measured = measure_refills(len, &cfg);
+            uint32_t rule = led_strip_rmt_refills_for_length(len, LED_PIXEL_FORMAT_GRB, &cfg);
+            if (measured != rule) {
+                fprintf(stderr, "%lu LEDs, %zu simbolos: medido %lu, regla %lu\n", (unsigned long)len,
+                        cases[c].mem_block_symbols, (unsigned long)measured, (unsigned long)rule);
+                CHECK_EQ(measured, rule);
+            }
+        }
+    }
+    // Bloque por defecto con mem_block_symbols a 0
+    led_strip_rmt_config_t def = { .resolution_hz = 10000000 };
+    led_strip_rmt_config_t one = { .resolution_hz = 10000000, .mem_block_symbols = 48 };
+    CHECK_EQ(led_strip_rmt_refills_for_length(8, LED_PIXEL_FORMAT_GRB, &def),
+             led_strip_rmt_refills_for_length(8, LED_PIXEL_FORMAT_GRB, &one));
+}
+
+static void test_config_for_length(void) {
+    uint32_t last_one = 0, last_two = 0;
+    for (uint32_t len = 1; len <= 1000; len++) {
+        led_strip_rmt_config_t cfg = { .resolution_hz = 10000000 };
+        led_strip_rmt_config_for_length(len, LED_PIXEL_FORMAT_GRB, &cfg);
+        uint32_t refills = led_strip_rmt_refills_for_length(len, LED_PIXEL_FORMAT_GRB, &cfg);
+        if (cfg.flags.with_dma) {
+            // Con DMA el buffer cabe el frame entero hasta el máximo de 4096 símbolos
+            CHECK(cfg.mem_block_symbols >= 1024 && cfg.mem_block_symbols <= 4096);
+            if (len * 24 + 2 <= 4096) CHECK_EQ(refills, 0);
+            continue;
+        }
+        // Sin DMA, dentro del límite y con el menor número de bloques que lo cumple
+        CHECK(refills <= LED_STRIP_RMT_AUTO_MAX_REFILLS);
+        if (cfg.mem_block_symbols == 48) last_one = len;
+        if (cfg.mem_block_symbols == 96) last_two = len;
+        CHECK(cfg.mem_block_symbols == 48 || cfg.mem_block_symbols == 96);
+    }
+    // Un bloque llega a 17 LEDs (17 recargas darían 18), dos bloques a 35
+    CHECK_EQ(last_one, 17);
+    CHECK_EQ(last_two, 35);
+
+    // La configuración elegida es la que mide el RMT simulado
+    static const uint32_t lengths[] = { 8, 17, 18, 35, 36, 144, 300 };
+    for (size_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++) {
+        led_strip_rmt_config_t cfg = { .resolution_hz = 10000000 };
+        led_strip_rmt_config_for_length(lengths[i], LED_PIXEL_FORMAT_GRB, &cfg);
+        CHECK_EQ(measure_refills(lengths[i], &cfg), led_strip_rmt_refills_for_length(lengths[i], LED_PIXEL_FORMAT_GRB, &cfg));
+    }
+}
+
+static int64_t frame_ns(led_strip_handle_t strip) {
+    rmt_channel_handle_t chan;
+    mock_rmt_stats_t st = { 0 };
+    led_strip_rmt_get_channel(strip, &chan);
+    mock_rmt_get_stats(chan, &st);
+    return st.end_ns - st.start_ns;
+}
+
+static int64_t frame_start_ns(led_strip_handle_t strip) {
+    rmt_channel_handle_t chan;
+    mock_rmt_stats_t st = { 0 };
+    led_strip_rmt_get_channel(strip, &chan);
+    mock_rmt_get_stats(chan, &st);
+    return st.start_ns;
+}
+
+static uint32_t frames_sent(led_strip_handle_t strip) {
+    rmt_channel_handle_t chan;
+    mock_rmt_stats_t st = { 0 };
+    led_strip_rmt_get_channel(strip, &chan);
+    mock_rmt_get_stats(chan, &st);
+    return st.frames;
+}
+
+static void test_group(void) {
+    // Cuatro canales de un bloque, como en `ledgroup`
+    static const uint32_t lengths[] = { 8, 16, 8, 12 };
+    led_strip_handle_t strips[4];
+    led_strip_rmt_config_t cfg = { .resolution_hz = 10000000, .mem_block_symbols = 48 };
+    for (int i = 0; i < 4; i++) strips[i] = new_strip(lengths[i], &cfg);
+
+    for (int n = 2; n <= 4; n++) {
+        // Secuencial: la suma de los frames
+        int64_t t0 = mock_rmt_now_ns(), sum = 0, longest = 0;
+        for (int i = 0; i < n; i++) {
+            CHECK_EQ(led_strip_refresh(strips[i]), ESP_OK);
+            sum += frame_ns(strips[i]);
+            if (frame_ns(strips[i]) > longest) longest = frame_ns(strips[i]);
+        }
+        CHECK_EQ(mock_rmt_now_ns() - t0, sum);
+
+        // En grupo: lo que dura el más largo, y todos salen a la vez
+        uint32_t before[4];
+        for (int i = 0; i < n; i++) before[i] = frames_sent(strips[i]);
+        led_strip_rmt_group_handle_t group;
+        CHECK_EQ(led_strip_rmt_new_group(strips, n, &group), ESP_OK);
+        t0 = mock_rmt_now_ns();
+        CHECK_EQ(led_strip_rmt_group_refresh(group), ESP_OK);
+        CHECK_EQ(mock_rmt_now_ns() - t0, longest);
+        for (int i = 0; i < n; i++) {
+            CHECK_EQ(frames_sent(strips[i]), before[i] + 1);
+            CHECK_EQ(frame_start_ns(strips[i]), t0);
+        }
+
+        // Una tira sincronizada no se puede refrescar sola: antes se quedaba esperando para siempre
+        CHECK_EQ(led_strip_refresh(strips[0]), ESP_ERR_INVALID_STATE);
+        CHECK_EQ(led_strip_clear(strips[1]), ESP_ERR_INVALID_STATE);
+        CHECK_EQ(mock_rmt_stalls(), 0);
+
+        // Una tira no puede estar en dos grupos
+        led_strip_rmt_group_handle_t other;
+        CHECK_EQ(led_strip_rmt_new_group(strips, 1, &other), ESP_ERR_INVALID_STATE);
+
+        CHECK_EQ(led_strip_rmt_del_group(group), ESP_OK);
+        for (int i = 0; i < n; i++) CHECK_EQ(frames_sent(strips[i]), before[i] + 1);
+        printf("%d tiras: secuencial %lld us, grupo %lld us\n", n, (long long)(sum / 1000), (long long)(longest / 1000));
+    }
+
+    // Sin gestor de sincronización (grupo de una) la tira se sigue refrescando sola
+    led_strip_rmt_group_handle_t single;
+    CHECK_EQ(led_strip_rmt_new_group(strips, 1, &single), ESP_OK);
+    CHECK_EQ(led_strip_refresh(strips[0]), ESP_OK);
+    CHECK_EQ(led_strip_rmt_group_refresh(single), ESP_OK);
+    CHECK_EQ(led_strip_rmt_del_group(single), ESP_OK);
+
+    // Después de borrar el grupo vuelve a funcionar sola
+    CHECK_EQ(led_strip_refresh(strips[3]), ESP_OK);
+    for (int i = 0; i < 4; i++) led_strip_del(strips[i]);
+}
+
+// Lo que tiene que salir por el pin: cada byte por la tabla, bit a bit con los tiempos WS2812
+// (0,3/0,9 us el cero, 0,9/0,3 us el uno, en ticks de 0,1 us) y el código de reset de 280 us
+static size_t reference_frame(const uint8_t *bytes, size_t len, uint8_t brightness, float gamma, rmt_symbol_word_t *out) {
+    const rmt_symbol_word_t bit0 = { .level0 = 1, .duration0 = 3, .level1 = 0, .duration1 = 9 };
+    const rmt_symbol_word_t bit1 = { .level0 = 1, .duration0 = 9, .level1 = 0, .duration1 = 3 };
+    const rmt_symbol_word_t reset = { .level0 = 0, .duration0 = 1400, .level1 = 0, .duration1 = 1400 };
+    size_t n = 0;
+    for (size_t i = 0; i < len; i++) {
+        double g = floor(pow(bytes[i] / 255.0, gamma) * 255.0 + 0.5);
+        uint8_t v = (uint8_t)floor(g * brightness / 255.0 + 0.5);
+        for (int bit = 7; bit >= 0; bit--) out[n++] = (v >> bit) & 1 ? bit1 : bit0;
+    }
+    out[n++] = reset;
+    return n;
+}
+
+static void check_frame(const char *name, rmt_channel_handle_t chan, const rmt_symbol_word_t *ref, size_t ref_len) {
+    size_t len;
+    const rmt_symbol_word_t *frame = mock_rmt_frame(chan, &len);
+    CHECK_EQ(len, ref_len);
+    for (size_t i = 0; i < len && i < ref_len; i++) {
+        if (frame[i].val != ref[i].val) {
+            fprintf(stderr, "%s: simbolo %zu\n", name, i);
+            CHECK_EQ(frame[i].val, ref[i].val);
+            break;
+        }
+    }
+}
+
+static void test_levels(void) {
+    static const struct {
+        uint8_t brightness;
+        float gamma;
+    } levels[] = { { 255, 1.0f }, { 128, 1.0f }, { 0, 1.0f }, { 40, 2.2f }, { 255, 2.8f }, { 200, 0.5f } };
+    // 48 símbolos como el backend fijo; 50 deja ventanas que no son múltiplo de un byte
+    static const size_t blocks[] = { 48, 50 };
+    static led_strip_fixed_t fixed;
+    static rmt_symbol_word_t ref[LED_STRIP_FIXED_LEN * 3 * 8 + 1];
+    uint8_t pixels[LED_STRIP_FIXED_LEN * 3];
+
+    srand(1);
+    for (size_t l = 0; l < sizeof(levels) / sizeof(levels[0]); l++) {
+        for (size_t i = 0; i < sizeof(pixels); i += 3) {
+            // Orden GRB en el buffer
+            pixels[i] = rand() & 0xFF;
+            pixels[i + 1] = rand() & 0xFF;
+            pixels[i + 2] = rand() & 0xFF;
+        }
+        size_t ref_len = reference_frame(pixels, sizeof(pixels), levels[l].brightness, levels[l].gamma, ref);
+
+        for (size_t b = 0; b < sizeof(blocks) / sizeof(blocks[0]); b++) {
+            led_strip_rmt_config_t cfg = { .resolution_hz = 10000000, .mem_block_symbols = blocks[b] };
+            led_strip_handle_t strip = new_strip(LED_STRIP_FIXED_LEN, &cfg);
+            CHECK_EQ(led_strip_rmt_set_gamma(strip, levels[l].gamma), ESP_OK);
+            CHECK_EQ(led_strip_rmt_set_brightness(strip, levels[l].brightness), ESP_OK);
+            for (int i = 0; i < LED_STRIP_FIXED_LEN; i++) {
+                led_strip_set_pixel(strip, i, pixels[i * 3 + 1], pixels[i * 3], pixels[i * 3 + 2]);
+            }
+            CHECK_EQ(led_strip_refresh(strip), ESP_OK);
+            rmt_channel_handle_t chan;
+            led_strip_rmt_get_channel(strip, &chan);
+            check_frame("encoder con tabla", chan, ref, ref_len);
+            led_strip_del(strip);
+        }
+
+        CHECK_EQ(led_strip_fixed_init(&fixed, 39), ESP_OK);
+        CHECK_EQ(led_strip_fixed_set_gamma(&fixed, levels[l].gamma), ESP_OK);
+        led_strip_fixed_set_brightness(&fixed, levels[l].brightness);
+        for (int i = 0; i < LED_STRIP_FIXED_LEN; i++) {
+            led_strip_fixed_set(&fixed, i, pixels[i * 3 + 1], pixels[i * 3], pixels[i * 3 + 2]);
+        }
+        CHECK_EQ(led_strip_fixed_refresh(&fixed), ESP_OK);
+        check_frame("backend fijo", fixed.chan, ref, ref_len);
+        // El buffer de píxeles sigue a escala completa
+        CHECK(memcmp(fixed.pixels, pixels, sizeof(pixels)) == 0);
+        fixed.encoder.base.del(&fixed.encoder.base);
+        rmt_del_channel(fixed.chan);
+    }
+
+    // Gamma no válida en los dos backends
+    led_strip_rmt_config_t cfg = { .resolution_hz = 10000000 };
+    led_strip_handle_t strip = new_strip(8, &cfg);
+    CHECK_EQ(led_strip_rmt_set_gamma(strip, 0.0f), ESP_ERR_INVALID_ARG);
+    led_strip_del(strip);
+    CHECK_EQ(led_strip_fixed_set_gamma(&fixed, -1.0f), ESP_ERR_INVALID_ARG);
+}
+
+int main(void) {
+    test_refills();
+    test_config_for_length();
+    test_group();
+    test_levels();
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,108 @@
+// Reloj MIDI (midi_clock.c) con el temporizador de mock_os.c: el interruptor del usuario y la
+// conexión de la pedalera deciden juntos si salen ticks, y reconectar respeta lo que pidió.
+#include <string.h>
+#include "host_test.h"
+#include "mock_os.h"
+#include "mock_rmt.h"
+#include "midi_clock.h"
+
+static int wakes;
+
+// La tarea MIDI no corre aquí: la prueba recoge los bytes ella misma
+void class_driver_wake(void) {
+    wakes++;
+}
+
+static size_t take(uint8_t *out) {
+    return midi_clock_take_pending(out, MIDI_CLOCK_PPQN + 2);
+}
+
+static void test_connect_toggle(void) {
+    uint8_t out[MIDI_CLOCK_PPQN + 2];
+    // Activado al encender, pero sin pedalera no sale nada
+    CHECK(!midi_clock_running());
+    mock_os_run_ms(100);
+    CHECK_EQ(take(out), 0);
+
+    midi_clock_on_connect();
+    CHECK(midi_clock_running());
+    CHECK_EQ(take(out), 1);
+    CHECK_EQ(out[0], 0xFA);
+    // 120 BPM: un tick cada 20833 us
+    mock_os_run_ms(100);
+    CHECK_EQ(take(out), 4);
+    CHECK_EQ(out[3], 0xF8);
+
+    // El usuario lo apaga: Stop y nada más
+    midi_clock_toggle();
+    CHECK(!midi_clock_running());
+    mock_os_run_ms(100);
+    CHECK_EQ(take(out), 1);
+    CHECK_EQ(out[0], 0xFC);
+
+    // Reconectar no lo vuelve a encender
+    midi_clock_on_disconnect();
+    midi_clock_on_connect();
+    CHECK(!midi_clock_running());
+    mock_os_run_ms(100);
+    CHECK_EQ(take(out), 0);
+
+    // Encendido de nuevo; al desconectar se descarta lo pendiente, Stop incluido
+    midi_clock_toggle();
+    CHECK(midi_clock_running());
+    mock_os_run_ms(50);
+    midi_clock_on_disconnect();
+    CHECK(!midi_clock_running());
+    CHECK_EQ(take(out), 0);
+
+    // Apagado y encendido sin pedalera: solo se recuerda
+    midi_clock_toggle();
+    midi_clock_toggle();
+    CHECK(!midi_clock_running());
+    midi_clock_on_connect();
+    CHECK(midi_clock_running());
+    CHECK_EQ(take(out), 1);
+    CHECK(wakes > 0);
+}
+
+static void test_tempo(void) {
+    uint8_t out[MIDI_CLOCK_PPQN + 2];
+    midi_clock_set_bpm(60);
+    CHECK_EQ(midi_clock_get_bpm(), 60);
+    take(out);
+    // 60 BPM: un tick cada 41666 us; 250 ms son 6
+    mock_os_run_ms(250);
+    CHECK_EQ(take(out), 6);
+    midi_clock_set_bpm(MIDI_CLOCK_MAX_BPM + 100);
+    CHECK_EQ(midi_clock_get_bpm(), MIDI_CLOCK_MAX_BPM);
+
+    // Dos envíos de un tick separados exactamente por el periodo: sin desviación
+    midi_clock_set_bpm(60);
+    midi_clock_stats_t before, s;
+    midi_clock_get_stats(&before);
+    midi_clock_record_tx(1000000, 1);
+    midi_clock_record_tx(1000000 + 60000000 / (60 * MIDI_CLOCK_PPQN), 1);
+    midi_clock_record_tx(1000000 + 3 * 60000000 / (60 * MIDI_CLOCK_PPQN) + 300, 2);
+    midi_clock_get_stats(&s);
+    CHECK_EQ(s.ticks_sent - before.ticks_sent, 4);
+    CHECK_EQ(s.ticks_merged - before.ticks_merged, 1);
+    CHECK_EQ(s.jitter_hist[0] - before.jitter_hist[0], 1);
+    CHECK_EQ(s.jitter_hist[3] - before.jitter_hist[3], 1);
+
+    // `reset` de la consola: contadores a cero, el reloj sigue como estaba
+    midi_clock_reset_stats();
+    midi_clock_get_stats(&s);
+    CHECK_EQ(s.ticks_sent, 0);
+    CHECK_EQ(s.max_jitter_us, 0);
+    CHECK_EQ(s.jitter_hist[3], 0);
+    CHECK_EQ(midi_clock_get_bpm(), 60);
+}
+
+int main(void) {
+    mock_rmt_reset();
+    mock_os_reset();
+    CHECK_EQ(midi_clock_init(), ESP_OK);
+    test_connect_toggle();
+    test_tempo();
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,136 @@
+// Orden de lo que llega a la pedalera (mock_usb.c) desde la tarea MIDI (class_driver.c): un
+// SysEx más largo que todas las transferencias libres sale en varias vueltas, y nada de lo que
+// se envía mientras tanto (pulsaciones, macros, pedal) puede caer entre sus trozos. Con ventana
+// de agrupación (CONFIG_APP_MIDI_COALESCE_MS) el lote sale al vencer la ventana o al llenarse,
+// no antes por mirar si cabría otra pulsación que no está en la cola.
+#include <string.h>
+#include "sdkconfig.h"
+#include "host_test.h"
+#include "esp_timer.h"
+#include "mock_os.h"
+#include "mock_rmt.h"
+#include "mock_usb.h"
+#include "freertos/queue.h"
+#include "class_driver.h"
+#include "app_config.h"
+#include "sysex.h"
+
+#define OUT_MAX 4096
+
+static uint8_t out[OUT_MAX];
+static size_t out_len;
+
+static void collect(void) {
+    out_len += mock_usb_take_out(&out[out_len], sizeof(out) - out_len);
+}
+
+static void post(uint8_t status, int button) {
+    midi_msg_t m = { .status = status, .data1 = button, .data2 = 0, .time_us = esp_timer_get_time() };
+    CHECK(class_driver_post(&m));
+}
+
+static void press(int button) {
+    post(MIDI_MSG_BUTTON, button);
+}
+
+// Recorre los paquetes USB MIDI: ningún mensaje de canal dentro de un SysEx abierto. Devuelve
+// los paquetes de canal y deja en sysex el SysEx reconstruido
+static int check_stream(uint8_t *sysex, size_t *sysex_len) {
+    bool open = false;
+    int channel = 0;
+    *sysex_len = 0;
+    for (size_t i = 0; i + 4 <= out_len; i += 4) {
+        const uint8_t *pkt = &out[i];
+        uint8_t cin = pkt[0] & 0x0F;
+        if (cin >= 0x04 && cin <= 0x07) {
+            size_t n = cin == 0x04 || cin == 0x07 ? 3 : cin - 0x04;
+            if (cin == 0x04 && pkt[1] == 0xF0) open = true;
+            memcpy(&sysex[*sysex_len], &pkt[1], n);
+            *sysex_len += n;
+            if (cin != 0x04) open = false;
+        } else if (cin >= 0x08 && cin <= 0x0E) {
+            if (open) {
+                fprintf(stderr, "mensaje de canal %02x en el paquete %u, dentro del SysEx\n", pkt[1], (unsigned)(i / 4));
+                host_test_failures++;
+            }
+            channel++;
+        }
+    }
+    return channel;
+}
+
+static void test_sysex_split(void) {
+    // El SysEx más largo: más paquetes de los que caben en todas las transferencias juntas
+    static uint8_t msg[SYSEX_MAX_TX_LEN];
+    msg[0] = 0xF0;
+    for (size_t i = 1; i < sizeof(msg) - 1; i++) msg[i] = i & 0x7F;
+    msg[sizeof(msg) - 1] = 0xF7;
+    out_len = 0;
+    CHECK_EQ(sysex_send(msg, sizeof(msg), 0), ESP_OK);
+    // Una vuelta: la primera parte ocupa todas las transferencias
+    mock_os_run_ms(1);
+
+    // Pisadas con el SysEx a medias: esperan a que termine
+    press(0);
+    press(1);
+    for (int i = 0; i < 20; i++) {
+        mock_os_run_ms(1);
+        collect();
+    }
+    static uint8_t sysex[SYSEX_MAX_TX_LEN + 3];
+    size_t sysex_len;
+    CHECK(check_stream(sysex, &sysex_len) >= 2);
+    CHECK_EQ(sysex_len, sizeof(msg));
+    CHECK(memcmp(sysex, msg, sizeof(msg)) == 0);
+}
+
+#if CONFIG_APP_MIDI_COALESCE_MS
+static void test_coalesce(void) {
+    // Dos canciones del mismo banco: tras la primera, cada paso es solo su Program Change
+    static app_config_t cfg;
+    app_config_copy(&cfg);
+    cfg.setlist_len = 2;
+    cfg.setlist[0] = (setlist_song_t){ .bank_lsb = 0, .program = 0, .scene = SETLIST_SCENE_NONE };
+    cfg.setlist[1] = (setlist_song_t){ .bank_lsb = 0, .program = 1, .scene = SETLIST_SCENE_NONE };
+    app_config_set(&cfg);
+    mock_os_run_ms(2 * CONFIG_APP_MIDI_COALESCE_MS);
+    collect();
+    out_len = 0;
+
+    // 12 + 4 * 4 + 2 * 12 = 52 bytes: no cabe otra ráfaga del set list (16) pero sí otro
+    // parche (12), así que el lote no está lleno y espera a que venza la ventana
+    post(MIDI_MSG_SETLIST_NEXT, 0);
+    post(MIDI_MSG_SETLIST_NEXT, 0);
+    post(MIDI_MSG_SETLIST_PREV, 0);
+    post(MIDI_MSG_SETLIST_NEXT, 0);
+    post(MIDI_MSG_SETLIST_PREV, 0);
+    press(0);
+    press(4);
+    mock_os_run_ms(CONFIG_APP_MIDI_COALESCE_MS - 1);
+    collect();
+    CHECK_EQ(out_len, 0);
+    mock_os_run_ms(3);
+    collect();
+    CHECK_EQ(out_len, 52);
+}
+#endif
+
+int main(void) {
+    mock_rmt_reset();
+    mock_os_reset();
+    mock_usb_reset();
+    midi_msg_queue = xQueueCreate(16, sizeof(midi_msg_t));
+    app_config_init();
+    CHECK_EQ(sysex_init(), ESP_OK);
+    class_driver_setup();
+    mock_os_set_background(class_driver_loop);
+    mock_usb_connect();
+    mock_os_run_ms(5);
+    collect();
+
+    test_sysex_split();
+#if CONFIG_APP_MIDI_COALESCE_MS
+    test_coalesce();
+#endif
+    return HOST_TEST_RESULT();
+}
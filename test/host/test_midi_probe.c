@@ -0,0 +1,185 @@
+// `rtt` (midi_probe.c) contra class_driver.c de verdad: la sonda encola, la tarea MIDI arma el
+// lote y lo envía, y la respuesta entra por el análisis de MIDI IN. Con la pedalera simulada de
+// class_driver.c y con la G6 de mock_usb.c; al terminar, el parche actual y el set list tienen
+// que quedar como estaban (la tarea MIDI los repone al atender el fin de la sonda, que
+// midi_probe_run() deja en la cola al volver). La tarea MIDI corre una vez por milisegundo simulado (mock_os.h):
+// cada medida puede llevar hasta una vuelta de más por el envío y otra por la respuesta.
+#include <string.h>
+#include "sdkconfig.h"
+#include "host_test.h"
+#include "esp_timer.h"
+#include "mock_os.h"
+#include "mock_rmt.h"
+#include "mock_usb.h"
+#include "freertos/queue.h"
+#include "class_driver.h"
+#include "app_config.h"
+#include "patch_cache.h"
+#include "patch_map.h"
+#include "midi_probe.h"
+
+#define ROUNDS 3
+#define LOOP_US 1000
+
+static const setlist_song_t songs[] = {
+    { .bank_msb = 0, .bank_lsb = 0x1B, .program = 2, .scene = SETLIST_SCENE_NONE },
+    { .bank_msb = 0, .bank_lsb = 0x1B, .program = 0, .scene = SETLIST_SCENE_NONE },
+};
+
+static void post(uint8_t status) {
+    midi_msg_t m = { .status = status, .time_us = esp_timer_get_time() };
+    CHECK(class_driver_post(&m));
+    mock_os_run_ms(20);
+}
+
+static void check_current(uint8_t bank, uint8_t program) {
+    uint8_t b = 0, p = 0;
+    CHECK(patch_cache_get_current(&b, &p));
+    CHECK_EQ(b, bank);
+    CHECK_EQ(p, program);
+}
+
+static void check_samples(int rounds, const uint32_t *delay_ms, int32_t slack_us) {
+    for (int b = 0; b < CONFIG_APP_NUM_BUTTONS; b++) {
+        for (int r = 0; r < rounds; r++) {
+            int32_t s = midi_probe_sample(b, r);
+            int32_t d = delay_ms[b] * 1000;
+            if (s < d || s > d + slack_us) {
+                fprintf(stderr, "boton %d ronda %d: %ld us, se esperaba %ld..%ld\n", b, r, (long)s, (long)d,
+                        (long)(d + slack_us));
+                host_test_failures++;
+            }
+        }
+    }
+}
+
+// Pedalera simulada con la G6 conectada: nada sale al bus y el set list sigue sincronizado
+static void test_sim(void) {
+    const uint32_t delay_ms[CONFIG_APP_NUM_BUTTONS] = { 0, 3, 7, 12, 25, 40, 80, 150 };
+    class_driver_stats_t before, after;
+    class_driver_get_stats(&before);
+    uint8_t out[256];
+    mock_usb_take_out(out, sizeof(out));
+
+    midi_probe_run(0, ROUNDS, delay_ms, CONFIG_APP_NUM_BUTTONS);
+    mock_os_run_ms(10);
+
+    check_samples(ROUNDS, delay_ms, 2 * LOOP_US);
+    CHECK_EQ(midi_probe_sample(0, ROUNDS), -1);
+    // Cada cambio de parche ha sido una transferencia del pool, como con la pedalera
+    class_driver_get_stats(&after);
+    CHECK_EQ(after.transfers - before.transfers, ROUNDS * CONFIG_APP_NUM_BUTTONS);
+    CHECK_EQ(after.packets - before.packets, ROUNDS * CONFIG_APP_NUM_BUTTONS * 3);
+    CHECK_EQ(mock_usb_take_out(out, sizeof(out)), 0);
+
+    check_current(songs[0].bank_lsb, songs[0].program);
+    // El set list sigue en la primera canción y sincronizado: el paso siguiente es solo el
+    // Program Change (las dos canciones están en el mismo banco)
+    post(MIDI_MSG_SETLIST_NEXT);
+    CHECK_EQ(mock_usb_take_out(out, sizeof(out)), 4);
+    CHECK_EQ(out[1], 0xC0);
+    CHECK_EQ(out[2], songs[1].program);
+    post(MIDI_MSG_SETLIST_PREV);
+    mock_usb_take_out(out, sizeof(out));
+}
+
+// Un retardo por encima del tiempo límite cuenta como sin respuesta
+static void test_sim_timeout(void) {
+    const uint32_t delay_ms[] = { 4, 2500 };
+    midi_probe_run(0, 1, delay_ms, 2);
+    mock_os_run_ms(5);
+    CHECK(midi_probe_sample(0, 0) >= 4000 && midi_probe_sample(0, 0) <= 4000 + 2 * LOOP_US);
+    for (int b = 1; b < CONFIG_APP_NUM_BUTTONS; b++) CHECK_EQ(midi_probe_sample(b, 0), -1);
+    check_current(songs[0].bank_lsb, songs[0].program);
+    // La respuesta tardía de la simulada no llega a nadie después de la sonda
+    mock_os_run_ms(3000);
+    check_current(songs[0].bank_lsb, songs[0].program);
+}
+
+// La G6 de mock_usb.c confirma por MIDI IN; al terminar vuelve al parche de antes
+static void test_pedal(void) {
+    const uint32_t reply_ms = 9;
+    uint32_t delay_ms[CONFIG_APP_NUM_BUTTONS];
+    for (int b = 0; b < CONFIG_APP_NUM_BUTTONS; b++) delay_ms[b] = reply_ms;
+    mock_usb_set_reply_ms(reply_ms);
+    uint8_t out[512];
+    mock_usb_take_out(out, sizeof(out));
+
+    midi_probe_run(0, 2, NULL, 0);
+    mock_os_run_ms(reply_ms + 10);
+
+    // Una vuelta para el lote, otra para completar la transferencia y otra para la respuesta
+    check_samples(2, delay_ms, 3 * LOOP_US);
+    size_t n = mock_usb_take_out(out, sizeof(out));
+    CHECK_EQ(n, (2 * CONFIG_APP_NUM_BUTTONS + 1) * ZOOM_G6_PATCH_BYTES);
+    for (int b = 0; b < CONFIG_APP_NUM_BUTTONS && n >= ZOOM_G6_PATCH_BYTES; b++) {
+        uint8_t expect[ZOOM_G6_PATCH_BYTES];
+        patch_map_entry_t e = patch_map_get(0, b);
+        zoom_encode_patch(&e, expect);
+        CHECK(memcmp(&out[b * ZOOM_G6_PATCH_BYTES], expect, sizeof(expect)) == 0);
+    }
+    // Lo último que recibe la pedalera es el parche que tenía antes de la medida
+    const patch_map_entry_t prev = { .bank_lsb = songs[0].bank_lsb, .program = songs[0].program };
+    uint8_t expect[ZOOM_G6_PATCH_BYTES];
+    zoom_encode_patch(&prev, expect);
+    CHECK(n >= ZOOM_G6_PATCH_BYTES && memcmp(&out[n - ZOOM_G6_PATCH_BYTES], expect, sizeof(expect)) == 0);
+    check_current(songs[0].bank_lsb, songs[0].program);
+
+    // La posición del set list se conserva; la pedalera ha pasado por otros parches, así que el
+    // siguiente paso manda la ráfaga completa
+    post(MIDI_MSG_SETLIST_NEXT);
+    n = mock_usb_take_out(out, sizeof(out));
+    CHECK_EQ(n, ZOOM_G6_PATCH_BYTES);
+    CHECK_EQ(out[7], songs[1].bank_lsb);
+    CHECK_EQ(out[10], songs[1].program);
+    check_current(songs[1].bank_lsb, songs[1].program);
+}
+
+// Sin pedalera no contesta nadie: sin medidas y sin parche inventado
+static void test_no_pedal(void) {
+    mock_usb_disconnect();
+    mock_os_run_ms(5);
+    patch_cache_set_current(songs[0].bank_lsb, songs[0].program);
+    midi_probe_run(0, 2, NULL, 0);
+    mock_os_run_ms(5);
+    for (int b = 0; b < CONFIG_APP_NUM_BUTTONS; b++) CHECK_EQ(midi_probe_sample(b, 0), -1);
+    CHECK_EQ(midi_probe_sample(0, 1), -1);
+    check_current(songs[0].bank_lsb, songs[0].program);
+
+    // Sin parche conocido antes de la sonda tampoco lo hay después
+    patch_cache_set_current(0xFF, 0xFF);
+    const uint32_t delay_ms[] = { 1 };
+    midi_probe_run(0, 1, delay_ms, 1);
+    mock_os_run_ms(5);
+    CHECK(midi_probe_sample(0, 0) >= 0);
+    uint8_t b, p;
+    CHECK(!patch_cache_get_current(&b, &p));
+}
+
+int main(void) {
+    mock_rmt_reset();
+    mock_os_reset();
+    mock_usb_reset();
+    midi_msg_queue = xQueueCreate(16, sizeof(midi_msg_t));
+    app_config_init();
+    static app_config_t cfg;
+    app_config_copy(&cfg);
+    memcpy(cfg.setlist, songs, sizeof(songs));
+    cfg.setlist_len = sizeof(songs) / sizeof(songs[0]);
+    app_config_set(&cfg);
+
+    class_driver_setup();
+    mock_os_set_background(class_driver_loop);
+    mock_usb_connect();
+    mock_os_run_ms(5);
+
+    // Primera canción del set list: parche actual y set list sincronizado
+    post(MIDI_MSG_SETLIST_NEXT);
+    check_current(songs[0].bank_lsb, songs[0].program);
+
+    test_sim();
+    test_sim_timeout();
+    test_pedal();
+    test_no_pedal();
+    return HOST_TEST_RESULT();
+}
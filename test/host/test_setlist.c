@@ -0,0 +1,115 @@
+// Set list escrito con el comando `setlist` de la consola (config_cmd.c) y recorrido con los
+// mensajes de la tarea hw a través de class_driver.c hasta la G6 de mock_usb.c. Cambiar otro
+// ajuste de la configuración no recompila la lista ni pierde la sincronía con la pedalera.
+#include <string.h>
+#include "sdkconfig.h"
+#include "host_test.h"
+#include "esp_timer.h"
+#include "mock_os.h"
+#include "mock_rmt.h"
+#include "mock_usb.h"
+#include "freertos/queue.h"
+#include "class_driver.h"
+#include "app_config.h"
+#include "config_cmd.h"
+
+static int cmd(const char *line) {
+    char buf[128];
+    char *argv[8];
+    int argc = 0;
+    snprintf(buf, sizeof(buf), "%s", line);
+    for (char *tok = strtok(buf, " "); tok && argc < 8; tok = strtok(NULL, " ")) argv[argc++] = tok;
+    return config_cmd_setlist(argc, argv);
+}
+
+// Un paso del set list; devuelve los bytes que llegaron a la pedalera
+static size_t step(uint8_t status, uint8_t *out, size_t cap) {
+    midi_msg_t m = { .status = status, .time_us = esp_timer_get_time() };
+    CHECK(class_driver_post(&m));
+    mock_os_run_ms(20);
+    return mock_usb_take_out(out, cap);
+}
+
+// Paquetes USB MIDI de canal: CIN, status, datos
+static void check_packet(const uint8_t *pkt, uint8_t status, uint8_t d1, uint8_t d2) {
+    CHECK_EQ(pkt[0], status >> 4);
+    CHECK_EQ(pkt[1], status);
+    CHECK_EQ(pkt[2], d1);
+    CHECK_EQ(pkt[3], d2);
+}
+
+static void test_edit(void) {
+    CHECK_EQ(cmd("setlist add A 1"), 0);
+    CHECK_EQ(cmd("setlist add a 2 3"), 0);
+    CHECK_EQ(cmd("setlist add 2 4"), 0);
+    // Banco, parche o escena fuera de rango: no cambia nada
+    CHECK_EQ(cmd("setlist add AY 1"), 1);
+    CHECK_EQ(cmd("setlist add A 5"), 1);
+    CHECK_EQ(cmd("setlist add A 1 128"), 1);
+    CHECK_EQ(cmd("setlist add A"), 1);
+    CHECK_EQ(cmd("setlist"), 0);
+
+    static app_config_t cfg;
+    app_config_copy(&cfg);
+    CHECK_EQ(cfg.setlist_len, 3);
+    CHECK_EQ(cfg.setlist[1].bank_lsb, 0);
+    CHECK_EQ(cfg.setlist[1].program, 1);
+    CHECK_EQ(cfg.setlist[1].scene, 3);
+    CHECK_EQ(cfg.setlist[2].bank_lsb, 2);
+    CHECK_EQ(cfg.setlist[2].program, 3);
+    CHECK_EQ(cfg.setlist[2].scene, SETLIST_SCENE_NONE);
+}
+
+static void test_steps(void) {
+    uint8_t out[64];
+    // Primera canción desde un estado desconocido: la ráfaga completa
+    CHECK_EQ(step(MIDI_MSG_SETLIST_NEXT, out, sizeof(out)), 12);
+    check_packet(&out[0], 0xB0, 0x00, 0);
+    check_packet(&out[4], 0xB0, 0x20, 0);
+    check_packet(&out[8], 0xC0, 0, 0);
+    // Mismo banco: Program Change y la escena
+    CHECK_EQ(step(MIDI_MSG_SETLIST_NEXT, out, sizeof(out)), 8);
+    check_packet(&out[0], 0xC0, 1, 0);
+    check_packet(&out[4], 0xB0, CONFIG_APP_SETLIST_SCENE_CC, 3);
+    CHECK_EQ(step(MIDI_MSG_SETLIST_NEXT, out, sizeof(out)), 12);
+    check_packet(&out[4], 0xB0, 0x20, 2);
+    check_packet(&out[8], 0xC0, 3, 0);
+    // Fin de la lista: nada
+    CHECK_EQ(step(MIDI_MSG_SETLIST_NEXT, out, sizeof(out)), 0);
+    CHECK_EQ(step(MIDI_MSG_SETLIST_PREV, out, sizeof(out)), 16);
+    check_packet(&out[12], 0xB0, CONFIG_APP_SETLIST_SCENE_CC, 3);
+
+    // Otro ajuste de la configuración: la lista sigue sincronizada, así que volver a la
+    // primera canción es solo su Program Change
+    static app_config_t cfg;
+    app_config_copy(&cfg);
+    cfg.brightness = 100;
+    app_config_set(&cfg);
+    CHECK_EQ(step(MIDI_MSG_SETLIST_PREV, out, sizeof(out)), 4);
+    check_packet(&out[0], 0xC0, 0, 0);
+
+    // Con la lista cambiada no se sabe qué tiene la pedalera: la ráfaga completa
+    CHECK_EQ(cmd("setlist add B 1"), 0);
+    CHECK_EQ(step(MIDI_MSG_SETLIST_NEXT, out, sizeof(out)), 16);
+    check_packet(&out[8], 0xC0, 1, 0);
+
+    CHECK_EQ(cmd("setlist clear"), 0);
+    CHECK_EQ(step(MIDI_MSG_SETLIST_NEXT, out, sizeof(out)), 0);
+    CHECK_EQ(step(MIDI_MSG_SETLIST_PREV, out, sizeof(out)), 0);
+}
+
+int main(void) {
+    mock_rmt_reset();
+    mock_os_reset();
+    mock_usb_reset();
+    midi_msg_queue = xQueueCreate(16, sizeof(midi_msg_t));
+    app_config_init();
+    class_driver_setup();
+    mock_os_set_background(class_driver_loop);
+    mock_usb_connect();
+    mock_os_run_ms(5);
+
+    test_edit();
+    test_steps();
+    return HOST_TEST_RESULT();
+}
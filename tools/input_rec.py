@@ -0,0 +1,130 @@
+#!/usr/bin/env python3
+# Grabaciones de los interruptores del firmware (main/input_rec.h) y salida de su reproducción.
+#
+# La entrada de extract, golden y check es cualquier captura del log (idf.py monitor,
+# miniterm, un fichero...): se toman las líneas "I:" (grabación) u "O:" (salida de
+# `inrec replay`) y el resto se ignora.
+#
+# Uso:
+#   tools/input_rec.py extract captura.log pisadas.g6in   # guarda la última grabación volcada
+#   tools/input_rec.py show pisadas.g6in                  # flancos crudos legibles
+#   tools/input_rec.py load pisadas.g6in                  # comandos "inrec load" para pegar en la consola
+#   tools/input_rec.py golden captura.log pisadas.ref     # guarda la salida de una reproducción
+#   tools/input_rec.py check captura.log pisadas.ref      # la compara; sale con 1 si difiere
+import argparse
+import difflib
+import re
+import struct
+import sys
+
+MAGIC = 0x52493647
+VERSION = 1
+HEADER = struct.Struct('<IBBHII')  # magic, version, num_buttons, scan_us, initial, num_edges
+REC_LINE = re.compile(r'I:([0-9a-fA-F]+)')
+OUT_LINE = re.compile(r'O:(.*\S)')
+# El firmware acepta líneas de consola cortas: 64 bytes por comando
+LOAD_CHUNK = 64
+
+
+def read_lines(path, pattern):
+    with open(path, encoding='utf-8', errors='replace') as f:
+        return [m.group(1) for m in (pattern.search(line) for line in f) if m]
+
+
+def extract(args):
+    data = bytearray()
+    magic = struct.pack('<I', MAGIC)
+    for chunk in read_lines(args.log, REC_LINE):
+        raw = bytes.fromhex(chunk)
+        # Cada volcado empieza por la cabecera: se queda el último
+        if raw.startswith(magic):
+            data = bytearray()
+        data += raw
+    if not data:
+        sys.exit('sin grabacion en la entrada')
+    with open(args.out, 'wb') as f:
+        f.write(data)
+    print(f'{len(data)} bytes')
+
+
+def varint(data, pos):
+    value = shift = 0
+    while True:
+        b = data[pos]
+        pos += 1
+        value |= (b & 0x7F) << shift
+        shift += 7
+        if not b & 0x80:
+            return value, pos
+
+
+def show(args):
+    with open(args.file, 'rb') as f:
+        data = f.read()
+    magic, version, buttons, scan_us, initial, edges = HEADER.unpack_from(data)
+    if magic != MAGIC or version != VERSION:
+        sys.exit('no es una grabacion valida')
+    print(f'{buttons} interruptores, escaneo {scan_us} us, estado inicial {initial:0{buttons}b}, {edges} flancos')
+    pos, t, state = HEADER.size, 0, initial
+    for _ in range(edges):
+        dt, pos = varint(data, pos)
+        mask, pos = varint(data, pos)
+        t += dt
+        state ^= mask
+        print(f'{t / 1000:12.3f} ms  +{dt:8d} us  {state:0{buttons}b}')
+
+
+def load(args):
+    with open(args.file, 'rb') as f:
+        data = f.read()
+    for off in range(0, len(data), LOAD_CHUNK):
+        print(f'inrec load {off} {data[off:off + LOAD_CHUNK].hex()}')
+
+
+def golden(args):
+    lines = read_lines(args.log, OUT_LINE)
+    if not lines:
+        sys.exit('sin salida de reproduccion en la entrada')
+    with open(args.ref, 'w', encoding='utf-8') as f:
+        f.write('\n'.join(lines) + '\n')
+    print(f'{len(lines)} lineas')
+
+
+def check(args):
+    lines = read_lines(args.log, OUT_LINE)
+    with open(args.ref, encoding='utf-8') as f:
+        ref = f.read().splitlines()
+    diff = list(difflib.unified_diff(ref, lines, 'referencia', 'reproduccion', lineterm=''))
+    if diff:
+        print('\n'.join(diff))
+        sys.exit(1)
+    print(f'{len(lines)} lineas, igual que la referencia')
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Grabaciones de interruptores del controlador Zoom G6')
+    sub = parser.add_subparsers(dest='cmd', required=True)
+    p = sub.add_parser('extract', help='guarda la ultima grabacion volcada con "inrec dump"')
+    p.add_argument('log')
+    p.add_argument('out')
+    p.set_defaults(func=extract)
+    p = sub.add_parser('show', help='flancos de una grabacion')
+    p.add_argument('file')
+    p.set_defaults(func=show)
+    p = sub.add_parser('load', help='comandos de consola que cargan una grabacion')
+    p.add_argument('file')
+    p.set_defaults(func=load)
+    p = sub.add_parser('golden', help='guarda la salida de "inrec replay" como referencia')
+    p.add_argument('log')
+    p.add_argument('ref')
+    p.set_defaults(func=golden)
+    p = sub.add_parser('check', help='compara la salida de "inrec replay" con la referencia')
+    p.add_argument('log')
+    p.add_argument('ref')
+    p.set_defaults(func=check)
+    args = parser.parse_args()
+    args.func(args)
+
+
+if __name__ == '__main__':
+    main()
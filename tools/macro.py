@@ -0,0 +1,104 @@
+#!/usr/bin/env python3
+# Compila una macro de texto al bytecode del firmware (ver main/macro.h) y genera los
+# comandos de consola que la guardan en NVS para un botón.
+#
+# Entrada: una instrucción por línea; canales de 1 a 16, el resto de valores tal cual van
+# en el mensaje MIDI (0..127, decimal o 0x..). Las líneas vacías y lo que sigue a '#' se ignoran.
+#   cc <canal> <control> <valor>
+#   pc <canal> <programa>
+#   bank <canal> <msb> <lsb>      # Bank Select MSB + LSB
+#   delay <ms>                    # La suma de esperas no puede pasar de 2000 ms
+#   sysex F0 52 00 64 ... F7      # Bytes en hexadecimal
+#
+# Uso:
+#   tools/macro.py escena.txt 3            # comandos "macro load"/"macro commit" para el botón 3
+#   tools/macro.py escena.txt 3 --hex      # solo el bytecode, para revisarlo
+import argparse
+import sys
+
+OP_END = 0x00
+OP_DELAY = 0x01
+MAX_CODE_LEN = 256
+MAX_BURST_MS = 2000
+SYSEX_MAX_LEN = 512
+# El firmware acepta líneas de consola cortas: 64 bytes por comando
+LOAD_CHUNK = 64
+
+
+def data_byte(text):
+    value = int(text, 0)
+    if not 0 <= value <= 127:
+        raise ValueError(f'valor fuera de rango (0..127): {text}')
+    return value
+
+
+def channel(text):
+    ch = int(text, 0)
+    if not 1 <= ch <= 16:
+        raise ValueError(f'canal fuera de rango (1..16): {text}')
+    return ch - 1
+
+
+def compile_line(words, total_ms):
+    op, args = words[0].lower(), words[1:]
+    if op == 'cc' and len(args) == 3:
+        return [0xB0 | channel(args[0]), data_byte(args[1]), data_byte(args[2])], total_ms
+    if op == 'pc' and len(args) == 2:
+        return [0xC0 | channel(args[0]), data_byte(args[1])], total_ms
+    if op == 'bank' and len(args) == 3:
+        ch = 0xB0 | channel(args[0])
+        return [ch, 0x00, data_byte(args[1]), ch, 0x20, data_byte(args[2])], total_ms
+    if op == 'delay' and len(args) == 1:
+        ms = int(args[0], 0)
+        total_ms += ms
+        if ms < 0 or total_ms > MAX_BURST_MS:
+            raise ValueError(f'la suma de esperas pasa de {MAX_BURST_MS} ms')
+        return [OP_DELAY, ms & 0x7F, (ms >> 7) & 0x7F], total_ms
+    if op == 'sysex' and args:
+        msg = [int(b, 16) for b in args]
+        if (len(msg) < 2 or msg[0] != 0xF0 or msg[-1] != 0xF7 or len(msg) > SYSEX_MAX_LEN
+                or any(b > 0x7F for b in msg[1:-1])):
+            raise ValueError('el SysEx tiene que ir de F0 a F7 con datos de 7 bits')
+        return msg, total_ms
+    raise ValueError(f'instruccion no valida: {" ".join(words)}')
+
+
+def compile_macro(path):
+    code = []
+    total_ms = 0
+    with open(path, encoding='utf-8') as f:
+        for num, line in enumerate(f, 1):
+            words = line.split('#', 1)[0].split()
+            if not words:
+                continue
+            try:
+                out, total_ms = compile_line(words, total_ms)
+            except ValueError as e:
+                sys.exit(f'{path}:{num}: {e}')
+            code += out
+    code.append(OP_END)
+    if len(code) > MAX_CODE_LEN:
+        sys.exit(f'la macro ocupa {len(code)} bytes; el maximo es {MAX_CODE_LEN}')
+    return bytes(code)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Macros por boton del controlador Zoom G6')
+    parser.add_argument('input')
+    parser.add_argument('button', type=int, help='boton, desde 1')
+    parser.add_argument('--hex', action='store_true', help='muestra el bytecode en vez de los comandos')
+    args = parser.parse_args()
+    if args.button < 1:
+        sys.exit('los botones empiezan en 1')
+
+    code = compile_macro(args.input)
+    if args.hex:
+        print(code.hex())
+        return
+    for off in range(0, len(code), LOAD_CHUNK):
+        print(f'macro load {off} {code[off:off + LOAD_CHUNK].hex()}')
+    print(f'macro commit {args.button}')
+
+
+if __name__ == '__main__':
+    main()
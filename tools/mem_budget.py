@@ -0,0 +1,150 @@
+#!/usr/bin/env python3
+# Informe de memoria estática del controlador. Lo ejecuta el build después de cada
+# enlazado (build/mem_budget.txt), pero también se puede lanzar a mano.
+#
+# - Pilas de las tareas según main/mem_layout.h y la configuración. En modo estático el
+#   tamaño del TCB se saca del .map (los task_tcb_ de APP_TASK_CREATE); sin .map no se suma.
+# - Variables estáticas de main y led_strip en DRAM, con su tamaño real sacado del .map.
+# - Con --hwm, una captura del comando "tasks" de la consola: pico de pila medido y
+#   tamaño propuesto (pico + STACK_MARGIN, redondeado a 256 bytes).
+#
+# Uso:
+#   tools/mem_budget.py --map build/usb_host_lib_example.map --sdkconfig build/config/sdkconfig.json
+#   tools/mem_budget.py --layout main/mem_layout.h --hwm captura_tasks.log
+import argparse
+import json
+import re
+import sys
+
+DEFINE = re.compile(r'^#define\s+(STACK_\w+|MIDI_QUEUE_LEN)\s+(\d+)', re.M)
+
+# Símbolos de entrada en el .map: el nombre puede ir solo en una línea y la dirección en la siguiente
+MAP_SECTION = re.compile(r'^ (\.(?:bss|data|dram1?|sbss|sdata)(?:\.\S+)?|COMMON)\s*\n?\s+(0x[0-9a-f]+)\s+(0x[0-9a-f]+)\s+(\S+)$',
+                         re.M)
+OWN_LIBS = re.compile(r'lib(main|led_strip)\.a\((\S+?)\.obj\)')
+# TCB estático de APP_TASK_CREATE: sizeof(StaticTask_t) tal como lo compiló el build
+TCB_SYMBOL = re.compile(r'^ \.bss\.task_tcb_\S*\s*\n?\s+0x[0-9a-f]+\s+(0x[0-9a-f]+)', re.M)
+
+# Línea de "tasks": nombre core cpu% libre pila
+TASKS_LINE = re.compile(r'^\s*(\w+)\s+(-?\d+)\s+\d+\.\d\s+(\d+)\s+(\d+)\s*$')
+
+# Tarea -> (define de la pila, opción que la activa o None si siempre existe)
+TASKS = {
+    'hw': ('STACK_HW', None),
+    'midi': ('STACK_MIDI', None),
+    'usb': ('STACK_USB', None),
+    'cache': ('STACK_CACHE', None),
+    'cfg': ('STACK_CFG', None),
+    'trace': ('STACK_TRACE', 'APP_TRACE_ENABLE'),
+    'expr': ('STACK_EXPR', 'APP_EXPRESSION_ENABLE'),
+}
+
+
+def round_up(value, step):
+    return (value + step - 1) // step * step
+
+
+def read_layout(path):
+    with open(path, encoding='utf-8') as f:
+        return {m.group(1): int(m.group(2)) for m in DEFINE.finditer(f.read())}
+
+
+def read_hwm(path):
+    # Con varias capturas se queda el peor caso de cada tarea
+    worst = {}
+    with open(path, encoding='utf-8', errors='replace') as f:
+        for line in f:
+            m = TASKS_LINE.match(line)
+            if not m or m.group(1) not in TASKS:
+                continue
+            free = int(m.group(3))
+            worst[m.group(1)] = min(free, worst.get(m.group(1), free))
+    return worst
+
+
+def read_tcb_size(path):
+    with open(path, encoding='utf-8', errors='replace') as f:
+        m = TCB_SYMBOL.search(f.read())
+    return int(m.group(1), 16) if m else None
+
+
+def read_map(path):
+    with open(path, encoding='utf-8', errors='replace') as f:
+        text = f.read()
+    symbols = []
+    for m in MAP_SECTION.finditer(text):
+        size = int(m.group(3), 16)
+        lib = OWN_LIBS.search(m.group(4))
+        if size == 0 or not lib:
+            continue
+        name = m.group(1)
+        for prefix in ('.bss.', '.data.', '.dram1.', '.sbss.', '.sdata.'):
+            if name.startswith(prefix):
+                name = name[len(prefix):]
+        symbols.append((size, f'{lib.group(2)}:{name}'))
+    symbols.sort(reverse=True)
+    return symbols
+
+
+def report(args, out):
+    layout = read_layout(args.layout)
+    config = {}
+    if args.sdkconfig:
+        with open(args.sdkconfig, encoding='utf-8') as f:
+            config = json.load(f)
+    static_mode = bool(config.get('APP_STATIC_MEMORY'))
+    hwm = read_hwm(args.hwm) if args.hwm else {}
+    margin = layout.get('STACK_MARGIN', 512)
+    tcb_size = read_tcb_size(args.map) if args.map else None
+
+    print(f'Modo de memoria: {"estatico" if static_mode else "heap"}', file=out)
+    print('', file=out)
+    print(f'{"tarea":<8} {"pila":>6} {"pico":>6} {"propuesta":>9}', file=out)
+    total = 0
+    for task, (define, option) in TASKS.items():
+        if option and config and not config.get(option):
+            continue
+        stack = layout.get(define, 0)
+        total += stack + (tcb_size or 0)
+        if task in hwm:
+            peak = stack - hwm[task]
+            print(f'{task:<8} {stack:>6} {peak:>6} {round_up(peak + margin, 256):>9}', file=out)
+        else:
+            print(f'{task:<8} {stack:>6} {"-":>6} {"-":>9}', file=out)
+    where = "en .bss" if static_mode else "del heap al arrancar"
+    if tcb_size:
+        print(f'pilas + TCB ({tcb_size} bytes cada uno): {total} bytes ({where})', file=out)
+    else:
+        # En modo heap el TCB no aparece en el .map: solo se suman las pilas
+        print(f'pilas: {total} bytes ({where}; sin el TCB de cada tarea)', file=out)
+
+    if args.map:
+        symbols = read_map(args.map)
+        print('', file=out)
+        print('RAM estatica (main y led_strip):', file=out)
+        for size, name in symbols[:args.top]:
+            print(f'{size:>8}  {name}', file=out)
+        if len(symbols) > args.top:
+            rest = sum(size for size, _ in symbols[args.top:])
+            print(f'{rest:>8}  ({len(symbols) - args.top} simbolos mas)', file=out)
+        print(f'total: {sum(size for size, _ in symbols)} bytes', file=out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Informe de memoria estatica del controlador Zoom G6')
+    parser.add_argument('--layout', default='main/mem_layout.h', help='cabecera con las pilas (STACK_*)')
+    parser.add_argument('--sdkconfig', help='build/config/sdkconfig.json')
+    parser.add_argument('--map', help='fichero .map del enlazado')
+    parser.add_argument('--hwm', help='captura del comando "tasks" de la consola')
+    parser.add_argument('--top', type=int, default=20, help='simbolos a listar')
+    parser.add_argument('-o', '--output', help='escribe el informe en un fichero ademas de en stdout')
+    args = parser.parse_args()
+
+    report(args, sys.stdout)
+    if args.output:
+        with open(args.output, 'w', encoding='utf-8') as f:
+            report(args, f)
+
+
+if __name__ == '__main__':
+    main()
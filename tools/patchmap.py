@@ -0,0 +1,85 @@
+#!/usr/bin/env python3
+# Genera la imagen de la partición "patchmap" (ver main/patch_map.h).
+#
+# Entrada: un fichero de texto con una línea por botón:
+#   pagina, boton, banco, parche
+# donde pagina y boton empiezan en 1, banco es el nombre de la G6 (A..Z, AA..AX)
+# o su número, y parche va de 1 a 4. Las líneas vacías y las que empiezan por '#'
+# se ignoran; los botones que no aparezcan quedan en el banco A, parche 1.
+#
+# Uso:
+#   tools/patchmap.py mapa.txt patchmap.bin --buttons 8
+#   parttool.py write_partition --partition-name patchmap --input patchmap.bin
+import argparse
+import struct
+import sys
+import zlib
+
+MAGIC = 0x50414D50
+VERSION = 1
+PATCHES_PER_BANK = 4
+NUM_BANKS = 50
+PARTITION_SIZE = 0x10000
+# num_pages y num_buttons ocupan un byte cada uno en la cabecera
+MAX_PAGES = 255
+MAX_BUTTONS = 255
+
+
+def parse_bank(text):
+    text = text.strip().upper()
+    if text.isdigit():
+        bank = int(text)
+    elif len(text) == 1 and text.isalpha():
+        bank = ord(text) - ord('A')
+    elif len(text) == 2 and text[0] == 'A' and text[1].isalpha():
+        bank = 26 + ord(text[1]) - ord('A')
+    else:
+        raise ValueError(f'banco no valido: {text}')
+    if not 0 <= bank < NUM_BANKS:
+        raise ValueError(f'banco fuera de rango: {text}')
+    return bank
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Genera patchmap.bin para el controlador Zoom G6')
+    parser.add_argument('input')
+    parser.add_argument('output')
+    parser.add_argument('--buttons', type=int, default=8, help='CONFIG_APP_NUM_BUTTONS del firmware')
+    args = parser.parse_args()
+    if not 1 <= args.buttons <= MAX_BUTTONS:
+        sys.exit(f'--buttons debe estar entre 1 y {MAX_BUTTONS}')
+
+    entries = {}
+    with open(args.input, encoding='utf-8') as f:
+        for num, line in enumerate(f, 1):
+            line = line.split('#', 1)[0].strip()
+            if not line:
+                continue
+            try:
+                page, button, bank, program = [x.strip() for x in line.split(',')]
+                page, button, program = int(page) - 1, int(button) - 1, int(program) - 1
+                # La página más alta fija num_pages = page + 1, que tiene que caber en un byte
+                if page < 0 or page > MAX_PAGES - 1 or not 0 <= button < args.buttons or not 0 <= program < PATCHES_PER_BANK:
+                    raise ValueError(f'pagina (1..{MAX_PAGES}), boton (1..{args.buttons}) o parche '
+                                     f'(1..{PATCHES_PER_BANK}) fuera de rango')
+                entries[(page, button)] = (0, parse_bank(bank), program)
+            except ValueError as e:
+                sys.exit(f'{args.input}:{num}: {e}')
+
+    if not entries:
+        sys.exit('el mapa no tiene entradas')
+
+    pages = max(p for p, _ in entries) + 1
+    body = b''.join(struct.pack('<BBBB', *entries.get((p, b), (0, 0, 0)), 0)
+                    for p in range(pages) for b in range(args.buttons))
+    header = struct.pack('<IBBBBII', MAGIC, VERSION, args.buttons, pages, 0, zlib.crc32(body), 0)
+    if len(header) + len(body) > PARTITION_SIZE:
+        sys.exit('el mapa no cabe en la particion')
+
+    with open(args.output, 'wb') as f:
+        f.write(header + body)
+    print(f'{args.output}: {pages} paginas de {args.buttons} botones')
+
+
+if __name__ == '__main__':
+    main()
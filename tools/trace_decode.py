@@ -0,0 +1,130 @@
+#!/usr/bin/env python3
+# Decodifica el volcado de trazas binarias del firmware (main/trace.h).
+#
+# La entrada es cualquier captura del log (idf.py monitor, miniterm, un fichero...):
+# se toman solo las líneas "T:<32 hex>" y el resto se ignora.
+#
+# Uso:
+#   tools/trace_decode.py captura.log                 # línea de tiempo legible
+#   tools/trace_decode.py captura.log --chrome t.json # además, JSON para chrome://tracing o Perfetto
+import argparse
+import json
+import re
+import struct
+import sys
+
+RECORD = struct.Struct('<IHBBII')  # ts_us, id, core, a0, a1, a2
+LINE = re.compile(r'T:([0-9a-fA-F]{32})')
+
+# Misma tabla que trace_event_t en main/trace.h
+EVENTS = {
+    1: 'press',
+    2: 'patch',
+    3: 'setlist',
+    4: 'xfer_submit',
+    5: 'xfer_done',
+    6: 'standby',
+    7: 'connect',
+}
+
+MSG_TYPES = {0: 'boton', 1: 'setlist+', 2: 'setlist-'}
+
+
+def bank_name(bank):
+    return chr(ord('A') + bank) if bank < 26 else 'A' + chr(ord('A') + (bank - 26) % 26)
+
+
+def describe(ev):
+    i, a0, a1, a2 = ev['id'], ev['a0'], ev['a1'], ev['a2']
+    if i == 1:
+        kind = MSG_TYPES.get(a1 & 0x7F, str(a1 & 0x7F))
+        return f'boton {a0} ({kind}{", despierta" if a1 & 0x80 else ""})'
+    if i == 2:
+        return f'pagina {a2 + 1} boton {a0} -> banco {bank_name(a1 >> 8)} parche {(a1 & 0xFF) + 1}'
+    if i == 3:
+        return f'cancion {a0 + 1} -> banco {bank_name(a2 >> 8)} parche {(a2 & 0xFF) + 1}, {a1} bytes'
+    if i == 4:
+        return f'{a0} paquetes, {a1} bytes'
+    if i == 5:
+        return f'estado {a0}' + (f', {a1} us desde la pulsacion' if a1 else '')
+    if i == 6:
+        return 'entra' if a0 else 'sale'
+    if i == 7:
+        return 'conectada' if a0 else 'desconectada'
+    return f'a0={a0} a1={a1} a2={a2}'
+
+
+def read_records(stream):
+    per_core = {}
+    for line in stream:
+        m = LINE.search(line)
+        if not m:
+            continue
+        ts, ev_id, core, a0, a1, a2 = RECORD.unpack(bytes.fromhex(m.group(1)))
+        per_core.setdefault(core, []).append({'ts': ts, 'id': ev_id, 'core': core, 'a0': a0, 'a1': a1, 'a2': a2})
+
+    # Cada núcleo vuelca en orden: se desenrolla el contador de 32 bits por separado
+    events = []
+    for recs in per_core.values():
+        wraps = 0
+        prev = None
+        for r in recs:
+            if prev is not None and r['ts'] < prev:
+                wraps += 1
+            prev = r['ts']
+            r['ts'] += wraps << 32
+            events.append(r)
+    events.sort(key=lambda e: e['ts'])
+    return events
+
+
+def print_timeline(events, out):
+    if not events:
+        print('sin trazas en la entrada', file=sys.stderr)
+        return
+    t0 = events[0]['ts']
+    prev = t0
+    for e in events:
+        name = EVENTS.get(e['id'], f'ev{e["id"]}')
+        print(f'{(e["ts"] - t0) / 1000:12.3f} ms  +{e["ts"] - prev:8d} us  core {e["core"]}  '
+              f'{name:<12} {describe(e)}', file=out)
+        prev = e['ts']
+
+
+def chrome_trace(events):
+    trace = []
+    for e in events:
+        name = EVENTS.get(e['id'], f'ev{e["id"]}')
+        item = {'name': name, 'ts': e['ts'], 'pid': 0, 'tid': e['core'],
+                'args': {'a0': e['a0'], 'a1': e['a1'], 'a2': e['a2'], 'info': describe(e)}}
+        if e['id'] == 5 and e['a1']:
+            # La transferencia completada se dibuja como un tramo desde la pulsación
+            item.update(ph='X', ts=e['ts'] - e['a1'], dur=e['a1'], name='press_to_midi')
+        else:
+            item.update(ph='i', s='t')
+        trace.append(item)
+    for core in sorted({e['core'] for e in events}):
+        trace.append({'name': 'thread_name', 'ph': 'M', 'pid': 0, 'tid': core, 'args': {'name': f'core {core}'}})
+    return {'traceEvents': trace, 'displayTimeUnit': 'ms'}
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Decodifica las trazas binarias del controlador Zoom G6')
+    parser.add_argument('input', nargs='?', default='-', help='captura del log (por defecto, stdin)')
+    parser.add_argument('--chrome', metavar='JSON', help='escribe también un fichero Chrome trace')
+    args = parser.parse_args()
+
+    if args.input == '-':
+        events = read_records(sys.stdin)
+    else:
+        with open(args.input, encoding='utf-8', errors='replace') as f:
+            events = read_records(f)
+
+    print_timeline(events, sys.stdout)
+    if args.chrome:
+        with open(args.chrome, 'w', encoding='utf-8') as f:
+            json.dump(chrome_trace(events), f)
+
+
+if __name__ == '__main__':
+    main()